@@ -46,21 +46,52 @@ typedef struct
 
     int x, y;                   /**< Hoofd-coördinaten (startpunt) */
     int x2, y2;                 /**< Tweede punt (lijn/figuur/rechthoek) */
-    int x3, y3;                 /**< Derde punt (figuur) */
+    int x3, y3;                 /**< Derde punt (figuur/driehoek) */
     int x4, y4;                 /**< Vierde punt (figuur) */
     int x5, y5;                 /**< Vijfde punt (figuur) */
 
     int breedte, hoogte;        /**< Afmetingen voor rechthoek */
     int dikte;                  /**< Lijndikte */
-    int radius;                 /**< Cirkel radius */
+    int radius;                 /**< Cirkel radius (horizontale straal bij ellips/boog) */
+    int radius_y;               /**< Verticale straal bij ellips/boog */
+    int starthoek, eindhoek;    /**< Hoeken in graden voor boog */
 
     int start;                  /**< Startindex voor herhaal */
     int aantal;                 /**< Aantal voor herhaal of bitmap index */
     int gevuld;                 /**< Gevuld = 1 of 0 */
 
     int bitmap_nr;              /**< Index bitmap */
+    int dekking;                /**< Dekking in procenten (25, 50, 75 of 100) */
+
+    int punten[POLYGOON_MAX_PUNTEN * 2]; /**< Hoekpunten (x, y) voor polygoon/driehoekstrip */
+    int aantal_punten;          /**< Aantal hoekpunten voor polygoon/driehoekstrip */
+    int vulling;                /**< Vulregel polygoon: 0 = geen, 1 = even-oneven, 2 = non-zero */
+    int patroon_nr;             /**< Nummer van een 8x8 patroon, -1 = uit (vulpatroon) */
+    int rijen[8];               /**< Rijen van een 8x8 patroon, bit 7 is de linker pixel */
+    int vlakheid;               /**< Maximale afwijking van een Bézier-kromme in 1/16 pixel */
+    int stap;                   /**< Horizontale afstand tussen meetwaarden (plot) of rasterlijnen (grafiekraster) */
+    int grafiek_nr;             /**< Nummer van een grafiek (grafiek/grafiekraster/meting) */
+    int ondergrens, bovengrens; /**< Meetwaarden op de onderste en bovenste rij van een grafiek */
+    int kanalen;                /**< Aantal kanalen van een grafiek */
+    int hoek;                   /**< Draaihoek in graden (draai) */
+    int schaal_x, schaal_y;     /**< Schaalfactoren in procenten (schaal) */
+    const int16_t *reeks;       /**< Meetwaarden (plot) of punten (x, y) (polylijn/puntenwolk), max. PLOT_MAX_PUNTEN */
+    int soort;                  /**< Soort verloop: 0 = horizontaal, 1 = verticaal, 2 = radiaal, -1 = onbekend */
+    int boven, onder;           /**< Vaste rijen boven en onder het rolgebied (splits) */
+    int regels;                 /**< Aantal rijen om te rollen, positief is omhoog (rol) */
+    int sprite_nr;              /**< Nummer van een sprite (sprite) */
+    int laag;                   /**< Z-volgorde van een sprite, hoger ligt bovenop (sprite) */
+    int effect_nr;              /**< Nummer van een raster-effect (effect/effectfase) */
+    int amplitude;              /**< Grootste verschuiving van een golf in pixels (effect) */
+    int fase;                   /**< Tabelwaarde van de eerste rij van een effect (effectfase) */
 
     char kleur[20];             /**< Kleurnaam als string */
+    char kleur2[20];            /**< Kleur tweede hoekpunt (driehoek), eindkleur (verloop) of achtergrond (schrijf) */
+    char kleur3[20];            /**< Kleur derde hoekpunt (driehoek) */
+    char kanaalkleuren[VGA_CHART_MAX_CHANNELS][20]; /**< Kleur per kanaal (grafiek) */
+    char lijnstijl[20];         /**< Lijnstijl (lijn/figuur): naam of 32-bits masker */
+    char actie[8];              /**< push, pop of reset (transformatie), aan of uit (dubbelbuffer, lijst), kopie (toon), soort (effect) */
+    char modus[12];             /**< Naam van een videomodus (modus), sprite-modus (spritemodus) of planner (planner) */
     char tekst[110];            /**< Tekst voor TEKST commando */
     char fontnaam[30];          /**< Lettertype */
     int fontgrootte;            /**< Grootte lettertype */
@@ -15,13 +15,44 @@
 #include <string.h>
 
 #include "stm32_ub_vga_screen.h"
+#include "stm32_ub_vga_blend.h"
+#include "stm32_ub_vga_shapes.h"
+#include "stm32_ub_vga_fill.h"
+#include "stm32_ub_vga_chart.h"
+#include "stm32_ub_vga_transform.h"
+#include "stm32_ub_vga_displaylist.h"
+#include "stm32_ub_vga_textmode.h"
+#include "stm32_ub_vga_sprite.h"
+#include "stm32_ub_vga_raster.h"
+#include "stm32_ub_vga_sched.h"
 #include "stm32f4xx_hal.h"
 
-// Schermdimensies
+/** @brief Dekking in procenten van een ondoorzichtig (normaal) commando. */
+#define DEKKING_VOL 100
+
+/** @brief Maximum aantal hoekpunten van een polygoon-commando (begrensd door de regellengte). */
+#define POLYGOON_MAX_PUNTEN 16
+
+/** @brief Maximum aantal punten of meetwaarden van een plot-, polylijn- of puntenwolk-commando. */
+#define PLOT_MAX_PUNTEN 512
+
+/** @brief Aantal waarden van een plot, polylijn, puntenwolk of meting dat 'herhaal' bewaart; een langere reeks kan niet herhaald worden. */
+#define HERHAAL_MAX_WAARDEN (POLYGOON_MAX_PUNTEN * 2)
+
+/** @brief Aantal grafieken (strip-charts) dat tegelijk op het scherm kan staan. */
+#define GRAFIEK_AANTAL 4
+
+/** @brief Aantal transformaties dat met 'transformatie,push' bewaard kan worden. */
+#define TRANSFORMATIE_DIEPTE 8
+
+/** @brief Aantal tabelwaarden van een golf of verloop van een raster-effect. */
+#define EFFECT_STAPPEN 32
+
+// Schermdimensies, volgen de videomodus van de VGA-driver (standaard 320x240)
 /** @brief Breedte van het scherm in pixels. */
-#define SCHERM_BREEDTE 320
+#define SCHERM_BREEDTE VGA_DISPLAY_X
 /** @brief Hoogte van het scherm in pixels. */
-#define SCHERM_HOOGTE 240
+#define SCHERM_HOOGTE VGA_DISPLAY_Y
 
 /**
  * @enum Resultaat
@@ -40,11 +71,15 @@ typedef enum {
     ERROR_OUT_OF_BOUNDS,
 	ERROR_TEXT_TOO_LONG,
 	ERROR_TOO_MANY_REPEATS,
+	ERROR_INVALID_PARAM_DEKKING,
+	ERROR_NOT_REPEATABLE,
 
 	VGA_OK = 200,
 	ERROR_VGA,
 	ERROR_VGA_INVALID_COORDINATE,
-	ERROR_VGA_INVALID_PARAMETER
+	ERROR_VGA_INVALID_PARAMETER,
+	ERROR_VGA_OUT_OF_MEMORY,
+	ERROR_VGA_TIMEOUT
 } Resultaat;
 
 /**
@@ -63,6 +98,47 @@ typedef enum {
     CMD_CLEAR,
     CMD_CIRKEL,
     CMD_FIGUUR,
+    CMD_POLYGOON,
+    CMD_DRIEHOEK,
+    CMD_DRIEHOEKSTRIP,
+    CMD_ELLIPS,
+    CMD_BOOG,
+    CMD_AFGERONDE_RECHTHOEK,
+    CMD_VUL,
+    CMD_VERLOOP,
+    CMD_PATROON,
+    CMD_VULPATROON,
+    CMD_BEZIER,
+    CMD_PLOT,
+    CMD_POLYLIJN,
+    CMD_PUNTENWOLK,
+    CMD_GRAFIEK,
+    CMD_GRAFIEKRASTER,
+    CMD_METING,
+    CMD_VERSCHUIF,
+    CMD_DRAAI,
+    CMD_SCHAAL,
+    CMD_TRANSFORMATIE,
+    CMD_SPLITS,
+    CMD_ROL,
+    CMD_MODUS,
+    CMD_DUBBELBUFFER,
+    CMD_TOON,
+    CMD_FPS,
+    CMD_LIJST,
+    CMD_LIJSTINFO,
+    CMD_TEKSTVAK,
+    CMD_SCHRIJF,
+    CMD_TEKSTROL,
+    CMD_SPRITE,
+    CMD_SPRITEMODUS,
+    CMD_SPRITEINFO,
+    CMD_EFFECT,
+    CMD_EFFECTFASE,
+    CMD_EFFECTINFO,
+    CMD_MENGINFO,
+    CMD_PLANNER,
+    CMD_PLANNERINFO,
     CMD_UNKNOWN
 } CommandType;
 
@@ -77,20 +153,65 @@ typedef struct {
     char tekst_inhoud[100];
     char fontnaam[20];
     char fontstijl[20];
+    int16_t punten[HERHAAL_MAX_WAARDEN]; // Hoekpunten (x, y) van een polygoon of driehoekstrip, of de waarden van een reeks
 } Commando;
 
 /**
  * @brief Functies die gebruikt worden in logic.c
  */
-Resultaat lijn(int x, int y, int x2, int y2, const char *kleur, int dikte);
-Resultaat rechthoek(int x_lup, int y_lup, int breedte, int hoogte, const char *kleur, int gevuld);
+Resultaat lijn(int x, int y, int x2, int y2, const char *kleur, int dikte, int dekking, const char *lijnstijl);
+Resultaat rechthoek(int x_lup, int y_lup, int breedte, int hoogte, const char *kleur, int gevuld, int dekking);
 Resultaat tekst(int x, int y, const char *kleur, const char tekst[100], const char fontnaam[20], int fontgrootte, const char fontstijl[20]);
-Resultaat bitmap(int nr, int x_lup, int y_lup);
+Resultaat bitmap(int nr, int x_lup, int y_lup, int dekking);
 Resultaat clearscherm(const char *kleur);
 Resultaat wacht(int msecs);
 Resultaat herhaal(int aantal, int hoevaak);
-Resultaat cirkel(int x, int y, int radius, const char *kleur);
-Resultaat figuur(int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4, int x5, int y5, const char *kleur);
+Resultaat cirkel(int x, int y, int radius, const char *kleur, int dikte, int gevuld);
+Resultaat figuur(int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4, int x5, int y5, const char *kleur, const char *lijnstijl);
+Resultaat polygoon(const int *punten, int aantal, const char *kleur, int dikte, int vulling);
+Resultaat driehoek(int x1, int y1, int x2, int y2, int x3, int y3, const char *kleur1, const char *kleur2, const char *kleur3);
+Resultaat driehoekstrip(const int *punten, int aantal, const char *kleur);
+Resultaat ellips(int x, int y, int radius_x, int radius_y, const char *kleur, int gevuld);
+Resultaat boog(int x, int y, int radius_x, int radius_y, int starthoek, int eindhoek, const char *kleur);
+Resultaat vul(int x, int y, const char *kleur);
+Resultaat bezier(const int *punten, int aantal, const char *kleur, int dikte, int vlakheid);
+Resultaat plot(int x, int stap, const int16_t *y, int aantal, const char *kleur, int dikte);
+Resultaat polylijn(const int16_t *punten, int aantal, const char *kleur, int dikte);
+Resultaat puntenwolk(const int16_t *punten, int aantal, const char *kleur);
+Resultaat grafiek(int id, int x_lup, int y_lup, int breedte, int hoogte, int ondergrens, int bovengrens,
+                  const char *achtergrond, const char kleuren[][20], int kanalen);
+Resultaat grafiekraster(int id, int afstand, const char *kleur);
+Resultaat meting(int id, const int16_t *waarden, int aantal);
+Resultaat verschuif(int dx, int dy);
+Resultaat draai(int hoek, int x, int y);
+Resultaat schaal(int sx, int sy);
+Resultaat transformatie(const char *actie);
+Resultaat splits(int boven, int onder);
+Resultaat rol(int regels, const char *kleur);
+Resultaat modus(const char *naam);
+Resultaat dubbelbuffer(const char *stand);
+Resultaat toon(const char *optie);
+Resultaat fps(VGA_PageStats *stats);
+Resultaat lijst(const char *stand);
+Resultaat lijstinfo(VGA_ListStats *stats);
+Resultaat tekstvak(int eerste, int rijen);
+Resultaat schrijf(int kolom, int rij, const char *kleur, const char *achtergrond, const char *tekst);
+Resultaat tekstrol(int regels, const char *kleur);
+Resultaat sprite(int id, int nr, int x, int y, int laag);
+Resultaat spritemodus(const char *naam);
+Resultaat spriteinfo(VGA_SpriteStats *stats);
+Resultaat effect(int id, const char *soort, int eerste, int rijen, int x, int breedte, int amplitude,
+                 const char *kleur, const char *van, const char *naar);
+Resultaat effectfase(int id, int fase);
+Resultaat effectinfo(VGA_RasterStats *stats);
+Resultaat menginfo(VGA_BlendBench *bench);
+Resultaat planner(const char *naam);
+Resultaat plannerinfo(VGA_SchedStats *stats, VGA_IsrStats *isr);
+void planner_volgorde(CommandType type);
+Resultaat patroon(int id, const int *rijen);
+Resultaat vulpatroon(int id, const char *achtergrond);
+Resultaat verloop(int x_lup, int y_lup, int breedte, int hoogte, const char *kleur1, const char *kleur2, int soort);
+Resultaat afgeronde_rechthoek(int x_lup, int y_lup, int breedte, int hoogte, int radius, const char *kleur, int gevuld);
 
 Resultaat vgaStatusToResultaat(int status);
 
@@ -0,0 +1,140 @@
+/**
+ * @file    stm32_ub_vga_blend.h
+ * @brief   Translucent drawing on the R3G3B2 framebuffer.
+ * @details Blends spans, rectangles, lines and bitmaps into VGA_RAM1 at a
+ *          fixed set of opacity levels (25/50/75%). The kernels work on four
+ *          pixels per 32-bit word using the Cortex-M4 SIMD instructions from
+ *          core_cm4_simd.h and fall back to plain C on other targets.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_BLEND_H
+#define __STM32F4_UB_VGA_BLEND_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+
+
+//--------------------------------------------------------------
+/**
+ * @brief Supported opacity levels, expressed in quarters.
+ * @details The blend of a source color S over a destination D is
+ *          S*a + D*(1-a), computed per R, G and B field.
+ */
+//--------------------------------------------------------------
+typedef enum {
+    VGA_ALPHA_0 = 0,   /*!< Fully transparent, nothing is drawn */
+    VGA_ALPHA_25,      /*!< 25% source, 75% destination */
+    VGA_ALPHA_50,      /*!< 50% source, 50% destination */
+    VGA_ALPHA_75,      /*!< 75% source, 25% destination */
+    VGA_ALPHA_100      /*!< Opaque, identical to the normal primitives */
+} VGA_Alpha;
+
+
+//--------------------------------------------------------------
+// Benchmark of the blend kernels
+//--------------------------------------------------------------
+#define VGA_BLEND_BENCH_PIXELS  320   /*!< Pixels in the benchmark row */
+#define VGA_BLEND_BENCH_RUNS    8     /*!< Runs per kernel; the shortest counts */
+
+//--------------------------------------------------------------
+/**
+ * @brief Cycles of the blend kernels on one row, from UB_VGA_BlendBenchmark.
+ * @details Cycles are HCLK cycles, from the DWT cycle counter, for
+ *          VGA_BLEND_BENCH_PIXELS pixels. The SIMD fields are 0 when the
+ *          library is built without the Cortex-M4 SIMD instructions.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    uint32_t span_simd[3];  /*!< Solid span at 25, 50 and 75%, __UHADD8 kernel */
+    uint32_t span_c[3];     /*!< Solid span at 25, 50 and 75%, plain C kernel */
+    uint32_t keyed_simd;    /*!< Color-keyed bitmap row at 50%, __UHADD8 and __SEL */
+    uint32_t keyed_c;       /*!< Color-keyed bitmap row at 50%, plain C */
+} VGA_BlendBench;
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Blends two R3G3B2 colors.
+ * @param src Source (foreground) color.
+ * @param dst Destination (background) color.
+ * @param alpha Opacity of the source color.
+ * @return The blended color.
+ */
+uint8_t UB_VGA_BlendColor(uint8_t src, uint8_t dst, VGA_Alpha alpha);
+
+/**
+ * @brief Blends a horizontal span with a color, respecting the clipping rectangle.
+ * @param x0 Starting X-coordinate.
+ * @param y Y-coordinate.
+ * @param x1 Ending X-coordinate.
+ * @param color 8-bit color value (R3G3B2).
+ * @param alpha Opacity of the color.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_BlendHLine(int32_t x0, int32_t y, int32_t x1, uint8_t color, VGA_Alpha alpha);
+
+/**
+ * @brief Draws a translucent rectangle.
+ * @param x_lup X-coordinate of the top-left corner.
+ * @param y_lup Y-coordinate of the top-left corner.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param color 8-bit color value (R3G3B2).
+ * @param filled 1 for a filled rectangle, 0 for the outline only.
+ * @param alpha Opacity of the color.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_BlendRectangle(uint16_t x_lup, uint16_t y_lup, uint16_t width, uint16_t height, uint8_t color, uint8_t filled, VGA_Alpha alpha);
+
+/**
+ * @brief Draws a translucent line.
+ * @details A thick line covers the same pixels as UB_VGA_DrawLine with the
+ *          same thickness, round ends included, and every pixel is blended
+ *          exactly once.
+ * @param x1 Starting X-coordinate.
+ * @param y1 Starting Y-coordinate.
+ * @param x2 Ending X-coordinate.
+ * @param y2 Ending Y-coordinate.
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Line thickness in pixels.
+ * @param alpha Opacity of the color.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_BlendLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t color, uint8_t thickness, VGA_Alpha alpha);
+
+/**
+ * @brief Draws a pre-defined bitmap with translucency.
+ * @details Pixels with BITMAP_TRANSPARENT_COLOR are skipped.
+ * @param id ID of the bitmap to draw.
+ * @param x_lup X-coordinate of the top-left corner.
+ * @param y_lup Y-coordinate of the top-left corner.
+ * @param alpha Opacity of the bitmap.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_BlendBitmap(uint8_t id, uint16_t x_lup, uint16_t y_lup, VGA_Alpha alpha);
+
+/**
+ * @brief Times the blend kernels against their plain C versions.
+ * @details Each kernel blends a row in RAM outside the framebuffer, so
+ *          the figure is the kernel alone without waits on the scanout
+ *          DMA. Interrupts stay enabled; the shortest of
+ *          VGA_BLEND_BENCH_RUNS runs is kept, which drops the runs an
+ *          interrupt fell into. Takes well under a millisecond.
+ * @param bench Filled with the cycles per row.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_BlendBenchmark(VGA_BlendBench *bench);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_BLEND_H
@@ -0,0 +1,119 @@
+/**
+ * @file    stm32_ub_vga_chart.h
+ * @brief   Strip charts (oscilloscope-style live traces) on the VGA screen.
+ * @details A strip chart is bound to a rectangle and shows the last
+ *          samples of up to VGA_CHART_MAX_CHANNELS channels. Appending a
+ *          sample only touches one or two columns of the rectangle, so the
+ *          cost per sample grows with the height of the chart, not with its
+ *          area.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_CHART_H
+#define __STM32F4_UB_VGA_CHART_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+
+
+//--------------------------------------------------------------
+/**
+ * @brief Largest number of channels (traces) of one chart.
+ */
+//--------------------------------------------------------------
+#define VGA_CHART_MAX_CHANNELS   4
+
+//--------------------------------------------------------------
+/**
+ * @brief Number of blank columns kept just ahead of the write column.
+ * @details Marks where the sweep is: the trace to the left of the gap is
+ *          new, the trace to the right of it is one sweep old.
+ */
+//--------------------------------------------------------------
+#define VGA_CHART_GAP   4
+
+//--------------------------------------------------------------
+/**
+ * @brief State of a strip chart.
+ * @details Owned by the caller and set up with UB_VGA_ChartInit. The
+ *          fields are read-only for the caller.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    int16_t x, y;                               /*!< Top-left corner on screen */
+    uint16_t width, height;                     /*!< Size of the chart */
+    int16_t min;                                /*!< Value shown on the bottom row */
+    uint32_t scale;                             /*!< (height - 1) / (max - min) in 16.16 fixed point */
+    uint16_t range;                             /*!< max - min */
+    uint8_t channels;                           /*!< Number of channels */
+    uint8_t colors[VGA_CHART_MAX_CHANNELS];     /*!< Trace color per channel (R3G3B2) */
+    int16_t last[VGA_CHART_MAX_CHANNELS];       /*!< Row of the previous sample, -1 before the first */
+    uint8_t background;                         /*!< Background color (R3G3B2) */
+    uint8_t grid_color;                         /*!< Grid color (R3G3B2) */
+    uint8_t grid_spacing;                       /*!< Distance between grid lines, 0 for no grid */
+    uint16_t column;                            /*!< Column the next sample is written to */
+} VGA_Chart;
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Sets up a strip chart and clears its rectangle.
+ * @param chart Chart state to initialise.
+ * @param x X-coordinate of the top-left corner.
+ * @param y Y-coordinate of the top-left corner.
+ * @param width Width (VGA_CHART_GAP + 1 or more). The chart must lie on screen.
+ * @param height Height (2 or more).
+ * @param min Sample value shown on the bottom row.
+ * @param max Sample value shown on the top row, larger than min.
+ * @param channels Number of channels (1 to VGA_CHART_MAX_CHANNELS).
+ * @param colors Array of channels trace colors (R3G3B2).
+ * @param background Background color (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_ChartInit(VGA_Chart *chart, int16_t x, int16_t y, uint16_t width, uint16_t height,
+                            int16_t min, int16_t max, uint8_t channels, const uint8_t *colors, uint8_t background);
+
+/**
+ * @brief Sets the grid of a chart and clears the chart.
+ * @details Grid lines run every spacing pixels, counted from the left
+ *          column and the bottom row of the chart.
+ * @param chart Chart state.
+ * @param spacing Distance between grid lines in pixels, 0 to switch the grid off.
+ * @param color Grid color (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_ChartSetGrid(VGA_Chart *chart, uint8_t spacing, uint8_t color);
+
+/**
+ * @brief Clears the chart and restarts the sweep at the left column.
+ * @param chart Chart state.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_ChartClear(VGA_Chart *chart);
+
+/**
+ * @brief Appends one sample per channel.
+ * @details The samples are written to the current column as a vertical
+ *          span per channel from the previous sample to the new one, then
+ *          the write column advances and wraps around at the right edge.
+ *          Only the column VGA_CHART_GAP ahead is erased, so the cost is a
+ *          few spans of at most the chart height. Values outside the range
+ *          are drawn on the top or bottom row.
+ * @param chart Chart state.
+ * @param values Array with one sample per channel.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_ChartAppend(VGA_Chart *chart, const int16_t *values);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_CHART_H
@@ -0,0 +1,179 @@
+/**
+ * @file    stm32_ub_vga_displaylist.h
+ * @brief   Display list renderer: the picture without a framebuffer.
+ * @details Instead of drawing pixels into the framebuffer, the program puts
+ *          rectangles, lines and circles in a display list. The scanout
+ *          interrupt rasterises every row from the list just before it is
+ *          sent, into one of the two line buffers, so no framebuffer is
+ *          needed and modes whose framebuffer does not fit (320x480 and
+ *          400x300 at 8 bpp) can be shown. The whole list is drawn again
+ *          every frame, so a scene changes by building a new list; nothing
+ *          has to be erased.
+ *
+ *          Every row has a budget of cycles. When it runs out, the items
+ *          not yet drawn on that row are left out, so the line is never
+ *          sent half drawn; UB_VGA_GetListStats tells how often that happens.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_DISPLAYLIST_H
+#define __STM32F4_UB_VGA_DISPLAYLIST_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+
+
+//--------------------------------------------------------------
+/**
+ * @brief Largest number of items in a display list (at most 255).
+ * @details There are two lists, the one on screen and the one being built,
+ *          of 20 bytes per item.
+ */
+//--------------------------------------------------------------
+#ifndef VGA_LIST_MAX_ITEMS
+#define VGA_LIST_MAX_ITEMS   128
+#endif
+
+//--------------------------------------------------------------
+/**
+ * @brief Default cycle budget of a row, in percent of a line.
+ * @details The interrupt has one line (4004 HCLK cycles at 640x480) to
+ *          draw the next row; the rest of that time is left to the program.
+ *          In the modes that show every row twice or more, rows are only
+ *          drawn on every second or fourth line.
+ */
+//--------------------------------------------------------------
+#ifndef VGA_LIST_BUDGET_PERCENT
+#define VGA_LIST_BUDGET_PERCENT   60
+#endif
+
+//--------------------------------------------------------------
+/**
+ * @brief Counters of the rasterisation.
+ * @details A row is late when its budget ran out before all of its items
+ *          were drawn; the items left out count as skipped, once per row.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    uint32_t lines;         /*!< Rows drawn since the reset */
+    uint32_t late_lines;    /*!< Rows on which the budget ran out */
+    uint32_t skipped;       /*!< Item rows left out because the budget ran out */
+    uint32_t max_cycles;    /*!< Longest row, in HCLK cycles */
+    uint32_t avg_cycles;    /*!< Average row, in HCLK cycles */
+    uint32_t budget_cycles; /*!< Budget of a row in the current mode, in HCLK cycles */
+    uint16_t items;         /*!< Items in the list on screen */
+    uint16_t max_active;    /*!< Most items on one row */
+} VGA_ListStats;
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Shows the display list instead of the framebuffer.
+ * @details From the next frame on. The list on screen stays as it was, an
+ *          empty black list at first. Drawing into the framebuffer is off
+ *          while the list is shown (see UB_VGA_SetLineRenderer). To use a
+ *          mode whose framebuffer does not fit, start the list first and
+ *          then set the mode; with a VGA_RAM_SIZE too small for the default
+ *          mode, start it before UB_VGA_Screen_Init.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_ListStart(void);
+
+/**
+ * @brief Shows the framebuffer again.
+ * @return VGA_Status indicating success or error; VGA_ERROR_OUT_OF_MEMORY
+ *         when the framebuffer of the mode does not fit.
+ */
+VGA_Status UB_VGA_ListStop(void);
+
+/**
+ * @brief Tells whether the display list is shown instead of the framebuffer.
+ * @return true between UB_VGA_ListStart and UB_VGA_ListStop.
+ */
+bool UB_VGA_ListActive(void);
+
+/**
+ * @brief Starts a new list, off screen.
+ * @param background Color of everything no item covers (R3G3B2).
+ */
+void UB_VGA_ListBegin(uint8_t background);
+
+/**
+ * @brief Adds a rectangle to the new list.
+ * @details Items are drawn in the order they were added, so later items
+ *          cover earlier ones. Items may lie partly or wholly off screen.
+ * @param x X-coordinate of the top-left corner.
+ * @param y Y-coordinate of the top-left corner.
+ * @param width Width (1 or more).
+ * @param height Height (1 or more).
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Border width, 0 for a filled rectangle.
+ * @return VGA_Status indicating success or error; VGA_ERROR_OUT_OF_MEMORY
+ *         when the list holds VGA_LIST_MAX_ITEMS items.
+ */
+VGA_Status UB_VGA_ListAddRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color, uint16_t thickness);
+
+/**
+ * @brief Adds a line of one pixel wide to the new list.
+ * @param x1 Starting X-coordinate.
+ * @param y1 Starting Y-coordinate.
+ * @param x2 Ending X-coordinate.
+ * @param y2 Ending Y-coordinate.
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_ListAddLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color);
+
+/**
+ * @brief Adds a circle to the new list.
+ * @param center_x X-coordinate of the center.
+ * @param center_y Y-coordinate of the center.
+ * @param radius Radius (at most 32767).
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Width of the ring, growing inward from the radius; 0 for a filled circle.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_ListAddCircle(int16_t center_x, int16_t center_y, uint16_t radius, uint8_t color, uint16_t thickness);
+
+/**
+ * @brief Shows the new list from the next frame on.
+ * @details While the list is shown, waits until the scanout has taken the
+ *          new list at the start of a frame (at most one frame), so the old
+ *          one can be reused. Then starts the next list: with keep it is a
+ *          copy of the list just shown, so that items can be added to the
+ *          scene, otherwise it is empty with the same background.
+ * @param keep true to continue from the list just shown.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_ListEnd(bool keep);
+
+/**
+ * @brief Sets the cycle budget of a row.
+ * @param percent Budget in percent of a line (1 to 100).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SetListBudget(uint8_t percent);
+
+/**
+ * @brief Returns the counters of the rasterisation.
+ * @param stats Filled with the counters since the last reset.
+ */
+void UB_VGA_GetListStats(VGA_ListStats *stats);
+
+/**
+ * @brief Clears the counters of the rasterisation.
+ */
+void UB_VGA_ResetListStats(void);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_DISPLAYLIST_H
@@ -0,0 +1,161 @@
+/**
+ * @file    stm32_ub_vga_fill.h
+ * @brief   Region fills on the VGA framebuffer.
+ * @details Fills that work on what is already in VGA_RAM1 instead of on a
+ *          geometric shape, such as the flood fill, and fills that cover an
+ *          area with more than one color, such as dithered gradients and
+ *          8x8 pattern fills.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_FILL_H
+#define __STM32F4_UB_VGA_FILL_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+
+
+//--------------------------------------------------------------
+/**
+ * @brief Number of pending spans the flood fill can hold (8 bytes each).
+ * @details Simple shapes need only a few entries. Regions that branch a lot
+ *          (mazes, combs) can need more; the fill then falls back to
+ *          sweeping the screen, which is slower but still exact.
+ */
+//--------------------------------------------------------------
+#define VGA_FLOOD_STACK_SIZE   256
+
+//--------------------------------------------------------------
+/**
+ * @brief Largest width and height of a gradient rectangle.
+ */
+//--------------------------------------------------------------
+#define VGA_GRADIENT_MAX_SIZE   1024
+
+//--------------------------------------------------------------
+/**
+ * @brief Direction in which a gradient changes from the first to the second color.
+ */
+//--------------------------------------------------------------
+typedef enum {
+    VGA_GRADIENT_HORIZONTAL = 0,   /*!< Left edge to right edge */
+    VGA_GRADIENT_VERTICAL,         /*!< Top edge to bottom edge */
+    VGA_GRADIENT_RADIAL            /*!< Center to the corners */
+} VGA_Gradient;
+
+//--------------------------------------------------------------
+/**
+ * @brief Number of 8x8 fill patterns that can be stored.
+ * @details Slots 0 to 7 start out with built-in patterns: 0 solid,
+ *          1 checkerboard, 2 horizontal hatch, 3 vertical hatch,
+ *          4 diagonal hatch (/), 5 diagonal hatch (\), 6 cross hatch and
+ *          7 dots. The other slots start out empty.
+ */
+//--------------------------------------------------------------
+#define VGA_PATTERN_COUNT   16
+
+//--------------------------------------------------------------
+/**
+ * @brief A pattern fill: a stored 8x8 pattern with its colors.
+ * @details The pattern is anchored to the screen: bit 7 of row (y & 7) is
+ *          the pixel with x & 7 == 0, so neighbouring fills line up.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    uint8_t id;         /*!< Pattern slot (0 to VGA_PATTERN_COUNT - 1) */
+    uint8_t fg;         /*!< Color of the set bits (R3G3B2) */
+    uint8_t bg;         /*!< Color of the clear bits (R3G3B2) */
+    bool transparent;   /*!< Clear bits leave the screen unchanged, bg is not used */
+} VGA_Pattern;
+
+//--------------------------------------------------------------
+/**
+ * @brief 4x4 Bayer matrix with thresholds 0..15, indexed [y & 3][x & 3].
+ * @details Shared by every function that dithers to R3G3B2, so dithered
+ *          areas drawn by different functions line up.
+ */
+//--------------------------------------------------------------
+extern const uint8_t VGA_BAYER_4X4[4][4];
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Fills the 4-connected region around a pixel with a color.
+ * @details The region is every pixel reachable from (x, y) through pixels
+ *          with the same color as (x, y), within the clipping rectangle.
+ *          Each row of the region is written as spans with
+ *          UB_VGA_FastHLine. No recursion is used, pending spans are kept on
+ *          a fixed stack in static RAM.
+ * @param x X-coordinate of the seed pixel.
+ * @param y Y-coordinate of the seed pixel.
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_SUCCESS, VGA_ERROR_INVALID_COORDINATE if the seed lies outside
+ *         the screen, or VGA_ERROR_OUT_OF_MEMORY if the stack overflowed while
+ *         all 256 colors are on screen, in which case the fill is incomplete.
+ */
+VGA_Status UB_VGA_FloodFill(uint16_t x, uint16_t y, uint8_t color);
+
+/**
+ * @brief Fills a rectangle with a dithered gradient between two colors.
+ * @details The R, G and B fields are interpolated separately and ordered
+ *          dithered (4x4 Bayer) down to R3G3B2. A vertical gradient writes
+ *          each scanline as one repeating 4-pixel word, a horizontal gradient
+ *          copies one of four precomputed rows, so both run at close to the
+ *          speed of a plain fill. A radial gradient is computed per pixel and
+ *          reaches the second color in the corners of the rectangle.
+ * @param x_lup X-coordinate of the top-left corner, may lie outside the screen.
+ * @param y_lup Y-coordinate of the top-left corner, may lie outside the screen.
+ * @param width Width of the rectangle (1 to VGA_GRADIENT_MAX_SIZE).
+ * @param height Height of the rectangle (1 to VGA_GRADIENT_MAX_SIZE).
+ * @param color1 Color at the left, top or center (R3G3B2).
+ * @param color2 Color at the right, bottom or corners (R3G3B2).
+ * @param type Direction of the gradient.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_FillGradient(int16_t x_lup, int16_t y_lup, uint16_t width, uint16_t height,
+                               uint8_t color1, uint8_t color2, VGA_Gradient type);
+
+
+/**
+ * @brief Stores an 8x8 one-bit pattern in a pattern slot.
+ * @param id Pattern slot (0 to VGA_PATTERN_COUNT - 1).
+ * @param rows 8 bytes, one per row from top to bottom; bit 7 is the leftmost pixel.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DefinePattern(uint8_t id, const uint8_t *rows);
+
+/**
+ * @brief Draws a horizontal span with a pattern, respecting the clipping rectangle.
+ * @param x0 Starting X-coordinate.
+ * @param y Y-coordinate.
+ * @param x1 Ending X-coordinate.
+ * @param pattern Pattern and colors.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_PatternHLine(int32_t x0, int32_t y, int32_t x1, const VGA_Pattern *pattern);
+
+/**
+ * @brief Fills a rectangle with a pattern, respecting the clipping rectangle.
+ * @details The eight pattern rows are expanded once into pairs of 32-bit
+ *          words and every scanline is written with aligned word stores.
+ * @param x_lup X-coordinate of the top-left corner, may lie outside the screen.
+ * @param y_lup Y-coordinate of the top-left corner, may lie outside the screen.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param pattern Pattern and colors.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_PatternRectangle(int16_t x_lup, int16_t y_lup, uint16_t width, uint16_t height, const VGA_Pattern *pattern);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_FILL_H
@@ -0,0 +1,61 @@
+/**
+ * @file    stm32_ub_vga_private.h
+ * @brief   Definitions shared by the VGA modules, not part of the API.
+ * @details The clocks the timing is built on, and the DWT cycle counter
+ *          with which the interrupt code measures itself.
+ *
+ * @date    19.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_PRIVATE_H
+#define __STM32F4_UB_VGA_PRIVATE_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32f4xx.h"
+#include <stdbool.h>
+
+
+//--------------------------------------------------------------
+// Clocks (HCLK = 126 MHz)
+//--------------------------------------------------------------
+/** @brief TIM2 clock (HCLK / 2), for the frame rate of a mode. */
+#define P_VGA_TIM2_HZ   63000000u
+
+/** @brief HCLK cycles per TIM2 tick, for the length of a line. */
+#define P_VGA_HCLK_PER_TICK   2
+
+/** @brief HCLK in kHz, to turn cycle counts into times. */
+#define P_VGA_HCLK_KHZ   (P_VGA_TIM2_HZ / 1000u * P_VGA_HCLK_PER_TICK)
+
+
+//--------------------------------------------------------------
+// DWT registers (not declared by this version of core_cm4.h)
+//--------------------------------------------------------------
+#define P_VGA_DWT_CTRL    (*(volatile uint32_t *)0xE0001000)
+#define P_VGA_DWT_CYCCNT  (*(volatile uint32_t *)0xE0001004)
+#define P_VGA_DWT_CTRL_CYCCNTENA  ((uint32_t)0x00000001)
+
+
+//--------------------------------------------------------------
+// Helpers of stm32_ub_vga_screen.c
+//--------------------------------------------------------------
+void P_VGA_CircleHalfWidths(uint16_t radius, uint8_t *half_width);
+
+
+//--------------------------------------------------------------
+// Helpers of stm32_ub_vga_sched.c, for the scanout interrupt
+//--------------------------------------------------------------
+/** @brief Set while a chunk of the render scheduler runs. */
+extern volatile bool P_VGA_SchedDrawing;
+
+/** @brief Records the TIM2 count at the end of a line sent while a chunk ran. */
+void P_VGA_SchedLineEnd(uint32_t tick);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_PRIVATE_H
@@ -0,0 +1,169 @@
+/**
+ * @file    stm32_ub_vga_raster.h
+ * @brief   Raster effects: a per-row effect list run at scanout time.
+ * @details A small table of effects that the scanout interrupt applies to
+ *          the framebuffer rows just before they are sent (see
+ *          UB_VGA_SetLineOverlay): moving rows sideways for a wobble or
+ *          parallax, replacing colors on a band of rows, or filling part of
+ *          a row. The framebuffer is not changed, so an effect costs nothing
+ *          to draw or to take away, and animating one means writing a phase
+ *          or a table entry.
+ *
+ *          Every row has a cycle budget. Before an effect the interrupt adds
+ *          its expected cost to the cycles used so far; when that does not
+ *          fit, the effect and the ones after it are left out of the row, so
+ *          the row is always sent in time.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_RASTER_H
+#define __STM32F4_UB_VGA_RASTER_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+
+
+//--------------------------------------------------------------
+/**
+ * @brief Number of effects in the table.
+ */
+//--------------------------------------------------------------
+#ifndef VGA_RASTER_MAX_EFFECTS
+#define VGA_RASTER_MAX_EFFECTS   8
+#endif
+
+//--------------------------------------------------------------
+/**
+ * @brief Default cycle budget of the effects on a row, in percent of a line.
+ * @details 40 % is 1 601 HCLK cycles at 640x480: room for a color
+ *          replacement over the whole row (about 1 250 cycles), with the
+ *          rest of the line left for the sprites and the program.
+ */
+//--------------------------------------------------------------
+#ifndef VGA_RASTER_BUDGET_PERCENT
+#define VGA_RASTER_BUDGET_PERCENT   40
+#endif
+
+//--------------------------------------------------------------
+/**
+ * @brief Kinds of effect.
+ */
+//--------------------------------------------------------------
+typedef enum {
+    VGA_RASTER_NONE = 0,    /*!< Empty entry */
+    VGA_RASTER_SHIFT,       /*!< Moves the row right by an offset from table (int8_t), wrapping around */
+    VGA_RASTER_REMAP,       /*!< Replaces every color c by table[c] (256 colors) */
+    VGA_RASTER_RECOLOR,     /*!< Replaces the color key by a color from table (uint8_t) */
+    VGA_RASTER_BLANK        /*!< Fills the columns with the color key */
+} VGA_RasterType;
+
+//--------------------------------------------------------------
+/**
+ * @brief One entry of the effect table.
+ * @details Rows are screen rows, columns screen pixels. SHIFT and RECOLOR
+ *          take one table entry per row: row first_row + n uses entry
+ *          (n / spacing + phase) % period, so a table of 16 colors with a
+ *          spacing of 4 makes a gradient of 64 rows, and counting the phase
+ *          up makes it move. Colors are R3G3B2, also in the 16-color modes.
+ *          The tables are read at scanout time and must stay valid.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    VGA_RasterType type;    /*!< Kind of effect */
+    uint16_t first_row;     /*!< First screen row */
+    uint16_t rows;          /*!< Number of rows */
+    uint16_t x;             /*!< REMAP, RECOLOR, BLANK: first column */
+    uint16_t width;         /*!< REMAP, RECOLOR, BLANK: columns, 0 for up to the right edge */
+    uint8_t key;            /*!< RECOLOR: color that is replaced; BLANK: fill color */
+    uint8_t period;         /*!< SHIFT, RECOLOR: table entries (1 or more) */
+    uint8_t spacing;        /*!< SHIFT, RECOLOR: rows per table entry, 0 counts as 1 */
+    uint8_t phase;          /*!< SHIFT, RECOLOR: table entry of the first row */
+    const void *table;      /*!< SHIFT: int8_t offsets; REMAP: 256 colors; RECOLOR: colors */
+} VGA_RasterEffect;
+
+//--------------------------------------------------------------
+/**
+ * @brief Counters of the effects.
+ * @details Cycles are HCLK cycles, from the DWT cycle counter.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    uint32_t rows;          /*!< Rows with an effect since the reset */
+    uint32_t late_rows;     /*!< Rows on which an effect was left out */
+    uint32_t skipped;       /*!< Effect rows left out, once per effect and row */
+    uint32_t max_cycles;    /*!< Longest row, in HCLK cycles */
+    uint32_t avg_cycles;    /*!< Average row with an effect, in HCLK cycles */
+    uint32_t budget_cycles; /*!< Budget of a row in the current mode, in HCLK cycles */
+} VGA_RasterStats;
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Sets an entry of the effect table, from the next frame on.
+ * @details The entries are applied to a row in order, so a later entry
+ *          works on the result of an earlier one. The interrupt copies
+ *          the table at the start of a frame, so a frame never shows half
+ *          a change. The first effect starts the effect overlay; when the
+ *          table is empty again it is stopped.
+ * @param slot Entry (0 to VGA_RASTER_MAX_EFFECTS - 1).
+ * @param effect The effect, or NULL to clear the entry.
+ * @return VGA_Status indicating success or error; VGA_ERROR_INVALID_PARAMETER
+ *         for an invalid entry, a missing table or period, or with the
+ *         original scanout engine.
+ */
+VGA_Status UB_VGA_RasterSet(uint8_t slot, const VGA_RasterEffect *effect);
+
+/**
+ * @brief Sets the phase of an effect, from the next frame on.
+ * @details Moves a wobble or a gradient by writing one byte.
+ * @param slot Entry.
+ * @param phase Table entry of the first row.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_RasterSetPhase(uint8_t slot, uint8_t phase);
+
+/**
+ * @brief Returns an entry of the effect table.
+ * @param slot Entry.
+ * @return The entry, or NULL for an invalid slot; its type is
+ *         VGA_RASTER_NONE when it is empty.
+ */
+const VGA_RasterEffect *UB_VGA_RasterGet(uint8_t slot);
+
+/**
+ * @brief Clears the effect table and stops the effect overlay.
+ */
+void UB_VGA_RasterClear(void);
+
+/**
+ * @brief Sets the cycle budget of the effects on a row.
+ * @param percent Budget in percent of a line (1 to 100).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SetRasterBudget(uint8_t percent);
+
+/**
+ * @brief Returns the counters of the effects.
+ * @param stats Filled with the counters since the last reset.
+ */
+void UB_VGA_GetRasterStats(VGA_RasterStats *stats);
+
+/**
+ * @brief Clears the counters of the effects.
+ * @details The cost per kind of effect that the budget check has measured
+ *          starts again from its estimate.
+ */
+void UB_VGA_ResetRasterStats(void);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_RASTER_H
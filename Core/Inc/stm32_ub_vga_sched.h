@@ -0,0 +1,204 @@
+/**
+ * @file    stm32_ub_vga_sched.h
+ * @brief   Render scheduler: drawing in the blanking intervals.
+ * @details While a line is sent, the DMA reads a pixel from SRAM every few
+ *          cycles. When the CPU draws into the framebuffer at the same time,
+ *          the two take turns on the bus: drawing gets slower, and a pixel
+ *          that the DMA reads late shows as jitter. The scheduler queues
+ *          drawing operations and cuts them into chunks that each fit in a
+ *          blanking interval, where the DMA leaves the bus alone.
+ *
+ *          There are three ways to run the queue, chosen per application:
+ *          - VGA_SCHED_DIRECT (default): the chunks run at once, one after
+ *            the other, as the drawing functions do.
+ *          - VGA_SCHED_VBLANK: the chunks only run in the vertical blanking
+ *            interval (1.4 ms per frame at 640x480).
+ *          - VGA_SCHED_BLANKING: the chunks also run between two lines, in
+ *            the horizontal blanking interval (about 760 cycles).
+ *
+ *          The program puts operations in the queue and calls
+ *          UB_VGA_SchedRun from its main loop, or UB_VGA_SchedFlush to wait
+ *          until everything is drawn. Nothing runs in an interrupt. A large
+ *          operation of its own is a job, a function that does a bounded
+ *          part of the work per call and yields by returning.
+ *
+ * @date    19.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_SCHED_H
+#define __STM32F4_UB_VGA_SCHED_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+
+
+//--------------------------------------------------------------
+/**
+ * @brief Number of operations in the queue.
+ */
+//--------------------------------------------------------------
+#ifndef VGA_SCHED_QUEUE_SIZE
+#define VGA_SCHED_QUEUE_SIZE   32
+#endif
+
+//--------------------------------------------------------------
+/**
+ * @brief Largest chunk, in pixels.
+ * @details A chunk is cut smaller when the blanking interval left is too
+ *          short for it. 256 pixels of a fill take about 150 cycles.
+ */
+//--------------------------------------------------------------
+#ifndef VGA_SCHED_CHUNK_PIXELS
+#define VGA_SCHED_CHUNK_PIXELS   256
+#endif
+
+//--------------------------------------------------------------
+/**
+ * @brief Where the chunks of the queue run.
+ */
+//--------------------------------------------------------------
+typedef enum {
+    VGA_SCHED_DIRECT = 0,   /*!< At once, also while lines are sent */
+    VGA_SCHED_VBLANK,       /*!< In the vertical blanking interval only */
+    VGA_SCHED_BLANKING      /*!< In the vertical and horizontal blanking intervals */
+} VGA_SchedMode;
+
+//--------------------------------------------------------------
+/**
+ * @brief A large operation that yields.
+ * @details Called with the number of pixels it may draw in this chunk; it
+ *          keeps its own progress in context.
+ * @return true when the operation is finished.
+ */
+//--------------------------------------------------------------
+typedef bool (*VGA_SchedJob)(void *context, uint32_t pixels);
+
+//--------------------------------------------------------------
+/**
+ * @brief Counters of the scheduler.
+ * @details Cycles are HCLK cycles, from the DWT cycle counter. Compare the
+ *          modes with the same drawing: draw_cycles shows the cost of
+ *          sharing the bus, busy_cycles the cost of waiting for the blank,
+ *          and jitter_ticks what the drawing did to the picture.
+ *
+ *          The jitter is measured by the scanout interrupt at the end of
+ *          every line that was sent while a chunk ran: it reads the TIM2
+ *          count, which is later when the DMA had to wait for the bus or
+ *          the chunk held off the interrupt. The spread of that count is
+ *          the jitter the chunks caused, in TIM2 ticks of two HCLK cycles.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    uint32_t ops;           /*!< Operations finished since the reset */
+    uint32_t pixels;        /*!< Pixels drawn */
+    uint32_t chunks;        /*!< Chunks run */
+    uint32_t late_chunks;   /*!< Chunks that were still running when a line was sent */
+    uint32_t max_chunk_cycles; /*!< Longest chunk */
+    uint32_t draw_cycles;   /*!< Cycles spent in the chunks */
+    uint32_t busy_cycles;   /*!< Cycles from a first operation in the empty queue until it was empty again */
+    uint32_t pixels_per_ms; /*!< pixels over busy_cycles: the drawing speed the program sees */
+    uint32_t jitter_lines;  /*!< Lines that ended while a chunk ran */
+    uint32_t jitter_ticks;  /*!< Spread of the TIM2 count at the end of those lines */
+    uint8_t queued;         /*!< Operations in the queue now */
+} VGA_SchedStats;
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Chooses where the chunks run.
+ * @details Without a running scanout every mode runs the chunks at once.
+ * @param mode VGA_SCHED_DIRECT, VGA_SCHED_VBLANK or VGA_SCHED_BLANKING.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SchedSetMode(VGA_SchedMode mode);
+
+/**
+ * @brief Returns where the chunks run.
+ * @return The mode set with UB_VGA_SchedSetMode.
+ */
+VGA_SchedMode UB_VGA_SchedGetMode(void);
+
+/**
+ * @brief Queues a filled rectangle, as UB_VGA_FillRectangle.
+ * @param x X-coordinate of the top-left corner.
+ * @param y Y-coordinate of the top-left corner.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error; VGA_ERROR_OUT_OF_MEMORY
+ *         when the queue is full.
+ */
+VGA_Status UB_VGA_SchedFillRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color);
+
+/**
+ * @brief Queues a line of one pixel wide, as UB_VGA_DrawLine.
+ * @param x1 Starting X-coordinate.
+ * @param y1 Starting Y-coordinate.
+ * @param x2 Ending X-coordinate.
+ * @param y2 Ending Y-coordinate.
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SchedLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color);
+
+/**
+ * @brief Queues a bitmap, as UB_VGA_DrawBitmap.
+ * @param id Bitmap ID.
+ * @param x X-coordinate of the top-left corner.
+ * @param y Y-coordinate of the top-left corner.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SchedBitmap(uint8_t id, int16_t x, int16_t y);
+
+/**
+ * @brief Queues a job, a large operation that yields.
+ * @param job Function that draws part of the operation per call.
+ * @param context Passed to job; must stay valid until the job is finished.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SchedJob(VGA_SchedJob job, void *context);
+
+/**
+ * @brief Tells whether the queue is full.
+ * @details Call UB_VGA_SchedRun until it is not, before queueing more.
+ * @return true when the next queueing function would fail.
+ */
+bool UB_VGA_SchedFull(void);
+
+/**
+ * @brief Runs chunks of the queue while the mode allows it.
+ * @details Returns as soon as the blanking interval is too short for the
+ *          next chunk, so the program can go on; call it again later.
+ * @return true when the queue is empty.
+ */
+bool UB_VGA_SchedRun(void);
+
+/**
+ * @brief Runs the queue until it is empty, waiting for the blanking intervals.
+ */
+void UB_VGA_SchedFlush(void);
+
+/**
+ * @brief Returns the counters of the scheduler.
+ * @param stats Filled with the counters since the last reset.
+ */
+void UB_VGA_GetSchedStats(VGA_SchedStats *stats);
+
+/**
+ * @brief Clears the counters of the scheduler.
+ * @details The measured cost per kind of operation starts again from its
+ *          estimate.
+ */
+void UB_VGA_ResetSchedStats(void);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_SCHED_H
@@ -3,7 +3,8 @@
  * @brief       VGA-Screen-Library for STM32F4xx
  * @details     This library offers functions to control a 320x240 pixel VGA screen.
  *              It uses TIM1 for the pixel clock, TIM2 for HSync, and DMA2 for transferring
- *              pixel data to the GPIO pins.
+ *              pixel data to the GPIO pins. With VGA_SCANOUT_DOUBLE_BUFFER, TIM3 gates
+ *              the pixel clock so that every line is started by hardware.
  *
  * @date        05.01.2026
  * @author      J. Mullink
@@ -56,11 +57,183 @@
 
 //--------------------------------------------------------------
 /**
- * @brief Screen dimensions.
+ * @brief Screen dimensions of the current video mode.
+ * @details These follow the mode set with UB_VGA_SetMode, so they are not
+ *          compile-time constants; use the VGA_MAX_ values to size arrays.
  */
 //--------------------------------------------------------------
-#define VGA_DISPLAY_X   320
-#define VGA_DISPLAY_Y   240
+#define VGA_DISPLAY_X   ((int32_t)VGA.mode->width)
+#define VGA_DISPLAY_Y   ((int32_t)VGA.mode->height)
+
+/** @brief Bytes per framebuffer line (visible pixels plus the guard pixels at 8 bpp). */
+#define VGA_LINE_STRIDE ((int32_t)VGA.mode->pitch)
+
+/** @brief True when the current mode stores 4-bit palette indices instead of colors. */
+#define VGA_INDEXED     (VGA.mode->bpp == 4)
+
+/** @brief Largest width, stride and height of all video modes. */
+#define VGA_MAX_DISPLAY_X     400
+#define VGA_MAX_LINE_STRIDE   402
+#define VGA_MAX_DISPLAY_Y     480
+
+//--------------------------------------------------------------
+/**
+ * @brief Size of the framebuffer in bytes.
+ * @details A mode only fits when pitch * height is at most this. The
+ *          default holds the 320x240 mode; the RAM of the STM32F407 that
+ *          the DMA can reach (128 KB) cannot hold 320x480 at one byte per
+ *          pixel, and 400x300 would leave only a few KB for everything else.
+ *          The 16 color modes need half a byte per pixel, so 320x480 in 16
+ *          colors fits in the default size as well. Two pages (see
+ *          UB_VGA_SetPages) fit in the 160x120, 320x120 and 320x240 16 color
+ *          modes. A program that only draws through a line renderer (see
+ *          UB_VGA_SetLineRenderer) can build with a VGA_RAM_SIZE of 4 and
+ *          use the RAM for other things.
+ */
+//--------------------------------------------------------------
+#ifndef VGA_RAM_SIZE
+#define VGA_RAM_SIZE   (321*240)
+#endif
+#define RAM_SIZE		VGA_RAM_SIZE
+
+//--------------------------------------------------------------
+/**
+ * @brief The video modes in VGA_Modes.
+ */
+//--------------------------------------------------------------
+typedef enum {
+    VGA_MODE_320X240 = 0,   /*!< 640x480@60, every line shown twice (default) */
+    VGA_MODE_320X480,       /*!< 640x480@60, every line shown once */
+    VGA_MODE_160X120,       /*!< 640x480@60, every pixel shown as 4x4 */
+    VGA_MODE_400X300,       /*!< 800x600@56, every line shown twice */
+    VGA_MODE_320X240_16,    /*!< 640x480@60, 16 colors, every line shown twice */
+    VGA_MODE_320X480_16,    /*!< 640x480@60, 16 colors, every line shown once */
+    VGA_MODE_320X120,       /*!< 640x480@60, every line shown four times */
+    VGA_MODE_COUNT
+} VGA_ModeId;
+
+#ifndef VGA_DEFAULT_MODE
+#define VGA_DEFAULT_MODE   VGA_MODE_320X240
+#endif
+
+//--------------------------------------------------------------
+/**
+ * @brief Timing and framebuffer layout of a video mode.
+ * @details Horizontal values are in TIM2 ticks (HCLK/2, 63 MHz), the pixel
+ *          clock is in HCLK cycles (126 MHz), vertical values are in lines.
+ *          At 8 bpp a framebuffer byte is one R3G3B2 pixel and the DMA sends
+ *          the framebuffer lines themselves. At 4 bpp a byte holds two
+ *          palette indices (the left pixel in the high nibble), and every
+ *          line is expanded through the palette into a line buffer that the
+ *          DMA sends instead.
+ */
+//--------------------------------------------------------------
+typedef struct {
+  uint16_t width;         /*!< Framebuffer width in pixels */
+  uint16_t height;        /*!< Framebuffer height in lines */
+  uint16_t stride;        /*!< Pixels sent per line: width plus black guard pixels */
+  uint16_t pitch;         /*!< Bytes per framebuffer line: stride at 8 bpp, width / 2 at 4 bpp */
+  uint8_t  bpp;           /*!< Bits per pixel in the framebuffer: 8 or 4 */
+  uint8_t  line_shift;    /*!< Every framebuffer line is shown 1 << line_shift times */
+  uint8_t  pixel_clocks;  /*!< HCLK cycles per pixel (TIM1 period) */
+  uint16_t h_total;       /*!< Line length in TIM2 ticks */
+  uint16_t h_sync;        /*!< HSync pulse length in TIM2 ticks */
+  uint16_t h_start;       /*!< TIM2 tick at which the first pixel is sent */
+  uint16_t v_total;       /*!< Lines per frame */
+  uint16_t v_sync;        /*!< VSync pulse length in lines */
+  uint16_t v_start;       /*!< First line with picture */
+  bool     sync_positive; /*!< true for positive sync pulses, false for negative */
+} VGA_Mode;
+
+extern const VGA_Mode VGA_Modes[VGA_MODE_COUNT];
+
+/** @brief Fewest HCLK cycles per pixel the DMA can keep up with. */
+#define VGA_MIN_PIXEL_CLOCKS   6
+
+/** @brief Number of palette entries of the 4 bpp modes. */
+#define VGA_PALETTE_SIZE   16
+
+//--------------------------------------------------------------
+/**
+ * @brief A band of screen rows that shows a window of the framebuffer.
+ * @details The bands of UB_VGA_SetBands are stacked from the top of the
+ *          screen. A band shows the framebuffer lines top to
+ *          top + height - 1, starting at line top + scroll and wrapping
+ *          around to top at the end of the window, so scrolling a band
+ *          moves no pixels. Rows are the rows of the video mode, so in the
+ *          320x240 mode a band of 16 rows covers 32 monitor lines.
+ */
+//--------------------------------------------------------------
+typedef struct {
+  uint16_t rows;    /*!< Screen rows covered by the band */
+  uint16_t top;     /*!< First framebuffer line of the window */
+  uint16_t height;  /*!< Framebuffer lines in the window */
+  uint16_t scroll;  /*!< Window line shown on the first row of the band (0 to height - 1) */
+  uint8_t  zoom;    /*!< Screen rows per framebuffer line, 1 for no zoom */
+} VGA_Band;
+
+/** @brief Largest number of bands. */
+#define VGA_MAX_BANDS   8
+
+//--------------------------------------------------------------
+/**
+ * @brief Counters of the page flips.
+ * @details A frame is dropped when it shows the front page again because
+ *          the next page was presented late: with two presents three
+ *          frames apart, two frames are dropped. Reset the counters before
+ *          measuring, so that idle time is not counted as dropped.
+ */
+//--------------------------------------------------------------
+typedef struct {
+  uint32_t frames;      /*!< Frames scanned out since the reset */
+  uint32_t presented;   /*!< Pages presented since the reset */
+  uint32_t dropped;     /*!< Frames that repeated a page between two presents */
+  uint32_t fps_x100;    /*!< Presented pages per second, times 100 */
+} VGA_PageStats;
+
+/** @brief Number of rectangles UB_VGA_MarkDirty keeps apart before merging them. */
+#define VGA_MAX_DIRTY   8
+
+//--------------------------------------------------------------
+/**
+ * @brief Draws one screen row into a line buffer, in place of the framebuffer.
+ * @details Called from the scanout interrupt for the rows it was set for
+ *          (all of them, 0 to VGA_DISPLAY_Y - 1, by default) in order, once
+ *          per row (on its first repeat) and about one line before the row is
+ *          sent, so it must return within that line. It writes VGA_DISPLAY_X
+ *          R3G3B2 pixels to line, also in the 4 bpp modes; the guard pixels
+ *          behind them must stay black. line is 4-byte aligned.
+ */
+//--------------------------------------------------------------
+typedef void (*VGA_LineRenderer)(uint8_t *line, uint16_t row);
+
+/** @brief Row count of UB_VGA_SetLineRendererRows for all rows from the first to the bottom. */
+#define VGA_RENDERER_ALL_ROWS   0xFFFF
+
+//--------------------------------------------------------------
+/**
+ * @brief Draws over one framebuffer row at scanout time.
+ * @details Called from the scanout interrupt for the rows the framebuffer
+ *          shows, like a VGA_LineRenderer. src is the row as it will be sent:
+ *          the framebuffer line at 8 bpp, or line itself when the row was
+ *          already expanded there at 4 bpp. To draw, the overlay copies src
+ *          into line first when they differ, then draws R3G3B2 pixels into
+ *          line and returns true, so the line buffer is sent. Without
+ *          anything to draw it leaves line alone and returns false.
+ */
+//--------------------------------------------------------------
+typedef bool (*VGA_LineOverlay)(uint8_t *line, const uint8_t *src, uint16_t row);
+
+//--------------------------------------------------------------
+/**
+ * @brief Layers of line overlays, drawn from layer 0 up.
+ * @details An overlay after one that drew gets the line buffer as src, so
+ *          it draws over the result without a second copy.
+ */
+//--------------------------------------------------------------
+#define VGA_OVERLAY_LAYERS    2
+#define VGA_OVERLAY_EFFECTS   0   /*!< Raster effects (stm32_ub_vga_raster.h) */
+#define VGA_OVERLAY_SPRITES   1   /*!< Sprites (stm32_ub_vga_sprite.h), over the effects */
 
 //--------------------------------------------------------------
 /**
@@ -88,10 +261,12 @@ typedef struct {
  */
 //--------------------------------------------------------------
 typedef struct {
+  const VGA_Mode *mode; /*!< Current video mode */
   uint16_t hsync_cnt;   /*!< HSync line counter */
-  uint32_t start_adr;   /*!< Start address of the current line in VGA_RAM */
+  uint32_t start_adr;   /*!< Start address of the last line handed to the DMA */
   uint32_t dma2_cr_reg; /*!< Pre-calculated value for the DMA2 CR register */
   VGA_Rect clip_rect;   /*!< Clipping rectangle for drawing operations */
+  uint8_t *draw_ram;    /*!< Page the drawing functions write to */
 }VGA_t;
 
 extern VGA_t VGA;
@@ -103,37 +278,85 @@ extern VGA_t VGA;
  * @brief Framebuffer for the VGA display.
  */
 //--------------------------------------------------------------
-extern uint8_t VGA_RAM1[(VGA_DISPLAY_X+1)*VGA_DISPLAY_Y];
+extern uint8_t VGA_RAM1[VGA_RAM_SIZE];
 
+/** @brief Page the drawing functions write to: VGA_RAM1, or the back page with two pages. */
+#define VGA_FRAMEBUFFER   (VGA.draw_ram)
 
 
 //--------------------------------------------------------------
-// Timer-1 configuration for Pixel Clock
+/**
+ * @brief Selects the scanout engine.
+ * @details 1: DMA2 Stream5 runs in double-buffer mode and is never stopped.
+ *          TIM3 opens a gate for the pixel clock at the start of every line
+ *          that is exactly stride pixels long, so the hardware
+ *          starts and ends each line by itself and one interrupt per line
+ *          only has to point the idle buffer at the line after next.
+ *          0: the original engine, where the TIM2 CC3 interrupt starts the
+ *          pixel clock and the DMA for every line and the DMA interrupt stops
+ *          them again. The 4 bpp modes need the double-buffer engine.
+ */
 //--------------------------------------------------------------
-#define VGA_TIM1_PERIODE      10-1
-#define VGA_TIM1_PRESCALE      0
-
-
+#ifndef VGA_SCANOUT_DOUBLE_BUFFER
+#define VGA_SCANOUT_DOUBLE_BUFFER   1
+#endif
 
 //--------------------------------------------------------------
-// Timer-2 configuration for HSync and DMA Trigger
+/**
+ * @brief Enables the cycle counting of the scanout interrupts.
+ * @details When set to 1, every scanout interrupt reads the DWT cycle
+ *          counter on entry and exit and adds the difference to the
+ *          statistics returned by UB_VGA_GetIsrStats. Costs about ten
+ *          cycles per interrupt, so it is off by default.
+ */
 //--------------------------------------------------------------
-#define  VGA_TIM2_HSYNC_PERIODE   2002-1
-#define  VGA_TIM2_HSYNC_PRESCALE     0
-
-#define  VGA_TIM2_HSYNC_IMP       240
-#define  VGA_TIM2_HTRIGGER_START  480
-#define  VGA_TIM2_DMA_DELAY       200
+#ifndef VGA_MEASURE_ISR
+#define VGA_MEASURE_ISR   0
+#endif
 
+//--------------------------------------------------------------
+/**
+ * @brief Cycle statistics of the scanout interrupts.
+ * @details Counted per interrupt call, from the first to the last
+ *          instruction of the handler; the 12 cycles of exception entry and
+ *          the 10 to 12 cycles of exit come on top. The original engine
+ *          takes two interrupts per visible line, the double-buffer engine
+ *          one per line.
+ *
+ *          The line-end interrupt also reads the TIM2 counter. When the CPU
+ *          holds the bus, the DMA sends pixels late and the line ends later,
+ *          so the spread of that count bounds the pixel jitter (it also
+ *          holds the variation of the interrupt latency).
+ */
+//--------------------------------------------------------------
+typedef struct {
+  uint32_t calls;         /*!< Number of interrupts measured */
+  uint64_t total_cycles;  /*!< Sum of the cycles of all calls */
+  uint32_t min_cycles;    /*!< Shortest call */
+  uint32_t max_cycles;    /*!< Longest call */
+  uint32_t min_end_tick;  /*!< Earliest TIM2 count at the end of a line (DMA transfer complete) */
+  uint32_t max_end_tick;  /*!< Latest TIM2 count there; the spread is the scanout jitter, in TIM2 ticks */
+}VGA_IsrStats;
 
 //--------------------------------------------------------------
-// VSync signal timing constants
+/**
+ * @brief Line and frame timing of the current mode.
+ * @details Computed from the mode table with the same expressions that
+ *          program the timers, so these are the programmed values, not
+ *          measurements. Cycles are HCLK cycles; TIM2 and TIM3 count one
+ *          tick per two of them.
+ */
 //--------------------------------------------------------------
-#define  VGA_VSYNC_PERIODE        525
-#define  VGA_VSYNC_IMP  2
-#define  VGA_VSYNC_BILD_START      36
-#define  VGA_VSYNC_BILD_STOP      514
-#define RAM_SIZE		(VGA_DISPLAY_X+1)*VGA_DISPLAY_Y
+typedef struct {
+  uint32_t line_cycles;     /*!< One line: h_total TIM2 ticks */
+  uint32_t pixel_cycles;    /*!< Pixels of a line, guard pixels included: stride TIM1 periods */
+  uint32_t gate_ticks;      /*!< TIM3 pixel clock gate, in TIM2 ticks */
+  uint32_t hblank_cycles;   /*!< Rest of the line after its pixels */
+  uint32_t frame_cycles;    /*!< One frame: v_total lines */
+  uint16_t visible_lines;   /*!< Lines with picture: height << line_shift */
+  uint16_t irqs_per_frame;  /*!< Scanout interrupts per frame with the selected engine */
+  uint32_t frame_hz_x100;   /*!< Frame rate, times 100 */
+}VGA_Timing;
 
 
 //--------------------------------------------------------------
@@ -158,7 +381,9 @@ extern uint8_t VGA_RAM1[(VGA_DISPLAY_X+1)*VGA_DISPLAY_Y];
 typedef enum {
     VGA_SUCCESS = 0,                /*!< Operation successful */
     VGA_ERROR_INVALID_COORDINATE,   /*!< Coordinate out of bounds */
-    VGA_ERROR_INVALID_PARAMETER     /*!< Other invalid parameter (e.g., radius=0) */
+    VGA_ERROR_INVALID_PARAMETER,    /*!< Other invalid parameter (e.g., radius=0) */
+    VGA_ERROR_OUT_OF_MEMORY,        /*!< A fixed-size work buffer was too small */
+    VGA_ERROR_TIMEOUT               /*!< The scanout did not respond in time */
 } VGA_Status;
 
 
@@ -173,6 +398,324 @@ typedef enum {
  */
 void UB_VGA_Screen_Init(void);
 
+/**
+ * @brief Switches to another video mode.
+ * @details Stops the scanout, reprograms the timers and the DMA for the
+ *          mode, clears the framebuffer and the clipping rectangle and
+ *          starts again. The monitor loses sync for a moment. While a
+ *          line renderer is set (UB_VGA_SetLineRenderer) the framebuffer of
+ *          the mode does not have to fit.
+ * @param id Mode from VGA_Modes.
+ * @return VGA_Status indicating success or error; the current mode is kept on error.
+ */
+VGA_Status UB_VGA_SetMode(VGA_ModeId id);
+
+/**
+ * @brief Checks the timing and memory use of a video mode.
+ * @param mode Mode to check.
+ * @return VGA_SUCCESS, VGA_ERROR_OUT_OF_MEMORY if the framebuffer does not
+ *         fit in VGA_RAM_SIZE, or VGA_ERROR_INVALID_PARAMETER if the timing
+ *         does not add up.
+ */
+VGA_Status UB_VGA_CheckMode(const VGA_Mode *mode);
+
+// Palette functions (4 bpp modes)
+/**
+ * @brief Sets one entry of the palette.
+ * @details The palette is used by the 4 bpp modes; a change shows from the
+ *          next scanned line on, without touching the framebuffer. Drawing
+ *          functions keep taking R3G3B2 colors and store the index of the
+ *          palette entry nearest to the color, so changing an entry also
+ *          changes which index later drawing picks for a color.
+ * @param index Palette index (0 to VGA_PALETTE_SIZE - 1).
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SetPaletteEntry(uint8_t index, uint8_t color);
+
+/**
+ * @brief Sets the whole palette.
+ * @param colors Array of VGA_PALETTE_SIZE colors (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SetPalette(const uint8_t *colors);
+
+/**
+ * @brief Restores the default palette (the 16 CGA colors).
+ */
+void UB_VGA_ResetPalette(void);
+
+/**
+ * @brief Reads one entry of the palette.
+ * @param index Palette index (0 to VGA_PALETTE_SIZE - 1).
+ * @return The color of the entry (R3G3B2), 0 for an invalid index.
+ */
+uint8_t UB_VGA_GetPaletteEntry(uint8_t index);
+
+/**
+ * @brief Returns the value the framebuffer stores for a color.
+ * @details The color itself at 8 bpp, the index of the nearest palette
+ *          entry at 4 bpp.
+ * @param color 8-bit color value (R3G3B2).
+ * @return Stored value.
+ */
+uint8_t UB_VGA_ColorValue(uint8_t color);
+
+/**
+ * @brief Returns the index of the palette entry nearest to a color.
+ * @details In every mode, for code that keeps colors as palette indices.
+ * @param color 8-bit color value (R3G3B2).
+ * @return Palette index (0 to VGA_PALETTE_SIZE - 1).
+ */
+uint8_t UB_VGA_PaletteIndex(uint8_t color);
+
+/**
+ * @brief Reads the color of a single pixel.
+ * @param xp X-coordinate of the pixel.
+ * @param yp Y-coordinate of the pixel.
+ * @return The color on screen (R3G3B2), 0 outside the screen.
+ */
+uint8_t UB_VGA_GetPixel(uint16_t xp, uint16_t yp);
+
+// Line map functions (split screens, scrolling, vertical zoom)
+/**
+ * @brief Divides the screen into bands with their own window and scroll position.
+ * @details The bands are turned into a table with the framebuffer line of
+ *          every screen row, which the scanout interrupt reads. The new table
+ *          takes effect at the start of the next frame, so a frame never shows
+ *          half of it. Drawing keeps using framebuffer coordinates.
+ * @param bands Array of bands, from the top of the screen down.
+ * @param count Number of bands (1 to VGA_MAX_BANDS); their rows must add up to VGA_DISPLAY_Y.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SetBands(const VGA_Band *bands, uint8_t count);
+
+/**
+ * @brief Scrolls one band.
+ * @param index Band index of the last UB_VGA_SetBands.
+ * @param lines Lines to scroll; positive moves the contents up.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_ScrollBand(uint8_t index, int32_t lines);
+
+/**
+ * @brief Sets the framebuffer line of every screen row directly.
+ * @details Takes effect at the start of the next frame. UB_VGA_ScrollBand
+ *          does not work on a table set this way.
+ * @param lines Array of VGA_DISPLAY_Y framebuffer lines (each below VGA_DISPLAY_Y).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SetLineMap(const uint16_t *lines);
+
+/**
+ * @brief Shows every framebuffer line on its own row again (one band, no scroll).
+ */
+void UB_VGA_ResetLineMap(void);
+
+/**
+ * @brief Returns the framebuffer line shown on a screen row.
+ * @details Follows the last table set, also before it takes effect, so
+ *          that the lines that scrolled into view can be drawn at once.
+ * @param row Screen row.
+ * @return Framebuffer line, or row itself when it is off screen.
+ */
+uint16_t UB_VGA_GetRowLine(uint16_t row);
+
+// Page functions (tear-free animation)
+/**
+ * @brief Sets the number of framebuffer pages.
+ * @details With two pages the scanout shows the front page while the
+ *          drawing functions write to the back page, which UB_VGA_Present
+ *          shows from the next frame on. Switching to two pages copies the
+ *          screen to the back page; switching back keeps what is on screen.
+ *          The line map applies to both pages. UB_VGA_SetMode returns to
+ *          one page.
+ * @param count 1 or 2.
+ * @return VGA_Status indicating success or error; VGA_ERROR_OUT_OF_MEMORY
+ *         when two pages of the mode do not fit in VGA_RAM_SIZE.
+ */
+VGA_Status UB_VGA_SetPages(uint8_t count);
+
+/**
+ * @brief Returns the number of framebuffer pages.
+ * @return 1 or 2.
+ */
+uint8_t UB_VGA_GetPages(void);
+
+/**
+ * @brief Shows the back page from the next frame on.
+ * @details Waits until the scanout has flipped to the page at the start of
+ *          a frame (at most one frame), then makes the old front page the
+ *          new back page. When the flip has not come after two frames, for
+ *          instance because interrupts are masked, it is withdrawn and
+ *          nothing changes. With copy_forward the rectangles marked with
+ *          UB_VGA_MarkDirty since the last present, or the whole page when
+ *          none were marked, are copied to the new back page, so that it
+ *          matches the screen again. Without it the back page is one frame
+ *          old, which suits animations that redraw everything they change.
+ * @param copy_forward true to copy what was drawn to the new back page.
+ * @return VGA_Status indicating success or error; VGA_ERROR_INVALID_PARAMETER with one page,
+ *         VGA_ERROR_TIMEOUT when the flip did not come.
+ */
+VGA_Status UB_VGA_Present(bool copy_forward);
+
+/**
+ * @brief Marks a rectangle of the back page as drawn, for the copy of UB_VGA_Present.
+ * @details Clipped to the screen. After VGA_MAX_DIRTY rectangles the new
+ *          ones are merged into the bounding box of all of them.
+ * @param rect Rectangle drawn since the last present.
+ */
+void UB_VGA_MarkDirty(const VGA_Rect *rect);
+
+/**
+ * @brief Returns the page flip counters.
+ * @param stats Filled with the counters since the last reset.
+ */
+void UB_VGA_GetPageStats(VGA_PageStats *stats);
+
+/**
+ * @brief Clears the page flip counters.
+ */
+void UB_VGA_ResetPageStats(void);
+
+// Line renderer functions (rows drawn at scanout time)
+/**
+ * @brief Lets a function draw every row just before it is scanned out.
+ * @details The framebuffer is then not shown and drawing into it is turned
+ *          off: the clipping rectangle is empty, so the drawing functions
+ *          draw nothing. UB_VGA_SetMode accepts modes whose framebuffer does
+ *          not fit in VGA_RAM_SIZE while a renderer is set. The line map is
+ *          not used. A new renderer takes effect at the start of the next
+ *          frame. Only the double-buffer scanout engine has line buffers.
+ * @param renderer Function that draws a row, or NULL for the framebuffer.
+ * @return VGA_Status indicating success or error; VGA_ERROR_INVALID_PARAMETER
+ *         with two pages or the original engine, VGA_ERROR_OUT_OF_MEMORY for
+ *         NULL when the framebuffer of the mode does not fit.
+ */
+VGA_Status UB_VGA_SetLineRenderer(VGA_LineRenderer renderer);
+
+/**
+ * @brief Lets a function draw some rows, the framebuffer shows the others.
+ * @details As UB_VGA_SetLineRenderer, but only for rows first to
+ *          first + count - 1; the other rows come from the framebuffer and
+ *          the line map as usual, and drawing into the framebuffer stays on.
+ *          With first 0 and count VGA_RENDERER_ALL_ROWS this is
+ *          UB_VGA_SetLineRenderer. The rows are screen rows: they do not
+ *          move when the mode or the line map changes.
+ * @param renderer Function that draws a row, or NULL for the framebuffer.
+ * @param first First row the renderer draws.
+ * @param count Number of rows (1 or more), or VGA_RENDERER_ALL_ROWS.
+ * @return VGA_Status indicating success or error; VGA_ERROR_OUT_OF_MEMORY
+ *         when the framebuffer is shown and does not fit.
+ */
+VGA_Status UB_VGA_SetLineRendererRows(VGA_LineRenderer renderer, uint16_t first, uint16_t count);
+
+/**
+ * @brief Returns the line renderer set with UB_VGA_SetLineRenderer(Rows).
+ * @return The renderer, or NULL when the framebuffer is shown.
+ */
+VGA_LineRenderer UB_VGA_GetLineRenderer(void);
+
+/**
+ * @brief Lets a function draw over the framebuffer rows just before they are scanned out.
+ * @details The framebuffer stays as it is, so the overlay needs no
+ *          save-under. It is not called for the rows of a line renderer.
+ *          A new overlay takes effect at the start of the next frame. Only the
+ *          double-buffer scanout engine has line buffers.
+ * @param layer Layer (0 to VGA_OVERLAY_LAYERS - 1); higher layers draw over lower ones.
+ * @param overlay Function that draws over a row, or NULL for none.
+ * @return VGA_Status indicating success or error; VGA_ERROR_INVALID_PARAMETER
+ *         for an invalid layer or with the original engine.
+ */
+VGA_Status UB_VGA_SetLineOverlay(uint8_t layer, VGA_LineOverlay overlay);
+
+/**
+ * @brief Returns the line overlay of a layer set with UB_VGA_SetLineOverlay.
+ * @param layer Layer.
+ * @return The overlay, or NULL.
+ */
+VGA_LineOverlay UB_VGA_GetLineOverlay(uint8_t layer);
+
+/**
+ * @brief Tells whether the scanout runs, so that its interrupt is called.
+ * @return true from the first UB_VGA_SetMode on.
+ */
+bool UB_VGA_IsRunning(void);
+
+/**
+ * @brief Tells whether the scanout is in the vertical blanking interval.
+ * @details Neither the line being sent nor the next one is part of the
+ *          picture, so the framebuffer can be changed without tearing until
+ *          the first row of the next frame (45 lines, 1.4 ms, at 640x480).
+ * @return true in the vertical blanking interval, or when the scanout does not run.
+ */
+bool UB_VGA_InVBlank(void);
+
+/**
+ * @brief Waits for the start of the next vertical blanking interval.
+ * @details Waits at most one frame; returns at once when the scanout does not run.
+ */
+void UB_VGA_WaitForVBlank(void);
+
+/**
+ * @brief Returns the time until the scanout reads pixels again.
+ * @details Between the end of the pixels of a line and the start of the
+ *          next line (the horizontal blanking interval, about 760 cycles at
+ *          640x480) and in the vertical blanking interval, the DMA does not
+ *          read memory, so the CPU has the bus to itself. Work that fits in
+ *          the returned time does not delay a pixel.
+ * @return HCLK cycles until the next pixel is read: 0 while the pixels of
+ *         a line are sent, UINT32_MAX when the scanout does not run.
+ */
+uint32_t UB_VGA_BlankCycles(void);
+
+// Framebuffer access for the drawing modules
+/**
+ * @brief Writes a stored value (see UB_VGA_ColorValue) to a run of pixels.
+ * @details No clipping: x0 <= x1 and the run must lie on screen.
+ * @param x0 First X-coordinate.
+ * @param y Y-coordinate.
+ * @param x1 Last X-coordinate.
+ * @param value Stored value.
+ */
+void UB_VGA_FillValues(int32_t x0, int32_t y, int32_t x1, uint8_t value);
+
+/**
+ * @brief Opens a run of pixels for direct access as R3G3B2 bytes.
+ * @details At 8 bpp this is a pointer into the framebuffer. At 4 bpp the
+ *          pixels are decoded into a scratch line, and UB_VGA_SpanEnd
+ *          stores them back as palette indices. Only one span can be open.
+ *          No clipping: the run must lie on screen.
+ * @param x First X-coordinate.
+ * @param y Y-coordinate.
+ * @param count Number of pixels (at most VGA_MAX_DISPLAY_X).
+ * @return Pointer to count color bytes; at 4 bpp the scratch line, which is word aligned.
+ */
+uint8_t *UB_VGA_SpanBegin(int32_t x, int32_t y, int32_t count);
+
+/**
+ * @brief Closes the span opened by UB_VGA_SpanBegin.
+ */
+void UB_VGA_SpanEnd(void);
+
+/**
+ * @brief Returns the line and frame timing of the current mode.
+ * @param timing Filled with the values computed from the mode table.
+ */
+void UB_VGA_GetTiming(VGA_Timing *timing);
+
+/**
+ * @brief Reads the cycle statistics of the scanout interrupts.
+ * @details All fields are 0 unless the library is built with VGA_MEASURE_ISR.
+ * @param stats Pointer to a VGA_IsrStats structure to store the statistics.
+ */
+void UB_VGA_GetIsrStats(VGA_IsrStats *stats);
+
+/**
+ * @brief Clears the cycle statistics of the scanout interrupts.
+ */
+void UB_VGA_ResetIsrStats(void);
+
 // Clipping functions
 /**
  * @brief Sets the clipping rectangle for all drawing operations.
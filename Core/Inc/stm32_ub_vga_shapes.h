@@ -0,0 +1,345 @@
+/**
+ * @file    stm32_ub_vga_shapes.h
+ * @brief   Extended shape primitives for the VGA library.
+ * @details Polygons, triangles and other shapes that are built on top of the basic
+ *          pixel, span and line functions of stm32_ub_vga_screen.h. Filled
+ *          shapes are rasterised scanline by scanline into horizontal spans.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_SHAPES_H
+#define __STM32F4_UB_VGA_SHAPES_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+#include "stm32_ub_vga_fill.h"
+
+
+//--------------------------------------------------------------
+/**
+ * @brief Maximum number of vertices of a polygon.
+ */
+//--------------------------------------------------------------
+#define VGA_POLY_MAX_POINTS   32
+
+//--------------------------------------------------------------
+/**
+ * @brief Largest radius of ellipses, arcs and rounded corners.
+ */
+//--------------------------------------------------------------
+#define VGA_ELLIPSE_MAX_RADIUS   512
+
+//--------------------------------------------------------------
+/**
+ * @brief Default flatness of Bezier curves, in 1/16 pixel (0.5 pixel).
+ */
+//--------------------------------------------------------------
+#define VGA_BEZIER_FLATNESS_DEFAULT   8
+
+//--------------------------------------------------------------
+/**
+ * @brief Finest subdivision of a Bezier curve: at most 2^depth line segments.
+ */
+//--------------------------------------------------------------
+#define VGA_BEZIER_MAX_DEPTH   10
+
+//--------------------------------------------------------------
+/**
+ * @brief Line styles for the styled line and polygon functions.
+ * @details A style is a 32-bit mask that repeats every 32 pixels along the
+ *          line. Bit 31 is the first pixel, a set bit is drawn and a clear
+ *          bit is skipped. Any mask other than 0 can be used.
+ */
+//--------------------------------------------------------------
+#define VGA_LINE_SOLID       0xFFFFFFFFu   /*!< Every pixel */
+#define VGA_LINE_DASHED      0xFFF0FFF0u   /*!< Dashes of 12, gaps of 4 */
+#define VGA_LINE_DOTTED      0xAAAAAAAAu   /*!< Every other pixel */
+#define VGA_LINE_DASH_DOT    0xFF18FF18u   /*!< Dash of 8, gap of 3, dot of 2, gap of 3 */
+#define VGA_LINE_LONG_DASH   0xFFFFFF00u   /*!< Dashes of 24, gaps of 8 */
+
+//--------------------------------------------------------------
+/**
+ * @brief A vertex in screen coordinates.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    int16_t x, y;
+} VGA_Point;
+
+//--------------------------------------------------------------
+/**
+ * @brief Rules that decide which parts of a polygon are inside.
+ */
+//--------------------------------------------------------------
+typedef enum {
+    VGA_FILL_EVENODD = 0,   /*!< Inside if a ray crosses an odd number of edges */
+    VGA_FILL_NONZERO        /*!< Inside if the winding number is not zero */
+} VGA_FillRule;
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Draws the outline of a closed polygon.
+ * @param pts Array of vertices. The last vertex is connected to the first.
+ * @param count Number of vertices (2 to VGA_POLY_MAX_POINTS).
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Line thickness in pixels.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawPolygon(const VGA_Point *pts, uint8_t count, uint8_t color, uint8_t thickness);
+
+/**
+ * @brief Draws a line with a dash pattern.
+ * @details As UB_VGA_DrawLine, but only the pixels whose bit is set in the
+ *          style are drawn. The style is tested with a shift while stepping
+ *          Bresenham; horizontal and vertical lines are written as one span
+ *          per dash. Clipping is handled like UB_VGA_DrawLine.
+ * @param x1 Starting X-coordinate.
+ * @param y1 Starting Y-coordinate.
+ * @param x2 Ending X-coordinate.
+ * @param y2 Ending Y-coordinate.
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Line thickness in pixels.
+ * @param style Line style, see VGA_LINE_SOLID; bit 31 is the starting pixel.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawLineStyled(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t color, uint8_t thickness, uint32_t style);
+
+/**
+ * @brief Draws the outline of a closed polygon with a dash pattern.
+ * @details The pattern runs on around the corners instead of restarting at
+ *          every vertex.
+ * @param pts Array of vertices. The last vertex is connected to the first.
+ * @param count Number of vertices (2 to VGA_POLY_MAX_POINTS).
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Line thickness in pixels.
+ * @param style Line style, see VGA_LINE_SOLID.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawPolygonStyled(const VGA_Point *pts, uint8_t count, uint8_t color, uint8_t thickness, uint32_t style);
+
+/**
+ * @brief Draws an open polyline through a list of points in one pass.
+ * @details Horizontal and vertical segments are written as single spans, and
+ *          steep segments one column wide (the usual step of a densely
+ *          sampled trace) as two vertical spans. The pixels are the same as
+ *          with UB_VGA_DrawLine per segment. Pixels outside the clipping
+ *          rectangle are skipped.
+ * @param pts Array of points, coordinates 0 to 8191.
+ * @param count Number of points (at least 1; a single point draws a dot).
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Line thickness in pixels.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawPolyline(const VGA_Point *pts, uint16_t count, uint8_t color, uint8_t thickness);
+
+/**
+ * @brief Draws a point cloud: one pixel per point.
+ * @param pts Array of points. Points outside the clipping rectangle are skipped.
+ * @param count Number of points.
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawPoints(const VGA_Point *pts, uint16_t count, uint8_t color);
+
+/**
+ * @brief Plots a data series: a polyline through (x0 + i * step, y[i]).
+ * @details Drawn like UB_VGA_DrawPolyline, without building a point list.
+ * @param x0 X-coordinate of the first sample (0 to 8191).
+ * @param step Horizontal distance between samples (at least 1).
+ * @param y Array of count sample values, 0 to 8191; values below the screen are clipped.
+ * @param count Number of samples (at least 1).
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Line thickness in pixels.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_PlotSeries(int16_t x0, uint16_t step, const int16_t *y, uint16_t count, uint8_t color, uint8_t thickness);
+
+/**
+ * @brief Fills a polygon, respecting the clipping rectangle.
+ * @details Concave and self-intersecting polygons are supported. A pixel is
+ *          filled when its center lies inside the polygon, so the right and
+ *          bottom edges of a shape are not part of the fill and polygons
+ *          sharing an edge do not overlap.
+ * @param pts Array of vertices. Vertices may lie outside the screen.
+ * @param count Number of vertices (3 to VGA_POLY_MAX_POINTS).
+ * @param color 8-bit color value (R3G3B2).
+ * @param rule Even-odd or non-zero fill rule.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_FillPolygon(const VGA_Point *pts, uint8_t count, uint8_t color, VGA_FillRule rule);
+
+/**
+ * @brief Fills a polygon with an 8x8 pattern.
+ * @details Covers the same pixels as UB_VGA_FillPolygon.
+ * @param pts Array of vertices.
+ * @param count Number of vertices (3 to VGA_POLY_MAX_POINTS).
+ * @param pattern Pattern and colors.
+ * @param rule Even-odd or non-zero fill rule.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_PatternPolygon(const VGA_Point *pts, uint8_t count, const VGA_Pattern *pattern, VGA_FillRule rule);
+
+/**
+ * @brief Fills a triangle with a single color, respecting the clipping rectangle.
+ * @details Uses the top-left fill convention: triangles that share an edge
+ *          neither overlap nor leave a gap between them.
+ * @param v Array of 3 vertices, in any order. Vertices may lie outside the screen.
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_FillTriangle(const VGA_Point *v, uint8_t color);
+
+/**
+ * @brief Fills a triangle with colors interpolated between its vertices.
+ * @details The R, G and B fields are interpolated separately and ordered
+ *          dithered (4x4 Bayer) down to R3G3B2.
+ * @param v Array of 3 vertices.
+ * @param colors Array of 3 vertex colors (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_FillTriangleShaded(const VGA_Point *v, const uint8_t *colors);
+
+/**
+ * @brief Fills a triangle strip.
+ * @details Triangle i is formed by vertices i, i+1 and i+2, so a strip of
+ *          count vertices gives count - 2 triangles.
+ * @param pts Array of vertices.
+ * @param count Number of vertices (at least 3).
+ * @param color 8-bit color value, used when colors is NULL.
+ * @param colors Optional array of count vertex colors for a shaded strip, or NULL.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_FillTriangleStrip(const VGA_Point *pts, uint16_t count, uint8_t color, const uint8_t *colors);
+
+/**
+ * @brief Draws an ellipse outline, respecting the clipping rectangle.
+ * @param center_x X-coordinate of the center, may lie outside the screen.
+ * @param center_y Y-coordinate of the center, may lie outside the screen.
+ * @param radius_x Horizontal radius (1 to VGA_ELLIPSE_MAX_RADIUS).
+ * @param radius_y Vertical radius (1 to VGA_ELLIPSE_MAX_RADIUS).
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawEllipse(int16_t center_x, int16_t center_y, uint16_t radius_x, uint16_t radius_y, uint8_t color);
+
+/**
+ * @brief Draws a filled ellipse, one span per scanline.
+ * @param center_x X-coordinate of the center.
+ * @param center_y Y-coordinate of the center.
+ * @param radius_x Horizontal radius (1 to VGA_ELLIPSE_MAX_RADIUS).
+ * @param radius_y Vertical radius (1 to VGA_ELLIPSE_MAX_RADIUS).
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_FillEllipse(int16_t center_x, int16_t center_y, uint16_t radius_x, uint16_t radius_y, uint8_t color);
+
+/**
+ * @brief Fills an ellipse with an 8x8 pattern, one span per scanline.
+ * @details Covers the same pixels as UB_VGA_FillEllipse; use equal radii
+ *          for a circle.
+ * @param center_x X-coordinate of the center.
+ * @param center_y Y-coordinate of the center.
+ * @param radius_x Horizontal radius (1 to VGA_ELLIPSE_MAX_RADIUS).
+ * @param radius_y Vertical radius (1 to VGA_ELLIPSE_MAX_RADIUS).
+ * @param pattern Pattern and colors.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_PatternEllipse(int16_t center_x, int16_t center_y, uint16_t radius_x, uint16_t radius_y, const VGA_Pattern *pattern);
+
+/**
+ * @brief Draws a ring: a circle outline of a given thickness.
+ * @details The ring grows inwards from the radius. Every scanline is written
+ *          as at most two spans. A thickness of radius or more gives a
+ *          filled disk.
+ * @param center_x X-coordinate of the center, may lie outside the screen.
+ * @param center_y Y-coordinate of the center, may lie outside the screen.
+ * @param radius Outer radius (1 to VGA_ELLIPSE_MAX_RADIUS).
+ * @param thickness Ring thickness in pixels (at least 1).
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawRing(int16_t center_x, int16_t center_y, uint16_t radius, uint16_t thickness, uint8_t color);
+
+/**
+ * @brief Draws part of an ellipse outline.
+ * @details Angles are in degrees, 0 is to the right of the center and
+ *          angles increase counter-clockwise; the arc runs from start_angle
+ *          counter-clockwise to end_angle. An angle is the direction of a
+ *          pixel as seen from the center. Equal angles draw the whole ellipse.
+ * @param center_x X-coordinate of the center.
+ * @param center_y Y-coordinate of the center.
+ * @param radius_x Horizontal radius (1 to VGA_ELLIPSE_MAX_RADIUS).
+ * @param radius_y Vertical radius (1 to VGA_ELLIPSE_MAX_RADIUS).
+ * @param start_angle Start angle in degrees.
+ * @param end_angle End angle in degrees.
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawArc(int16_t center_x, int16_t center_y, uint16_t radius_x, uint16_t radius_y,
+                          int16_t start_angle, int16_t end_angle, uint8_t color);
+
+/**
+ * @brief Draws the outline of a rectangle with rounded corners.
+ * @param x_lup X-coordinate of the top-left corner.
+ * @param y_lup Y-coordinate of the top-left corner.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param radius Corner radius, limited to half the shortest side.
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawRoundRect(int16_t x_lup, int16_t y_lup, uint16_t width, uint16_t height, uint16_t radius, uint8_t color);
+
+/**
+ * @brief Draws a filled rectangle with rounded corners, one span per scanline.
+ * @param x_lup X-coordinate of the top-left corner.
+ * @param y_lup Y-coordinate of the top-left corner.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param radius Corner radius, limited to half the shortest side.
+ * @param color 8-bit color value (R3G3B2).
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_FillRoundRect(int16_t x_lup, int16_t y_lup, uint16_t width, uint16_t height, uint16_t radius, uint8_t color);
+
+/**
+ * @brief Draws a quadratic Bezier curve.
+ * @details The curve is split into straight segments with adaptive forward
+ *          differencing in fixed point: the step along the curve is halved
+ *          where it bends and doubled where it is straight, so no segment
+ *          lies further than the flatness from the curve. The segments are
+ *          drawn with UB_VGA_DrawLine.
+ * @param p Array of 3 points: start, control point and end. All on screen.
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Line thickness in pixels.
+ * @param flatness Largest distance between curve and segments in 1/16 pixel,
+ *        0 for VGA_BEZIER_FLATNESS_DEFAULT.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawBezierQuad(const VGA_Point *p, uint8_t color, uint8_t thickness, uint16_t flatness);
+
+/**
+ * @brief Draws a cubic Bezier curve.
+ * @details As UB_VGA_DrawBezierQuad, with two control points.
+ * @param p Array of 4 points: start, two control points and end. All on screen.
+ * @param color 8-bit color value (R3G3B2).
+ * @param thickness Line thickness in pixels.
+ * @param flatness Largest distance between curve and segments in 1/16 pixel,
+ *        0 for VGA_BEZIER_FLATNESS_DEFAULT.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_DrawBezierCubic(const VGA_Point *p, uint8_t color, uint8_t thickness, uint16_t flatness);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_SHAPES_H
@@ -0,0 +1,164 @@
+/**
+ * @file    stm32_ub_vga_sprite.h
+ * @brief   Sprite layer: bitmaps that move over the picture.
+ * @details Up to VGA_SPRITE_COUNT sprites of at most 16x16 pixels, such as
+ *          the arrows and smileys of bitmaps.c, each with a position, a
+ *          z-order and a color key. The program only changes positions and
+ *          calls UB_VGA_SpriteUpdate once per frame; the background under a
+ *          sprite is never drawn again by the program.
+ *
+ *          There are two ways to put the sprites on screen:
+ *          - VGA_SPRITE_FRAMEBUFFER (default): the sprites are drawn into
+ *            the framebuffer, in the vertical blanking interval. Every sprite
+ *            keeps the pixels it covers in a save-under buffer; moving it
+ *            puts those back and draws it at the new place, so only the old
+ *            and the new rectangle are written.
+ *          - VGA_SPRITE_SCANOUT: the scanout interrupt draws the sprites into
+ *            the line buffer of every row they are on, just before the row
+ *            is sent (see UB_VGA_SetLineOverlay). The framebuffer is never
+ *            changed, so drawing under the sprites is free, at the cost of
+ *            some interrupt time per row.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_SPRITE_H
+#define __STM32F4_UB_VGA_SPRITE_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+#include "bitmaps.h"
+
+
+//--------------------------------------------------------------
+/**
+ * @brief Number of sprites.
+ * @details Every sprite has a save-under buffer of 256 bytes. In scanout
+ *          mode a row with all sprites on it costs about 1 500 cycles.
+ */
+//--------------------------------------------------------------
+#ifndef VGA_SPRITE_COUNT
+#define VGA_SPRITE_COUNT   16
+#endif
+
+/** @brief Largest width and height of a sprite: the rows of a Bitmap_t. */
+#define VGA_SPRITE_SIZE    16
+
+//--------------------------------------------------------------
+/**
+ * @brief Where the sprites are drawn.
+ */
+//--------------------------------------------------------------
+typedef enum {
+    VGA_SPRITE_FRAMEBUFFER = 0, /*!< Into the framebuffer, with save-under buffers */
+    VGA_SPRITE_SCANOUT          /*!< Into the line buffers, by the scanout interrupt */
+} VGA_SpriteMode;
+
+//--------------------------------------------------------------
+/**
+ * @brief Counters of the sprite layer.
+ * @details Cycles are HCLK cycles, from the DWT cycle counter.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    uint32_t updates;       /*!< Calls of UB_VGA_SpriteUpdate since the reset */
+    uint32_t update_cycles; /*!< Longest update, without the wait for the blank */
+    uint32_t late;          /*!< Framebuffer: updates that were still drawing when the picture started */
+    uint32_t redrawn;       /*!< Framebuffer: sprites put back and drawn again by the last update */
+    uint32_t frame_cycles;  /*!< Scanout: most interrupt cycles of one frame */
+    uint32_t row_cycles;    /*!< Scanout: longest row */
+    uint32_t rows;          /*!< Scanout: rows with a sprite in the last frame */
+} VGA_SpriteStats;
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Chooses where the sprites are drawn.
+ * @details Takes the sprites out of the framebuffer first; the next
+ *          UB_VGA_SpriteUpdate shows them the new way.
+ * @param mode VGA_SPRITE_FRAMEBUFFER or VGA_SPRITE_SCANOUT.
+ * @return VGA_Status indicating success or error; VGA_ERROR_INVALID_PARAMETER
+ *         for scanout with the original scanout engine.
+ */
+VGA_Status UB_VGA_SpriteSetMode(VGA_SpriteMode mode);
+
+/**
+ * @brief Shows a sprite from the next update on.
+ * @param id Sprite (0 to VGA_SPRITE_COUNT - 1).
+ * @param image Bitmap of at most VGA_SPRITE_SIZE x VGA_SPRITE_SIZE pixels,
+ *              for example &vga_bitmaps[BITMAP_SMILEY_HAPPY].
+ * @param x X-coordinate of the top-left corner; may lie off screen.
+ * @param y Y-coordinate of the top-left corner; may lie off screen.
+ * @param z Z-order: sprites with a higher z cover those with a lower one;
+ *          at the same z the higher id covers the lower.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SpriteShow(uint8_t id, const Bitmap_t *image, int16_t x, int16_t y, uint8_t z);
+
+/**
+ * @brief Moves a sprite, from the next update on.
+ * @param id Sprite.
+ * @param x X-coordinate of the top-left corner.
+ * @param y Y-coordinate of the top-left corner.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SpriteMove(uint8_t id, int16_t x, int16_t y);
+
+/**
+ * @brief Sets the color of the pixels of a sprite that are not drawn.
+ * @param id Sprite.
+ * @param key Color key (R3G3B2), BITMAP_TRANSPARENT_COLOR by default.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SpriteSetKey(uint8_t id, uint8_t key);
+
+/**
+ * @brief Hides a sprite from the next update on.
+ * @param id Sprite.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_SpriteHide(uint8_t id);
+
+/**
+ * @brief Puts the changes of the sprites on screen.
+ * @details Framebuffer: waits for the vertical blanking interval, puts back
+ *          the background of the sprites that changed (and of the sprites
+ *          overlapping them) and draws them at their new places. Scanout:
+ *          hands the sprites to the interrupt, which takes them over at the
+ *          start of the next frame; it does not wait.
+ * @return VGA_Status indicating success or error; VGA_ERROR_INVALID_PARAMETER
+ *         in framebuffer mode with two pages.
+ */
+VGA_Status UB_VGA_SpriteUpdate(void);
+
+/**
+ * @brief Takes the sprites out of the framebuffer.
+ * @details Puts back the background under every sprite, at once, so the
+ *          program can draw there; the next UB_VGA_SpriteUpdate draws the
+ *          sprites again. Drawing under a sprite without this is undone
+ *          when the sprite moves.
+ */
+void UB_VGA_SpriteErase(void);
+
+/**
+ * @brief Returns the counters of the sprite layer.
+ * @param stats Filled with the counters since the last reset.
+ */
+void UB_VGA_GetSpriteStats(VGA_SpriteStats *stats);
+
+/**
+ * @brief Clears the counters of the sprite layer.
+ */
+void UB_VGA_ResetSpriteStats(void);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_SPRITE_H
@@ -0,0 +1,168 @@
+/**
+ * @file    stm32_ub_vga_textmode.h
+ * @brief   Character-cell text mode, expanded at scanout time.
+ * @details A text area is a map of character cells of 6x8 pixels, in the
+ *          Consolas 5x7 font of fonts.h with a blank column and row between
+ *          the characters. Every cell holds a character and an attribute
+ *          byte with a foreground and background palette index, so changing
+ *          a character writes two bytes instead of up to 48 pixels. The
+ *          scanout interrupt expands the cells of a row into the line buffer
+ *          just before the row is sent (see UB_VGA_SetLineRendererRows).
+ *
+ *          The text area covers a band of screen rows; the framebuffer shows
+ *          the rows above and below it, so a graphic and a text console can
+ *          share the screen. Over the whole screen no framebuffer is needed.
+ *          Scrolling moves the first row of the map, not the characters.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_TEXTMODE_H
+#define __STM32F4_UB_VGA_TEXTMODE_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+
+
+//--------------------------------------------------------------
+// Cell size in pixels
+//--------------------------------------------------------------
+#define VGA_TEXT_CELL_WIDTH    6
+#define VGA_TEXT_CELL_HEIGHT   8
+
+//--------------------------------------------------------------
+/**
+ * @brief Largest number of cells in the text area, two bytes each.
+ * @details 2560 cells hold the whole screen in every mode except 320x480,
+ *          which gets 48 of its 60 rows: 53x30 cells at 320x240 and 66x37
+ *          at 400x300.
+ */
+//--------------------------------------------------------------
+#ifndef VGA_TEXT_MAX_CELLS
+#define VGA_TEXT_MAX_CELLS   2560
+#endif
+
+/** @brief Attribute of a cell: foreground and background palette index (0 to 15). */
+#define VGA_TEXT_ATTR(fg, bg)  ((uint8_t)((((bg) & 0x0F) << 4) | ((fg) & 0x0F)))
+
+/** @brief Attribute of a cleared text area: white (15) on black (0) in the default palette. */
+#define VGA_TEXT_ATTR_DEFAULT  VGA_TEXT_ATTR(15, 0)
+
+//--------------------------------------------------------------
+/**
+ * @brief One character cell.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    uint8_t ch;     /*!< Character (ASCII, 0 to 127) */
+    uint8_t attr;   /*!< Attribute, see VGA_TEXT_ATTR */
+} VGA_TextCell;
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Shows a text area from the next frame on.
+ * @details The area starts at screen row first_row and is as wide as the
+ *          screen: VGA_DISPLAY_X / 6 columns. It is cleared with
+ *          VGA_TEXT_ATTR_DEFAULT. With rows 0 the area reaches to the bottom
+ *          of the screen and has as many rows as fit there and in
+ *          VGA_TEXT_MAX_CELLS; rows below the last text row show the
+ *          background of the last clear. From row 0 to the bottom it replaces
+ *          the framebuffer, which then need not fit (see
+ *          UB_VGA_SetLineRenderer).
+ * @param first_row First screen row of the area.
+ * @param rows Number of text rows, 0 for as many as fit.
+ * @return VGA_Status indicating success or error; VGA_ERROR_INVALID_COORDINATE
+ *         when the rows do not fit on the screen, VGA_ERROR_OUT_OF_MEMORY when
+ *         they do not fit in VGA_TEXT_MAX_CELLS.
+ */
+VGA_Status UB_VGA_TextStart(uint16_t first_row, uint8_t rows);
+
+/**
+ * @brief Shows the framebuffer in the rows of the text area again.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_TextStop(void);
+
+/**
+ * @brief Tells whether the text area is shown.
+ * @return true between UB_VGA_TextStart and UB_VGA_TextStop.
+ */
+bool UB_VGA_TextActive(void);
+
+/**
+ * @brief Returns the number of columns of the text area.
+ * @return Columns, 0 before UB_VGA_TextStart.
+ */
+uint8_t UB_VGA_TextColumns(void);
+
+/**
+ * @brief Returns the number of rows of the text area.
+ * @return Rows, 0 before UB_VGA_TextStart.
+ */
+uint8_t UB_VGA_TextRows(void);
+
+/**
+ * @brief Returns the attribute for two colors.
+ * @param fg Foreground color (R3G3B2), stored as the nearest palette entry.
+ * @param bg Background color (R3G3B2), stored as the nearest palette entry.
+ * @return Attribute byte.
+ */
+uint8_t UB_VGA_TextAttr(uint8_t fg, uint8_t bg);
+
+/**
+ * @brief Returns the cells of one row, for writing them directly.
+ * @details The pointer stays valid until the next scroll. Changes show from
+ *          the next time the row is scanned out.
+ * @param row Text row (0 is the top of the area).
+ * @return The row's UB_VGA_TextColumns cells, NULL for an invalid row.
+ */
+VGA_TextCell *UB_VGA_TextRow(uint8_t row);
+
+/**
+ * @brief Writes one character.
+ * @param col Column.
+ * @param row Text row.
+ * @param ch Character.
+ * @param attr Attribute.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_TextPutChar(uint8_t col, uint8_t row, char ch, uint8_t attr);
+
+/**
+ * @brief Writes a string from a cell on, up to the end of the row.
+ * @param col Column of the first character.
+ * @param row Text row.
+ * @param text String; characters past the end of the row are left out.
+ * @param attr Attribute.
+ * @return VGA_Status indicating success or error.
+ */
+VGA_Status UB_VGA_TextPrint(uint8_t col, uint8_t row, const char *text, uint8_t attr);
+
+/**
+ * @brief Clears the text area to spaces.
+ * @param attr Attribute of the cleared cells; its background also fills the
+ *             pixels to the right of the last column and below the last row.
+ */
+void UB_VGA_TextClear(uint8_t attr);
+
+/**
+ * @brief Scrolls the text area up.
+ * @details Moves the first row of the map, so no characters are copied, and
+ *          clears the rows that come in at the bottom.
+ * @param rows Number of text rows.
+ * @param attr Attribute of the new rows.
+ */
+void UB_VGA_TextScroll(uint8_t rows, uint8_t attr);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_TEXTMODE_H
@@ -0,0 +1,116 @@
+/**
+ * @file    stm32_ub_vga_transform.h
+ * @brief   2D affine transforms in fixed point.
+ * @details Translate, rotate and scale vertices before they are drawn. All
+ *          arithmetic is integer: matrix entries are 16.16 fixed point and
+ *          sines come from a table that the compiler builds, so no floating
+ *          point is needed (the FPU is not enabled).
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+#ifndef __STM32F4_UB_VGA_TRANSFORM_H
+#define __STM32F4_UB_VGA_TRANSFORM_H
+
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_screen.h"
+#include "stm32_ub_vga_shapes.h"
+
+
+//--------------------------------------------------------------
+/**
+ * @brief 1.0 in 16.16 fixed point.
+ */
+//--------------------------------------------------------------
+#define VGA_Q16_ONE   65536
+
+//--------------------------------------------------------------
+/**
+ * @brief An affine transform in 16.16 fixed point.
+ * @details A point (x, y) is mapped to
+ *          (a * x + b * y + tx, c * x + d * y + ty).
+ */
+//--------------------------------------------------------------
+typedef struct {
+    int32_t a, b;     /*!< First row of the matrix */
+    int32_t c, d;     /*!< Second row of the matrix */
+    int32_t tx, ty;   /*!< Translation in pixels, also 16.16 */
+} VGA_Transform;
+
+
+//--------------------------------------------------------------
+// Global Function call
+//--------------------------------------------------------------
+
+/**
+ * @brief Sine of an angle in whole degrees, in 16.16 fixed point.
+ * @param degrees Angle in degrees, any value.
+ * @return sin(degrees) * 65536, rounded.
+ */
+int32_t UB_VGA_SinQ16(int32_t degrees);
+
+/**
+ * @brief Cosine of an angle in whole degrees, in 16.16 fixed point.
+ * @param degrees Angle in degrees, any value.
+ * @return cos(degrees) * 65536, rounded.
+ */
+int32_t UB_VGA_CosQ16(int32_t degrees);
+
+/**
+ * @brief Sets a transform to the identity.
+ * @param t Transform.
+ */
+void UB_VGA_TransformIdentity(VGA_Transform *t);
+
+/**
+ * @brief Checks whether a transform leaves every point in place.
+ * @param t Transform.
+ * @return true for the identity.
+ */
+bool UB_VGA_TransformIsIdentity(const VGA_Transform *t);
+
+/**
+ * @brief Adds a translation to a transform.
+ * @details As with all the transform operations, the new operation is
+ *          applied to points before the operations already in t, so a
+ *          sequence reads from the outside in: translate to a center,
+ *          then rotate around it.
+ * @param t Transform.
+ * @param dx Horizontal offset in pixels.
+ * @param dy Vertical offset in pixels.
+ */
+void UB_VGA_TransformTranslate(VGA_Transform *t, int32_t dx, int32_t dy);
+
+/**
+ * @brief Adds a rotation around the origin to a transform.
+ * @param t Transform.
+ * @param degrees Angle in degrees; positive angles turn counter-clockwise on screen.
+ */
+void UB_VGA_TransformRotate(VGA_Transform *t, int32_t degrees);
+
+/**
+ * @brief Adds a scaling around the origin to a transform.
+ * @param t Transform.
+ * @param sx Horizontal factor in 16.16 fixed point (VGA_Q16_ONE is 1.0); negative mirrors.
+ * @param sy Vertical factor in 16.16 fixed point.
+ */
+void UB_VGA_TransformScale(VGA_Transform *t, int32_t sx, int32_t sy);
+
+/**
+ * @brief Transforms points in place.
+ * @details Four 32x32-bit multiply-accumulates per point, rounded to the
+ *          nearest pixel and limited to the range of int16_t.
+ * @param t Transform.
+ * @param pts Array of points.
+ * @param count Number of points.
+ */
+void UB_VGA_TransformPoints(const VGA_Transform *t, VGA_Point *pts, uint16_t count);
+
+
+//--------------------------------------------------------------
+#endif // __STM32F4_UB_VGA_TRANSFORM_H
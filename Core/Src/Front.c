@@ -18,6 +18,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <ctype.h>
 
 #define UART_BUF_SIZE 128
 #define UART_RX_BUFFER_SIZE 128
@@ -34,6 +35,9 @@ volatile uint16_t uart_tail = 0;
 char *line_buffer = NULL; ///< Dynamische buffer voor één complete lijn
 uint16_t line_idx = 0;    ///< Index in dynamische buffer
 
+// Meetwaarden of punten van het laatste plot-, polylijn- of puntenwolk-commando
+static int16_t reeks[PLOT_MAX_PUNTEN * 2];
+
 
 // Functies
 
@@ -48,6 +52,131 @@ void front_send_error(const char *msg)
     USART2_SendString("\r\n");
 }
 
+/**
+ * @brief Haalt de tellers van 'toon' op en stuurt ze via UART.
+ * @return Resultaat van de logic layer.
+ */
+static Resultaat fps_melden(void)
+{
+    VGA_PageStats stats;
+    Resultaat result = fps(&stats);
+    if(result != OK)
+        return result;
+
+    char melding[96];
+    snprintf(melding, sizeof(melding), "FPS %lu.%02lu, getoond %lu, gemist %lu, beelden %lu\r\n",
+             (unsigned long)(stats.fps_x100 / 100), (unsigned long)(stats.fps_x100 % 100),
+             (unsigned long)stats.presented, (unsigned long)stats.dropped, (unsigned long)stats.frames);
+    USART2_SendString(melding);
+    return OK;
+}
+
+/**
+ * @brief Haalt de tellers van de displaylijst op en stuurt ze via UART.
+ * @return Resultaat van de logic layer.
+ */
+static Resultaat lijstinfo_melden(void)
+{
+    VGA_ListStats stats;
+    Resultaat result = lijstinfo(&stats);
+    if(result != OK)
+        return result;
+
+    char melding[128];
+    snprintf(melding, sizeof(melding), "Lijst %u items, max %u per regel, regels %lu, te laat %lu, weggelaten %lu, cycli gem %lu max %lu budget %lu\r\n",
+             stats.items, stats.max_active, (unsigned long)stats.lines, (unsigned long)stats.late_lines,
+             (unsigned long)stats.skipped, (unsigned long)stats.avg_cycles, (unsigned long)stats.max_cycles,
+             (unsigned long)stats.budget_cycles);
+    USART2_SendString(melding);
+    return OK;
+}
+
+/**
+ * @brief Haalt de tellers van de sprites op en stuurt ze via UART.
+ * @return Resultaat van de logic layer.
+ */
+static Resultaat spriteinfo_melden(void)
+{
+    VGA_SpriteStats stats;
+    Resultaat result = spriteinfo(&stats);
+    if(result != OK)
+        return result;
+
+    char melding[160];
+    snprintf(melding, sizeof(melding), "Sprites updates %lu, cycli max %lu, te laat %lu, hertekend %lu, regels %lu, cycli per beeld %lu per regel %lu\r\n",
+             (unsigned long)stats.updates, (unsigned long)stats.update_cycles, (unsigned long)stats.late,
+             (unsigned long)stats.redrawn, (unsigned long)stats.rows, (unsigned long)stats.frame_cycles,
+             (unsigned long)stats.row_cycles);
+    USART2_SendString(melding);
+    return OK;
+}
+
+/**
+ * @brief Haalt de tellers van de raster-effecten op en stuurt ze via UART.
+ * @return Resultaat van de logic layer.
+ */
+static Resultaat effectinfo_melden(void)
+{
+    VGA_RasterStats stats;
+    Resultaat result = effectinfo(&stats);
+    if(result != OK)
+        return result;
+
+    char melding[128];
+    snprintf(melding, sizeof(melding), "Effecten regels %lu, te laat %lu, weggelaten %lu, cycli gem %lu max %lu budget %lu\r\n",
+             (unsigned long)stats.rows, (unsigned long)stats.late_rows, (unsigned long)stats.skipped,
+             (unsigned long)stats.avg_cycles, (unsigned long)stats.max_cycles, (unsigned long)stats.budget_cycles);
+    USART2_SendString(melding);
+    return OK;
+}
+
+/**
+ * @brief Meet de meng-kernels en stuurt de cycli per rij via UART.
+ * @details Een SIMD-waarde 0 betekent dat de library zonder de Cortex-M4
+ *          SIMD-instructies gebouwd is.
+ * @return Resultaat van de logic layer.
+ */
+static Resultaat menginfo_melden(void)
+{
+    VGA_BlendBench bench;
+    Resultaat result = menginfo(&bench);
+    if(result != OK)
+        return result;
+
+    char melding[160];
+    snprintf(melding, sizeof(melding), "Mengen %d px cycli SIMD 25%% %lu 50%% %lu 75%% %lu sleutel %lu, C 25%% %lu 50%% %lu 75%% %lu sleutel %lu\r\n",
+             VGA_BLEND_BENCH_PIXELS,
+             (unsigned long)bench.span_simd[0], (unsigned long)bench.span_simd[1], (unsigned long)bench.span_simd[2],
+             (unsigned long)bench.keyed_simd,
+             (unsigned long)bench.span_c[0], (unsigned long)bench.span_c[1], (unsigned long)bench.span_c[2],
+             (unsigned long)bench.keyed_c);
+    USART2_SendString(melding);
+    return OK;
+}
+
+/**
+ * @brief Haalt de tellers van de planner op en stuurt ze via UART.
+ * @details De trilling is de spreiding van TIM2 aan het einde van de regels
+ *          die tijdens een stukje van de planner eindigden, in TIM2-ticks.
+ * @return Resultaat van de logic layer.
+ */
+static Resultaat plannerinfo_melden(void)
+{
+    VGA_SchedStats stats;
+    VGA_IsrStats isr;
+    Resultaat result = plannerinfo(&stats, &isr);
+    if(result != OK)
+        return result;
+
+    char melding[192];
+    snprintf(melding, sizeof(melding), "Planner pixels %lu, stukjes %lu, te laat %lu, cycli max %lu tekenen %lu bezig %lu, pixels per ms %lu, trilling %lu over %lu regels\r\n",
+             (unsigned long)stats.pixels, (unsigned long)stats.chunks, (unsigned long)stats.late_chunks,
+             (unsigned long)stats.max_chunk_cycles, (unsigned long)stats.draw_cycles, (unsigned long)stats.busy_cycles,
+             (unsigned long)stats.pixels_per_ms, (unsigned long)stats.jitter_ticks, (unsigned long)stats.jitter_lines);
+    USART2_SendString(melding);
+    return OK;
+}
+
 /**
  * @brief Converteert een foutcode naar een leesbare string.
  * @param code Foutcode van Front, Logic of VGA layer.
@@ -74,16 +203,222 @@ const char* status_to_string(int code)
         case ERROR_OUT_OF_BOUNDS: return "LOGIC ERROR: coördinaten buiten scherm";
         case ERROR_TEXT_TOO_LONG: return "LOGIC ERROR: tekst te lang";
         case ERROR_TOO_MANY_REPEATS: return "LOGIC ERROR: te veel herhalingen";
+        case ERROR_INVALID_PARAM_DEKKING: return "LOGIC ERROR: ongeldige dekking";
+        case ERROR_NOT_REPEATABLE: return "LOGIC ERROR: reeks te lang voor herhaal";
 
         case VGA_OK: return "VGA OK";
         case ERROR_VGA: return "IO ERROR: VGA fout";
         case ERROR_VGA_INVALID_COORDINATE: return "IO ERROR: VGA ongeldig coördinaat";
         case ERROR_VGA_INVALID_PARAMETER: return "IO ERROR: VGA ongeldig parameter";
+        case ERROR_VGA_OUT_OF_MEMORY: return "IO ERROR: VGA te weinig geheugen";
+        case ERROR_VGA_TIMEOUT: return "IO ERROR: VGA reageert niet";
 
         default: return "Onbekende foutcode";
     }
 }
 
+/**
+ * @brief Leest een geheel getal uit een token (spaties en regeleinde toegestaan).
+ * @param token Het token.
+ * @param waarde Pointer waarin het getal wordt opgeslagen.
+ * @return 1 als het token een getal is, anders 0.
+ */
+static int lees_getal(const char *token, int *waarde)
+{
+    char *eind;
+    long v = strtol(token, &eind, 10);
+    if (eind == token)
+        return 0;
+    while (*eind == ' ' || *eind == '\r' || *eind == '\n')
+        eind++;
+    if (*eind != '\0')
+        return 0;
+    *waarde = (int)v;
+    return 1;
+}
+
+/**
+ * @brief Parseert een lijst hoekpunten gevolgd door een kleur: x1,y1,...,xn,yn,kleur.
+ * @details Verwacht dat strtok al op het commando-woord is aangeroepen.
+ * @param cmd Pointer naar Command struct die gevuld wordt.
+ * @param rest Pointer waarin het token na de kleur wordt opgeslagen (NULL als er geen is).
+ * @return FrontStatus code (FRONT_OK of foutcode).
+ */
+static FrontStatus parse_punten(Command *cmd, char **rest)
+{
+    int aantal = 0;
+    char *token = strtok(NULL, ",");
+
+    // Coördinaten tot aan de (niet-numerieke) kleurnaam
+    int waarde;
+    while (token != NULL && lees_getal(token, &waarde))
+    {
+        if (aantal == POLYGOON_MAX_PUNTEN * 2)
+            return FRONT_ERROR_PARSE;
+        cmd->punten[aantal++] = waarde;
+        token = strtok(NULL, ",");
+    }
+    if (token == NULL || aantal % 2 != 0)
+        return FRONT_ERROR_PARSE;
+    cmd->aantal_punten = aantal / 2;
+
+    if (sscanf(token, " %19[^,\r\n]", cmd->kleur) != 1)
+        return FRONT_ERROR_PARSE;
+
+    *rest = strtok(NULL, ",");
+    return FRONT_OK;
+}
+
+/**
+ * @brief Parseert een polygoon commando: polygoon,x1,y1,...,xn,yn,kleur[,dikte[,vulling]].
+ * @param cmd Pointer naar Command struct die gevuld wordt.
+ * @return FrontStatus code (FRONT_OK of foutcode).
+ */
+static FrontStatus parse_polygoon(Command *cmd)
+{
+    char *token;
+    FrontStatus status = parse_punten(cmd, &token);
+    if (status != FRONT_OK)
+        return status;
+
+    cmd->dikte = 1;
+    cmd->vulling = 0;
+    if (token != NULL && !lees_getal(token, &cmd->dikte))
+        return FRONT_ERROR_PARSE;
+    token = token ? strtok(NULL, ",") : NULL;
+    if (token != NULL && !lees_getal(token, &cmd->vulling))
+        return FRONT_ERROR_PARSE;
+    if (token != NULL && strtok(NULL, ",") != NULL)
+        return FRONT_ERROR_PARSE;
+
+    return FRONT_OK;
+}
+
+/**
+ * @brief Geeft de waarde van een hexadecimaal cijfer (0-9, a-f, A-F).
+ */
+static int hex_waarde(char c)
+{
+    return isdigit((unsigned char)c) ? c - '0' : tolower((unsigned char)c) - 'a' + 10;
+}
+
+/**
+ * @brief Parseert een plot commando: plot,x,stap,kleur,meetwaarden[,dikte].
+ * @details De meetwaarden zijn één hex-string met twee cijfers per waarde
+ *          (00 t/m FF), zodat een reeks van honderden waarden in één regel
+ *          past. Wordt rechtstreeks uit de invoer gelezen, niet uit de
+ *          (begrensde) parse-buffer.
+ * @param input De volledige invoerregel.
+ * @param cmd Pointer naar Command struct die gevuld wordt.
+ * @return FrontStatus code (FRONT_OK of foutcode).
+ */
+static FrontStatus parse_plot(const char *input, Command *cmd)
+{
+    int pos = -1;
+    int aantal = 0;
+
+    cmd->dikte = 1;
+    if (sscanf(input, "plot,%d,%d, %19[^,],%n", &cmd->x, &cmd->stap, cmd->kleur, &pos) != 3 || pos < 0)
+        return FRONT_ERROR_PARSE;
+
+    const char *p = input + pos;
+    while (isxdigit((unsigned char)p[0]) && isxdigit((unsigned char)p[1]))
+    {
+        if (aantal == PLOT_MAX_PUNTEN)
+            return FRONT_ERROR_PARSE;
+        reeks[aantal++] = (hex_waarde(p[0]) << 4) | hex_waarde(p[1]);
+        p += 2;
+    }
+    // Geen waarden of een oneven aantal cijfers
+    if (aantal == 0 || isxdigit((unsigned char)*p))
+        return FRONT_ERROR_PARSE;
+    if (*p == ',' && sscanf(p, ",%d", &cmd->dikte) != 1)
+        return FRONT_ERROR_PARSE;
+
+    cmd->reeks = reeks;
+    cmd->aantal_punten = aantal;
+    return FRONT_OK;
+}
+
+/**
+ * @brief Parseert een lange lijst punten: x1,y1,...,xn,yn,kleur[,dikte].
+ * @details Als parse_punten, maar tot PLOT_MAX_PUNTEN punten en rechtstreeks
+ *          uit de invoer gelezen.
+ * @param p De invoer na het commando-woord en de komma.
+ * @param cmd Pointer naar Command struct die gevuld wordt.
+ * @param dikte Pointer voor de optionele dikte, of NULL als er geen dikte mag volgen.
+ * @return FrontStatus code (FRONT_OK of foutcode).
+ */
+static FrontStatus parse_puntenreeks(const char *p, Command *cmd, int *dikte)
+{
+    int aantal = 0;
+    char *eind;
+
+    // Coördinaten tot aan de (niet-numerieke) kleurnaam
+    for (;;)
+    {
+        long v = strtol(p, &eind, 10);
+        if (eind == p)
+            break;
+        if (aantal == PLOT_MAX_PUNTEN * 2 || v < INT16_MIN || v > INT16_MAX)
+            return FRONT_ERROR_PARSE;
+        reeks[aantal++] = (int16_t)v;
+        while (*eind == ' ')
+            eind++;
+        if (*eind != ',')
+            return FRONT_ERROR_PARSE;
+        p = eind + 1;
+    }
+    if (aantal == 0 || aantal % 2 != 0)
+        return FRONT_ERROR_PARSE;
+    cmd->reeks = reeks;
+    cmd->aantal_punten = aantal / 2;
+
+    int n = dikte ? sscanf(p, " %19[^,\r\n],%d", cmd->kleur, dikte)
+                  : sscanf(p, " %19[^,\r\n]", cmd->kleur);
+    if (n < 1)
+        return FRONT_ERROR_PARSE;
+    return FRONT_OK;
+}
+
+/**
+ * @brief Parseert een meting commando: meting,nr,w1[,w2,...].
+ * @details Rechtstreeks uit de invoer gelezen, zodat veel metingen in één
+ *          bericht passen (tot PLOT_MAX_PUNTEN * 2 waarden).
+ * @param input De volledige invoerregel.
+ * @param cmd Pointer naar Command struct die gevuld wordt.
+ * @return FrontStatus code (FRONT_OK of foutcode).
+ */
+static FrontStatus parse_meting(const char *input, Command *cmd)
+{
+    int pos = -1;
+    int aantal = 0;
+    char *eind;
+
+    if (sscanf(input, "meting,%d,%n", &cmd->grafiek_nr, &pos) != 1 || pos < 0)
+        return FRONT_ERROR_PARSE;
+
+    const char *p = input + pos;
+    for (;;)
+    {
+        long v = strtol(p, &eind, 10);
+        if (eind == p || aantal == PLOT_MAX_PUNTEN * 2 || v < INT16_MIN || v > INT16_MAX)
+            return FRONT_ERROR_PARSE;
+        reeks[aantal++] = (int16_t)v;
+        while (*eind == ' ')
+            eind++;
+        if (*eind != ',')
+            break;
+        p = eind + 1;
+    }
+    if (*eind != '\0' && *eind != '\r' && *eind != '\n')
+        return FRONT_ERROR_PARSE;
+
+    cmd->reeks = reeks;
+    cmd->aantal_punten = aantal;
+    return FRONT_OK;
+}
+
 /**
  * @brief Parseert een commando string en vult een Command struct.
  * @param input De input string (bijv. "LIJN,0,0,100,100,rood,2").
@@ -99,17 +434,21 @@ FrontStatus parse_command(const char* input, Command* cmd)
     strncpy(buffer, input, sizeof(buffer)-1);
     buffer[sizeof(buffer)-1] = '\0';
 
-    char* Commando = strtok(buffer, ",");
+    char* Commando = strtok(buffer, ",\r\n");
     if (Commando == NULL)
         return FRONT_ERROR_PARSE;
 
+    // Optionele dekking; zonder laatste argument wordt ondoorzichtig getekend
+    cmd->dekking = DEKKING_VOL;
+    strcpy(cmd->lijnstijl, "vol");
+
     // LIJN command
     if (strcmp(Commando, "lijn") == 0)
     {
         cmd->type = CMD_LIJN;
-        int n = sscanf(input, "lijn,%d,%d,%d,%d, %19[^,],%d",
-                       &cmd->x, &cmd->y, &cmd->x2, &cmd->y2, cmd->kleur, &cmd->dikte);
-        if(n != 6)
+        int n = sscanf(input, "lijn,%d,%d,%d,%d, %19[^,],%d,%d, %19[^,\r\n]",
+                       &cmd->x, &cmd->y, &cmd->x2, &cmd->y2, cmd->kleur, &cmd->dikte, &cmd->dekking, cmd->lijnstijl);
+        if(n < 6)
             return FRONT_ERROR_PARSE;
     }
 
@@ -117,9 +456,9 @@ FrontStatus parse_command(const char* input, Command* cmd)
     else if(strcmp(Commando, "rechthoek") == 0)
     {
         cmd->type = CMD_RECHTHOEK;
-        int n = sscanf(input, "rechthoek,%d,%d,%d,%d, %19[^,],%d",
-                       &cmd->x, &cmd->y, &cmd->breedte, &cmd->hoogte, cmd->kleur, &cmd->gevuld);
-        if(n != 6)
+        int n = sscanf(input, "rechthoek,%d,%d,%d,%d, %19[^,],%d,%d",
+                       &cmd->x, &cmd->y, &cmd->breedte, &cmd->hoogte, cmd->kleur, &cmd->gevuld, &cmd->dekking);
+        if(n != 6 && n != 7)
             return FRONT_ERROR_PARSE;
     }
 
@@ -139,8 +478,8 @@ FrontStatus parse_command(const char* input, Command* cmd)
     else if(strcmp(Commando, "bitmap") == 0)
     {
         cmd->type = CMD_BITMAP;
-        int n = sscanf(input, "bitmap,%d,%d,%d", &cmd->bitmap_nr, &cmd->x, &cmd->y);
-        if(n != 3) return FRONT_ERROR_PARSE;
+        int n = sscanf(input, "bitmap,%d,%d,%d,%d", &cmd->bitmap_nr, &cmd->x, &cmd->y, &cmd->dekking);
+        if(n != 3 && n != 4) return FRONT_ERROR_PARSE;
     }
 
     // CLEARSCHERM command
@@ -171,18 +510,431 @@ FrontStatus parse_command(const char* input, Command* cmd)
     else if(strcmp(Commando, "cirkel") == 0)
     {
         cmd->type = CMD_CIRKEL;
-        int n = sscanf(input, "cirkel,%d,%d,%d, %19[^,\n]", &cmd->x, &cmd->y, &cmd->radius, cmd->kleur);
-        if(n != 4) return FRONT_ERROR_PARSE;
+        cmd->dikte = 1;
+        cmd->gevuld = 0;
+        int n = sscanf(input, "cirkel,%d,%d,%d, %19[^,\r\n],%d,%d",
+                       &cmd->x, &cmd->y, &cmd->radius, cmd->kleur, &cmd->dikte, &cmd->gevuld);
+        if(n < 4) return FRONT_ERROR_PARSE;
     }
 
     // FIGUUR command
     else if(strcmp(Commando, "figuur") == 0)
     {
         cmd->type = CMD_FIGUUR;
-        int n = sscanf(input, "figuur,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d, %19[^,\n]",
+        int n = sscanf(input, "figuur,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d, %19[^,\n], %19[^,\r\n]",
+                       &cmd->x, &cmd->y, &cmd->x2, &cmd->y2, &cmd->x3, &cmd->y3,
+                       &cmd->x4, &cmd->y4, &cmd->x5, &cmd->y5, cmd->kleur, cmd->lijnstijl);
+        if(n < 11) return FRONT_ERROR_PARSE;
+    }
+
+    // POLYGOON command
+    else if(strcmp(Commando, "polygoon") == 0)
+    {
+        cmd->type = CMD_POLYGOON;
+        FrontStatus status = parse_polygoon(cmd);
+        if(status != FRONT_OK) return status;
+    }
+
+    // DRIEHOEK command, optioneel met een kleur per hoekpunt
+    else if(strcmp(Commando, "driehoek") == 0)
+    {
+        cmd->type = CMD_DRIEHOEK;
+        int n = sscanf(input, "driehoek,%d,%d,%d,%d,%d,%d, %19[^,\r\n], %19[^,\r\n], %19[^,\r\n]",
                        &cmd->x, &cmd->y, &cmd->x2, &cmd->y2, &cmd->x3, &cmd->y3,
-                       &cmd->x4, &cmd->y4, &cmd->x5, &cmd->y5, cmd->kleur);
-        if(n != 11) return FRONT_ERROR_PARSE;
+                       cmd->kleur, cmd->kleur2, cmd->kleur3);
+        if(n == 7)
+        {
+            strcpy(cmd->kleur2, cmd->kleur);
+            strcpy(cmd->kleur3, cmd->kleur);
+        }
+        else if(n != 9) return FRONT_ERROR_PARSE;
+    }
+
+    // VUL command
+    else if(strcmp(Commando, "vul") == 0)
+    {
+        cmd->type = CMD_VUL;
+        int n = sscanf(input, "vul,%d,%d, %19[^,\r\n]", &cmd->x, &cmd->y, cmd->kleur);
+        if(n != 3) return FRONT_ERROR_PARSE;
+    }
+
+    // VERLOOP command
+    else if(strcmp(Commando, "verloop") == 0)
+    {
+        cmd->type = CMD_VERLOOP;
+        char soort[20] = "horizontaal";
+        int n = sscanf(input, "verloop,%d,%d,%d,%d, %19[^,\r\n], %19[^,\r\n], %19[^,\r\n]",
+                       &cmd->x, &cmd->y, &cmd->breedte, &cmd->hoogte, cmd->kleur, cmd->kleur2, soort);
+        if(n != 6 && n != 7) return FRONT_ERROR_PARSE;
+
+        if(strcmp(soort, "horizontaal") == 0) cmd->soort = 0;
+        else if(strcmp(soort, "verticaal") == 0) cmd->soort = 1;
+        else if(strcmp(soort, "radiaal") == 0) cmd->soort = 2;
+        else cmd->soort = -1;
+    }
+
+    // BEZIER2 / BEZIER3 command: punten, kleur en optioneel dikte en vlakheid
+    else if(strcmp(Commando, "bezier2") == 0 || strcmp(Commando, "bezier3") == 0)
+    {
+        cmd->type = CMD_BEZIER;
+        cmd->dikte = 1;
+        cmd->vlakheid = VGA_BEZIER_FLATNESS_DEFAULT;
+        int *p = cmd->punten;
+        int n;
+        if(strcmp(Commando, "bezier2") == 0)
+        {
+            cmd->aantal_punten = 3;
+            n = sscanf(input, "bezier2,%d,%d,%d,%d,%d,%d, %19[^,\r\n],%d,%d",
+                       &p[0], &p[1], &p[2], &p[3], &p[4], &p[5], cmd->kleur, &cmd->dikte, &cmd->vlakheid) - 6;
+        }
+        else
+        {
+            cmd->aantal_punten = 4;
+            n = sscanf(input, "bezier3,%d,%d,%d,%d,%d,%d,%d,%d, %19[^,\r\n],%d,%d",
+                       &p[0], &p[1], &p[2], &p[3], &p[4], &p[5], &p[6], &p[7], cmd->kleur, &cmd->dikte, &cmd->vlakheid) - 8;
+        }
+        if(n < 1) return FRONT_ERROR_PARSE;
+    }
+
+    // PATROON command
+    else if(strcmp(Commando, "patroon") == 0)
+    {
+        cmd->type = CMD_PATROON;
+        int *r = cmd->rijen;
+        // %i accepteert ook hexadecimale rijen, bijvoorbeeld 0xAA
+        int n = sscanf(input, "patroon,%d,%i,%i,%i,%i,%i,%i,%i,%i",
+                       &cmd->patroon_nr, &r[0], &r[1], &r[2], &r[3], &r[4], &r[5], &r[6], &r[7]);
+        if(n != 9) return FRONT_ERROR_PARSE;
+    }
+
+    // VULPATROON command
+    else if(strcmp(Commando, "vulpatroon") == 0)
+    {
+        cmd->type = CMD_VULPATROON;
+        char uit[8];
+        if(sscanf(input, "vulpatroon, %7[^,\r\n]", uit) == 1 && strcmp(uit, "uit") == 0)
+        {
+            cmd->patroon_nr = -1;
+        }
+        else
+        {
+            int n = sscanf(input, "vulpatroon,%d, %19[^,\r\n]", &cmd->patroon_nr, cmd->kleur);
+            if(n != 2) return FRONT_ERROR_PARSE;
+        }
+    }
+
+    // ELLIPS command
+    else if(strcmp(Commando, "ellips") == 0)
+    {
+        cmd->type = CMD_ELLIPS;
+        cmd->gevuld = 0;
+        int n = sscanf(input, "ellips,%d,%d,%d,%d, %19[^,\r\n],%d",
+                       &cmd->x, &cmd->y, &cmd->radius, &cmd->radius_y, cmd->kleur, &cmd->gevuld);
+        if(n != 5 && n != 6) return FRONT_ERROR_PARSE;
+    }
+
+    // BOOG command
+    else if(strcmp(Commando, "boog") == 0)
+    {
+        cmd->type = CMD_BOOG;
+        int n = sscanf(input, "boog,%d,%d,%d,%d,%d,%d, %19[^,\r\n]",
+                       &cmd->x, &cmd->y, &cmd->radius, &cmd->radius_y,
+                       &cmd->starthoek, &cmd->eindhoek, cmd->kleur);
+        if(n != 7) return FRONT_ERROR_PARSE;
+    }
+
+    // AFGERONDERECHTHOEK command
+    else if(strcmp(Commando, "afgeronderechthoek") == 0)
+    {
+        cmd->type = CMD_AFGERONDE_RECHTHOEK;
+        cmd->gevuld = 0;
+        int n = sscanf(input, "afgeronderechthoek,%d,%d,%d,%d,%d, %19[^,\r\n],%d",
+                       &cmd->x, &cmd->y, &cmd->breedte, &cmd->hoogte, &cmd->radius, cmd->kleur, &cmd->gevuld);
+        if(n != 6 && n != 7) return FRONT_ERROR_PARSE;
+    }
+
+    // DRIEHOEKSTRIP command
+    else if(strcmp(Commando, "driehoekstrip") == 0)
+    {
+        cmd->type = CMD_DRIEHOEKSTRIP;
+        char *rest;
+        FrontStatus status = parse_punten(cmd, &rest);
+        if(status != FRONT_OK) return status;
+        if(rest != NULL) return FRONT_ERROR_PARSE;
+    }
+
+    // PLOT command: meetreeks als hex-string
+    else if(strcmp(Commando, "plot") == 0)
+    {
+        cmd->type = CMD_PLOT;
+        FrontStatus status = parse_plot(input, cmd);
+        if(status != FRONT_OK) return status;
+    }
+
+    // POLYLIJN en PUNTENWOLK commands: lange lijst punten
+    else if(strcmp(Commando, "polylijn") == 0 || strcmp(Commando, "puntenwolk") == 0)
+    {
+        const char *rest = strchr(input, ',');
+        if(rest == NULL) return FRONT_ERROR_PARSE;
+        cmd->type = (strcmp(Commando, "polylijn") == 0) ? CMD_POLYLIJN : CMD_PUNTENWOLK;
+        cmd->dikte = 1;
+        FrontStatus status = parse_puntenreeks(rest + 1, cmd, cmd->type == CMD_POLYLIJN ? &cmd->dikte : NULL);
+        if(status != FRONT_OK) return status;
+    }
+
+    // GRAFIEK command: strip-chart met 1 t/m 4 kanalen
+    else if(strcmp(Commando, "grafiek") == 0)
+    {
+        cmd->type = CMD_GRAFIEK;
+        int n = sscanf(input, "grafiek,%d,%d,%d,%d,%d,%d,%d, %19[^,], %19[^,\r\n], %19[^,\r\n], %19[^,\r\n], %19[^,\r\n]",
+                       &cmd->grafiek_nr, &cmd->x, &cmd->y, &cmd->breedte, &cmd->hoogte,
+                       &cmd->ondergrens, &cmd->bovengrens, cmd->kleur,
+                       cmd->kanaalkleuren[0], cmd->kanaalkleuren[1], cmd->kanaalkleuren[2], cmd->kanaalkleuren[3]);
+        if(n < 9) return FRONT_ERROR_PARSE;
+        cmd->kanalen = n - 8;
+    }
+
+    // GRAFIEKRASTER command
+    else if(strcmp(Commando, "grafiekraster") == 0)
+    {
+        cmd->type = CMD_GRAFIEKRASTER;
+        int n = sscanf(input, "grafiekraster,%d,%d, %19[^,\r\n]", &cmd->grafiek_nr, &cmd->stap, cmd->kleur);
+        if(n != 3) return FRONT_ERROR_PARSE;
+    }
+
+    // METING command: één of meer metingen voor een grafiek
+    else if(strcmp(Commando, "meting") == 0)
+    {
+        cmd->type = CMD_METING;
+        FrontStatus status = parse_meting(input, cmd);
+        if(status != FRONT_OK) return status;
+    }
+
+    // VERSCHUIF command
+    else if(strcmp(Commando, "verschuif") == 0)
+    {
+        cmd->type = CMD_VERSCHUIF;
+        int n = sscanf(input, "verschuif,%d,%d", &cmd->x, &cmd->y);
+        if(n != 2) return FRONT_ERROR_PARSE;
+    }
+
+    // DRAAI command: middelpunt is optioneel, standaard (0, 0)
+    else if(strcmp(Commando, "draai") == 0)
+    {
+        cmd->type = CMD_DRAAI;
+        cmd->x = 0;
+        cmd->y = 0;
+        int n = sscanf(input, "draai,%d,%d,%d", &cmd->hoek, &cmd->x, &cmd->y);
+        if(n != 1 && n != 3) return FRONT_ERROR_PARSE;
+    }
+
+    // SCHAAL command: zonder verticale factor wordt uniform geschaald
+    else if(strcmp(Commando, "schaal") == 0)
+    {
+        cmd->type = CMD_SCHAAL;
+        int n = sscanf(input, "schaal,%d,%d", &cmd->schaal_x, &cmd->schaal_y);
+        if(n == 1) cmd->schaal_y = cmd->schaal_x;
+        else if(n != 2) return FRONT_ERROR_PARSE;
+    }
+
+    // TRANSFORMATIE command
+    else if(strcmp(Commando, "transformatie") == 0)
+    {
+        cmd->type = CMD_TRANSFORMATIE;
+        int n = sscanf(input, "transformatie, %7[^,\r\n]", cmd->actie);
+        if(n != 1) return FRONT_ERROR_PARSE;
+    }
+
+    // SPLITS command
+    else if(strcmp(Commando, "splits") == 0)
+    {
+        cmd->type = CMD_SPLITS;
+        int n = sscanf(input, "splits,%d,%d", &cmd->boven, &cmd->onder);
+        if(n != 2) return FRONT_ERROR_PARSE;
+    }
+
+    // ROL command: kleur voor de nieuwe rijen is optioneel
+    else if(strcmp(Commando, "rol") == 0)
+    {
+        cmd->type = CMD_ROL;
+        cmd->kleur[0] = '\0';
+        int n = sscanf(input, "rol,%d, %19[^,\r\n]", &cmd->regels, cmd->kleur);
+        if(n < 1) return FRONT_ERROR_PARSE;
+    }
+
+    // MODUS command
+    else if(strcmp(Commando, "modus") == 0)
+    {
+        cmd->type = CMD_MODUS;
+        int n = sscanf(input, "modus, %11[^,\r\n ]", cmd->modus);
+        if(n != 1) return FRONT_ERROR_PARSE;
+    }
+
+    // DUBBELBUFFER command
+    else if(strcmp(Commando, "dubbelbuffer") == 0)
+    {
+        cmd->type = CMD_DUBBELBUFFER;
+        int n = sscanf(input, "dubbelbuffer, %7[^,\r\n ]", cmd->actie);
+        if(n != 1) return FRONT_ERROR_PARSE;
+    }
+
+    // TOON command: kopie is optioneel
+    else if(strcmp(Commando, "toon") == 0)
+    {
+        cmd->type = CMD_TOON;
+        cmd->actie[0] = '\0';
+        sscanf(input, "toon, %7[^,\r\n ]", cmd->actie);
+    }
+
+    // FPS command
+    else if(strcmp(Commando, "fps") == 0)
+    {
+        cmd->type = CMD_FPS;
+    }
+
+    // LIJST command
+    else if(strcmp(Commando, "lijst") == 0)
+    {
+        cmd->type = CMD_LIJST;
+        int n = sscanf(input, "lijst, %7[^,\r\n ]", cmd->actie);
+        if(n != 1) return FRONT_ERROR_PARSE;
+    }
+
+    // LIJSTINFO command
+    else if(strcmp(Commando, "lijstinfo") == 0)
+    {
+        cmd->type = CMD_LIJSTINFO;
+    }
+
+    // TEKSTVAK command: zonder aantal rijen tot de onderkant
+    else if(strcmp(Commando, "tekstvak") == 0)
+    {
+        cmd->type = CMD_TEKSTVAK;
+        char uit[8];
+        cmd->aantal = 0;
+        if(sscanf(input, "tekstvak, %7[^,\r\n ]", uit) == 1 && strcmp(uit, "uit") == 0)
+        {
+            cmd->y = -1;
+        }
+        else
+        {
+            int n = sscanf(input, "tekstvak,%d,%d", &cmd->y, &cmd->aantal);
+            if(n != 1 && n != 2) return FRONT_ERROR_PARSE;
+        }
+    }
+
+    // SCHRIJF command: de tekst loopt tot het einde van de regel en mag komma's bevatten
+    else if(strcmp(Commando, "schrijf") == 0)
+    {
+        cmd->type = CMD_SCHRIJF;
+        int n = sscanf(input, "schrijf,%d,%d, %19[^,], %19[^,],%109[^\r\n]",
+                       &cmd->x, &cmd->y, cmd->kleur, cmd->kleur2, cmd->tekst);
+        if(n != 5) return FRONT_ERROR_PARSE;
+    }
+
+    // TEKSTROL command: achtergrond van de nieuwe regels is optioneel
+    else if(strcmp(Commando, "tekstrol") == 0)
+    {
+        cmd->type = CMD_TEKSTROL;
+        strcpy(cmd->kleur, "zwart");
+        int n = sscanf(input, "tekstrol,%d, %19[^,\r\n]", &cmd->regels, cmd->kleur);
+        if(n < 1) return FRONT_ERROR_PARSE;
+    }
+
+    // SPRITE command: laag is optioneel, "uit" haalt de sprite weg
+    else if(strcmp(Commando, "sprite") == 0)
+    {
+        cmd->type = CMD_SPRITE;
+        char uit[8];
+        cmd->laag = 0;
+        if(sscanf(input, "sprite,%d, %7[^,\r\n ]", &cmd->sprite_nr, uit) == 2 && strcmp(uit, "uit") == 0)
+        {
+            cmd->bitmap_nr = -1;
+            cmd->x = 0;
+            cmd->y = 0;
+        }
+        else
+        {
+            int n = sscanf(input, "sprite,%d,%d,%d,%d,%d", &cmd->sprite_nr, &cmd->bitmap_nr, &cmd->x, &cmd->y, &cmd->laag);
+            if(n != 4 && n != 5) return FRONT_ERROR_PARSE;
+        }
+    }
+
+    // SPRITEMODUS command
+    else if(strcmp(Commando, "spritemodus") == 0)
+    {
+        cmd->type = CMD_SPRITEMODUS;
+        int n = sscanf(input, "spritemodus, %11[^,\r\n ]", cmd->modus);
+        if(n != 1) return FRONT_ERROR_PARSE;
+    }
+
+    // SPRITEINFO command
+    else if(strcmp(Commando, "spriteinfo") == 0)
+    {
+        cmd->type = CMD_SPRITEINFO;
+    }
+
+    // EFFECT command: de velden na eerste en rijen hangen af van de soort
+    else if(strcmp(Commando, "effect") == 0)
+    {
+        cmd->type = CMD_EFFECT;
+        cmd->y = cmd->hoogte = cmd->x = cmd->breedte = cmd->amplitude = 0;
+        strcpy(cmd->kleur, "zwart");
+        strcpy(cmd->kleur2, "zwart");
+        strcpy(cmd->kleur3, "zwart");
+        int n = sscanf(input, "effect,%d, %7[^,\r\n ]", &cmd->effect_nr, cmd->actie);
+        if(n != 2) return FRONT_ERROR_PARSE;
+
+        if(strcmp(cmd->actie, "golf") == 0)
+            n = sscanf(input, "effect,%*d, %*[^,],%d,%d,%d", &cmd->y, &cmd->hoogte, &cmd->amplitude) - 3;
+        else if(strcmp(cmd->actie, "verloop") == 0)
+            n = sscanf(input, "effect,%*d, %*[^,],%d,%d, %19[^,], %19[^,], %19[^,\r\n]",
+                       &cmd->y, &cmd->hoogte, cmd->kleur, cmd->kleur2, cmd->kleur3) - 5;
+        else if(strcmp(cmd->actie, "invers") == 0 || strcmp(cmd->actie, "donker") == 0)
+        {
+            n = sscanf(input, "effect,%*d, %*[^,],%d,%d,%d,%d", &cmd->y, &cmd->hoogte, &cmd->x, &cmd->breedte);
+            n = (n == 2 || n == 4) ? 0 : -1;
+        }
+        else if(strcmp(cmd->actie, "vlak") == 0)
+            n = sscanf(input, "effect,%*d, %*[^,],%d,%d,%d,%d, %19[^,\r\n]",
+                       &cmd->y, &cmd->hoogte, &cmd->x, &cmd->breedte, cmd->kleur) - 5;
+        else
+            n = 0;
+        if(n != 0) return FRONT_ERROR_PARSE;
+    }
+
+    // EFFECTFASE command
+    else if(strcmp(Commando, "effectfase") == 0)
+    {
+        cmd->type = CMD_EFFECTFASE;
+        int n = sscanf(input, "effectfase,%d,%d", &cmd->effect_nr, &cmd->fase);
+        if(n != 2) return FRONT_ERROR_PARSE;
+    }
+
+    // EFFECTINFO command
+    else if(strcmp(Commando, "effectinfo") == 0)
+    {
+        cmd->type = CMD_EFFECTINFO;
+    }
+
+    // MENGINFO command
+    else if(strcmp(Commando, "menginfo") == 0)
+    {
+        cmd->type = CMD_MENGINFO;
+    }
+
+    // PLANNER command
+    else if(strcmp(Commando, "planner") == 0)
+    {
+        cmd->type = CMD_PLANNER;
+        int n = sscanf(input, "planner, %11[^,\r\n ]", cmd->modus);
+        if(n != 1) return FRONT_ERROR_PARSE;
+    }
+
+    // PLANNERINFO command
+    else if(strcmp(Commando, "plannerinfo") == 0)
+    {
+        cmd->type = CMD_PLANNERINFO;
     }
 
     // ERROR unknown command
@@ -214,15 +966,61 @@ void front_handle_input(const char* input_line)
 
     Resultaat result = OK;
 
+    // Wat direct tekent of het beeld leest, komt na wat de planner nog moet tekenen
+    planner_volgorde(cmd.type);
+
     switch(cmd.type)
     {
-        case CMD_LIJN: result = lijn(cmd.x, cmd.y, cmd.x2, cmd.y2, cmd.kleur, cmd.dikte); break;
-        case CMD_RECHTHOEK: result = rechthoek(cmd.x, cmd.y, cmd.breedte, cmd.hoogte, cmd.kleur, cmd.gevuld); break;
+        case CMD_LIJN: result = lijn(cmd.x, cmd.y, cmd.x2, cmd.y2, cmd.kleur, cmd.dikte, cmd.dekking, cmd.lijnstijl); break;
+        case CMD_RECHTHOEK: result = rechthoek(cmd.x, cmd.y, cmd.breedte, cmd.hoogte, cmd.kleur, cmd.gevuld, cmd.dekking); break;
         case CMD_TEKST: result = tekst(cmd.x, cmd.y, cmd.kleur, cmd.tekst, cmd.fontnaam, cmd.fontgrootte, cmd.fontstijl); break;
-        case CMD_CIRKEL: result = cirkel(cmd.x, cmd.y, cmd.radius, cmd.kleur); break;
-        case CMD_FIGUUR: result = figuur(cmd.x, cmd.y, cmd.x2, cmd.y2, cmd.x3, cmd.y3, cmd.x4, cmd.y4, cmd.x5, cmd.y5, cmd.kleur); break;
+        case CMD_CIRKEL: result = cirkel(cmd.x, cmd.y, cmd.radius, cmd.kleur, cmd.dikte, cmd.gevuld); break;
+        case CMD_FIGUUR: result = figuur(cmd.x, cmd.y, cmd.x2, cmd.y2, cmd.x3, cmd.y3, cmd.x4, cmd.y4, cmd.x5, cmd.y5, cmd.kleur, cmd.lijnstijl); break;
+        case CMD_POLYGOON: result = polygoon(cmd.punten, cmd.aantal_punten, cmd.kleur, cmd.dikte, cmd.vulling); break;
+        case CMD_DRIEHOEK: result = driehoek(cmd.x, cmd.y, cmd.x2, cmd.y2, cmd.x3, cmd.y3, cmd.kleur, cmd.kleur2, cmd.kleur3); break;
+        case CMD_DRIEHOEKSTRIP: result = driehoekstrip(cmd.punten, cmd.aantal_punten, cmd.kleur); break;
+        case CMD_VERLOOP: result = verloop(cmd.x, cmd.y, cmd.breedte, cmd.hoogte, cmd.kleur, cmd.kleur2, cmd.soort); break;
+        case CMD_PLOT: result = plot(cmd.x, cmd.stap, cmd.reeks, cmd.aantal_punten, cmd.kleur, cmd.dikte); break;
+        case CMD_POLYLIJN: result = polylijn(cmd.reeks, cmd.aantal_punten, cmd.kleur, cmd.dikte); break;
+        case CMD_PUNTENWOLK: result = puntenwolk(cmd.reeks, cmd.aantal_punten, cmd.kleur); break;
+        case CMD_GRAFIEK: result = grafiek(cmd.grafiek_nr, cmd.x, cmd.y, cmd.breedte, cmd.hoogte, cmd.ondergrens, cmd.bovengrens,
+                                           cmd.kleur, cmd.kanaalkleuren, cmd.kanalen); break;
+        case CMD_GRAFIEKRASTER: result = grafiekraster(cmd.grafiek_nr, cmd.stap, cmd.kleur); break;
+        case CMD_METING: result = meting(cmd.grafiek_nr, cmd.reeks, cmd.aantal_punten); break;
+        case CMD_BEZIER: result = bezier(cmd.punten, cmd.aantal_punten, cmd.kleur, cmd.dikte, cmd.vlakheid); break;
+        case CMD_PATROON: result = patroon(cmd.patroon_nr, cmd.rijen); break;
+        case CMD_VULPATROON: result = vulpatroon(cmd.patroon_nr, cmd.kleur); break;
+        case CMD_VERSCHUIF: result = verschuif(cmd.x, cmd.y); break;
+        case CMD_DRAAI: result = draai(cmd.hoek, cmd.x, cmd.y); break;
+        case CMD_SCHAAL: result = schaal(cmd.schaal_x, cmd.schaal_y); break;
+        case CMD_TRANSFORMATIE: result = transformatie(cmd.actie); break;
+        case CMD_SPLITS: result = splits(cmd.boven, cmd.onder); break;
+        case CMD_ROL: result = rol(cmd.regels, cmd.kleur); break;
+        case CMD_MODUS: result = modus(cmd.modus); break;
+        case CMD_DUBBELBUFFER: result = dubbelbuffer(cmd.actie); break;
+        case CMD_TOON: result = toon(cmd.actie); break;
+        case CMD_FPS: result = fps_melden(); break;
+        case CMD_LIJST: result = lijst(cmd.actie); break;
+        case CMD_LIJSTINFO: result = lijstinfo_melden(); break;
+        case CMD_TEKSTVAK: result = tekstvak(cmd.y, cmd.aantal); break;
+        case CMD_SCHRIJF: result = schrijf(cmd.x, cmd.y, cmd.kleur, cmd.kleur2, cmd.tekst); break;
+        case CMD_TEKSTROL: result = tekstrol(cmd.regels, cmd.kleur); break;
+        case CMD_SPRITE: result = sprite(cmd.sprite_nr, cmd.bitmap_nr, cmd.x, cmd.y, cmd.laag); break;
+        case CMD_SPRITEMODUS: result = spritemodus(cmd.modus); break;
+        case CMD_SPRITEINFO: result = spriteinfo_melden(); break;
+        case CMD_EFFECT: result = effect(cmd.effect_nr, cmd.actie, cmd.y, cmd.hoogte, cmd.x, cmd.breedte, cmd.amplitude,
+                                         cmd.kleur, cmd.kleur2, cmd.kleur3); break;
+        case CMD_EFFECTFASE: result = effectfase(cmd.effect_nr, cmd.fase); break;
+        case CMD_EFFECTINFO: result = effectinfo_melden(); break;
+        case CMD_MENGINFO: result = menginfo_melden(); break;
+        case CMD_PLANNER: result = planner(cmd.modus); break;
+        case CMD_PLANNERINFO: result = plannerinfo_melden(); break;
+        case CMD_VUL: result = vul(cmd.x, cmd.y, cmd.kleur); break;
+        case CMD_ELLIPS: result = ellips(cmd.x, cmd.y, cmd.radius, cmd.radius_y, cmd.kleur, cmd.gevuld); break;
+        case CMD_BOOG: result = boog(cmd.x, cmd.y, cmd.radius, cmd.radius_y, cmd.starthoek, cmd.eindhoek, cmd.kleur); break;
+        case CMD_AFGERONDE_RECHTHOEK: result = afgeronde_rechthoek(cmd.x, cmd.y, cmd.breedte, cmd.hoogte, cmd.radius, cmd.kleur, cmd.gevuld); break;
         case CMD_CLEARSCHERM: result = clearscherm(cmd.kleur); break;
-        case CMD_BITMAP: result = bitmap(cmd.bitmap_nr, cmd.x, cmd.y); break;
+        case CMD_BITMAP: result = bitmap(cmd.bitmap_nr, cmd.x, cmd.y, cmd.dekking); break;
         case CMD_WACHT: result = wacht(cmd.aantal); break;
         case CMD_HERHAAL: result = herhaal(cmd.start, cmd.aantal); break;
         default: result = ERROR_INVALID_PARAM; break;
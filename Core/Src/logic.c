@@ -10,11 +10,16 @@
  */
 
 #include "logic.h"
+#include <stdlib.h>
 
 // Lijst van toegestane kleuren, lettertypes en stijlen voor validatie
 const char *kleuren[] = { "zwart", "blauw", "lichtblauw", "groen", "lichtgroen", "cyaan", "lichtcyaan", "rood", "lichtrood", "magenta", "lichtmagenta", "bruin", "geel", "grijs", "wit"};
 const char *fontnamen[] = {"arial", "consolas"};
 const char *stijlen[] = {"normaal", "vet", "cursief"};
+const char *lijnstijlen[] = {"vol", "gestreept", "gestippeld", "streepstip", "langgestreept"};
+// Namen van de videomodi, in de volgorde van VGA_ModeId
+static const char *modi[VGA_MODE_COUNT] = {"320x240", "320x480", "160x120", "400x300", "320x240_16", "320x480_16", "320x120"};
+static const uint32_t lijnstijl_maskers[] = {VGA_LINE_SOLID, VGA_LINE_DASHED, VGA_LINE_DOTTED, VGA_LINE_DASH_DOT, VGA_LINE_LONG_DASH};
 
 // Statische buffer om de laatste 20 commando's op te slaan voor de 'herhaal' functionaliteit
 static Commando geschiedenis[20];
@@ -24,6 +29,31 @@ static int totaal_opgeslagen = 0;
 static int aantal_kleur = sizeof(kleuren) / sizeof(kleuren[0]);
 static int aantal_fontnaam = sizeof(fontnamen) / sizeof(fontnamen[0]);
 static int aantal_stijl = sizeof(stijlen) / sizeof(stijlen[0]);
+static int aantal_lijnstijl = sizeof(lijnstijlen) / sizeof(lijnstijlen[0]);
+
+// Grafieken (strip-charts); een grafiek met breedte 0 is nog niet aangemaakt
+static VGA_Chart grafieken[GRAFIEK_AANTAL];
+
+// Actief vulpatroon voor gevulde rechthoeken, polygonen en cirkels (id -1 = effen kleur)
+static int patroon_id = -1;
+static uint8_t patroon_achtergrond = VGA_COL_BLACK;
+static int patroon_transparant = 0;
+
+// Actieve transformatie voor de hoekpunten van lijn, figuur, polygonen en 'herhaal', met een stapel voor push/pop
+static VGA_Transform transformatie_actief = {VGA_Q16_ONE, 0, 0, VGA_Q16_ONE, 0, 0};
+static VGA_Transform transformatie_stapel[TRANSFORMATIE_DIEPTE];
+static int transformatie_niveau = 0;
+
+// Vaste rijen boven en onder het rolgebied van 'splits', en de band van de driver die rolt
+static int splits_boven = 0;
+static int splits_onder = 0;
+static uint8_t rol_band = 0;
+
+// Tabellen van de raster-effecten: een golf of verloop per effect, en de kleurtabellen van 'invers' en 'donker'
+static int8_t effect_golven[VGA_RASTER_MAX_EFFECTS][EFFECT_STAPPEN];
+static uint8_t effect_verlopen[VGA_RASTER_MAX_EFFECTS][EFFECT_STAPPEN];
+static uint8_t effect_invers[256];
+static uint8_t effect_donker[256];
 
 /**
  * @brief Slaat een uitgevoerd commando op in het circulaire geheugen (geschiedenis).
@@ -39,6 +69,26 @@ static void log_commando(Commando c)
     if (totaal_opgeslagen < 20) totaal_opgeslagen++;
 }
 
+/**
+ * @brief Slaat een commando met een reeks waarden op (plot, polylijn, puntenwolk, meting).
+ * @param c: Het commando; p10 wordt het aantal bewaarde waarden.
+ * @param waarden: De reeks.
+ * @param aantal: Aantal waarden in de reeks.
+ * @note Een reeks langer dan HERHAAL_MAX_WAARDEN wordt niet bewaard (p10 = -1);
+ *       'herhaal' weigert dan de hele herhaling met ERROR_NOT_REPEATABLE.
+ */
+static void log_reeks(Commando *c, const int16_t *waarden, int aantal)
+{
+	if (aantal <= HERHAAL_MAX_WAARDEN)
+	{
+		memcpy(c->punten, waarden, aantal * sizeof(int16_t));
+		c->p10 = aantal;
+	}
+	else
+		c->p10 = -1;
+	log_commando(*c);
+}
+
 /**
  * @brief Controleert of een string aanwezig is in een lijst van toegestane strings.
  * @param items: Array van strings.
@@ -104,6 +154,334 @@ uint8_t kleurToCode(const char *kleur)
 	return code;
 }
 
+/**
+ * @brief Vertaalt een lijnstijl naar een 32-bits streepmasker.
+ * @param lijnstijl: Naam (bijv. "gestreept") of een eigen masker als getal (bijv. "0xF0F0F0F0").
+ * @param masker: Ontvangt het masker; bit 31 is de eerste pixel, een gezette bit wordt getekend.
+ * @return 1 indien geldig, 0 bij een onbekende naam of een masker zonder gezette bits.
+ */
+static int lijnstijlToMasker(const char *lijnstijl, uint32_t *masker)
+{
+	char *einde;
+
+	for (int i = 0; i < aantal_lijnstijl; i++)
+	{
+		if (strcmp(lijnstijl, lijnstijlen[i]) == 0)
+		{
+			*masker = lijnstijl_maskers[i];
+			return 1;
+		}
+	}
+	if (lijnstijl[0] < '0' || lijnstijl[0] > '9')
+		return 0;
+	*masker = strtoul(lijnstijl, &einde, 0);
+	return *einde == '\0' && *masker != 0;
+}
+
+/**
+ * @brief Controleert of een dekking (in procenten) ondersteund wordt.
+ * @param dekking: 25, 50, 75 of 100.
+ * @return 1 indien geldig, 0 indien niet.
+ */
+int validDekking(int dekking)
+{
+	return dekking == 25 || dekking == 50 || dekking == 75 || dekking == DEKKING_VOL;
+}
+
+/**
+ * @brief Vertaalt een (gevalideerde) dekking in procenten naar een VGA_Alpha niveau.
+ * @param dekking: 25, 50, 75 of 100.
+ * @return VGA_Alpha in kwarten (VGA_ALPHA_25 t/m VGA_ALPHA_100).
+ */
+static VGA_Alpha dekkingToAlpha(int dekking)
+{
+	return (VGA_Alpha)(dekking / 25);
+}
+
+/**
+ * @brief Vult een VGA_Pattern met het actieve vulpatroon.
+ * @param voorgrond: Kleurcode van de gezette bits (de kleur van het commando).
+ * @param p: Te vullen patroon.
+ * @return p, of NULL als er met een effen kleur gevuld wordt.
+ */
+static const VGA_Pattern *actief_patroon(uint8_t voorgrond, VGA_Pattern *p)
+{
+	if (patroon_id < 0)
+		return NULL;
+	p->id = patroon_id;
+	p->fg = voorgrond;
+	p->bg = patroon_achtergrond;
+	p->transparent = patroon_transparant;
+	return p;
+}
+
+/**
+ * @brief Slaat het actieve vulpatroon op in p8..p10 van een te loggen commando.
+ */
+static void log_patroon(Commando *c)
+{
+	c->p8 = patroon_id + 1;
+	c->p9 = patroon_achtergrond;
+	c->p10 = patroon_transparant;
+}
+
+/**
+ * @brief Haalt het vulpatroon uit een gelogd commando (zie log_patroon).
+ * @return p, of NULL als het commando met een effen kleur gevuld werd.
+ */
+static const VGA_Pattern *lees_patroon(const Commando *c, uint8_t voorgrond, VGA_Pattern *p)
+{
+	if (c->p8 == 0)
+		return NULL;
+	p->id = c->p8 - 1;
+	p->fg = voorgrond;
+	p->bg = c->p9;
+	p->transparent = c->p10;
+	return p;
+}
+
+/**
+ * @brief Past de actieve transformatie toe op één hoekpunt.
+ * @param x, y: Hoekpunt zoals in het commando opgegeven.
+ * @param uit: Krijgt het getransformeerde punt (x, y) op het scherm.
+ * @return 1 als het getransformeerde punt binnen het scherm valt, anders 0.
+ */
+static int transformeer_punt(int x, int y, int16_t *uit)
+{
+	if (x < INT16_MIN || x > INT16_MAX || y < INT16_MIN || y > INT16_MAX)
+		return 0;
+
+	VGA_Point p = {x, y};
+	UB_VGA_TransformPoints(&transformatie_actief, &p, 1);
+	if (p.x < 0 || p.x >= SCHERM_BREEDTE || p.y < 0 || p.y >= SCHERM_HOOGTE)
+		return 0;
+	uit[0] = p.x;
+	uit[1] = p.y;
+	return 1;
+}
+
+/**
+ * @brief Past de actieve transformatie toe op een lijst hoekpunten (x1, y1, x2, y2, ...).
+ * @return 1 als alle punten binnen het scherm vallen, anders 0.
+ */
+static int transformeer_punten(const int16_t *punten, int16_t *uit, int aantal)
+{
+	for (int i = 0; i < aantal; i++)
+	{
+		if (!transformeer_punt(punten[2 * i], punten[2 * i + 1], &uit[2 * i]))
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Tekenhulpen die zowel door de commando's als door 'herhaal' gebruikt worden.
+ * Bij volle dekking wordt de normale (ondoorzichtige) driverfunctie gebruikt.
+ * Na 'lijst,aan' komen lijnen, rechthoeken en cirkels in de displaylijst.
+ * Met een planner (zie 'planner') gaan effen vlakken, dunne lijnen en
+ * bitmaps via de wachtrij, in stukjes in de blanking-intervallen; de
+ * hoofdlus tekent de wachtrij leeg. Wat direct tekent, wacht eerst tot de
+ * wachtrij leeg is, zodat de volgorde klopt. Het hele scherm wissen blijft
+ * UB_VGA_FillScreen: die negeert de clip-rechthoek en houdt de randpixels
+ * zwart.
+ */
+
+static bool planner_aan(void)
+{
+	return UB_VGA_SchedGetMode() != VGA_SCHED_DIRECT;
+}
+
+// Maakt plaats in een volle wachtrij door de oudste bewerking af te tekenen
+static void planner_plaats(void)
+{
+	while (UB_VGA_SchedFull())
+		UB_VGA_SchedRun();
+}
+
+// Laat de displaylijst met het nieuwe item zien; de volgende lijst begint als kopie ervan
+static int lijst_tonen(int status)
+{
+	if (status != 0)
+		return status;
+	return UB_VGA_ListEnd(true);
+}
+
+static int teken_lijn(int x, int y, int x2, int y2, uint8_t code, int dikte, int dekking, uint32_t masker)
+{
+	// De displaylijst kent alleen dunne, volle en ondoorzichtige lijnen
+	if (UB_VGA_ListActive())
+	{
+		if (dikte != 1 || dekking != DEKKING_VOL || masker != VGA_LINE_SOLID)
+			return VGA_ERROR_INVALID_PARAMETER;
+		return lijst_tonen(UB_VGA_ListAddLine(x, y, x2, y2, code));
+	}
+
+	// Negatieve coördinaten tekent de driver als verre uint16-punten; die blijven direct
+	if (planner_aan() && dikte == 1 && dekking == DEKKING_VOL && masker == VGA_LINE_SOLID &&
+		x >= 0 && y >= 0 && x2 >= 0 && y2 >= 0)
+	{
+		planner_plaats();
+		return UB_VGA_SchedLine(x, y, x2, y2, code);
+	}
+	UB_VGA_SchedFlush();
+
+	// Een lijnstijl geldt alleen bij volle dekking; doorschijnend wordt doorgetrokken getekend
+	if (dekking == DEKKING_VOL && masker != VGA_LINE_SOLID)
+		return UB_VGA_DrawLineStyled(x, y, x2, y2, code, dikte, masker);
+	if (dekking == DEKKING_VOL)
+		return UB_VGA_DrawLine(x, y, x2, y2, code, dikte);
+	return UB_VGA_BlendLine(x, y, x2, y2, code, dikte, dekkingToAlpha(dekking));
+}
+
+static int teken_rechthoek(int x_lup, int y_lup, int breedte, int hoogte, uint8_t code, int gevuld, int dekking, const VGA_Pattern *patroon)
+{
+	if (UB_VGA_ListActive())
+	{
+		if (dekking != DEKKING_VOL || (gevuld && patroon != NULL))
+			return VGA_ERROR_INVALID_PARAMETER;
+		return lijst_tonen(UB_VGA_ListAddRectangle(x_lup, y_lup, breedte, hoogte, code, gevuld ? 0 : 1));
+	}
+
+	if (planner_aan() && gevuld && patroon == NULL && dekking == DEKKING_VOL)
+	{
+		planner_plaats();
+		return UB_VGA_SchedFillRect(x_lup, y_lup, breedte, hoogte, code);
+	}
+	UB_VGA_SchedFlush();
+
+	// Een vulpatroon is altijd ondoorzichtig; bij een lagere dekking wordt effen gevuld
+	if (gevuld && patroon != NULL && dekking == DEKKING_VOL)
+		return UB_VGA_PatternRectangle(x_lup, y_lup, breedte, hoogte, patroon);
+	if (dekking == DEKKING_VOL)
+		return UB_VGA_DrawRectangle(x_lup, y_lup, breedte, hoogte, code, gevuld);
+	return UB_VGA_BlendRectangle(x_lup, y_lup, breedte, hoogte, code, gevuld, dekkingToAlpha(dekking));
+}
+
+static int teken_scherm(uint8_t code)
+{
+	// Een lege displaylijst met de kleur als achtergrond
+	if (UB_VGA_ListActive())
+	{
+		UB_VGA_ListBegin(code);
+		return UB_VGA_ListEnd(true);
+	}
+	// De sprites komen daarna weer over de nieuwe achtergrond; met twee
+	// pagina's staan ze niet in het framebuffer
+	UB_VGA_SchedFlush();
+	UB_VGA_SpriteErase();
+	int status = UB_VGA_FillScreen(code);
+	if (status == 0 && UB_VGA_GetPages() == 1)
+		status = UB_VGA_SpriteUpdate();
+	return status;
+}
+
+static int teken_bitmap(int nr, int x_lup, int y_lup, int dekking)
+{
+	if (planner_aan() && dekking == DEKKING_VOL)
+	{
+		planner_plaats();
+		return UB_VGA_SchedBitmap(nr, x_lup, y_lup);
+	}
+	UB_VGA_SchedFlush();
+	if (dekking == DEKKING_VOL)
+		return UB_VGA_DrawBitmap(nr, x_lup, y_lup);
+	return UB_VGA_BlendBitmap(nr, x_lup, y_lup, dekkingToAlpha(dekking));
+}
+
+static int teken_cirkel(int x, int y, int radius, uint8_t code, int dikte, int gevuld, const VGA_Pattern *patroon)
+{
+	if (UB_VGA_ListActive())
+	{
+		if (gevuld && patroon != NULL)
+			return VGA_ERROR_INVALID_PARAMETER;
+		return lijst_tonen(UB_VGA_ListAddCircle(x, y, radius, code, gevuld ? 0 : dikte));
+	}
+
+	if (gevuld && patroon != NULL)
+		return UB_VGA_PatternEllipse(x, y, radius, radius, patroon);
+	if (gevuld)
+		return UB_VGA_FillCircle(x, y, radius, code);
+	// Een dikke rand wordt als ring (twee spans per regel) getekend
+	if (dikte > 1)
+		return UB_VGA_DrawRing(x, y, radius, dikte, code);
+	return UB_VGA_DrawCircle(x, y, radius, code);
+}
+
+static int teken_polygoon(const int16_t *punten, int aantal, uint8_t code, int dikte, int vulling, const VGA_Pattern *patroon, uint32_t masker)
+{
+	VGA_Point pts[POLYGOON_MAX_PUNTEN];
+	int status = 0;
+
+	for (int i = 0; i < aantal; i++)
+	{
+		pts[i].x = punten[2 * i];
+		pts[i].y = punten[2 * i + 1];
+	}
+
+	// Eerst vullen, daarna de rand eroverheen
+	VGA_FillRule regel = (vulling == 1) ? VGA_FILL_EVENODD : VGA_FILL_NONZERO;
+	if (vulling != 0 && patroon != NULL)
+		status = UB_VGA_PatternPolygon(pts, aantal, patroon, regel);
+	else if (vulling != 0)
+		status = UB_VGA_FillPolygon(pts, aantal, code, regel);
+	if (status == 0 && dikte > 0)
+		status = UB_VGA_DrawPolygonStyled(pts, aantal, code, dikte, masker);
+	return status;
+}
+
+static int teken_driehoek(const int16_t *punten, int aantal, const uint8_t *codes)
+{
+	VGA_Point pts[POLYGOON_MAX_PUNTEN];
+
+	for (int i = 0; i < aantal; i++)
+	{
+		pts[i].x = punten[2 * i];
+		pts[i].y = punten[2 * i + 1];
+	}
+
+	// Eén kleurcode voor de hele strip, of een kleurcode per hoekpunt
+	if (codes[0] == codes[1] && codes[0] == codes[2])
+		return UB_VGA_FillTriangleStrip(pts, aantal, codes[0], NULL);
+	return UB_VGA_FillTriangleStrip(pts, aantal, 0, codes);
+}
+
+static int teken_bezier(const int16_t *punten, int aantal, uint8_t code, int dikte, int vlakheid)
+{
+	VGA_Point pts[4];
+
+	for (int i = 0; i < aantal; i++)
+	{
+		pts[i].x = punten[2 * i];
+		pts[i].y = punten[2 * i + 1];
+	}
+	if (aantal == 3)
+		return UB_VGA_DrawBezierQuad(pts, code, dikte, vlakheid);
+	return UB_VGA_DrawBezierCubic(pts, code, dikte, vlakheid);
+}
+
+static int teken_puntenreeks(const int16_t *punten, int aantal, uint8_t code, int dikte)
+{
+	VGA_Point pts[POLYGOON_MAX_PUNTEN];
+	int start = 0;
+
+	// In blokken; bij een polylijn begint elk blok op het laatste punt van het vorige
+	for (;;)
+	{
+		int n = aantal - start;
+		if (n > POLYGOON_MAX_PUNTEN)
+			n = POLYGOON_MAX_PUNTEN;
+		for (int i = 0; i < n; i++)
+		{
+			pts[i].x = punten[2 * (start + i)];
+			pts[i].y = punten[2 * (start + i) + 1];
+		}
+		int status = (dikte > 0) ? UB_VGA_DrawPolyline(pts, n, code, dikte) : UB_VGA_DrawPoints(pts, n, code);
+		if (status != 0 || start + n >= aantal)
+			return status;
+		start += (dikte > 0) ? n - 1 : n;
+	}
+}
+
 /* ===================== COMMANDO’S ===================== */
 
 /**
@@ -112,12 +490,16 @@ uint8_t kleurToCode(const char *kleur)
  * @param x2, y2: Eindpunt.
  * @param kleur: Kleurnaam als string.
  * @param dikte: Lijndikte in pixels.
+ * @param dekking: Dekking in procenten (25, 50, 75 of 100).
+ * @param lijnstijl: "vol", "gestreept", "gestippeld", "streepstip", "langgestreept" of een
+ *                   32-bits masker; alleen bij volle dekking.
  * @return Resultaat: OK, ERROR_OUT_OF_BOUNDS, ERROR_INVALID_COLOR, etc.
  */
-Resultaat lijn(int x, int y, int x2, int y2, const char *kleur, int dikte)
+Resultaat lijn(int x, int y, int x2, int y2, const char *kleur, int dikte, int dekking, const char *lijnstijl)
 {
-	// Validatie: vallen de punten binnen het bereik?
-    if (x < 0 || x >= SCHERM_BREEDTE || y < 0 || y >= SCHERM_HOOGTE || x2 < 0 || x2 >= SCHERM_BREEDTE ||y2 < 0 || y2 >= SCHERM_HOOGTE)
+	// Validatie: vallen de (getransformeerde) punten binnen het bereik?
+    int16_t scherm[4];
+    if (!transformeer_punt(x, y, &scherm[0]) || !transformeer_punt(x2, y2, &scherm[2]))
     	return ERROR_OUT_OF_BOUNDS;
 
     if (dikte <= 0)
@@ -126,15 +508,22 @@ Resultaat lijn(int x, int y, int x2, int y2, const char *kleur, int dikte)
     if (!validColor(kleur))
         return ERROR_INVALID_COLOR;
 
+    if (!validDekking(dekking))
+        return ERROR_INVALID_PARAM_DEKKING;
+
+    uint32_t masker;
+    if (!lijnstijlToMasker(lijnstijl, &masker))
+        return ERROR_INVALID_PARAM;
+
     // Directe aanroep naar de hardware driver
-    int status = UB_VGA_DrawLine(x, y, x2, y2, kleurToCode(kleur), dikte);
+    int status = teken_lijn(scherm[0], scherm[1], scherm[2], scherm[3], kleurToCode(kleur), dikte, dekking, masker);
     if (status != 0)
     	return vgaStatusToResultaat(status);
 
     // Commando struct vullen en loggen voor de herhaal-functie
     Commando c;
     memset(&c, 0, sizeof(Commando));
-    c.type = CMD_LIJN; c.p1 = x; c.p2 = y; c.p3 = x2; c.p4 = y2; c.p5 = dikte;
+    c.type = CMD_LIJN; c.p1 = x; c.p2 = y; c.p3 = x2; c.p4 = y2; c.p5 = dikte; c.p6 = dekking; c.p7 = (int)masker;
     strncpy(c.kleur, kleur, 19);
     log_commando(c);
 
@@ -147,9 +536,10 @@ Resultaat lijn(int x, int y, int x2, int y2, const char *kleur, int dikte)
  * @param breedte, hoogte: Afmetingen.
  * @param kleur: Kleurnaam.
  * @param gevuld: 1 voor gevuld, 0 voor alleen rand.
+ * @param dekking: Dekking in procenten (25, 50, 75 of 100).
  * @return Resultaat statuscode.
  */
-Resultaat rechthoek(int x_lup, int y_lup, int breedte, int hoogte, const char *kleur, int gevuld)
+Resultaat rechthoek(int x_lup, int y_lup, int breedte, int hoogte, const char *kleur, int gevuld, int dekking)
 {
 	// Check of de volledige rechthoek binnen het scherm past
     if (x_lup < 0 || x_lup >= SCHERM_BREEDTE || y_lup < 0 || y_lup >= SCHERM_HOOGTE || x_lup + breedte > SCHERM_BREEDTE || y_lup + hoogte > SCHERM_HOOGTE)
@@ -160,14 +550,18 @@ Resultaat rechthoek(int x_lup, int y_lup, int breedte, int hoogte, const char *k
         return ERROR_INVALID_PARAM_FILLED;
     if (!validColor(kleur))
         return ERROR_INVALID_COLOR;
+    if (!validDekking(dekking))
+        return ERROR_INVALID_PARAM_DEKKING;
 
-    int status = UB_VGA_DrawRectangle(x_lup, y_lup, breedte, hoogte, kleurToCode(kleur), gevuld);
+    VGA_Pattern p;
+    int status = teken_rechthoek(x_lup, y_lup, breedte, hoogte, kleurToCode(kleur), gevuld, dekking, actief_patroon(kleurToCode(kleur), &p));
     if (status != 0)
         return vgaStatusToResultaat(status);
 
     Commando c;
     memset(&c, 0, sizeof(Commando));
-    c.type = CMD_RECHTHOEK; c.p1 = x_lup; c.p2 = y_lup; c.p3 = breedte; c.p4 = hoogte; c.p5 = gevuld;
+    c.type = CMD_RECHTHOEK; c.p1 = x_lup; c.p2 = y_lup; c.p3 = breedte; c.p4 = hoogte; c.p5 = gevuld; c.p6 = dekking;
+    log_patroon(&c);
     strncpy(c.kleur, kleur, 19);
     log_commando(c);
 
@@ -219,9 +613,10 @@ Resultaat tekst(int x, int y, const char *kleur, const char tekst[100], const ch
  * @brief Tekent een voorgedefinieerde bitmap (pijlen of smileys).
  * @param nr: Index van de bitmap (0-5), 0–3 = pijlen, 4–5 = smileys.
  * @param x_lup, y_lup: Positie op het scherm.
+ * @param dekking: Dekking in procenten (25, 50, 75 of 100).
  * @return Resultaat statuscode.
  */
-Resultaat bitmap(int nr, int x_lup, int y_lup)
+Resultaat bitmap(int nr, int x_lup, int y_lup, int dekking)
 {
     if (x_lup < 0 || x_lup >= SCHERM_BREEDTE || y_lup < 0 || y_lup >= SCHERM_HOOGTE)
         return ERROR_OUT_OF_BOUNDS;
@@ -229,13 +624,16 @@ Resultaat bitmap(int nr, int x_lup, int y_lup)
     if (nr < 0 || nr > 5)
         return ERROR_INVALID_PARAM;
 
-    int status = UB_VGA_DrawBitmap(nr, x_lup, y_lup);
+    if (!validDekking(dekking))
+        return ERROR_INVALID_PARAM_DEKKING;
+
+    int status = teken_bitmap(nr, x_lup, y_lup, dekking);
     if (status != 0)
         return vgaStatusToResultaat(status);
 
     Commando c;
     memset(&c, 0, sizeof(Commando));
-    c.type = CMD_BITMAP; c.p1 = nr; c.p2 = x_lup; c.p3 = y_lup;
+    c.type = CMD_BITMAP; c.p1 = nr; c.p2 = x_lup; c.p3 = y_lup; c.p4 = dekking;
     log_commando(c);
 
     return OK;
@@ -251,7 +649,7 @@ Resultaat clearscherm(const char *kleur)
     if (!validColor(kleur))
         return ERROR_INVALID_COLOR;
 
-    int status = UB_VGA_FillScreen(kleurToCode(kleur));
+    int status = teken_scherm(kleurToCode(kleur));
     if (status != 0)
         return vgaStatusToResultaat(status);
 
@@ -301,25 +699,33 @@ Resultaat wacht(int msecs)
  * @param x, y: Middelpunt.
  * @param radius: Straal in pixels.
  * @param kleur: Kleurnaam.
+ * @param dikte: Randdikte in pixels; de rand groeit vanaf de straal naar binnen.
+ * @param gevuld: 1 voor een gevulde cirkel, 0 voor alleen de rand.
  * @return Resultaat statuscode.
  */
-Resultaat cirkel(int x, int y, int radius, const char *kleur)
+Resultaat cirkel(int x, int y, int radius, const char *kleur, int dikte, int gevuld)
 {
     if (radius <= 0)
         return ERROR_INVALID_PARAM;
-    // Bounds check: past de cirkel binnen de randen van 320x240?
+    // Bounds check: past de cirkel binnen de randen van het scherm?
     if (x - radius < 0 || x + radius >= SCHERM_BREEDTE || y - radius < 0 || y + radius >= SCHERM_HOOGTE)
         return ERROR_OUT_OF_BOUNDS;
+    if (dikte <= 0)
+        return ERROR_INVALID_PARAM_THICKNESS;
+    if (gevuld < 0 || gevuld > 1)
+        return ERROR_INVALID_PARAM_FILLED;
     if (!validColor(kleur))
         return ERROR_INVALID_COLOR;
 
-    int status = UB_VGA_DrawCircle(x, y, radius, kleurToCode(kleur));
+    VGA_Pattern p;
+    int status = teken_cirkel(x, y, radius, kleurToCode(kleur), dikte, gevuld, actief_patroon(kleurToCode(kleur), &p));
     if (status != 0)
         return vgaStatusToResultaat(status);
 
     Commando c;
     memset(&c, 0, sizeof(Commando));
-    c.type = CMD_CIRKEL; c.p1 = x; c.p2 = y; c.p3 = radius;
+    c.type = CMD_CIRKEL; c.p1 = x; c.p2 = y; c.p3 = radius; c.p4 = dikte; c.p5 = gevuld;
+    log_patroon(&c);
     strncpy(c.kleur, kleur, 19);
     log_commando(c);
 
@@ -330,9 +736,10 @@ Resultaat cirkel(int x, int y, int radius, const char *kleur)
  * @brief Tekent een gesloten figuur (5-hoek) door 5 punten te verbinden.
  * @param x1..y5: Coördinaten van de 5 hoekpunten.
  * @param kleur: Kleurnaam.
+ * @param lijnstijl: Lijnstijl van de rand, zie lijn().
  * @return Resultaat statuscode.
  */
-Resultaat figuur(int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4, int x5, int y5, const char *kleur)
+Resultaat figuur(int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4, int x5, int y5, const char *kleur, const char *lijnstijl)
 {
     int x[] = {x1, x2, x3, x4, x5};
     int y[] = {y1, y2, y3, y4, y5};
@@ -341,26 +748,30 @@ Resultaat figuur(int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4,
     if (!validColor(kleur))
         return ERROR_INVALID_COLOR;
 
-    // Controleer of alle 5 punten binnen het scherm vallen
+    uint32_t masker;
+    if (!lijnstijlToMasker(lijnstijl, &masker))
+        return ERROR_INVALID_PARAM;
+
+    // Controleer of alle 5 (getransformeerde) punten binnen het scherm vallen
+    int16_t scherm[10];
     for (int i = 0; i < aantal_punten; i++)
     {
-        if (x[i] < 0 || x[i] >= SCHERM_BREEDTE || y[i] < 0 || y[i] >= SCHERM_HOOGTE)
+        if (!transformeer_punt(x[i], y[i], &scherm[2 * i]))
             return ERROR_OUT_OF_BOUNDS;
     }
 
-    uint8_t c_code = kleurToCode(kleur);
-    // Teken opeenvolgende lijnen tussen de punten
-    UB_VGA_DrawLine(x1, y1, x2, y2, c_code, 1);
-    UB_VGA_DrawLine(x2, y2, x3, y3, c_code, 1);
-    UB_VGA_DrawLine(x3, y3, x4, y4, c_code, 1);
-    UB_VGA_DrawLine(x4, y4, x5, y5, c_code, 1);
-    UB_VGA_DrawLine(x5, y5, x1, y1, c_code, 1); // Sluit de figuur terug naar punt 1
+    // Een figuur is een gesloten polygoon van 5 punten zonder vulling
+    int16_t punten[] = {x1, y1, x2, y2, x3, y3, x4, y4, x5, y5};
+    int status = teken_polygoon(scherm, aantal_punten, kleurToCode(kleur), 1, 0, NULL, masker);
+    if (status != 0)
+        return vgaStatusToResultaat(status);
 
+    // De hoekpunten gaan in punten[], zodat p1 vrij is voor de lijnstijl
     Commando c;
     memset(&c, 0, sizeof(Commando));
     c.type = CMD_FIGUUR;
-    c.p1 = x1; c.p2 = y1; c.p3 = x2; c.p4 = y2; c.p5 = x3;
-    c.p6 = y3; c.p7 = x4; c.p8 = y4; c.p9 = x5; c.p10 = y5;
+    c.p1 = (int)masker;
+    memcpy(c.punten, punten, sizeof(punten));
     strncpy(c.kleur, kleur, 19);
     log_commando(c);
 
@@ -368,55 +779,1550 @@ Resultaat figuur(int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4,
 }
 
 /**
- * @brief Herhaalt een specifiek aantal van de laatst uitgevoerde commando's.
- * @param aantal: Hoeveel voorgaande commando's herhaald moeten worden (max 20).
- * @param hoevaak: Hoe vaak deze reeks herhaald moet worden.
+ * @brief Tekent een polygoon met een willekeurig aantal hoekpunten.
+ * @param punten: Coördinaten als x1, y1, x2, y2, ... (2 * aantal waarden).
+ * @param aantal: Aantal hoekpunten (3 t/m POLYGOON_MAX_PUNTEN).
+ * @param kleur: Kleurnaam.
+ * @param dikte: Randdikte in pixels, 0 voor geen rand (alleen bij vulling).
+ * @param vulling: 0 = geen vulling, 1 = even-oneven regel, 2 = non-zero regel.
  * @return Resultaat statuscode.
+ * @note Concave en zichzelf snijdende polygonen worden ondersteund; de vulling
+ *       kost één span per scanlijn per binnen-interval.
  */
-Resultaat herhaal(int aantal, int hoevaak)
+Resultaat polygoon(const int *punten, int aantal, const char *kleur, int dikte, int vulling)
 {
-	// Validatie: kunnen we wel zoveel commando's teruggaan in het geheugen?
-	if (aantal <= 0 || aantal > totaal_opgeslagen || hoevaak <= 0)
-	        return ERROR_INVALID_PARAM; //
+    if (punten == NULL || aantal < 3 || aantal > POLYGOON_MAX_PUNTEN)
+        return ERROR_INVALID_PARAM_SIZE;
+    if (vulling < 0 || vulling > 2)
+        return ERROR_INVALID_PARAM_FILLED;
+    if (dikte < 0 || (dikte == 0 && vulling == 0))
+        return ERROR_INVALID_PARAM_THICKNESS;
+    if (!validColor(kleur))
+        return ERROR_INVALID_COLOR;
 
-    for (int h = 0; h < hoevaak; h++)
+    Commando c;
+    memset(&c, 0, sizeof(Commando));
+
+    int16_t scherm[POLYGOON_MAX_PUNTEN * 2];
+    for (int i = 0; i < aantal; i++)
     {
-    	// Bereken de startindex in de circulaire buffer
-        int idx = (geschiedenis_index - aantal + 20) % 20;
-        for (int i = 0; i < aantal; i++)
-        {
-            Commando *c = &geschiedenis[idx];
-            // Her-uitvoeren van commando's op basis van hun type
-            switch (c->type)
-            {
-                case CMD_LIJN:
-                	UB_VGA_DrawLine(c->p1, c->p2, c->p3, c->p4, kleurToCode(c->kleur), c->p5);
-                	break;
-                case CMD_RECHTHOEK:
-                	UB_VGA_DrawRectangle(c->p1, c->p2, c->p3, c->p4, kleurToCode(c->kleur), c->p5);
-                	break;
-                case CMD_CIRKEL:
-                	UB_VGA_DrawCircle(c->p1, c->p2, c->p3, kleurToCode(c->kleur));
-                	break;
-                case CMD_TEKST:
-                	UB_VGA_DrawText(c->p1, c->p2, kleurToCode(c->kleur), c->tekst_inhoud, c->fontnaam, c->p3, c->fontstijl);
-                	break;
-                case CMD_BITMAP:
-                	UB_VGA_DrawBitmap(c->p1, c->p2, c->p3);
-                	break;
-                case CMD_CLEAR:
-                	UB_VGA_FillScreen(kleurToCode(c->kleur));
-                	break;
-                case CMD_WAIT:
-                	wachten(c->p1);
-                	break;
-                case CMD_FIGUUR:
-                    UB_VGA_DrawLine(c->p1, c->p2, c->p3, c->p4, kleurToCode(c->kleur), 1);
-                    UB_VGA_DrawLine(c->p3, c->p4, c->p5, c->p6, kleurToCode(c->kleur), 1);
-                    UB_VGA_DrawLine(c->p5, c->p6, c->p7, c->p8, kleurToCode(c->kleur), 1);
-                    UB_VGA_DrawLine(c->p7, c->p8, c->p9, c->p10, kleurToCode(c->kleur), 1);
-                    UB_VGA_DrawLine(c->p9, c->p10, c->p1, c->p2, kleurToCode(c->kleur), 1);
+        int x = punten[2 * i];
+        int y = punten[2 * i + 1];
+        if (!transformeer_punt(x, y, &scherm[2 * i]))
+            return ERROR_OUT_OF_BOUNDS;
+        c.punten[2 * i] = x;
+        c.punten[2 * i + 1] = y;
+    }
+
+    VGA_Pattern p;
+    int status = teken_polygoon(scherm, aantal, kleurToCode(kleur), dikte, vulling, actief_patroon(kleurToCode(kleur), &p), VGA_LINE_SOLID);
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+
+    c.type = CMD_POLYGOON; c.p1 = aantal; c.p2 = dikte; c.p3 = vulling;
+    log_patroon(&c);
+    strncpy(c.kleur, kleur, 19);
+    log_commando(c);
+
+    return OK;
+}
+
+/**
+ * @brief Tekent een gevulde driehoek.
+ * @param x1, y1, x2, y2, x3, y3: Hoekpunten.
+ * @param kleur1, kleur2, kleur3: Kleur per hoekpunt. Bij verschillende kleuren
+ *        loopt de kleur geleidelijk over (met dithering).
+ * @return Resultaat statuscode.
+ */
+Resultaat driehoek(int x1, int y1, int x2, int y2, int x3, int y3, const char *kleur1, const char *kleur2, const char *kleur3)
+{
+    int x[] = {x1, x2, x3};
+    int y[] = {y1, y2, y3};
+
+    if (!validColor(kleur1) || !validColor(kleur2) || !validColor(kleur3))
+        return ERROR_INVALID_COLOR;
+
+    int16_t scherm[6];
+    for (int i = 0; i < 3; i++)
+    {
+        if (!transformeer_punt(x[i], y[i], &scherm[2 * i]))
+            return ERROR_OUT_OF_BOUNDS;
+    }
+
+    Commando c;
+    memset(&c, 0, sizeof(Commando));
+    c.type = CMD_DRIEHOEK;
+    c.p1 = x1; c.p2 = y1; c.p3 = x2; c.p4 = y2; c.p5 = x3; c.p6 = y3;
+    c.p7 = kleurToCode(kleur1); c.p8 = kleurToCode(kleur2); c.p9 = kleurToCode(kleur3);
+
+    uint8_t codes[] = {c.p7, c.p8, c.p9};
+    int status = teken_driehoek(scherm, 3, codes);
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+
+    strncpy(c.kleur, kleur1, 19);
+    log_commando(c);
+
+    return OK;
+}
+
+/**
+ * @brief Tekent een strip van gevulde driehoeken.
+ * @details Driehoek i bestaat uit de hoekpunten i, i+1 en i+2; elk nieuw
+ *          punt voegt dus één driehoek toe.
+ * @param punten: Coördinaten als x1, y1, x2, y2, ... (2 * aantal waarden).
+ * @param aantal: Aantal hoekpunten (3 t/m POLYGOON_MAX_PUNTEN).
+ * @param kleur: Kleurnaam.
+ * @return Resultaat statuscode.
+ */
+Resultaat driehoekstrip(const int *punten, int aantal, const char *kleur)
+{
+    if (punten == NULL || aantal < 3 || aantal > POLYGOON_MAX_PUNTEN)
+        return ERROR_INVALID_PARAM_SIZE;
+    if (!validColor(kleur))
+        return ERROR_INVALID_COLOR;
+
+    Commando c;
+    memset(&c, 0, sizeof(Commando));
+
+    int16_t scherm[POLYGOON_MAX_PUNTEN * 2];
+    for (int i = 0; i < aantal; i++)
+    {
+        int x = punten[2 * i];
+        int y = punten[2 * i + 1];
+        if (!transformeer_punt(x, y, &scherm[2 * i]))
+            return ERROR_OUT_OF_BOUNDS;
+        c.punten[2 * i] = x;
+        c.punten[2 * i + 1] = y;
+    }
+
+    c.type = CMD_DRIEHOEKSTRIP; c.p1 = aantal;
+    c.p7 = c.p8 = c.p9 = kleurToCode(kleur);
+
+    uint8_t codes[] = {c.p7, c.p8, c.p9};
+    int status = teken_driehoek(scherm, aantal, codes);
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+
+    strncpy(c.kleur, kleur, 19);
+    log_commando(c);
+
+    return OK;
+}
+
+/**
+ * @brief Tekent een Bézier-kromme.
+ * @details De kromme wordt op het scherm in rechte stukjes verdeeld: korte
+ *          stukjes waar hij sterk buigt, lange waar hij bijna recht is.
+ * @param punten: Coördinaten als x1, y1, x2, y2, ... (2 * aantal waarden):
+ *        beginpunt, één of twee controlepunten en eindpunt.
+ * @param aantal: 3 voor een kwadratische, 4 voor een kubische kromme.
+ * @param kleur: Kleurnaam.
+ * @param dikte: Lijndikte in pixels.
+ * @param vlakheid: Maximale afwijking van de kromme in 1/16 pixel (standaard 8).
+ * @return Resultaat statuscode.
+ */
+Resultaat bezier(const int *punten, int aantal, const char *kleur, int dikte, int vlakheid)
+{
+    if (punten == NULL || aantal < 3 || aantal > 4)
+        return ERROR_INVALID_PARAM_SIZE;
+    if (dikte <= 0 || dikte > 255)
+        return ERROR_INVALID_PARAM_THICKNESS;
+    if (vlakheid <= 0 || vlakheid > 1023)
+        return ERROR_INVALID_PARAM;
+    if (!validColor(kleur))
+        return ERROR_INVALID_COLOR;
+
+    Commando c;
+    memset(&c, 0, sizeof(Commando));
+
+    int16_t scherm[POLYGOON_MAX_PUNTEN * 2];
+    for (int i = 0; i < aantal; i++)
+    {
+        int x = punten[2 * i];
+        int y = punten[2 * i + 1];
+        if (!transformeer_punt(x, y, &scherm[2 * i]))
+            return ERROR_OUT_OF_BOUNDS;
+        c.punten[2 * i] = x;
+        c.punten[2 * i + 1] = y;
+    }
+
+    int status = teken_bezier(scherm, aantal, kleurToCode(kleur), dikte, vlakheid);
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+
+    c.type = CMD_BEZIER; c.p1 = aantal; c.p2 = dikte; c.p3 = vlakheid;
+    strncpy(c.kleur, kleur, 19);
+    log_commando(c);
+
+    return OK;
+}
+
+/**
+ * @brief Tekent een ellips.
+ * @param x, y: Middelpunt.
+ * @param radius_x, radius_y: Horizontale en verticale straal.
+ * @param kleur: Kleurnaam.
+ * @param gevuld: 1 voor gevuld, 0 voor alleen de rand.
+ * @return Resultaat statuscode.
+ */
+Resultaat ellips(int x, int y, int radius_x, int radius_y, const char *kleur, int gevuld)
+{
+    if (radius_x <= 0 || radius_y <= 0)
+        return ERROR_INVALID_PARAM;
+    if (x - radius_x < 0 || x + radius_x >= SCHERM_BREEDTE || y - radius_y < 0 || y + radius_y >= SCHERM_HOOGTE)
+        return ERROR_OUT_OF_BOUNDS;
+    if (gevuld < 0 || gevuld > 1)
+        return ERROR_INVALID_PARAM_FILLED;
+    if (!validColor(kleur))
+        return ERROR_INVALID_COLOR;
+
+    int status = gevuld ? UB_VGA_FillEllipse(x, y, radius_x, radius_y, kleurToCode(kleur))
+                        : UB_VGA_DrawEllipse(x, y, radius_x, radius_y, kleurToCode(kleur));
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+
+    Commando c;
+    memset(&c, 0, sizeof(Commando));
+    c.type = CMD_ELLIPS; c.p1 = x; c.p2 = y; c.p3 = radius_x; c.p4 = radius_y; c.p5 = gevuld;
+    strncpy(c.kleur, kleur, 19);
+    log_commando(c);
+
+    return OK;
+}
+
+/**
+ * @brief Tekent een boog: een deel van de rand van een ellips.
+ * @param x, y: Middelpunt.
+ * @param radius_x, radius_y: Horizontale en verticale straal (gelijk voor een cirkelboog).
+ * @param starthoek, eindhoek: Hoeken in graden (0 t/m 360), 0 = rechts, tegen de klok in.
+ * @param kleur: Kleurnaam.
+ * @return Resultaat statuscode.
+ */
+Resultaat boog(int x, int y, int radius_x, int radius_y, int starthoek, int eindhoek, const char *kleur)
+{
+    if (radius_x <= 0 || radius_y <= 0)
+        return ERROR_INVALID_PARAM;
+    if (starthoek < 0 || starthoek > 360 || eindhoek < 0 || eindhoek > 360)
+        return ERROR_INVALID_PARAM;
+    if (x - radius_x < 0 || x + radius_x >= SCHERM_BREEDTE || y - radius_y < 0 || y + radius_y >= SCHERM_HOOGTE)
+        return ERROR_OUT_OF_BOUNDS;
+    if (!validColor(kleur))
+        return ERROR_INVALID_COLOR;
+
+    int status = UB_VGA_DrawArc(x, y, radius_x, radius_y, starthoek, eindhoek, kleurToCode(kleur));
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+
+    Commando c;
+    memset(&c, 0, sizeof(Commando));
+    c.type = CMD_BOOG; c.p1 = x; c.p2 = y; c.p3 = radius_x; c.p4 = radius_y; c.p5 = starthoek; c.p6 = eindhoek;
+    strncpy(c.kleur, kleur, 19);
+    log_commando(c);
+
+    return OK;
+}
+
+/**
+ * @brief Tekent een rechthoek met afgeronde hoeken.
+ * @param x_lup, y_lup: Linkerbovenhoek.
+ * @param breedte, hoogte: Afmetingen.
+ * @param radius: Straal van de hoeken; wordt begrensd op de helft van de kortste zijde.
+ * @param kleur: Kleurnaam.
+ * @param gevuld: 1 voor gevuld, 0 voor alleen de rand.
+ * @return Resultaat statuscode.
+ */
+Resultaat afgeronde_rechthoek(int x_lup, int y_lup, int breedte, int hoogte, int radius, const char *kleur, int gevuld)
+{
+    if (x_lup < 0 || x_lup >= SCHERM_BREEDTE || y_lup < 0 || y_lup >= SCHERM_HOOGTE || x_lup + breedte > SCHERM_BREEDTE || y_lup + hoogte > SCHERM_HOOGTE)
+        return ERROR_OUT_OF_BOUNDS;
+    if (breedte <= 0 || hoogte <= 0)
+        return ERROR_INVALID_PARAM_SIZE;
+    if (radius < 0)
+        return ERROR_INVALID_PARAM;
+    if (gevuld < 0 || gevuld > 1)
+        return ERROR_INVALID_PARAM_FILLED;
+    if (!validColor(kleur))
+        return ERROR_INVALID_COLOR;
+
+    // Grotere stralen hebben hetzelfde effect als de maximale straal
+    int max_radius = (breedte < hoogte ? breedte : hoogte) / 2;
+    if (radius > max_radius)
+        radius = max_radius;
+
+    int status = gevuld ? UB_VGA_FillRoundRect(x_lup, y_lup, breedte, hoogte, radius, kleurToCode(kleur))
+                        : UB_VGA_DrawRoundRect(x_lup, y_lup, breedte, hoogte, radius, kleurToCode(kleur));
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+
+    Commando c;
+    memset(&c, 0, sizeof(Commando));
+    c.type = CMD_AFGERONDE_RECHTHOEK; c.p1 = x_lup; c.p2 = y_lup; c.p3 = breedte; c.p4 = hoogte; c.p5 = radius; c.p6 = gevuld;
+    strncpy(c.kleur, kleur, 19);
+    log_commando(c);
+
+    return OK;
+}
+
+/**
+ * @brief Vult het gebied rond een punt (flood fill).
+ * @details Alle pixels die via boven/onder/links/rechts met het startpunt
+ *          verbonden zijn en dezelfde kleur hebben, krijgen de nieuwe kleur.
+ * @param x, y: Startpunt binnen het te vullen gebied.
+ * @param kleur: Kleurnaam.
+ * @return Resultaat statuscode.
+ */
+Resultaat vul(int x, int y, const char *kleur)
+{
+    if (x < 0 || x >= SCHERM_BREEDTE || y < 0 || y >= SCHERM_HOOGTE)
+        return ERROR_OUT_OF_BOUNDS;
+    if (!validColor(kleur))
+        return ERROR_INVALID_COLOR;
+
+    int status = UB_VGA_FloodFill(x, y, kleurToCode(kleur));
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+
+    Commando c;
+    memset(&c, 0, sizeof(Commando));
+    c.type = CMD_VUL; c.p1 = x; c.p2 = y;
+    strncpy(c.kleur, kleur, 19);
+    log_commando(c);
+
+    return OK;
+}
+
+/**
+ * @brief Vult een rechthoek met een kleurverloop tussen twee kleuren.
+ * @details Tussenliggende tinten worden met een vast 4x4 patroon (dithering)
+ *          benaderd.
+ * @param x_lup, y_lup: Linkerbovenhoek coördinaten.
+ * @param breedte, hoogte: Afmetingen.
+ * @param kleur1: Kleur links, boven of in het midden.
+ * @param kleur2: Kleur rechts, onder of in de hoeken.
+ * @param soort: 0 = horizontaal, 1 = verticaal, 2 = radiaal.
+ * @return Resultaat statuscode.
+ */
+Resultaat verloop(int x_lup, int y_lup, int breedte, int hoogte, const char *kleur1, const char *kleur2, int soort)
+{
+    if (x_lup < 0 || x_lup >= SCHERM_BREEDTE || y_lup < 0 || y_lup >= SCHERM_HOOGTE || x_lup + breedte > SCHERM_BREEDTE || y_lup + hoogte > SCHERM_HOOGTE)
+        return ERROR_OUT_OF_BOUNDS;
+    if (breedte <= 0 || hoogte <= 0)
+        return ERROR_INVALID_PARAM_SIZE;
+    if (soort < VGA_GRADIENT_HORIZONTAL || soort > VGA_GRADIENT_RADIAL)
+        return ERROR_INVALID_PARAM;
+    if (!validColor(kleur1) || !validColor(kleur2))
+        return ERROR_INVALID_COLOR;
+
+    int status = UB_VGA_FillGradient(x_lup, y_lup, breedte, hoogte, kleurToCode(kleur1), kleurToCode(kleur2), soort);
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+
+    Commando c;
+    memset(&c, 0, sizeof(Commando));
+    c.type = CMD_VERLOOP; c.p1 = x_lup; c.p2 = y_lup; c.p3 = breedte; c.p4 = hoogte;
+    c.p5 = soort; c.p6 = kleurToCode(kleur2);
+    strncpy(c.kleur, kleur1, 19);
+    log_commando(c);
+
+    return OK;
+}
+
+/**
+ * @brief Tekent een meetreeks als lijn door de punten (x + i * stap, y[i]).
+ * @param x: X-coördinaat van de eerste meetwaarde, binnen het scherm.
+ * @param stap: Horizontale afstand tussen meetwaarden (1 t/m SCHERM_BREEDTE - 1).
+ * @param y: De meetwaarden; waarden onder de onderrand worden afgekapt.
+ * @param aantal: Aantal meetwaarden (1 t/m PLOT_MAX_PUNTEN).
+ * @param kleur: Kleurnaam.
+ * @param dikte: Lijndikte (1 t/m 255).
+ * @return Resultaat statuscode.
+ * @note Wordt gelogd voor 'herhaal' tot HERHAAL_MAX_WAARDEN meetwaarden; een
+ *       langere reeks past niet in de geschiedenis en kan niet herhaald worden.
+ */
+Resultaat plot(int x, int stap, const int16_t *y, int aantal, const char *kleur, int dikte)
+{
+	if (aantal < 1 || aantal > PLOT_MAX_PUNTEN)
+		return ERROR_INVALID_PARAM_SIZE;
+	if (x < 0 || x >= SCHERM_BREEDTE)
+		return ERROR_OUT_OF_BOUNDS;
+	if (stap < 1 || stap >= SCHERM_BREEDTE)
+		return ERROR_INVALID_PARAM;
+	if (dikte < 1 || dikte > 255)
+		return ERROR_INVALID_PARAM_THICKNESS;
+	if (!validColor(kleur))
+		return ERROR_INVALID_COLOR;
+
+	int status = UB_VGA_PlotSeries(x, stap, y, aantal, kleurToCode(kleur), dikte);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_PLOT; c.p1 = x; c.p2 = stap; c.p3 = dikte;
+	strncpy(c.kleur, kleur, 19);
+	log_reeks(&c, y, aantal);
+	return OK;
+}
+
+/**
+ * @brief Controleert een lijst punten voor polylijn en puntenwolk.
+ * @return OK, ERROR_INVALID_PARAM_SIZE of ERROR_OUT_OF_BOUNDS.
+ */
+static Resultaat controleer_puntenreeks(const int16_t *punten, int aantal)
+{
+	if (aantal < 1 || aantal > PLOT_MAX_PUNTEN)
+		return ERROR_INVALID_PARAM_SIZE;
+	for (int i = 0; i < aantal; i++)
+	{
+		if (punten[2 * i] < 0 || punten[2 * i] >= SCHERM_BREEDTE || punten[2 * i + 1] < 0 || punten[2 * i + 1] >= SCHERM_HOOGTE)
+			return ERROR_OUT_OF_BOUNDS;
+	}
+	return OK;
+}
+
+/**
+ * @brief Tekent een open lijn door een lijst punten, in één doorgang.
+ * @param punten: Coördinaten als x1, y1, x2, y2, ... (2 * aantal waarden), binnen het scherm.
+ * @param aantal: Aantal punten (1 t/m PLOT_MAX_PUNTEN).
+ * @param kleur: Kleurnaam.
+ * @param dikte: Lijndikte (1 t/m 255).
+ * @return Resultaat statuscode.
+ * @note Wordt gelogd voor 'herhaal' tot HERHAAL_MAX_WAARDEN / 2 punten, net als plot.
+ */
+Resultaat polylijn(const int16_t *punten, int aantal, const char *kleur, int dikte)
+{
+	Resultaat r = controleer_puntenreeks(punten, aantal);
+	if (r != OK)
+		return r;
+	if (dikte < 1 || dikte > 255)
+		return ERROR_INVALID_PARAM_THICKNESS;
+	if (!validColor(kleur))
+		return ERROR_INVALID_COLOR;
+
+	int status = teken_puntenreeks(punten, aantal, kleurToCode(kleur), dikte);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_POLYLIJN; c.p1 = dikte;
+	strncpy(c.kleur, kleur, 19);
+	log_reeks(&c, punten, 2 * aantal);
+	return OK;
+}
+
+/**
+ * @brief Tekent een puntenwolk: één pixel per punt.
+ * @param punten: Coördinaten als x1, y1, x2, y2, ... (2 * aantal waarden), binnen het scherm.
+ * @param aantal: Aantal punten (1 t/m PLOT_MAX_PUNTEN).
+ * @param kleur: Kleurnaam.
+ * @return Resultaat statuscode.
+ * @note Wordt gelogd voor 'herhaal' tot HERHAAL_MAX_WAARDEN / 2 punten, net als plot.
+ */
+Resultaat puntenwolk(const int16_t *punten, int aantal, const char *kleur)
+{
+	Resultaat r = controleer_puntenreeks(punten, aantal);
+	if (r != OK)
+		return r;
+	if (!validColor(kleur))
+		return ERROR_INVALID_COLOR;
+
+	int status = teken_puntenreeks(punten, aantal, kleurToCode(kleur), 0);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_PUNTENWOLK;
+	strncpy(c.kleur, kleur, 19);
+	log_reeks(&c, punten, 2 * aantal);
+	return OK;
+}
+
+/**
+ * @brief Maakt een grafiek (strip-chart) aan en wist zijn rechthoek.
+ * @param id: Nummer van de grafiek (0 t/m GRAFIEK_AANTAL - 1).
+ * @param x_lup, y_lup: Linkerbovenhoek.
+ * @param breedte, hoogte: Afmetingen; de grafiek moet binnen het scherm vallen.
+ * @param ondergrens, bovengrens: Meetwaarden op de onderste en bovenste rij (-32768 t/m 32767).
+ * @param achtergrond: Kleurnaam van de achtergrond.
+ * @param kleuren: Kleurnaam per kanaal.
+ * @param kanalen: Aantal kanalen (1 t/m VGA_CHART_MAX_CHANNELS).
+ * @return Resultaat statuscode.
+ * @note Wordt gelogd voor 'herhaal'; een herhaalde grafiek begint weer leeg.
+ */
+Resultaat grafiek(int id, int x_lup, int y_lup, int breedte, int hoogte, int ondergrens, int bovengrens,
+                  const char *achtergrond, const char kleuren[][20], int kanalen)
+{
+	uint8_t codes[VGA_CHART_MAX_CHANNELS];
+
+	if (id < 0 || id >= GRAFIEK_AANTAL)
+		return ERROR_INVALID_PARAM;
+	if (breedte <= VGA_CHART_GAP || hoogte < 2)
+		return ERROR_INVALID_PARAM_SIZE;
+	if (x_lup < 0 || y_lup < 0 || x_lup + breedte > SCHERM_BREEDTE || y_lup + hoogte > SCHERM_HOOGTE)
+		return ERROR_OUT_OF_BOUNDS;
+	if (ondergrens < INT16_MIN || bovengrens > INT16_MAX || ondergrens >= bovengrens)
+		return ERROR_INVALID_PARAM;
+	if (kanalen < 1 || kanalen > VGA_CHART_MAX_CHANNELS)
+		return ERROR_INVALID_PARAM;
+	if (!validColor(achtergrond))
+		return ERROR_INVALID_COLOR;
+	for (int i = 0; i < kanalen; i++)
+	{
+		if (!validColor(kleuren[i]))
+			return ERROR_INVALID_COLOR;
+		codes[i] = kleurToCode(kleuren[i]);
+	}
+
+	int status = UB_VGA_ChartInit(&grafieken[id], x_lup, y_lup, breedte, hoogte, ondergrens, bovengrens,
+	                              kanalen, codes, kleurToCode(achtergrond));
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_GRAFIEK; c.p1 = id; c.p2 = x_lup; c.p3 = y_lup; c.p4 = breedte; c.p5 = hoogte;
+	c.p6 = ondergrens; c.p7 = bovengrens; c.p8 = kanalen;
+	for (int i = 0; i < kanalen; i++)
+		c.punten[i] = codes[i];
+	strncpy(c.kleur, achtergrond, 19);
+	log_commando(c);
+	return OK;
+}
+
+/**
+ * @brief Zet het raster van een grafiek aan of uit; de grafiek wordt gewist.
+ * @param id: Nummer van een aangemaakte grafiek.
+ * @param afstand: Afstand tussen rasterlijnen in pixels (1 t/m 255), 0 = geen raster.
+ * @param kleur: Kleurnaam van het raster.
+ * @return Resultaat statuscode.
+ */
+Resultaat grafiekraster(int id, int afstand, const char *kleur)
+{
+	if (id < 0 || id >= GRAFIEK_AANTAL || grafieken[id].width == 0)
+		return ERROR_INVALID_PARAM;
+	if (afstand < 0 || afstand > 255)
+		return ERROR_INVALID_PARAM;
+	if (!validColor(kleur))
+		return ERROR_INVALID_COLOR;
+
+	int status = UB_VGA_ChartSetGrid(&grafieken[id], afstand, kleurToCode(kleur));
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_GRAFIEKRASTER; c.p1 = id; c.p2 = afstand;
+	strncpy(c.kleur, kleur, 19);
+	log_commando(c);
+	return OK;
+}
+
+/**
+ * @brief Voegt metingen toe aan een grafiek.
+ * @details Per meting wordt alleen de schrijfkolom getekend en de kolom
+ *          daarvoor gewist, dus de kosten hangen af van de hoogte van de
+ *          grafiek en niet van de oppervlakte.
+ * @param id: Nummer van een aangemaakte grafiek.
+ * @param waarden: Eén of meer metingen achter elkaar, elk met één waarde per kanaal.
+ * @param aantal: Aantal waarden; een veelvoud van het aantal kanalen.
+ * @return Resultaat statuscode.
+ * @note Wordt gelogd voor 'herhaal' tot HERHAAL_MAX_WAARDEN waarden, net als plot.
+ */
+Resultaat meting(int id, const int16_t *waarden, int aantal)
+{
+	if (id < 0 || id >= GRAFIEK_AANTAL || grafieken[id].width == 0)
+		return ERROR_INVALID_PARAM;
+
+	VGA_Chart *g = &grafieken[id];
+	if (aantal < g->channels || aantal % g->channels != 0)
+		return ERROR_INVALID_PARAM_SIZE;
+
+	for (int i = 0; i < aantal; i += g->channels)
+	{
+		int status = UB_VGA_ChartAppend(g, &waarden[i]);
+		if (status != 0)
+			return vgaStatusToResultaat(status);
+	}
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_METING; c.p1 = id;
+	log_reeks(&c, waarden, aantal);
+	return OK;
+}
+
+/*
+ * De stappen van de transformatiecommando's, zonder controle. 'herhaal'
+ * voert de gelogde stappen hiermee opnieuw uit, in dezelfde volgorde als
+ * de tekencommando's ertussen.
+ */
+
+static void stap_draai(int hoek, int x, int y)
+{
+	UB_VGA_TransformTranslate(&transformatie_actief, x, y);
+	UB_VGA_TransformRotate(&transformatie_actief, hoek);
+	UB_VGA_TransformTranslate(&transformatie_actief, -x, -y);
+}
+
+static void stap_schaal(int sx, int sy)
+{
+	UB_VGA_TransformScale(&transformatie_actief, (sx * VGA_Q16_ONE) / 100, (sy * VGA_Q16_ONE) / 100);
+}
+
+// Geeft ERROR_INVALID_PARAM bij een onbekende actie of een volle of lege stapel
+static Resultaat stap_transformatie(const char *actie)
+{
+	if (strcmp(actie, "push") == 0)
+	{
+		if (transformatie_niveau >= TRANSFORMATIE_DIEPTE)
+			return ERROR_INVALID_PARAM;
+		transformatie_stapel[transformatie_niveau++] = transformatie_actief;
+	}
+	else if (strcmp(actie, "pop") == 0)
+	{
+		if (transformatie_niveau == 0)
+			return ERROR_INVALID_PARAM;
+		transformatie_actief = transformatie_stapel[--transformatie_niveau];
+	}
+	else if (strcmp(actie, "reset") == 0)
+	{
+		// Alleen de actieve transformatie; de stapel blijft staan
+		UB_VGA_TransformIdentity(&transformatie_actief);
+	}
+	else
+		return ERROR_INVALID_PARAM;
+	return OK;
+}
+
+/**
+ * @brief Verschuift de hoekpunten van de volgende commando's.
+ * @param dx, dy: Verschuiving in pixels (-32768 t/m 32767).
+ * @return Resultaat statuscode.
+ * @note Net als draai en schaal werkt de verschuiving op de punten vóór de
+ *       transformaties die al actief zijn. Wordt gelogd voor 'herhaal', net
+ *       als draai, schaal en transformatie.
+ */
+Resultaat verschuif(int dx, int dy)
+{
+	if (dx < INT16_MIN || dx > INT16_MAX || dy < INT16_MIN || dy > INT16_MAX)
+		return ERROR_INVALID_PARAM;
+
+	UB_VGA_TransformTranslate(&transformatie_actief, dx, dy);
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_VERSCHUIF; c.p1 = dx; c.p2 = dy;
+	log_commando(c);
+	return OK;
+}
+
+/**
+ * @brief Draait de hoekpunten van de volgende commando's om een middelpunt.
+ * @param hoek: Hoek in graden; positief is tegen de klok in.
+ * @param x, y: Middelpunt van de draaiing.
+ * @return Resultaat statuscode.
+ */
+Resultaat draai(int hoek, int x, int y)
+{
+	if (x < INT16_MIN || x > INT16_MAX || y < INT16_MIN || y > INT16_MAX)
+		return ERROR_INVALID_PARAM;
+
+	stap_draai(hoek, x, y);
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_DRAAI; c.p1 = hoek; c.p2 = x; c.p3 = y;
+	log_commando(c);
+	return OK;
+}
+
+/**
+ * @brief Schaalt de hoekpunten van de volgende commando's ten opzichte van (0, 0).
+ * @param sx, sy: Horizontale en verticale factor in procenten (-1000 t/m 1000, niet 0);
+ *        een negatieve factor spiegelt.
+ * @return Resultaat statuscode.
+ */
+Resultaat schaal(int sx, int sy)
+{
+	if (sx == 0 || sy == 0 || sx < -1000 || sx > 1000 || sy < -1000 || sy > 1000)
+		return ERROR_INVALID_PARAM;
+
+	stap_schaal(sx, sy);
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_SCHAAL; c.p1 = sx; c.p2 = sy;
+	log_commando(c);
+	return OK;
+}
+
+/**
+ * @brief Bewaart, herstelt of wist de actieve transformatie.
+ * @param actie: "push" (bewaren op de stapel), "pop" (terugzetten) of "reset" (geen transformatie).
+ * @return Resultaat statuscode; ERROR_INVALID_PARAM bij een volle of lege stapel.
+ */
+Resultaat transformatie(const char *actie)
+{
+	Resultaat r = stap_transformatie(actie);
+	if (r != OK)
+		return r;
+
+	Commando c;
+	memset(&c, 0, sizeof(Commando));
+	c.type = CMD_TRANSFORMATIE;
+	strncpy(c.kleur, actie, 19);
+	log_commando(c);
+	return OK;
+}
+
+/**
+ * @brief Band van de driver die de rijen eerste t/m eerste + rijen - 1 op hun eigen plaats toont.
+ */
+static VGA_Band maak_band(int eerste, int rijen)
+{
+	VGA_Band band = { .rows = rijen, .top = eerste, .height = rijen, .scroll = 0, .zoom = 1 };
+	return band;
+}
+
+/**
+ * @brief Verdeelt het scherm in een vaste balk boven, een rolgebied en een vaste balk onder.
+ * @details Het rolgebied toont de framebufferregels ertussen en rolt met
+ *          'rol' rond, zonder dat er pixels verplaatst worden. 0,0 maakt het
+ *          hele scherm tot rolgebied. De rolpositie begint weer bij 0.
+ * @param boven, onder: Aantal vaste rijen boven en onder; het rolgebied moet minstens één rij hoog blijven.
+ * @return Resultaat statuscode.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat splits(int boven, int onder)
+{
+	if (boven < 0 || onder < 0 || boven + onder >= SCHERM_HOOGTE)
+		return ERROR_INVALID_PARAM;
+
+	VGA_Band banden[3];
+	uint8_t aantal = 0;
+	int midden = SCHERM_HOOGTE - boven - onder;
+
+	if (boven > 0)
+		banden[aantal++] = maak_band(0, boven);
+	uint8_t band = aantal;
+	banden[aantal++] = maak_band(boven, midden);
+	if (onder > 0)
+		banden[aantal++] = maak_band(boven + midden, onder);
+
+	// Pas na succes overnemen; anders rolt 'rol' een band van een indeling die er niet is
+	int status = UB_VGA_SetBands(banden, aantal);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	splits_boven = boven;
+	splits_onder = onder;
+	rol_band = band;
+	return OK;
+}
+
+/**
+ * @brief Rolt het rolgebied van 'splits' (standaard het hele scherm).
+ * @details Alleen de tabel met de framebufferregel per schermrij verandert;
+ *          de nieuwe stand gaat in bij het volgende beeld. Zonder kleur
+ *          komen de regels die aan de andere kant verdwenen weer in beeld;
+ *          met een kleur worden de rijen die in beeld komen eerst gewist.
+ *          Tekencommando's blijven framebuffercoördinaten gebruiken.
+ * @param regels: Aantal rijen; positief rolt de inhoud omhoog (zoals een terminal), negatief omlaag.
+ * @param kleur: Kleur voor de nieuwe rijen, of "" om ze niet te wissen.
+ * @return Resultaat statuscode.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat rol(int regels, const char *kleur)
+{
+	int wissen = (kleur[0] != '\0');
+	if (wissen && !validColor(kleur))
+		return ERROR_INVALID_COLOR;
+
+	int status = UB_VGA_ScrollBand(rol_band, regels);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+
+	if (wissen && regels != 0)
+	{
+		// De rijen die in beeld kwamen, aan de onderkant bij omhoog rollen
+		int eerste = splits_boven;
+		int laatste = SCHERM_HOOGTE - splits_onder - 1;
+		if (regels > 0 && regels <= laatste - eerste)
+			eerste = laatste - regels + 1;
+		else if (regels < 0 && regels >= eerste - laatste)
+			laatste = eerste - regels - 1;
+
+		uint8_t code = kleurToCode(kleur);
+		for (int rij = eerste; rij <= laatste; rij++)
+			UB_VGA_FastHLine(0, UB_VGA_GetRowLine(rij), SCHERM_BREEDTE - 1, code);
+	}
+	return OK;
+}
+
+/**
+ * @brief Schakelt over op een andere videomodus.
+ * @details Het scherm wordt zwart, de splitsing en de tweede pagina vervallen.
+ * @param naam: "320x240", "320x480", "160x120", "400x300", "320x240_16", "320x480_16" of "320x120".
+ * @return Resultaat statuscode; ERROR_VGA_OUT_OF_MEMORY als de modus niet in het framebuffer past en de displaylijst
+ *         of een tekstvak over het hele scherm niet aan staat.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat modus(const char *naam)
+{
+	for (int i = 0; i < VGA_MODE_COUNT; i++)
+	{
+		if (strcmp(naam, modi[i]) == 0)
+		{
+			int status = UB_VGA_SetMode((VGA_ModeId)i);
+			if (status != 0)
+				return vgaStatusToResultaat(status);
+			splits_boven = 0;
+			splits_onder = 0;
+			rol_band = 0;
+			return OK;
+		}
+	}
+	return ERROR_INVALID_PARAM;
+}
+
+/**
+ * @brief Zet het tekenen op een tweede pagina aan of uit.
+ * @details Met "aan" tekenen de commando's op een verborgen pagina die 'toon'
+ *          in één keer laat zien, zodat animaties niet scheuren of flikkeren.
+ *          Twee pagina's passen in de modi 160x120, 320x120 en 320x240_16.
+ * @param stand: "aan" of "uit".
+ * @return Resultaat statuscode; ERROR_VGA_OUT_OF_MEMORY als twee pagina's niet passen.
+ */
+Resultaat dubbelbuffer(const char *stand)
+{
+	int status;
+	if (strcmp(stand, "aan") == 0)
+		status = UB_VGA_SetPages(2);
+	else if (strcmp(stand, "uit") == 0)
+		status = UB_VGA_SetPages(1);
+	else
+		return ERROR_INVALID_PARAM;
+
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Laat de verborgen pagina zien vanaf het volgende beeld.
+ * @details Wacht op het begin van het volgende beeld (hoogstens 17 ms).
+ *          Daarna tekenen de commando's op de pagina die tot dan te zien
+ *          was. Met "kopie" wordt die eerst gelijk gemaakt aan het scherm;
+ *          zonder kopie loopt ze één beeld achter, wat goed is als elk beeld
+ *          helemaal opnieuw getekend wordt.
+ * @param optie: "" of "kopie".
+ * @return Resultaat statuscode; ERROR_VGA_INVALID_PARAMETER zonder 'dubbelbuffer,aan'.
+ */
+Resultaat toon(const char *optie)
+{
+	int kopie = (strcmp(optie, "kopie") == 0);
+	if (!kopie && optie[0] != '\0')
+		return ERROR_INVALID_PARAM;
+
+	int status = UB_VGA_Present(kopie);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Geeft de tellers van 'toon' sinds de vorige aanroep en zet ze op nul.
+ * @param stats: Wordt gevuld met beelden, getoonde pagina's, gemiste beelden en pagina's per seconde.
+ * @return Resultaat statuscode.
+ */
+Resultaat fps(VGA_PageStats *stats)
+{
+	if (stats == NULL)
+		return ERROR_INVALID_PARAM;
+
+	UB_VGA_GetPageStats(stats);
+	UB_VGA_ResetPageStats();
+	return OK;
+}
+
+/**
+ * @brief Toont de displaylijst in plaats van het framebuffer, of weer het framebuffer.
+ * @details Met "aan" tekent de interrupt elke regel vlak voor hij verstuurd
+ *          wordt uit een lijst van lijnen, rechthoeken en cirkels; die komen
+ *          daar via 'lijn', 'rechthoek' en 'cirkel' in, en 'clearscherm'
+ *          maakt de lijst leeg. Er is dan geen framebuffer nodig, zodat
+ *          daarna ook 'modus,320x480' en 'modus,400x300' kunnen. De andere
+ *          tekencommando's tekenen niets zolang de lijst aan staat.
+ * @param stand: "aan" of "uit".
+ * @return Resultaat statuscode; ERROR_VGA_OUT_OF_MEMORY als het framebuffer
+ *         van de modus niet past, ERROR_VGA_INVALID_PARAMETER met 'dubbelbuffer,aan'.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat lijst(const char *stand)
+{
+	int status;
+	if (strcmp(stand, "aan") == 0)
+		status = UB_VGA_ListStart();
+	else if (strcmp(stand, "uit") == 0)
+		status = UB_VGA_ListStop();
+	else
+		return ERROR_INVALID_PARAM;
+
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Geeft de tellers van de displaylijst sinds de vorige aanroep en zet ze op nul.
+ * @param stats: Wordt gevuld met getekende regels, te late regels, weggelaten items en cycli per regel.
+ * @return Resultaat statuscode.
+ */
+Resultaat lijstinfo(VGA_ListStats *stats)
+{
+	if (stats == NULL)
+		return ERROR_INVALID_PARAM;
+
+	UB_VGA_GetListStats(stats);
+	UB_VGA_ResetListStats();
+	return OK;
+}
+
+/**
+ * @brief Toont een tekstvak over een band schermrijen, of weer het framebuffer.
+ * @details Het tekstvak is een raster van tekens van 6x8 pixels in het
+ *          Consolas-lettertype, zo breed als het scherm (53 kolommen bij 320
+ *          pixels). De interrupt zet de tekens van elke rij vlak voor hij
+ *          verstuurd wordt om in pixels, dus 'schrijf' verandert maar twee
+ *          bytes per teken en 'tekstrol' verschuift geen tekens. Boven en
+ *          onder het vak blijft het framebuffer te zien en blijven de
+ *          tekencommando's werken. Een vak van rij 0 tot de onderkant heeft
+ *          geen framebuffer nodig, zoals 'lijst,aan'. Na 'modus' blijft het
+ *          vak staan met het oude aantal kolommen; geef dan opnieuw 'tekstvak'.
+ * @param eerste: Eerste schermrij van het vak, of -1 voor uit.
+ * @param rijen: Aantal tekstregels, 0 voor zoveel als er tot de onderkant passen.
+ * @return Resultaat statuscode; ERROR_VGA_INVALID_COORDINATE als de regels niet
+ *         op het scherm passen, ERROR_VGA_OUT_OF_MEMORY als het framebuffer
+ *         of het tekstgeheugen te klein is.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat tekstvak(int eerste, int rijen)
+{
+	int status;
+	if (eerste < 0)
+		status = UB_VGA_TextStop();
+	else if (eerste > 0xFFFF || rijen < 0 || rijen > 255)
+		return ERROR_INVALID_PARAM;
+	else
+		status = UB_VGA_TextStart((uint16_t)eerste, (uint8_t)rijen);
+
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Schrijft tekst in het tekstvak.
+ * @details Tekens voorbij het einde van de regel vallen weg. Elk teken krijgt
+ *          de dichtstbijzijnde kleuren van het palet (16 kleuren).
+ * @param kolom: Kolom van het eerste teken (0 is links).
+ * @param rij: Tekstregel (0 is de bovenste regel van het vak).
+ * @param kleur: Kleur van de tekens.
+ * @param achtergrond: Kleur van de vakjes achter de tekens.
+ * @param tekst: De tekst.
+ * @return Resultaat statuscode; ERROR_VGA_INVALID_PARAMETER zonder 'tekstvak'.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat schrijf(int kolom, int rij, const char *kleur, const char *achtergrond, const char *tekst)
+{
+	if (!validColor(kleur) || !validColor(achtergrond))
+		return ERROR_INVALID_COLOR;
+	if (!UB_VGA_TextActive())
+		return ERROR_VGA_INVALID_PARAMETER;
+	if (kolom < 0 || rij < 0 || kolom > 255 || rij > 255)
+		return ERROR_VGA_INVALID_COORDINATE;
+
+	uint8_t attr = UB_VGA_TextAttr(kleurToCode(kleur), kleurToCode(achtergrond));
+	int status = UB_VGA_TextPrint((uint8_t)kolom, (uint8_t)rij, tekst, attr);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Rolt het tekstvak omhoog.
+ * @details Alleen de bovenste regel van het tekstraster verschuift; de
+ *          regels die onderaan in beeld komen zijn leeg.
+ * @param regels: Aantal tekstregels (1 of meer).
+ * @param kleur: Achtergrond van de nieuwe regels.
+ * @return Resultaat statuscode; ERROR_VGA_INVALID_PARAMETER zonder 'tekstvak'.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat tekstrol(int regels, const char *kleur)
+{
+	if (!validColor(kleur))
+		return ERROR_INVALID_COLOR;
+	if (!UB_VGA_TextActive())
+		return ERROR_VGA_INVALID_PARAMETER;
+	if (regels < 1)
+		return ERROR_INVALID_PARAM;
+
+	uint8_t code = kleurToCode(kleur);
+	UB_VGA_TextScroll((uint8_t)(regels > 255 ? 255 : regels), UB_VGA_TextAttr(code, code));
+	return OK;
+}
+
+/**
+ * @brief Laat een bitmap als sprite over het beeld bewegen, of haalt hem weg.
+ * @details De sprite staat meteen op zijn nieuwe plek. De pixels onder een
+ *          sprite worden bewaard en teruggezet als hij verplaatst wordt, dus
+ *          het beeld eronder hoeft niet opnieuw getekend te worden. Pixels in
+ *          de transparante kleur van de bitmap worden niet getekend.
+ *          Tekenen onder een sprite wordt overschreven als hij verplaatst
+ *          wordt; 'clearscherm' houdt wel rekening met de sprites.
+ * @param id: Nummer van de sprite (0 t/m VGA_SPRITE_COUNT - 1).
+ * @param nr: Index van de bitmap (0-5), of -1 om de sprite weg te halen.
+ * @param x, y: Linkerbovenhoek; mag (deels) buiten het scherm liggen.
+ * @param laag: Z-volgorde (0-255); een hogere laag ligt bovenop, bij een gelijke laag het hoogste nummer.
+ * @return Resultaat statuscode; ERROR_VGA_INVALID_PARAMETER met 'dubbelbuffer,aan' in de modus "framebuffer".
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat sprite(int id, int nr, int x, int y, int laag)
+{
+	if (id < 0 || id >= VGA_SPRITE_COUNT || nr < -1 || nr > 5 || laag < 0 || laag > 255)
+		return ERROR_INVALID_PARAM;
+	if (x < INT16_MIN || x > INT16_MAX || y < INT16_MIN || y > INT16_MAX)
+		return ERROR_OUT_OF_BOUNDS;
+
+	int status;
+	if (nr < 0)
+		status = UB_VGA_SpriteHide((uint8_t)id);
+	else
+		status = UB_VGA_SpriteShow((uint8_t)id, &vga_bitmaps[nr], (int16_t)x, (int16_t)y, (uint8_t)laag);
+	if (status == 0)
+		status = UB_VGA_SpriteUpdate();
+
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Kiest waar de sprites getekend worden.
+ * @details Met "framebuffer" (standaard) komen de sprites in de vertical
+ *          blank in het framebuffer, met een bewaarde achtergrond. Met
+ *          "scanout" tekent de interrupt ze in elke regel vlak voor hij
+ *          verstuurd wordt; het framebuffer blijft dan onaangeroerd, zodat
+ *          onder de sprites getekend kan worden, maar elke regel met een
+ *          sprite kost interrupttijd. De sprites verdwijnen tot het volgende
+ *          'sprite'-commando.
+ * @param naam: "framebuffer" of "scanout".
+ * @return Resultaat statuscode.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat spritemodus(const char *naam)
+{
+	int status;
+	if (strcmp(naam, "framebuffer") == 0)
+		status = UB_VGA_SpriteSetMode(VGA_SPRITE_FRAMEBUFFER);
+	else if (strcmp(naam, "scanout") == 0)
+		status = UB_VGA_SpriteSetMode(VGA_SPRITE_SCANOUT);
+	else
+		return ERROR_INVALID_PARAM;
+
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Geeft de tellers van de sprites sinds de vorige aanroep en zet ze op nul.
+ * @param stats: Wordt gevuld met het aantal updates, cycli per update en te late updates (framebuffer),
+ *               en cycli per beeld en per regel in de interrupt (scanout).
+ * @return Resultaat statuscode.
+ */
+Resultaat spriteinfo(VGA_SpriteStats *stats)
+{
+	if (stats == NULL)
+		return ERROR_INVALID_PARAM;
+
+	UB_VGA_GetSpriteStats(stats);
+	UB_VGA_ResetSpriteStats();
+	return OK;
+}
+
+/**
+ * @brief Zet een raster-effect aan of uit.
+ * @details Een raster-effect verandert de rijen pas als ze naar het scherm
+ *          gaan; het framebuffer blijft gelijk, dus tekenen, 'clearscherm' en
+ *          'herhaal' werken er gewoon onder. De effecten werken in volgorde
+ *          van hun nummer, de sprites in scanout-modus liggen erbovenop.
+ *          - "golf": schuift de rijen heen en weer, een sinus van 32 stappen
+ *            van 2 rijen per stap, tot amplitude pixels.
+ *          - "verloop": vervangt kleur door een verloop van van naar naar
+ *            over de rijen.
+ *          - "invers" of "donker": keert alle kleuren om of maakt ze half zo
+ *            licht, in de kolommen x tot x + breedte.
+ *          - "vlak": vult de kolommen x tot x + breedte met kleur.
+ *          - "uit": haalt het effect weg.
+ *          Een breedte van 0 loopt tot de rechterrand. Past een effect niet
+ *          meer in het cyclusbudget van een regel, dan valt het voor die
+ *          regel weg (zie effectinfo).
+ * @param id: Nummer van het effect (0 t/m VGA_RASTER_MAX_EFFECTS - 1).
+ * @param soort: "golf", "verloop", "invers", "donker", "vlak" of "uit".
+ * @param eerste: Eerste rij.
+ * @param rijen: Aantal rijen.
+ * @param x: Eerste kolom (invers, donker, vlak).
+ * @param breedte: Aantal kolommen (invers, donker, vlak).
+ * @param amplitude: Grootste verschuiving in pixels, 1 t/m 127 (golf).
+ * @param kleur: Kleur die vervangen wordt (verloop) of vulkleur (vlak).
+ * @param van: Kleur op de eerste rij (verloop).
+ * @param naar: Kleur op de laatste rij (verloop).
+ * @return Resultaat statuscode.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat effect(int id, const char *soort, int eerste, int rijen, int x, int breedte, int amplitude,
+                 const char *kleur, const char *van, const char *naar)
+{
+	if (id < 0 || id >= VGA_RASTER_MAX_EFFECTS || soort == NULL)
+		return ERROR_INVALID_PARAM;
+
+	int status;
+	if (strcmp(soort, "uit") == 0)
+	{
+		status = UB_VGA_RasterSet((uint8_t)id, NULL);
+		if (status != 0)
+			return vgaStatusToResultaat(status);
+		return OK;
+	}
+
+	if (rijen <= 0 || eerste < 0 || eerste >= SCHERM_HOOGTE || x < 0 || x >= SCHERM_BREEDTE || breedte < 0)
+		return ERROR_OUT_OF_BOUNDS;
+	if (eerste + rijen > SCHERM_HOOGTE)
+		rijen = SCHERM_HOOGTE - eerste;
+
+	VGA_RasterEffect e;
+	memset(&e, 0, sizeof(e));
+	e.first_row = (uint16_t)eerste;
+	e.rows = (uint16_t)rijen;
+	e.x = (uint16_t)x;
+	e.width = (uint16_t)breedte;
+
+	if (strcmp(soort, "golf") == 0)
+	{
+		if (amplitude < 1 || amplitude > 127)
+			return ERROR_INVALID_PARAM;
+		for (int i = 0; i < EFFECT_STAPPEN; i++)
+			effect_golven[id][i] = (int8_t)((amplitude * UB_VGA_SinQ16(i * 360 / EFFECT_STAPPEN)) >> 16);
+		e.type = VGA_RASTER_SHIFT;
+		e.period = EFFECT_STAPPEN;
+		e.spacing = 2;
+		e.table = effect_golven[id];
+	}
+	else if (strcmp(soort, "verloop") == 0)
+	{
+		if (!validColor(kleur) || !validColor(van) || !validColor(naar))
+			return ERROR_INVALID_COLOR;
+		// R3G3B2 per kanaal verlopen, een stap per rijen / EFFECT_STAPPEN rijen
+		uint8_t a = kleurToCode(van);
+		uint8_t b = kleurToCode(naar);
+		for (int i = 0; i < EFFECT_STAPPEN; i++)
+		{
+			int r = ((a >> 5) * (EFFECT_STAPPEN - 1 - i) + (b >> 5) * i) / (EFFECT_STAPPEN - 1);
+			int g = (((a >> 2) & 7) * (EFFECT_STAPPEN - 1 - i) + ((b >> 2) & 7) * i) / (EFFECT_STAPPEN - 1);
+			int bl = ((a & 3) * (EFFECT_STAPPEN - 1 - i) + (b & 3) * i) / (EFFECT_STAPPEN - 1);
+			effect_verlopen[id][i] = (uint8_t)((r << 5) | (g << 2) | bl);
+		}
+		int stap = (rijen + EFFECT_STAPPEN - 1) / EFFECT_STAPPEN;
+		e.type = VGA_RASTER_RECOLOR;
+		e.key = kleurToCode(kleur);
+		e.period = EFFECT_STAPPEN;
+		e.spacing = (uint8_t)(stap > 255 ? 255 : stap);
+		e.table = effect_verlopen[id];
+	}
+	else if (strcmp(soort, "invers") == 0 || strcmp(soort, "donker") == 0)
+	{
+		for (int c = 0; c < 256; c++)
+		{
+			effect_invers[c] = (uint8_t)(255 - c);
+			effect_donker[c] = (uint8_t)((((c >> 5) >> 1) << 5) | ((((c >> 2) & 7) >> 1) << 2) | ((c & 3) >> 1));
+		}
+		e.type = VGA_RASTER_REMAP;
+		e.table = (soort[0] == 'i') ? effect_invers : effect_donker;
+	}
+	else if (strcmp(soort, "vlak") == 0)
+	{
+		if (!validColor(kleur))
+			return ERROR_INVALID_COLOR;
+		e.type = VGA_RASTER_BLANK;
+		e.key = kleurToCode(kleur);
+	}
+	else
+		return ERROR_INVALID_PARAM;
+
+	status = UB_VGA_RasterSet((uint8_t)id, &e);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Zet de fase van een golf of verloop, vanaf het volgende beeld.
+ * @details Een fase verschuift het effect een tabelwaarde; steeds een hogere
+ *          fase laat een golf of verloop bewegen zonder iets te tekenen.
+ * @param id: Nummer van het effect.
+ * @param fase: Tabelwaarde van de eerste rij, 0 t/m EFFECT_STAPPEN - 1.
+ * @return Resultaat statuscode.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat effectfase(int id, int fase)
+{
+	if (id < 0 || id >= VGA_RASTER_MAX_EFFECTS || fase < 0 || fase >= EFFECT_STAPPEN)
+		return ERROR_INVALID_PARAM;
+
+	int status = UB_VGA_RasterSetPhase((uint8_t)id, (uint8_t)fase);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Geeft de tellers van de raster-effecten sinds de vorige aanroep en zet ze op nul.
+ * @param stats: Wordt gevuld met het aantal rijen met een effect, rijen waarop een effect
+ *               wegviel, en de cycli per rij tegenover het budget.
+ * @return Resultaat statuscode.
+ */
+Resultaat effectinfo(VGA_RasterStats *stats)
+{
+	if (stats == NULL)
+		return ERROR_INVALID_PARAM;
+
+	UB_VGA_GetRasterStats(stats);
+	UB_VGA_ResetRasterStats();
+	return OK;
+}
+
+/**
+ * @brief Meet hoeveel cycli de meng-kernels voor een rij nodig hebben.
+ * @details Elke kernel draait met de SIMD-instructies en als gewone C, zodat
+ *          te zien is wat __UHADD8 en __SEL op het bord opleveren.
+ * @param bench: Wordt gevuld met de cycli per rij van VGA_BLEND_BENCH_PIXELS pixels.
+ * @return Resultaat statuscode.
+ */
+Resultaat menginfo(VGA_BlendBench *bench)
+{
+	if (bench == NULL)
+		return ERROR_INVALID_PARAM;
+
+	VGA_Status status = UB_VGA_BlendBenchmark(bench);
+	return vgaStatusToResultaat(status);
+}
+
+/**
+ * @brief Kiest wanneer effen vlakken, dunne lijnen en bitmaps getekend worden.
+ * @details Tijdens een regel leest de DMA het framebuffer; tekent de CPU
+ *          dan ook, dan wachten ze op elkaar: tekenen gaat langzamer en het
+ *          beeld kan trillen. Een planner knipt het tekenen in stukjes die
+ *          in de blanking-intervallen passen.
+ *          - "direct" (standaard): tekent meteen, zoals altijd.
+ *          - "vblank": tekent alleen in de vertical blank.
+ *          - "blanking": tekent ook tussen twee regels, in de horizontal blank.
+ *          Met een planner komt een commando terug zodra het in de
+ *          wachtrij staat; de hoofdlus tekent de wachtrij leeg. Andere
+ *          commando's wachten eerst tot de wachtrij leeg is (zie
+ *          planner_volgorde). Tekenen duurt zo langer, maar het beeld
+ *          blijft rustig en UART-invoer blijft binnenkomen (zie
+ *          plannerinfo).
+ * @param naam: "direct", "vblank" of "blanking".
+ * @return Resultaat statuscode.
+ * @note Wordt niet gelogd voor 'herhaal'.
+ */
+Resultaat planner(const char *naam)
+{
+	VGA_SchedMode stand;
+	if (strcmp(naam, "direct") == 0)
+		stand = VGA_SCHED_DIRECT;
+	else if (strcmp(naam, "vblank") == 0)
+		stand = VGA_SCHED_VBLANK;
+	else if (strcmp(naam, "blanking") == 0)
+		stand = VGA_SCHED_BLANKING;
+	else
+		return ERROR_INVALID_PARAM;
+
+	UB_VGA_SchedFlush();
+	int status = UB_VGA_SchedSetMode(stand);
+	if (status != 0)
+		return vgaStatusToResultaat(status);
+	return OK;
+}
+
+/**
+ * @brief Tekent de wachtrij van de planner leeg voor een commando dat de volgorde nodig heeft.
+ * @details Lijnen, rechthoeken en bitmaps regelen dat zelf en commando's
+ *          die niet in het framebuffer tekenen of lezen hoeven niet te
+ *          wachten. Alle andere commando's tekenen direct of lezen het
+ *          beeld, en komen dus pas na wat al in de wachtrij staat.
+ * @param type: Het commando dat zo uitgevoerd wordt.
+ */
+void planner_volgorde(CommandType type)
+{
+	switch (type)
+	{
+	case CMD_LIJN:
+	case CMD_RECHTHOEK:
+	case CMD_BITMAP:
+	case CMD_VERSCHUIF:
+	case CMD_DRAAI:
+	case CMD_SCHAAL:
+	case CMD_TRANSFORMATIE:
+	case CMD_PATROON:
+	case CMD_FPS:
+	case CMD_LIJSTINFO:
+	case CMD_SPRITEINFO:
+	case CMD_EFFECTINFO:
+	case CMD_MENGINFO:
+	case CMD_PLANNERINFO:
+		return;
+	default:
+		UB_VGA_SchedFlush();
+		return;
+	}
+}
+
+/**
+ * @brief Geeft de tellers van de planner en de scanout-interrupt sinds de vorige aanroep en zet ze op nul.
+ * @param stats: Wordt gevuld met de getekende pixels, stukjes, te late stukjes, de
+ *               tekensnelheid en de trilling van de regels die tijdens een stukje eindigden.
+ * @param isr: Wordt gevuld met de tellers van de interrupt; het verschil tussen
+ *             max_end_tick en min_end_tick is de trilling van het regeleinde
+ *             (alleen met VGA_MEASURE_ISR).
+ * @return Resultaat statuscode.
+ */
+Resultaat plannerinfo(VGA_SchedStats *stats, VGA_IsrStats *isr)
+{
+	if (stats == NULL || isr == NULL)
+		return ERROR_INVALID_PARAM;
+
+	UB_VGA_GetSchedStats(stats);
+	UB_VGA_ResetSchedStats();
+	UB_VGA_GetIsrStats(isr);
+	UB_VGA_ResetIsrStats();
+	return OK;
+}
+
+/**
+ * @brief Slaat een 8x8 patroon op onder een nummer.
+ * @param id: Nummer van het patroon (0 t/m VGA_PATTERN_COUNT - 1).
+ * @param rijen: 8 getallen (0-255), één per rij van boven naar onder; bit 7 is de linker pixel.
+ * @return Resultaat statuscode.
+ */
+Resultaat patroon(int id, const int *rijen)
+{
+    if (id < 0 || id >= VGA_PATTERN_COUNT || rijen == NULL)
+        return ERROR_INVALID_PARAM;
+
+    uint8_t bits[8];
+    for (int i = 0; i < 8; i++)
+    {
+        if (rijen[i] < 0 || rijen[i] > 255)
+            return ERROR_INVALID_PARAM;
+        bits[i] = rijen[i];
+    }
+
+    int status = UB_VGA_DefinePattern(id, bits);
+    if (status != 0)
+        return vgaStatusToResultaat(status);
+    return OK;
+}
+
+/**
+ * @brief Kiest het patroon waarmee gevulde rechthoeken, polygonen en cirkels getekend worden.
+ * @details De kleur van het tekencommando is de kleur van de gezette bits.
+ * @param id: Nummer van het patroon, of -1 om weer effen te vullen.
+ * @param achtergrond: Kleur van de niet-gezette bits, of "transparant".
+ * @return Resultaat statuscode.
+ */
+Resultaat vulpatroon(int id, const char *achtergrond)
+{
+    if (id == -1)
+    {
+        patroon_id = -1;
+        return OK;
+    }
+    if (id < 0 || id >= VGA_PATTERN_COUNT)
+        return ERROR_INVALID_PARAM;
+
+    int transparant = (strcmp(achtergrond, "transparant") == 0);
+    if (!transparant && !validColor(achtergrond))
+        return ERROR_INVALID_COLOR;
+
+    patroon_id = id;
+    patroon_transparant = transparant;
+    patroon_achtergrond = transparant ? VGA_COL_BLACK : kleurToCode(achtergrond);
+    return OK;
+}
+
+/**
+ * @brief Herhaalt een specifiek aantal van de laatst uitgevoerde commando's.
+ * @details De hoekpunten van lijnen, figuren, polygonen, driehoeken en
+ *          Bézier-krommen gaan opnieuw door de transformatie die dan actief is.
+ *          Transformatiecommando's in de reeks worden mee herhaald, in volgorde,
+ *          dus de transformatie verloopt net als toen; elke ronde gaat verder
+ *          waar de vorige ophield. Begint de reeks na de transformatie, dan
+ *          geldt die van nu: zo tekent 'draai' gevolgd door 'herhaal' een
+ *          gedraaide kopie. Een commando waarvan een punt buiten het scherm
+ *          valt, of een pop op een lege stapel, wordt overgeslagen.
+ *          Plot, polylijn, puntenwolk en meting tekenen hun bewaarde reeks opnieuw;
+ *          was die te lang voor de geschiedenis, dan wordt niets herhaald.
+ * @param aantal: Hoeveel voorgaande commando's herhaald moeten worden (max 20).
+ * @param hoevaak: Hoe vaak deze reeks herhaald moet worden.
+ * @return Resultaat statuscode; ERROR_NOT_REPEATABLE als er een te lange reeks tussen zit.
+ */
+Resultaat herhaal(int aantal, int hoevaak)
+{
+	// Validatie: kunnen we wel zoveel commando's teruggaan in het geheugen?
+	if (aantal <= 0 || aantal > totaal_opgeslagen || hoevaak <= 0)
+	        return ERROR_INVALID_PARAM; //
+
+	// Een reeks die niet bewaard kon worden, zou stil wegvallen
+	for (int i = 0, idx = (geschiedenis_index - aantal + 20) % 20; i < aantal; i++, idx = (idx + 1) % 20)
+	{
+		if (geschiedenis[idx].p10 < 0 && (geschiedenis[idx].type == CMD_PLOT || geschiedenis[idx].type == CMD_POLYLIJN ||
+		                                  geschiedenis[idx].type == CMD_PUNTENWOLK || geschiedenis[idx].type == CMD_METING))
+			return ERROR_NOT_REPEATABLE;
+	}
+
+    for (int h = 0; h < hoevaak; h++)
+    {
+    	// Bereken de startindex in de circulaire buffer
+        int idx = (geschiedenis_index - aantal + 20) % 20;
+        for (int i = 0; i < aantal; i++)
+        {
+            Commando *c = &geschiedenis[idx];
+            VGA_Pattern p;
+            int16_t scherm[POLYGOON_MAX_PUNTEN * 2];
+            planner_volgorde(c->type);
+            // Her-uitvoeren van commando's op basis van hun type
+            switch (c->type)
+            {
+                case CMD_LIJN:
+                	if (transformeer_punt(c->p1, c->p2, &scherm[0]) && transformeer_punt(c->p3, c->p4, &scherm[2]))
+                		teken_lijn(scherm[0], scherm[1], scherm[2], scherm[3], kleurToCode(c->kleur), c->p5, c->p6, (uint32_t)c->p7);
+                	break;
+                case CMD_RECHTHOEK:
+                	teken_rechthoek(c->p1, c->p2, c->p3, c->p4, kleurToCode(c->kleur), c->p5, c->p6,
+                	                lees_patroon(c, kleurToCode(c->kleur), &p));
+                	break;
+                case CMD_CIRKEL:
+                	teken_cirkel(c->p1, c->p2, c->p3, kleurToCode(c->kleur), c->p4, c->p5,
+                	             lees_patroon(c, kleurToCode(c->kleur), &p));
+                	break;
+                case CMD_TEKST:
+                	UB_VGA_DrawText(c->p1, c->p2, kleurToCode(c->kleur), c->tekst_inhoud, c->fontnaam, c->p3, c->fontstijl);
+                	break;
+                case CMD_BITMAP:
+                	teken_bitmap(c->p1, c->p2, c->p3, c->p4);
+                	break;
+                case CMD_CLEAR:
+                	teken_scherm(kleurToCode(c->kleur));
+                	break;
+                case CMD_WAIT:
+                	wachten(c->p1);
+                	break;
+                case CMD_FIGUUR:
+                    if (transformeer_punten(c->punten, scherm, 5))
+                        teken_polygoon(scherm, 5, kleurToCode(c->kleur), 1, 0, NULL, (uint32_t)c->p1);
+                    break;
+                case CMD_POLYGOON:
+                    if (transformeer_punten(c->punten, scherm, c->p1))
+                        teken_polygoon(scherm, c->p1, kleurToCode(c->kleur), c->p2, c->p3,
+                                       lees_patroon(c, kleurToCode(c->kleur), &p), VGA_LINE_SOLID);
+                    break;
+                case CMD_DRIEHOEK:
+                {
+                    int16_t punten[] = {c->p1, c->p2, c->p3, c->p4, c->p5, c->p6};
+                    uint8_t codes[] = {c->p7, c->p8, c->p9};
+                    if (transformeer_punten(punten, scherm, 3))
+                        teken_driehoek(scherm, 3, codes);
+                    break;
+                }
+                case CMD_VUL:
+                    UB_VGA_FloodFill(c->p1, c->p2, kleurToCode(c->kleur));
+                    break;
+                case CMD_VERLOOP:
+                    UB_VGA_FillGradient(c->p1, c->p2, c->p3, c->p4, kleurToCode(c->kleur), c->p6, c->p5);
+                    break;
+                case CMD_ELLIPS:
+                    if (c->p5)
+                        UB_VGA_FillEllipse(c->p1, c->p2, c->p3, c->p4, kleurToCode(c->kleur));
+                    else
+                        UB_VGA_DrawEllipse(c->p1, c->p2, c->p3, c->p4, kleurToCode(c->kleur));
+                    break;
+                case CMD_BOOG:
+                    UB_VGA_DrawArc(c->p1, c->p2, c->p3, c->p4, c->p5, c->p6, kleurToCode(c->kleur));
+                    break;
+                case CMD_AFGERONDE_RECHTHOEK:
+                    if (c->p6)
+                        UB_VGA_FillRoundRect(c->p1, c->p2, c->p3, c->p4, c->p5, kleurToCode(c->kleur));
+                    else
+                        UB_VGA_DrawRoundRect(c->p1, c->p2, c->p3, c->p4, c->p5, kleurToCode(c->kleur));
+                    break;
+                case CMD_DRIEHOEKSTRIP:
+                {
+                    uint8_t codes[] = {c->p7, c->p8, c->p9};
+                    if (transformeer_punten(c->punten, scherm, c->p1))
+                        teken_driehoek(scherm, c->p1, codes);
+                    break;
+                }
+                case CMD_BEZIER:
+                    if (transformeer_punten(c->punten, scherm, c->p1))
+                        teken_bezier(scherm, c->p1, kleurToCode(c->kleur), c->p2, c->p3);
+                    break;
+                case CMD_VERSCHUIF:
+                    UB_VGA_TransformTranslate(&transformatie_actief, c->p1, c->p2);
+                    break;
+                case CMD_DRAAI:
+                    stap_draai(c->p1, c->p2, c->p3);
+                    break;
+                case CMD_SCHAAL:
+                    stap_schaal(c->p1, c->p2);
+                    break;
+                case CMD_TRANSFORMATIE:
+                    stap_transformatie(c->kleur);
+                    break;
+                case CMD_PLOT:
+                    UB_VGA_PlotSeries(c->p1, c->p2, c->punten, c->p10, kleurToCode(c->kleur), c->p3);
+                    break;
+                case CMD_POLYLIJN:
+                    teken_puntenreeks(c->punten, c->p10 / 2, kleurToCode(c->kleur), c->p1);
+                    break;
+                case CMD_PUNTENWOLK:
+                    teken_puntenreeks(c->punten, c->p10 / 2, kleurToCode(c->kleur), 0);
+                    break;
+                case CMD_GRAFIEK:
+                {
+                    uint8_t codes[VGA_CHART_MAX_CHANNELS];
+                    for (int k = 0; k < c->p8; k++)
+                        codes[k] = (uint8_t)c->punten[k];
+                    UB_VGA_ChartInit(&grafieken[c->p1], c->p2, c->p3, c->p4, c->p5, c->p6, c->p7,
+                                     c->p8, codes, kleurToCode(c->kleur));
+                    break;
+                }
+                case CMD_GRAFIEKRASTER:
+                    UB_VGA_ChartSetGrid(&grafieken[c->p1], c->p2, kleurToCode(c->kleur));
+                    break;
+                case CMD_METING:
+                {
+                    // De grafiek kan intussen met een ander aantal kanalen opnieuw aangemaakt zijn
+                    VGA_Chart *g = &grafieken[c->p1];
+                    if (g->width == 0 || c->p10 % g->channels != 0)
+                        break;
+                    for (int k = 0; k < c->p10; k += g->channels)
+                        UB_VGA_ChartAppend(g, &c->punten[k]);
                     break;
+                }
                 default:
                     break;
             }
@@ -441,6 +2347,10 @@ Resultaat vgaStatusToResultaat(int status)
             return ERROR_VGA_INVALID_COORDINATE;
         case 2:
             return ERROR_VGA_INVALID_PARAMETER;
+        case 3:
+            return ERROR_VGA_OUT_OF_MEMORY;
+        case 4:
+            return ERROR_VGA_TIMEOUT;
         default:
             return ERROR_VGA;
     }
@@ -10,6 +10,7 @@
 
 #include "main.h"
 #include "stm32_ub_vga_screen.h"
+#include "stm32_ub_vga_sched.h"
 #include <math.h>
 
 void RunFeatureDemo(void);
@@ -31,6 +32,7 @@ int main(void)
     while(1)
     {
         USART2_BUFFER(); // verwerk inkomende UART karakters
+        UB_VGA_SchedRun(); // teken de wachtrij van de planner in de blanking
     }
 }
 
@@ -0,0 +1,513 @@
+/**
+ * @file    stm32_ub_vga_blend.c
+ * @brief   Implementation of translucent drawing for the VGA library.
+ *
+ * @details An R3G3B2 pixel packs three color fields into one byte, so a
+ *          plain byte average would carry bits from one field into the next.
+ *          The 50% blend therefore averages each field separately:
+ *          - On the Cortex-M4 the R/B fields and the G field are masked into
+ *            separate words, so that every byte lane can be averaged with
+ *            __UHADD8 without the fields interfering.
+ *          - On other targets the same result is computed with the carry-free
+ *            average (a & b) + (((a ^ b) & ~field_lsb) >> 1).
+ *          The 25% and 75% levels are built from two 50% steps. Transparent
+ *          bitmap pixels are masked out with __UADD8/__SEL. All kernels handle
+ *          four pixels per 32-bit word.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_blend.h"
+#include "stm32_ub_vga_private.h"
+#include "bitmaps.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define max(a,b) ((a) > (b) ? (a) : (b))
+#define min(a,b) ((a) < (b) ? (a) : (b))
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define VGA_BLEND_USE_DSP   1
+#else
+#define VGA_BLEND_USE_DSP   0
+#endif
+
+//--------------------------------------------------------------
+// Field masks for four R3G3B2 pixels in one word
+//--------------------------------------------------------------
+#define VGA_BLEND_MASK_RB     0xE3E3E3E3u  /*!< Red and blue fields */
+#define VGA_BLEND_MASK_G      0x1C1C1C1Cu  /*!< Green field */
+#define VGA_BLEND_MASK_NOLSB  0xDADADADAu  /*!< All bits except the LSB of each field */
+#define VGA_BLEND_KEY_WORD    (BITMAP_TRANSPARENT_COLOR * 0x01010101u)
+
+#define VGA_INLINE  static inline __attribute__((always_inline))
+
+// The span of every row of a thick line, from UB_VGA_BlendLine
+static int16_t blend_line_left[VGA_MAX_DISPLAY_Y];
+static int16_t blend_line_right[VGA_MAX_DISPLAY_Y];
+
+// Rows of UB_VGA_BlendBenchmark, word aligned like the framebuffer rows
+static uint32_t blend_bench_dst[VGA_BLEND_BENCH_PIXELS / 4];
+static uint32_t blend_bench_src[VGA_BLEND_BENCH_PIXELS / 4];
+
+
+//--------------------------------------------------------------
+// Word kernels
+//--------------------------------------------------------------
+
+// The kernels below take a simd flag that is always a constant, so every
+// caller gets one of the two versions; UB_VGA_BlendBenchmark times both.
+
+/**
+ * @brief Per-field 50% average of four pixel pairs.
+ */
+VGA_INLINE uint32_t P_VGA_Avg4(uint32_t a, uint32_t b, bool simd)
+{
+#if VGA_BLEND_USE_DSP
+    if (simd) {
+        uint32_t rb = __UHADD8(a & VGA_BLEND_MASK_RB, b & VGA_BLEND_MASK_RB) & VGA_BLEND_MASK_RB;
+        uint32_t g  = __UHADD8(a & VGA_BLEND_MASK_G,  b & VGA_BLEND_MASK_G)  & VGA_BLEND_MASK_G;
+        return rb | g;
+    }
+#else
+    (void)simd;
+#endif
+    return (a & b) + (((a ^ b) & VGA_BLEND_MASK_NOLSB) >> 1);
+}
+
+/**
+ * @brief Blends four source pixels over four destination pixels.
+ */
+VGA_INLINE uint32_t P_VGA_Blend4(uint32_t src, uint32_t dst, VGA_Alpha alpha, bool simd)
+{
+    uint32_t half;
+
+    switch (alpha) {
+        case VGA_ALPHA_25:
+            half = P_VGA_Avg4(src, dst, simd);
+            return P_VGA_Avg4(half, dst, simd);
+        case VGA_ALPHA_50:
+            return P_VGA_Avg4(src, dst, simd);
+        case VGA_ALPHA_75:
+            half = P_VGA_Avg4(src, dst, simd);
+            return P_VGA_Avg4(src, half, simd);
+        case VGA_ALPHA_100:
+            return src;
+        default:
+            return dst;
+    }
+}
+
+/**
+ * @brief Replaces the blended pixels by the destination where the source
+ *        pixel equals BITMAP_TRANSPARENT_COLOR.
+ */
+VGA_INLINE uint32_t P_VGA_KeySelect4(uint32_t src, uint32_t blended, uint32_t dst, bool simd)
+{
+    uint32_t diff = src ^ VGA_BLEND_KEY_WORD;
+#if VGA_BLEND_USE_DSP
+    if (simd) {
+        // GE[n] is set for every byte lane where diff != 0, i.e. opaque pixels.
+        (void)__UADD8(diff, 0xFFFFFFFFu);
+        return __SEL(blended, dst);
+    }
+#else
+    (void)simd;
+#endif
+    uint32_t nz = (((diff & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | diff) & 0x80808080u;
+    uint32_t mask = (nz >> 7) * 0xFFu;
+    return (blended & mask) | (dst & ~mask);
+}
+
+VGA_INLINE uint32_t P_VGA_Load32(const uint8_t *p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+VGA_INLINE void P_VGA_Store32(uint8_t *p, uint32_t w)
+{
+    memcpy(p, &w, sizeof(w));
+}
+
+
+//--------------------------------------------------------------
+// Span kernels
+//--------------------------------------------------------------
+
+/**
+ * @brief Blends a solid color into a run of pixels.
+ * @details Bytes up to the first word boundary and after the last one are
+ *          blended one at a time, the rest four pixels per aligned word.
+ */
+VGA_INLINE void P_VGA_BlendSpanK(uint8_t *dst, uint32_t len, uint8_t color, VGA_Alpha alpha, bool simd)
+{
+    uint32_t src = color * 0x01010101u;
+
+    while (len > 0 && ((uintptr_t)dst & 3u) != 0) {
+        *dst = (uint8_t)P_VGA_Blend4(src, *dst, alpha, simd);
+        dst++;
+        len--;
+    }
+
+    uint32_t *wp = (uint32_t *)dst;
+    for (uint32_t n = len >> 2; n > 0; n--) {
+        *wp = P_VGA_Blend4(src, *wp, alpha, simd);
+        wp++;
+    }
+
+    dst = (uint8_t *)wp;
+    for (len &= 3u; len > 0; len--) {
+        *dst = (uint8_t)P_VGA_Blend4(src, *dst, alpha, simd);
+        dst++;
+    }
+}
+
+static void P_VGA_BlendSpan(uint8_t *dst, uint32_t len, uint8_t color, VGA_Alpha alpha)
+{
+    switch (alpha) {
+        case VGA_ALPHA_25:  P_VGA_BlendSpanK(dst, len, color, VGA_ALPHA_25, VGA_BLEND_USE_DSP);  break;
+        case VGA_ALPHA_50:  P_VGA_BlendSpanK(dst, len, color, VGA_ALPHA_50, VGA_BLEND_USE_DSP);  break;
+        case VGA_ALPHA_75:  P_VGA_BlendSpanK(dst, len, color, VGA_ALPHA_75, VGA_BLEND_USE_DSP);  break;
+        case VGA_ALPHA_100: memset(dst, color, len); break;
+        default: break;
+    }
+}
+
+/**
+ * @brief P_VGA_BlendSpan with the plain C kernel, for the benchmark.
+ */
+static void P_VGA_BlendSpanC(uint8_t *dst, uint32_t len, uint8_t color, VGA_Alpha alpha)
+{
+    switch (alpha) {
+        case VGA_ALPHA_25:  P_VGA_BlendSpanK(dst, len, color, VGA_ALPHA_25, false);  break;
+        case VGA_ALPHA_50:  P_VGA_BlendSpanK(dst, len, color, VGA_ALPHA_50, false);  break;
+        case VGA_ALPHA_75:  P_VGA_BlendSpanK(dst, len, color, VGA_ALPHA_75, false);  break;
+        case VGA_ALPHA_100: memset(dst, color, len); break;
+        default: break;
+    }
+}
+
+/**
+ * @brief Blends a row of color-keyed source pixels into the framebuffer.
+ */
+VGA_INLINE void P_VGA_BlendRowKeyedK(uint8_t *dst, const uint8_t *src, uint32_t len, VGA_Alpha alpha, bool simd)
+{
+    for (; len >= 4; len -= 4) {
+        uint32_t s = P_VGA_Load32(src);
+        uint32_t d = P_VGA_Load32(dst);
+        P_VGA_Store32(dst, P_VGA_KeySelect4(s, P_VGA_Blend4(s, d, alpha, simd), d, simd));
+        src += 4;
+        dst += 4;
+    }
+    for (; len > 0; len--) {
+        if (*src != BITMAP_TRANSPARENT_COLOR) {
+            *dst = (uint8_t)P_VGA_Blend4(*src, *dst, alpha, simd);
+        }
+        src++;
+        dst++;
+    }
+}
+
+static void P_VGA_BlendRowKeyed(uint8_t *dst, const uint8_t *src, uint32_t len, VGA_Alpha alpha)
+{
+    switch (alpha) {
+        case VGA_ALPHA_25:  P_VGA_BlendRowKeyedK(dst, src, len, VGA_ALPHA_25, VGA_BLEND_USE_DSP);  break;
+        case VGA_ALPHA_50:  P_VGA_BlendRowKeyedK(dst, src, len, VGA_ALPHA_50, VGA_BLEND_USE_DSP);  break;
+        case VGA_ALPHA_75:  P_VGA_BlendRowKeyedK(dst, src, len, VGA_ALPHA_75, VGA_BLEND_USE_DSP);  break;
+        case VGA_ALPHA_100: P_VGA_BlendRowKeyedK(dst, src, len, VGA_ALPHA_100, VGA_BLEND_USE_DSP); break;
+        default: break;
+    }
+}
+
+/**
+ * @brief P_VGA_BlendRowKeyed with the plain C kernels, for the benchmark.
+ */
+static void P_VGA_BlendRowKeyedC(uint8_t *dst, const uint8_t *src, uint32_t len, VGA_Alpha alpha)
+{
+    switch (alpha) {
+        case VGA_ALPHA_25:  P_VGA_BlendRowKeyedK(dst, src, len, VGA_ALPHA_25, false);  break;
+        case VGA_ALPHA_50:  P_VGA_BlendRowKeyedK(dst, src, len, VGA_ALPHA_50, false);  break;
+        case VGA_ALPHA_75:  P_VGA_BlendRowKeyedK(dst, src, len, VGA_ALPHA_75, false);  break;
+        case VGA_ALPHA_100: P_VGA_BlendRowKeyedK(dst, src, len, VGA_ALPHA_100, false); break;
+        default: break;
+    }
+}
+
+/**
+ * @brief Shortest time of a span kernel over the benchmark row.
+ */
+static uint32_t P_VGA_BenchSpan(void (*span)(uint8_t *, uint32_t, uint8_t, VGA_Alpha), VGA_Alpha alpha)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (uint32_t run = 0; run < VGA_BLEND_BENCH_RUNS; run++) {
+        uint32_t start = P_VGA_DWT_CYCCNT;
+        span((uint8_t *)blend_bench_dst, VGA_BLEND_BENCH_PIXELS, 0x5F, alpha);
+        uint32_t cycles = P_VGA_DWT_CYCCNT - start;
+        if (cycles < best) best = cycles;
+    }
+    return best;
+}
+
+/**
+ * @brief Shortest time of a keyed row kernel over the benchmark row.
+ */
+static uint32_t P_VGA_BenchKeyed(void (*row)(uint8_t *, const uint8_t *, uint32_t, VGA_Alpha))
+{
+    uint32_t best = UINT32_MAX;
+
+    for (uint32_t run = 0; run < VGA_BLEND_BENCH_RUNS; run++) {
+        uint32_t start = P_VGA_DWT_CYCCNT;
+        row((uint8_t *)blend_bench_dst, (const uint8_t *)blend_bench_src, VGA_BLEND_BENCH_PIXELS, VGA_ALPHA_50);
+        uint32_t cycles = P_VGA_DWT_CYCCNT - start;
+        if (cycles < best) best = cycles;
+    }
+    return best;
+}
+
+/**
+ * @brief Blends a single pixel, respecting the clipping rectangle.
+ */
+static void P_VGA_BlendPixel(int32_t x, int32_t y, uint8_t color, VGA_Alpha alpha)
+{
+    if (x < VGA.clip_rect.x || y < VGA.clip_rect.y ||
+        x >= VGA.clip_rect.x + VGA.clip_rect.width ||
+        y >= VGA.clip_rect.y + VGA.clip_rect.height) {
+        return;
+    }
+    uint8_t *p = UB_VGA_SpanBegin(x, y, 1);
+    *p = UB_VGA_BlendColor(color, *p, alpha);
+    UB_VGA_SpanEnd();
+}
+
+/**
+ * @brief Blends a 1-pixel line using Bresenham's algorithm.
+ */
+static void P_VGA_BlendSinglePixelLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint8_t color, VGA_Alpha alpha)
+{
+    if (y1 == y2) {
+        UB_VGA_BlendHLine(x1, y1, x2, color, alpha);
+        return;
+    }
+
+    int32_t dx = abs(x2 - x1);
+    int32_t sx = x1 < x2 ? 1 : -1;
+    int32_t dy = -abs(y2 - y1);
+    int32_t sy = y1 < y2 ? 1 : -1;
+    int32_t err = dx + dy;
+    int32_t e2;
+
+    for (;;) {
+        P_VGA_BlendPixel(x1, y1, color, alpha);
+        if (x1 == x2 && y1 == y2) break;
+        e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x1 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------
+// Public functions
+//--------------------------------------------------------------
+
+/**
+ * @brief Blends two R3G3B2 colors.
+ */
+uint8_t UB_VGA_BlendColor(uint8_t src, uint8_t dst, VGA_Alpha alpha)
+{
+    return (uint8_t)P_VGA_Blend4(src, dst, alpha, VGA_BLEND_USE_DSP);
+}
+
+/**
+ * @brief Blends a horizontal span with a color, respecting the clipping rectangle.
+ */
+VGA_Status UB_VGA_BlendHLine(int32_t x0, int32_t y, int32_t x1, uint8_t color, VGA_Alpha alpha)
+{
+    if (alpha > VGA_ALPHA_100) return VGA_ERROR_INVALID_PARAMETER;
+    if (y < VGA.clip_rect.y || y >= (VGA.clip_rect.y + VGA.clip_rect.height)) return VGA_SUCCESS;
+
+    int32_t start_x = max(min(x0, x1), VGA.clip_rect.x);
+    int32_t end_x = min(max(x0, x1), VGA.clip_rect.x + VGA.clip_rect.width - 1);
+
+    if (start_x > end_x) return VGA_SUCCESS;
+
+    P_VGA_BlendSpan(UB_VGA_SpanBegin(start_x, y, end_x - start_x + 1), end_x - start_x + 1, color, alpha);
+    UB_VGA_SpanEnd();
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws a translucent rectangle.
+ */
+VGA_Status UB_VGA_BlendRectangle(uint16_t x_lup, uint16_t y_lup, uint16_t width, uint16_t height, uint8_t color, uint8_t filled, VGA_Alpha alpha)
+{
+    if (width == 0 || height == 0 || alpha > VGA_ALPHA_100) return VGA_ERROR_INVALID_PARAMETER;
+
+    int32_t x2 = x_lup + width - 1;
+    int32_t y2 = y_lup + height - 1;
+
+    if (x2 >= VGA_DISPLAY_X || y2 >= VGA_DISPLAY_Y) return VGA_ERROR_INVALID_COORDINATE;
+
+    if (filled) {
+        for (int32_t y = y_lup; y <= y2; y++) {
+            UB_VGA_BlendHLine(x_lup, y, x2, color, alpha);
+        }
+    } else {
+        // Top and bottom span the full width; the sides skip the corner
+        // pixels so that no pixel is blended twice.
+        UB_VGA_BlendHLine(x_lup, y_lup, x2, color, alpha);
+        if (y2 != y_lup) UB_VGA_BlendHLine(x_lup, y2, x2, color, alpha);
+        for (int32_t y = y_lup + 1; y < y2; y++) {
+            P_VGA_BlendPixel(x_lup, y, color, alpha);
+            if (x2 != x_lup) P_VGA_BlendPixel(x2, y, color, alpha);
+        }
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws a translucent line.
+ * @details A thick line covers the same pixels as UB_VGA_DrawLine: a filled
+ *          circle of radius thickness / 2 on every Bresenham point. The
+ *          circles are not blended one by one, which would blend their
+ *          overlap several times; each row first collects the union of its
+ *          circle spans, which is one span because every circle span holds
+ *          its center and the centers move by at most one column, and then
+ *          blends that span once.
+ */
+VGA_Status UB_VGA_BlendLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t color, uint8_t thickness, VGA_Alpha alpha)
+{
+    if (thickness == 0 || alpha > VGA_ALPHA_100) return VGA_ERROR_INVALID_PARAMETER;
+    if (thickness == 1) {
+        P_VGA_BlendSinglePixelLine(x1, y1, x2, y2, color, alpha);
+        return VGA_SUCCESS;
+    }
+
+    int32_t r = thickness / 2;
+    uint8_t half_width[128];
+    P_VGA_CircleHalfWidths(r, half_width);
+
+    // Rows on screen that the line can reach
+    int32_t top = max(min((int32_t)y1, (int32_t)y2) - r, 0);
+    int32_t bottom = min(max((int32_t)y1, (int32_t)y2) + r, VGA_DISPLAY_Y - 1);
+    if (top > bottom) return VGA_SUCCESS;
+    for (int32_t y = top; y <= bottom; y++) {
+        blend_line_left[y] = INT16_MAX;
+        blend_line_right[y] = INT16_MIN;
+    }
+
+    int32_t dx = abs(x2 - x1);
+    int32_t sx = x1 < x2 ? 1 : -1;
+    int32_t dy = -abs(y2 - y1);
+    int32_t sy = y1 < y2 ? 1 : -1;
+    int32_t err = dx + dy;
+    int32_t e2;
+    int32_t x = x1;
+    int32_t y = y1;
+
+    for (;;) {
+        // Columns outside the screen are kept at -1 and VGA_MAX_DISPLAY_X,
+        // so they fit the int16_t spans; the clip removes them
+        int32_t from = max(y - r, top);
+        int32_t to = min(y + r, bottom);
+        for (int32_t row = from; row <= to; row++) {
+            int32_t w = half_width[abs(row - y)];
+            int32_t left = max(x - w, -1);
+            int32_t right = min(x + w, VGA_MAX_DISPLAY_X);
+            if (left < blend_line_left[row]) blend_line_left[row] = (int16_t)left;
+            if (right > blend_line_right[row]) blend_line_right[row] = (int16_t)right;
+        }
+        if (x == x2 && y == y2) break;
+        e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+
+    for (int32_t row = top; row <= bottom; row++) {
+        if (blend_line_left[row] <= blend_line_right[row]) {
+            UB_VGA_BlendHLine(blend_line_left[row], row, blend_line_right[row], color, alpha);
+        }
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws a pre-defined bitmap with translucency.
+ */
+VGA_Status UB_VGA_BlendBitmap(uint8_t id, uint16_t x_lup, uint16_t y_lup, VGA_Alpha alpha)
+{
+    if (id >= NUM_BITMAPS || alpha > VGA_ALPHA_100) {
+        return VGA_ERROR_INVALID_PARAMETER;
+    }
+
+    const Bitmap_t *bitmap = &vga_bitmaps[id];
+
+    // Clip the bitmap against the clipping rectangle once, then blend whole rows.
+    int32_t x_start = max((int32_t)x_lup, VGA.clip_rect.x);
+    int32_t x_end = min((int32_t)x_lup + bitmap->width, VGA.clip_rect.x + VGA.clip_rect.width);
+    int32_t y_start = max((int32_t)y_lup, VGA.clip_rect.y);
+    int32_t y_end = min((int32_t)y_lup + bitmap->height, VGA.clip_rect.y + VGA.clip_rect.height);
+
+    if (x_start >= x_end || y_start >= y_end) return VGA_SUCCESS;
+
+    for (int32_t y = y_start; y < y_end; y++) {
+        P_VGA_BlendRowKeyed(UB_VGA_SpanBegin(x_start, y, x_end - x_start),
+                            &bitmap->data[y - y_lup][x_start - x_lup],
+                            x_end - x_start, alpha);
+        UB_VGA_SpanEnd();
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Times the blend kernels against their plain C versions.
+ */
+VGA_Status UB_VGA_BlendBenchmark(VGA_BlendBench *bench)
+{
+    if (bench == NULL) return VGA_ERROR_INVALID_PARAMETER;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    P_VGA_DWT_CTRL |= P_VGA_DWT_CTRL_CYCCNTENA;
+
+    // A busy background, and a bitmap row with a transparent pixel in
+    // every word, so the keyed kernel has to merge each word
+    uint8_t *dst = (uint8_t *)blend_bench_dst;
+    uint8_t *src = (uint8_t *)blend_bench_src;
+    for (uint32_t i = 0; i < VGA_BLEND_BENCH_PIXELS; i++) {
+        dst[i] = (uint8_t)(i * 37u);
+        src[i] = (i % 4u == 1u) ? BITMAP_TRANSPARENT_COLOR : (uint8_t)(i * 11u);
+    }
+
+    memset(bench, 0, sizeof(*bench));
+    for (uint32_t level = 0; level < 3; level++) {
+        VGA_Alpha alpha = (VGA_Alpha)(VGA_ALPHA_25 + level);
+#if VGA_BLEND_USE_DSP
+        bench->span_simd[level] = P_VGA_BenchSpan(P_VGA_BlendSpan, alpha);
+#endif
+        bench->span_c[level] = P_VGA_BenchSpan(P_VGA_BlendSpanC, alpha);
+    }
+#if VGA_BLEND_USE_DSP
+    bench->keyed_simd = P_VGA_BenchKeyed(P_VGA_BlendRowKeyed);
+#endif
+    bench->keyed_c = P_VGA_BenchKeyed(P_VGA_BlendRowKeyedC);
+    return VGA_SUCCESS;
+}
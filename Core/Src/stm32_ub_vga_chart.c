@@ -0,0 +1,138 @@
+/**
+ * @file    stm32_ub_vga_chart.c
+ * @brief   Implementation of the strip charts.
+ *
+ * @details The chart is a sweep display with a circular write column, as
+ *          on a patient monitor: new samples are written left to right and
+ *          wrap around to the left edge, overwriting the oldest ones. The
+ *          screen contents never move, so nothing is copied. A sample is
+ *          drawn in its own column as a vertical span from the row of the
+ *          previous sample to the row of the new one, which keeps the trace
+ *          connected however steep it is. Before that, the column
+ *          VGA_CHART_GAP ahead is erased (and its grid redrawn), so every
+ *          column is clean by the time the sweep reaches it.
+ *
+ *          Scrolling the whole chart by one column per sample would keep
+ *          the newest sample at the right edge, but costs a copy of the
+ *          whole area per sample; the sweep costs one erase and one span per
+ *          channel.
+ *
+ *          Values are mapped to rows with a 16.16 scale factor computed once
+ *          in UB_VGA_ChartInit, so appending needs no division.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_chart.h"
+#include <stddef.h>
+
+#define max(a,b) ((a) > (b) ? (a) : (b))
+#define min(a,b) ((a) < (b) ? (a) : (b))
+
+
+/**
+ * @brief Erases one column of the chart and redraws its grid.
+ */
+static void P_VGA_ChartEraseColumn(const VGA_Chart *chart, uint16_t column)
+{
+    int32_t x = chart->x + column;
+    int32_t top = chart->y;
+    int32_t bottom = chart->y + chart->height - 1;
+
+    if (chart->grid_spacing != 0 && column % chart->grid_spacing == 0) {
+        UB_VGA_FastVLine(x, top, bottom, chart->grid_color);
+        return;
+    }
+    UB_VGA_FastVLine(x, top, bottom, chart->background);
+    if (chart->grid_spacing != 0) {
+        for (int32_t y = bottom; y >= top; y -= chart->grid_spacing) {
+            UB_VGA_SetPixel(x, y, chart->grid_color);
+        }
+    }
+}
+
+/**
+ * @brief Sets up a strip chart and clears its rectangle.
+ */
+VGA_Status UB_VGA_ChartInit(VGA_Chart *chart, int16_t x, int16_t y, uint16_t width, uint16_t height,
+                            int16_t min, int16_t max, uint8_t channels, const uint8_t *colors, uint8_t background)
+{
+    if (chart == NULL || colors == NULL) return VGA_ERROR_INVALID_PARAMETER;
+    if (channels == 0 || channels > VGA_CHART_MAX_CHANNELS) return VGA_ERROR_INVALID_PARAMETER;
+    if (width <= VGA_CHART_GAP || height < 2 || min >= max) return VGA_ERROR_INVALID_PARAMETER;
+    if (x < 0 || y < 0 || x + width > VGA_DISPLAY_X || y + height > VGA_DISPLAY_Y) return VGA_ERROR_INVALID_COORDINATE;
+
+    chart->x = x;
+    chart->y = y;
+    chart->width = width;
+    chart->height = height;
+    chart->min = min;
+    chart->range = (uint16_t)(max - min);
+    chart->scale = ((uint32_t)(height - 1) << 16) / chart->range;
+    chart->channels = channels;
+    for (uint8_t i = 0; i < channels; i++) {
+        chart->colors[i] = colors[i];
+    }
+    chart->background = background;
+    chart->grid_color = background;
+    chart->grid_spacing = 0;
+    return UB_VGA_ChartClear(chart);
+}
+
+/**
+ * @brief Sets the grid of a chart and clears the chart.
+ */
+VGA_Status UB_VGA_ChartSetGrid(VGA_Chart *chart, uint8_t spacing, uint8_t color)
+{
+    if (chart == NULL || chart->width == 0) return VGA_ERROR_INVALID_PARAMETER;
+
+    chart->grid_spacing = spacing;
+    chart->grid_color = color;
+    return UB_VGA_ChartClear(chart);
+}
+
+/**
+ * @brief Clears the chart and restarts the sweep at the left column.
+ */
+VGA_Status UB_VGA_ChartClear(VGA_Chart *chart)
+{
+    if (chart == NULL || chart->width == 0) return VGA_ERROR_INVALID_PARAMETER;
+
+    for (uint16_t col = 0; col < chart->width; col++) {
+        P_VGA_ChartEraseColumn(chart, col);
+    }
+    for (uint8_t i = 0; i < VGA_CHART_MAX_CHANNELS; i++) {
+        chart->last[i] = -1;
+    }
+    chart->column = 0;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Appends one sample per channel.
+ */
+VGA_Status UB_VGA_ChartAppend(VGA_Chart *chart, const int16_t *values)
+{
+    if (chart == NULL || values == NULL || chart->width == 0) return VGA_ERROR_INVALID_PARAMETER;
+
+    uint16_t ahead = chart->column + VGA_CHART_GAP;
+    if (ahead >= chart->width) ahead -= chart->width;
+    P_VGA_ChartEraseColumn(chart, ahead);
+
+    int32_t x = chart->x + chart->column;
+    int32_t bottom = chart->y + chart->height - 1;
+    for (uint8_t i = 0; i < chart->channels; i++) {
+        int32_t v = max(0, min((int32_t)values[i] - chart->min, (int32_t)chart->range));
+        int32_t row = bottom - (int32_t)((v * chart->scale + 0x8000) >> 16);
+        int32_t prev = (chart->last[i] < 0) ? row : chart->last[i];
+        UB_VGA_FastVLine(x, min(prev, row), max(prev, row), chart->colors[i]);
+        chart->last[i] = row;
+    }
+
+    if (++chart->column == chart->width) chart->column = 0;
+    return VGA_SUCCESS;
+}
@@ -0,0 +1,488 @@
+/**
+ * @file    stm32_ub_vga_displaylist.c
+ * @brief   Implementation of the display list renderer.
+ *
+ * @details The list is a line renderer (see UB_VGA_SetLineRenderer): the
+ *          scanout interrupt calls P_VGA_ListRender for every row, about one
+ *          line before the row is sent, with the line buffer to fill.
+ *
+ *          Items are kept in the order they were added, which is the order
+ *          they are drawn in, plus an index sorted by first row. Walking down
+ *          the screen, an item joins the active set on its first row and
+ *          leaves it after its last, so a row only looks at the items that
+ *          cover it, not at the whole list. The active set stays sorted by
+ *          list position, so later items still cover earlier ones.
+ *
+ *          Every item computes its span(s) on a row from the row number
+ *          alone, without state carried over from the row above: a line from
+ *          its slope in 16.16 fixed point, a circle from an integer square
+ *          root. An item that is skipped on one row is therefore drawn
+ *          correctly on the next.
+ *
+ *          There are two lists: the one on screen, which only the interrupt
+ *          reads, and the one being built. UB_VGA_ListEnd hands the new list
+ *          to the interrupt, which takes it at the start of a frame, so a
+ *          frame never shows half of a list.
+ *
+ *          The DWT cycle counter measures every row against the budget; once
+ *          it is used up, the remaining items of the row are left out.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_displaylist.h"
+#include "stm32_ub_vga_private.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if VGA_LIST_MAX_ITEMS > 255
+#error "VGA_LIST_MAX_ITEMS must fit in the uint8_t indices of the list"
+#endif
+
+typedef enum {
+    P_VGA_ITEM_RECTANGLE,
+    P_VGA_ITEM_LINE,
+    P_VGA_ITEM_CIRCLE
+} P_VGA_ItemType;
+
+/**
+ * @brief One item of a display list.
+ */
+typedef struct {
+    int32_t top;            /*!< First row */
+    int32_t bottom;         /*!< Last row */
+    int32_t step;           /*!< Line: x per row (16.16); circle: center row */
+    int16_t x0;             /*!< Rectangle: first column; line: x on the first row; circle: center column */
+    int16_t x1;             /*!< Rectangle: last column; line: x on the last row; circle: radius */
+    uint16_t thickness;     /*!< Rectangle, circle: border width, 0 for filled */
+    uint8_t type;           /*!< P_VGA_ItemType */
+    uint8_t color;          /*!< R3G3B2 */
+} P_VGA_ListItem;
+
+/**
+ * @brief A display list.
+ */
+typedef struct {
+    P_VGA_ListItem items[VGA_LIST_MAX_ITEMS];   /*!< In drawing order */
+    uint8_t order[VGA_LIST_MAX_ITEMS];          /*!< Item indices sorted by first row */
+    uint16_t count;                             /*!< Number of items */
+    uint8_t background;                         /*!< Color where no item is drawn */
+} P_VGA_List;
+
+static P_VGA_List P_VGA_Lists[2];
+
+/**
+ * @brief The list on screen, the list handed to the interrupt, and the list being built.
+ * @details UB_VGA_ListEnd sets P_VGA_ListQueued; the interrupt moves it to
+ *          P_VGA_ListShow on row 0 and clears it.
+ */
+static P_VGA_List * volatile P_VGA_ListShow = &P_VGA_Lists[0];
+static P_VGA_List * volatile P_VGA_ListQueued = NULL;
+static P_VGA_List *P_VGA_ListBuild = &P_VGA_Lists[1];
+
+// State of the interrupt within a frame: the next entry of order[] to
+// activate, and the active items in list order
+static uint16_t P_VGA_ListSorted = 0;
+static uint8_t P_VGA_ListActiveItems[VGA_LIST_MAX_ITEMS];
+static uint16_t P_VGA_ListActiveCount = 0;
+static uint32_t P_VGA_ListBudget = 0;
+
+static uint8_t P_VGA_ListBudgetPercent = VGA_LIST_BUDGET_PERCENT;
+
+// Counters of UB_VGA_GetListStats
+static volatile uint32_t P_VGA_ListLines = 0;
+static volatile uint32_t P_VGA_ListLate = 0;
+static volatile uint32_t P_VGA_ListSkipped = 0;
+static volatile uint32_t P_VGA_ListMaxCycles = 0;
+static volatile uint64_t P_VGA_ListTotalCycles = 0;
+static volatile uint16_t P_VGA_ListMaxActive = 0;
+
+
+/**
+ * @brief Integer square root, rounded down.
+ */
+static uint32_t P_VGA_ListSqrt(uint32_t v)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > v) bit >>= 2;
+    while (bit != 0) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/**
+ * @brief Fills the pixels x0 to x1 of a line, clipped to the screen.
+ */
+static inline void P_VGA_ListSpan(uint8_t *line, int32_t width, int32_t x0, int32_t x1, uint8_t color)
+{
+    if (x0 < 0) x0 = 0;
+    if (x1 >= width) x1 = width - 1;
+    if (x0 <= x1) memset(&line[x0], color, x1 - x0 + 1);
+}
+
+/**
+ * @brief Draws the span(s) of one item on a row it covers.
+ */
+static void P_VGA_ListDrawItem(uint8_t *line, int32_t width, const P_VGA_ListItem *item, int32_t row)
+{
+    int32_t t = item->thickness;
+
+    switch (item->type) {
+    case P_VGA_ITEM_RECTANGLE:
+        if (t == 0 || row < item->top + t || row > item->bottom - t) {
+            P_VGA_ListSpan(line, width, item->x0, item->x1, item->color);
+        }
+        else {
+            P_VGA_ListSpan(line, width, item->x0, item->x0 + t - 1, item->color);
+            P_VGA_ListSpan(line, width, item->x1 - t + 1, item->x1, item->color);
+        }
+        break;
+
+    case P_VGA_ITEM_LINE: {
+        // The row takes the columns whose centers lie within half a row of
+        // it along the line, measured from x0; a steep line that has no such
+        // column on this row gets the column nearest to it
+        int32_t k = row - item->top;
+        int64_t s = llabs((int64_t)item->step);
+        int32_t near = (k == 0) ? 0 : (int32_t)(((2 * k - 1) * s / 2 + 0xFFFF) >> 16);
+        int32_t far = (row == item->bottom) ? abs(item->x1 - item->x0)
+                                            : (int32_t)(((2 * k + 1) * s / 2 + 0xFFFF) >> 16) - 1;
+        if (far < near) {
+            near = (int32_t)((k * s + 0x8000) >> 16);
+            far = near;
+        }
+        if (item->step >= 0) {
+            P_VGA_ListSpan(line, width, item->x0 + near, item->x0 + far, item->color);
+        }
+        else {
+            P_VGA_ListSpan(line, width, item->x0 - far, item->x0 - near, item->color);
+        }
+        break;
+    }
+
+    case P_VGA_ITEM_CIRCLE: {
+        // Half widths of the outer circle and of the circle inside the ring
+        int32_t r = item->x1;
+        int32_t dy = row - item->step;
+        int32_t outer = (int32_t)P_VGA_ListSqrt((uint32_t)(r * r - dy * dy));
+        int32_t inner_r = r - t;
+        if (t == 0 || abs(dy) > inner_r) {
+            P_VGA_ListSpan(line, width, item->x0 - outer, item->x0 + outer, item->color);
+        }
+        else {
+            int32_t inner = (int32_t)P_VGA_ListSqrt((uint32_t)(inner_r * inner_r - dy * dy));
+            P_VGA_ListSpan(line, width, item->x0 - outer, item->x0 - inner - 1, item->color);
+            P_VGA_ListSpan(line, width, item->x0 + inner + 1, item->x0 + outer, item->color);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Restarts the walk down the screen and sets the budget of a row.
+ */
+static void P_VGA_ListWalkReset(void)
+{
+    P_VGA_ListSorted = 0;
+    P_VGA_ListActiveCount = 0;
+    P_VGA_ListBudget = (uint32_t)VGA.mode->h_total * P_VGA_HCLK_PER_TICK * P_VGA_ListBudgetPercent / 100;
+}
+
+/**
+ * @brief Takes a queued list and restarts the walk down the screen.
+ */
+static void P_VGA_ListFrameStart(void)
+{
+    if (P_VGA_ListQueued != NULL) {
+        P_VGA_ListShow = P_VGA_ListQueued;
+        P_VGA_ListQueued = NULL;
+    }
+    P_VGA_ListWalkReset();
+}
+
+/**
+ * @brief   Draws one row of the list on screen (the line renderer).
+ * @details Runs in the scanout interrupt. Rows come in order from 0.
+ */
+static void P_VGA_ListRender(uint8_t *line, uint16_t row)
+{
+    uint32_t start = P_VGA_DWT_CYCCNT;
+
+    if (row == 0) P_VGA_ListFrameStart();
+
+    const P_VGA_List *list = P_VGA_ListShow;
+    const int32_t width = VGA_DISPLAY_X;
+
+    // Items starting on this row join the active set, in list order
+    while (P_VGA_ListSorted < list->count) {
+        uint8_t index = list->order[P_VGA_ListSorted];
+        if (list->items[index].top > row) break;
+        uint32_t n = P_VGA_ListActiveCount;
+        while (n > 0 && P_VGA_ListActiveItems[n - 1] > index) {
+            P_VGA_ListActiveItems[n] = P_VGA_ListActiveItems[n - 1];
+            n--;
+        }
+        P_VGA_ListActiveItems[n] = index;
+        P_VGA_ListActiveCount++;
+        P_VGA_ListSorted++;
+    }
+
+    memset(line, list->background, width);
+
+    // Draw the active items and drop the ones that ended on an earlier row.
+    // Once the budget is used up the rest of the row is left out.
+    uint32_t kept = 0;
+    uint32_t skipped = 0;
+    for (uint32_t i = 0; i < P_VGA_ListActiveCount; i++) {
+        uint8_t index = P_VGA_ListActiveItems[i];
+        const P_VGA_ListItem *item = &list->items[index];
+        if (item->bottom < row) continue;
+        P_VGA_ListActiveItems[kept++] = index;
+        if (skipped != 0 || P_VGA_DWT_CYCCNT - start > P_VGA_ListBudget) {
+            skipped++;
+            continue;
+        }
+        P_VGA_ListDrawItem(line, width, item, row);
+    }
+    P_VGA_ListActiveCount = kept;
+
+    uint32_t cycles = P_VGA_DWT_CYCCNT - start;
+    P_VGA_ListLines++;
+    P_VGA_ListTotalCycles += cycles;
+    if (cycles > P_VGA_ListMaxCycles) P_VGA_ListMaxCycles = cycles;
+    if (kept > P_VGA_ListMaxActive) P_VGA_ListMaxActive = kept;
+    if (skipped != 0) {
+        P_VGA_ListLate++;
+        P_VGA_ListSkipped += skipped;
+    }
+}
+
+/**
+ * @brief Sorts the row index of a list by first row, keeping the list order of equal rows.
+ */
+static void P_VGA_ListSort(P_VGA_List *list)
+{
+    for (uint32_t i = 1; i < list->count; i++) {
+        uint8_t index = list->order[i];
+        int32_t top = list->items[index].top;
+        uint32_t n = i;
+        while (n > 0 && list->items[list->order[n - 1]].top > top) {
+            list->order[n] = list->order[n - 1];
+            n--;
+        }
+        list->order[n] = index;
+    }
+}
+
+/**
+ * @brief Appends an item to the list being built.
+ * @return The new item, or NULL when the list is full.
+ */
+static P_VGA_ListItem *P_VGA_ListAdd(uint8_t type, uint8_t color, int32_t top, int32_t bottom)
+{
+    P_VGA_List *list = P_VGA_ListBuild;
+    if (list->count >= VGA_LIST_MAX_ITEMS) return NULL;
+
+    P_VGA_ListItem *item = &list->items[list->count];
+    item->type = type;
+    item->color = color;
+    item->top = top;
+    item->bottom = bottom;
+    item->step = 0;
+    item->thickness = 0;
+    list->order[list->count] = (uint8_t)list->count;
+    list->count++;
+    return item;
+}
+
+/**
+ * @brief Shows the display list instead of the framebuffer.
+ */
+VGA_Status UB_VGA_ListStart(void)
+{
+    // Start the cycle counter for the budget
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    P_VGA_DWT_CTRL |= P_VGA_DWT_CTRL_CYCCNTENA;
+
+    if (UB_VGA_ListActive()) return VGA_SUCCESS;
+
+    // The renderer may start in the middle of a frame: its first row must
+    // not see the walk of an earlier session or a budget of 0
+    P_VGA_ListWalkReset();
+    return UB_VGA_SetLineRenderer(P_VGA_ListRender);
+}
+
+/**
+ * @brief Shows the framebuffer again.
+ */
+VGA_Status UB_VGA_ListStop(void)
+{
+    if (!UB_VGA_ListActive()) return VGA_SUCCESS;
+    return UB_VGA_SetLineRenderer(NULL);
+}
+
+/**
+ * @brief Tells whether the display list is shown.
+ */
+bool UB_VGA_ListActive(void)
+{
+    return UB_VGA_GetLineRenderer() == P_VGA_ListRender;
+}
+
+/**
+ * @brief Starts a new list, off screen.
+ */
+void UB_VGA_ListBegin(uint8_t background)
+{
+    P_VGA_ListBuild->count = 0;
+    P_VGA_ListBuild->background = background;
+}
+
+/**
+ * @brief Adds a rectangle to the new list.
+ */
+VGA_Status UB_VGA_ListAddRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color, uint16_t thickness)
+{
+    if (width == 0 || height == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if (x + width - 1 > INT16_MAX) return VGA_ERROR_INVALID_COORDINATE;
+
+    P_VGA_ListItem *item = P_VGA_ListAdd(P_VGA_ITEM_RECTANGLE, color, y, y + height - 1);
+    if (item == NULL) return VGA_ERROR_OUT_OF_MEMORY;
+    item->x0 = x;
+    item->x1 = (int16_t)(x + width - 1);
+    item->thickness = thickness;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Adds a line of one pixel wide to the new list.
+ */
+VGA_Status UB_VGA_ListAddLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color)
+{
+    // Walk from the upper end down; a horizontal line from left to right
+    if (y2 < y1 || (y2 == y1 && x2 < x1)) {
+        int16_t t = x1; x1 = x2; x2 = t;
+        t = y1; y1 = y2; y2 = t;
+    }
+
+    P_VGA_ListItem *item = P_VGA_ListAdd(P_VGA_ITEM_LINE, color, y1, y2);
+    if (item == NULL) return VGA_ERROR_OUT_OF_MEMORY;
+    item->x0 = x1;
+    item->x1 = x2;
+    if (y2 != y1) {
+        int64_t step = (int64_t)(x2 - x1) * 65536 / (y2 - y1);
+        item->step = (int32_t)((step > INT32_MAX) ? INT32_MAX : (step < -INT32_MAX) ? -INT32_MAX : step);
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Adds a circle to the new list.
+ */
+VGA_Status UB_VGA_ListAddCircle(int16_t center_x, int16_t center_y, uint16_t radius, uint8_t color, uint16_t thickness)
+{
+    if (radius > INT16_MAX) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_ListItem *item = P_VGA_ListAdd(P_VGA_ITEM_CIRCLE, color, center_y - radius, center_y + radius);
+    if (item == NULL) return VGA_ERROR_OUT_OF_MEMORY;
+    item->x0 = center_x;
+    item->x1 = (int16_t)radius;
+    item->step = center_y;
+    item->thickness = thickness;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Shows the new list from the next frame on.
+ */
+VGA_Status UB_VGA_ListEnd(bool keep)
+{
+    P_VGA_List *list = P_VGA_ListBuild;
+    P_VGA_List *old = P_VGA_ListShow;
+
+    P_VGA_ListSort(list);
+
+    // Without the interrupt drawing the list, it is shown at once
+    if (UB_VGA_ListActive() && UB_VGA_IsRunning()) {
+        P_VGA_ListQueued = list;
+        while (P_VGA_ListQueued != NULL && UB_VGA_ListActive() && UB_VGA_IsRunning()) {
+        }
+    }
+    P_VGA_ListQueued = NULL;
+    P_VGA_ListShow = list;
+
+    // The old list is no longer read and becomes the next one
+    P_VGA_ListBuild = old;
+    old->background = list->background;
+    old->count = keep ? list->count : 0;
+    if (keep) {
+        memcpy(old->items, list->items, list->count * sizeof(P_VGA_ListItem));
+        memcpy(old->order, list->order, list->count);
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Sets the cycle budget of a row.
+ */
+VGA_Status UB_VGA_SetListBudget(uint8_t percent)
+{
+    if (percent == 0 || percent > 100) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_ListBudgetPercent = percent;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Returns the counters of the rasterisation.
+ */
+void UB_VGA_GetListStats(VGA_ListStats *stats)
+{
+    if (stats == NULL) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stats->lines = P_VGA_ListLines;
+    stats->late_lines = P_VGA_ListLate;
+    stats->skipped = P_VGA_ListSkipped;
+    stats->max_cycles = P_VGA_ListMaxCycles;
+    stats->avg_cycles = (P_VGA_ListLines != 0) ? (uint32_t)(P_VGA_ListTotalCycles / P_VGA_ListLines) : 0;
+    stats->max_active = P_VGA_ListMaxActive;
+    stats->items = P_VGA_ListShow->count;
+    __set_PRIMASK(primask);
+    stats->budget_cycles = (uint32_t)VGA.mode->h_total * P_VGA_HCLK_PER_TICK * P_VGA_ListBudgetPercent / 100;
+}
+
+/**
+ * @brief Clears the counters of the rasterisation.
+ */
+void UB_VGA_ResetListStats(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    P_VGA_ListLines = 0;
+    P_VGA_ListLate = 0;
+    P_VGA_ListSkipped = 0;
+    P_VGA_ListMaxCycles = 0;
+    P_VGA_ListTotalCycles = 0;
+    P_VGA_ListMaxActive = 0;
+    __set_PRIMASK(primask);
+}
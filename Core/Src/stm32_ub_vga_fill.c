@@ -0,0 +1,630 @@
+/**
+ * @file    stm32_ub_vga_fill.c
+ * @brief   Implementation of the region fills.
+ *
+ * @details The flood fill is a span seed fill (after Heckbert, "A Seed Fill
+ *          Algorithm", Graphics Gems I). A stack entry is a span that has
+ *          just been filled plus the direction of the neighbouring row that
+ *          still has to be scanned. Popping an entry scans that row below
+ *          the span, fills every run found there in one write, and pushes
+ *          the new runs. Each pixel is read a small, bounded number of times
+ *          and written once.
+ *
+ *          The stack has a fixed size. When it is full, the span that
+ *          could not be pushed is repainted in a marker color that does not
+ *          occur on screen. After the stack is empty, the screen is swept
+ *          up and down, growing the marked spans into touching runs of the
+ *          old color until nothing changes, and the marker is replaced by
+ *          the fill color. This is slower but gives the same result.
+ *          The fill compares stored values (see UB_VGA_ColorValue), so in
+ *          the 4 bpp modes it works on palette indices and the marker is an
+ *          unused index.
+ *
+ *          Gradients keep each color field in 16.16 fixed point, in units
+ *          of one output level, and round it with the Bayer threshold of
+ *          the pixel. Whatever the stride of a scanline (321 bytes in the
+ *          default mode), the word alignment of a column repeats every four
+ *          scanlines, as does the Bayer pattern, so precomputed rows can be
+ *          copied with aligned word loads and stores. In the 4 bpp modes
+ *          the spans are written through UB_VGA_SpanBegin/UB_VGA_SpanEnd.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_fill.h"
+#include <stddef.h>
+
+#define max(a,b) ((a) > (b) ? (a) : (b))
+#define min(a,b) ((a) < (b) ? (a) : (b))
+
+//--------------------------------------------------------------
+/**
+ * @brief A filled span whose neighbouring row y + dy is still to be scanned.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    int16_t y;
+    int16_t x_left;
+    int16_t x_right;
+    int8_t  dy;
+} P_VGA_FloodSpan;
+
+//--------------------------------------------------------------
+/**
+ * @brief State of one flood fill.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    int32_t left, right, top, bottom; /*!< Clipping rectangle, inclusive */
+    uint8_t old_color;                /*!< Stored value of the region being filled */
+    uint8_t color;                    /*!< Stored value of the fill color */
+    uint8_t marker;                   /*!< Marker value after an overflow */
+    bool overflow;                    /*!< The stack has overflowed */
+    bool marker_ok;                   /*!< A marker color was found */
+    uint16_t sp;                      /*!< Number of entries on the stack */
+} P_VGA_Flood;
+
+//--------------------------------------------------------------
+/**
+ * @brief Visible part and color fields of a gradient.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    int32_t left, right, top, bottom; /*!< Visible rectangle, inclusive */
+    int32_t base[3];                  /*!< Fields of the first color, 16.16 */
+    int32_t delta[3];                 /*!< Second minus first color, 16.16 */
+} P_VGA_Grad;
+
+static P_VGA_FloodSpan flood_stack[VGA_FLOOD_STACK_SIZE];
+
+// One precomputed row per Bayer row, with room to match the word alignment of the screen
+static uint32_t gradient_rows[4][VGA_MAX_DISPLAY_X / 4 + 1];
+
+static const uint8_t grad_shift[3] = {5, 2, 0};
+static const uint8_t grad_mask[3]  = {7, 7, 3};
+
+static uint8_t pattern_table[VGA_PATTERN_COUNT][8] = {
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},   // Solid
+    {0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55},   // Checkerboard
+    {0xFF, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00},   // Horizontal hatch
+    {0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88},   // Vertical hatch
+    {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80},   // Diagonal hatch, rising
+    {0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01},   // Diagonal hatch, falling
+    {0xFF, 0x88, 0x88, 0x88, 0xFF, 0x88, 0x88, 0x88},   // Cross hatch
+    {0x88, 0x00, 0x22, 0x00, 0x88, 0x00, 0x22, 0x00}    // Dots
+};
+
+// Byte i is 0xFF when bit 3 - i of the index is set, so the leftmost pixel is the highest bit
+static const uint32_t nibble_mask[16] = {
+    0x00000000, 0xFF000000, 0x00FF0000, 0xFFFF0000,
+    0x0000FF00, 0xFF00FF00, 0x00FFFF00, 0xFFFFFF00,
+    0x000000FF, 0xFF0000FF, 0x00FF00FF, 0xFFFF00FF,
+    0x0000FFFF, 0xFF00FFFF, 0x00FFFFFF, 0xFFFFFFFF
+};
+
+const uint8_t VGA_BAYER_4X4[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5}
+};
+
+
+/**
+ * @brief Stored value of pixel x of a framebuffer line.
+ */
+static inline uint8_t P_VGA_RowValue(const uint8_t *row, int32_t x)
+{
+    if (VGA_INDEXED) return (row[x >> 1] >> ((~x & 1) << 2)) & 0x0F;
+    return row[x];
+}
+
+/**
+ * @brief Finds a stored value that does not occur anywhere on the screen.
+ * @details The old and the new value of the fill never count as unused: by
+ *          the time the stack overflows the old value may have left the
+ *          screen, and a marker equal to it would match itself in the sweep.
+ */
+static bool P_VGA_FindUnusedColor(uint8_t old, uint8_t color, uint8_t *unused)
+{
+    uint32_t seen[8] = {0};
+    seen[old >> 5] |= 1UL << (old & 31);
+    seen[color >> 5] |= 1UL << (color & 31);
+
+    for (int32_t y = 0; y < VGA_DISPLAY_Y; y++) {
+        const uint8_t *row = &VGA_FRAMEBUFFER[y * VGA_LINE_STRIDE];
+        for (int32_t x = 0; x < VGA_DISPLAY_X; x++) {
+            uint8_t v = P_VGA_RowValue(row, x);
+            seen[v >> 5] |= 1UL << (v & 31);
+        }
+    }
+    int32_t values = VGA_INDEXED ? VGA_PALETTE_SIZE : 256;
+    for (int32_t c = 0; c < values; c++) {
+        if (!(seen[c >> 5] & (1UL << (c & 31)))) {
+            *unused = (uint8_t)c;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Pushes a filled span; on overflow the span is marked for the sweep.
+ */
+static void P_VGA_FloodPush(P_VGA_Flood *f, int32_t y, int32_t x_left, int32_t x_right, int32_t dy)
+{
+    if (y + dy < f->top || y + dy > f->bottom) return;
+
+    if (f->sp < VGA_FLOOD_STACK_SIZE) {
+        P_VGA_FloodSpan *s = &flood_stack[f->sp++];
+        s->y = y;
+        s->x_left = x_left;
+        s->x_right = x_right;
+        s->dy = dy;
+        return;
+    }
+
+    if (!f->overflow) {
+        f->overflow = true;
+        f->marker_ok = P_VGA_FindUnusedColor(f->old_color, f->color, &f->marker);
+    }
+    if (f->marker_ok) UB_VGA_FillValues(x_left, y, x_right, f->marker);
+}
+
+/**
+ * @brief Grows the marked spans into the rest of the region.
+ */
+static void P_VGA_FloodSweep(const P_VGA_Flood *f)
+{
+    const uint8_t old = f->old_color;
+    const uint8_t marker = f->marker;
+    bool changed;
+
+    do {
+        changed = false;
+        // One pass down and one pass up, so growth in both directions is fast
+        for (uint8_t pass = 0; pass < 2; pass++) {
+            for (int32_t i = 0; i <= f->bottom - f->top; i++) {
+                int32_t y = (pass == 0) ? f->top + i : f->bottom - i;
+                const uint8_t *row = &VGA_FRAMEBUFFER[y * VGA_LINE_STRIDE];
+                const uint8_t *above = (y > f->top) ? row - VGA_LINE_STRIDE : NULL;
+                const uint8_t *below = (y < f->bottom) ? row + VGA_LINE_STRIDE : NULL;
+
+                int32_t x = f->left;
+                while (x <= f->right) {
+                    if (P_VGA_RowValue(row, x) != old) { x++; continue; }
+
+                    int32_t l = x;
+                    bool touches = false;
+                    for (; x <= f->right && P_VGA_RowValue(row, x) == old; x++) {
+                        if ((above && P_VGA_RowValue(above, x) == marker) ||
+                            (below && P_VGA_RowValue(below, x) == marker)) touches = true;
+                    }
+                    if (touches) {
+                        UB_VGA_FillValues(l, y, x - 1, marker);
+                        changed = true;
+                    }
+                }
+            }
+        }
+    } while (changed);
+
+    // Replace the marker by the fill color
+    for (int32_t y = f->top; y <= f->bottom; y++) {
+        const uint8_t *row = &VGA_FRAMEBUFFER[y * VGA_LINE_STRIDE];
+        int32_t x = f->left;
+        while (x <= f->right) {
+            if (P_VGA_RowValue(row, x) != marker) { x++; continue; }
+            int32_t l = x;
+            while (x <= f->right && P_VGA_RowValue(row, x) == marker) x++;
+            UB_VGA_FillValues(l, y, x - 1, f->color);
+        }
+    }
+}
+
+/**
+ * @brief Fills the 4-connected region around a pixel with a color.
+ */
+VGA_Status UB_VGA_FloodFill(uint16_t x, uint16_t y, uint8_t color)
+{
+    if (x >= VGA_DISPLAY_X || y >= VGA_DISPLAY_Y) return VGA_ERROR_INVALID_COORDINATE;
+
+    P_VGA_Flood f;
+    f.left = max(VGA.clip_rect.x, 0);
+    f.right = min(VGA.clip_rect.x + VGA.clip_rect.width, VGA_DISPLAY_X) - 1;
+    f.top = max(VGA.clip_rect.y, 0);
+    f.bottom = min(VGA.clip_rect.y + VGA.clip_rect.height, VGA_DISPLAY_Y) - 1;
+    if (x < f.left || x > f.right || y < f.top || y > f.bottom) return VGA_SUCCESS;
+
+    f.old_color = P_VGA_RowValue(&VGA_FRAMEBUFFER[y * VGA_LINE_STRIDE], x);
+    f.color = UB_VGA_ColorValue(color);
+    f.overflow = false;
+    f.marker_ok = false;
+    f.sp = 0;
+    if (f.old_color == f.color) return VGA_SUCCESS;
+
+    const uint8_t old = f.old_color;
+
+    // The seed row is scanned first (entry for row y + 1, looking up),
+    // the row below the seed last.
+    P_VGA_FloodPush(&f, y, x, x, 1);
+    P_VGA_FloodPush(&f, y + 1, x, x, -1);
+
+    while (f.sp > 0) {
+        P_VGA_FloodSpan s = flood_stack[--f.sp];
+        int32_t row_y = s.y + s.dy;
+        const uint8_t *row = &VGA_FRAMEBUFFER[row_y * VGA_LINE_STRIDE];
+
+        // Find the first run touching the parent span; it may start further left
+        int32_t px = s.x_left;
+        if (P_VGA_RowValue(row, px) == old) {
+            while (px > f.left && P_VGA_RowValue(row, px - 1) == old) px--;
+        } else {
+            px++;
+            while (px <= s.x_right && P_VGA_RowValue(row, px) != old) px++;
+        }
+
+        while (px <= s.x_right) {
+            int32_t l = px;
+            int32_t r = px;
+            while (r < f.right && P_VGA_RowValue(row, r + 1) == old) r++;
+
+            UB_VGA_FillValues(l, row_y, r, f.color);
+
+            P_VGA_FloodPush(&f, row_y, l, r, s.dy);
+            // Parts that stick out past the parent span also continue backwards
+            if (l < s.x_left) P_VGA_FloodPush(&f, row_y, l, s.x_left - 1, -s.dy);
+            if (r > s.x_right) P_VGA_FloodPush(&f, row_y, s.x_right + 1, r, -s.dy);
+
+            // Next run below the parent span; pixel r + 1 is a boundary
+            px = r + 2;
+            while (px <= s.x_right && P_VGA_RowValue(row, px) != old) px++;
+        }
+    }
+
+    if (f.overflow) {
+        if (!f.marker_ok) return VGA_ERROR_OUT_OF_MEMORY;
+        P_VGA_FloodSweep(&f);
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Rounding offsets 1 - (threshold + 0.5) / 16 of one scanline, in 16.16.
+ */
+static void P_VGA_DitherBias(int32_t *bias, int32_t y)
+{
+    for (uint8_t i = 0; i < 4; i++) {
+        bias[i] = 0x10000 - (2 * VGA_BAYER_4X4[y & 3][i] + 1) * 0x800;
+    }
+}
+
+/**
+ * @brief Rounds the three fields of a pixel to an R3G3B2 color.
+ */
+static inline uint8_t P_VGA_DitherPixel(const int32_t *val, int32_t bias)
+{
+    return (uint8_t)((((val[0] + bias) >> 16) << 5) | (((val[1] + bias) >> 16) << 2) | ((val[2] + bias) >> 16));
+}
+
+/**
+ * @brief Integer square root, rounded down.
+ */
+static uint32_t P_VGA_Sqrt(uint32_t n)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > n) bit >>= 2;
+    while (bit != 0) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/**
+ * @brief Writes a repeating 8-pixel pattern to the pixels x0..x1 of a scanline.
+ * @details Bytes up to the first word boundary are written one at a time,
+ *          then two aligned words per period, then the rest. Pixels whose
+ *          mask byte is 0 keep their color.
+ * @param colors Byte i holds the color of the pixels with x & 7 == i.
+ * @param mask Byte i is 0xFF where the pattern is drawn and 0x00 where it is transparent.
+ */
+static void P_VGA_PatternSpan(int32_t x0, int32_t x1, int32_t y, uint64_t colors, uint64_t mask)
+{
+    uint32_t len = x1 - x0 + 1;
+    uint8_t *dst = UB_VGA_SpanBegin(x0, y, len);
+    int32_t x = x0;
+
+    while (len > 0 && ((uintptr_t)dst & 3u) != 0) {
+        uint32_t shift = 8 * (x & 7);
+        if ((uint8_t)(mask >> shift)) *dst = (uint8_t)(colors >> shift);
+        dst++;
+        x++;
+        len--;
+    }
+
+    // Rotate the pattern so the lowest byte (first in memory) belongs to pixel x
+    uint32_t shift = 8 * (x & 7);
+    if (shift) {
+        colors = (colors >> shift) | (colors << (64 - shift));
+        mask = (mask >> shift) | (mask << (64 - shift));
+    }
+    uint32_t c0 = (uint32_t)colors, c1 = (uint32_t)(colors >> 32);
+    uint32_t m0 = (uint32_t)mask, m1 = (uint32_t)(mask >> 32);
+
+    uint32_t *wp = (uint32_t *)dst;
+    if ((m0 & m1) == 0xFFFFFFFFu) {
+        for (; len >= 8; len -= 8) {
+            wp[0] = c0;
+            wp[1] = c1;
+            wp += 2;
+        }
+    } else {
+        for (; len >= 8; len -= 8) {
+            wp[0] = (wp[0] & ~m0) | (c0 & m0);
+            wp[1] = (wp[1] & ~m1) | (c1 & m1);
+            wp += 2;
+        }
+    }
+
+    dst = (uint8_t *)wp;
+    for (; len > 0; len--) {
+        if ((uint8_t)mask) *dst = (uint8_t)colors;
+        dst++;
+        colors >>= 8;
+        mask >>= 8;
+    }
+    UB_VGA_SpanEnd();
+}
+
+/**
+ * @brief Copies a run of pixels when source and destination have the same word alignment.
+ */
+static void P_VGA_CopySpan(uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+    while (len > 0 && ((uintptr_t)dst & 3u) != 0) {
+        *dst++ = *src++;
+        len--;
+    }
+
+    uint32_t *wp = (uint32_t *)dst;
+    const uint32_t *sp = (const uint32_t *)src;
+    for (uint32_t n = len >> 2; n > 0; n--) {
+        *wp++ = *sp++;
+    }
+
+    dst = (uint8_t *)wp;
+    src = (const uint8_t *)sp;
+    for (len &= 3u; len > 0; len--) {
+        *dst++ = *src++;
+    }
+}
+
+/**
+ * @brief Returns the precomputed row for scanline y, aligned like the screen at column left.
+ * @details At 4 bpp the row is copied to the word-aligned line of UB_VGA_SpanBegin instead.
+ */
+static uint8_t *P_VGA_GradientRow(int32_t left, int32_t y)
+{
+    uintptr_t offset = VGA_INDEXED ? 0 : (uintptr_t)&VGA_FRAMEBUFFER[y * VGA_LINE_STRIDE + left] & 3u;
+    return (uint8_t *)gradient_rows[y & 3] + offset;
+}
+
+/**
+ * @brief Left to right: four dithered rows are computed once and copied to every scanline.
+ */
+static void P_VGA_GradientHorizontal(const P_VGA_Grad *g, int32_t x_lup, uint16_t width)
+{
+    int32_t slope[3], start[3];
+
+    // Values at the center of the first visible pixel
+    for (uint8_t i = 0; i < 3; i++) {
+        slope[i] = g->delta[i] / width;
+        start[i] = g->base[i] + slope[i] * (g->left - x_lup) + slope[i] / 2;
+    }
+
+    int32_t rows = min(g->bottom - g->top + 1, 4);
+    for (int32_t y = g->top; y < g->top + rows; y++) {
+        uint8_t *row = P_VGA_GradientRow(g->left, y);
+        int32_t bias[4];
+        int32_t val[3] = {start[0], start[1], start[2]};
+
+        P_VGA_DitherBias(bias, y);
+        for (int32_t x = g->left; x <= g->right; x++) {
+            *row++ = P_VGA_DitherPixel(val, bias[x & 3]);
+            val[0] += slope[0]; val[1] += slope[1]; val[2] += slope[2];
+        }
+    }
+
+    for (int32_t y = g->top; y <= g->bottom; y++) {
+        uint32_t len = g->right - g->left + 1;
+        P_VGA_CopySpan(UB_VGA_SpanBegin(g->left, y, len), P_VGA_GradientRow(g->left, y), len);
+        UB_VGA_SpanEnd();
+    }
+}
+
+/**
+ * @brief Top to bottom: every scanline is one repeating pattern word.
+ */
+static void P_VGA_GradientVertical(const P_VGA_Grad *g, int32_t y_lup, uint16_t height)
+{
+    int32_t slope[3], val[3];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        slope[i] = g->delta[i] / height;
+        val[i] = g->base[i] + slope[i] * (g->top - y_lup) + slope[i] / 2;
+    }
+
+    for (int32_t y = g->top; y <= g->bottom; y++) {
+        int32_t bias[4];
+        uint32_t pattern = 0;
+
+        P_VGA_DitherBias(bias, y);
+        for (uint8_t i = 0; i < 4; i++) {
+            pattern |= (uint32_t)P_VGA_DitherPixel(val, bias[i]) << (8 * i);
+        }
+        P_VGA_PatternSpan(g->left, g->right, y, pattern | ((uint64_t)pattern << 32), ~0ULL);
+        val[0] += slope[0]; val[1] += slope[1]; val[2] += slope[2];
+    }
+}
+
+/**
+ * @brief Center to corners: the distance of each pixel is tracked along the scanline.
+ * @details Distances are in quarter pixels. Moving one pixel changes the
+ *          distance by at most four units, so the square root is updated
+ *          with a few steps instead of being computed per pixel.
+ */
+static void P_VGA_GradientRadial(const P_VGA_Grad *g, int32_t x_lup, int32_t y_lup, uint16_t width, uint16_t height)
+{
+    // Doubled coordinates, so the center and the pixel centers are whole numbers
+    int32_t cx2 = 2 * x_lup + width;
+    int32_t cy2 = 2 * y_lup + height;
+    int32_t radius = (int32_t)P_VGA_Sqrt(4UL * ((uint32_t)width * width + (uint32_t)height * height));
+    int32_t slope[3];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        slope[i] = g->delta[i] / radius;
+    }
+
+    for (int32_t y = g->top; y <= g->bottom; y++) {
+        int32_t dx2 = 2 * g->left + 1 - cx2;
+        int32_t dy2 = 2 * y + 1 - cy2;
+        int32_t sq = 4 * (dx2 * dx2 + dy2 * dy2);   // Squared distance in quarter pixels
+        int32_t q = (int32_t)P_VGA_Sqrt(sq);
+        int32_t qq = q * q;
+        int32_t bias[4];
+        uint8_t *dst = UB_VGA_SpanBegin(g->left, y, g->right - g->left + 1);
+
+        P_VGA_DitherBias(bias, y);
+        for (int32_t x = g->left; x <= g->right; x++) {
+            int32_t d = min(q, radius);
+            int32_t val[3] = {
+                g->base[0] + slope[0] * d,
+                g->base[1] + slope[1] * d,
+                g->base[2] + slope[2] * d
+            };
+            *dst++ = P_VGA_DitherPixel(val, bias[x & 3]);
+
+            // Step to the next pixel: (dx2 + 2)^2 - dx2^2 = 4 * (dx2 + 1)
+            sq += 16 * (dx2 + 1);
+            dx2 += 2;
+            while (qq > sq) { qq -= 2 * q - 1; q--; }
+            while (qq + 2 * q + 1 <= sq) { qq += 2 * q + 1; q++; }
+        }
+        UB_VGA_SpanEnd();
+    }
+}
+
+/**
+ * @brief Fills a rectangle with a dithered gradient between two colors.
+ */
+VGA_Status UB_VGA_FillGradient(int16_t x_lup, int16_t y_lup, uint16_t width, uint16_t height,
+                               uint8_t color1, uint8_t color2, VGA_Gradient type)
+{
+    if (width == 0 || height == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if (width > VGA_GRADIENT_MAX_SIZE || height > VGA_GRADIENT_MAX_SIZE) return VGA_ERROR_INVALID_PARAMETER;
+    if (type > VGA_GRADIENT_RADIAL) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_Grad g;
+    g.left = max(max(x_lup, VGA.clip_rect.x), 0);
+    g.right = min(min(x_lup + width, VGA.clip_rect.x + VGA.clip_rect.width), VGA_DISPLAY_X) - 1;
+    g.top = max(max(y_lup, VGA.clip_rect.y), 0);
+    g.bottom = min(min(y_lup + height, VGA.clip_rect.y + VGA.clip_rect.height), VGA_DISPLAY_Y) - 1;
+    if (g.left > g.right || g.top > g.bottom) return VGA_SUCCESS;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t c1 = (color1 >> grad_shift[i]) & grad_mask[i];
+        int32_t c2 = (color2 >> grad_shift[i]) & grad_mask[i];
+        g.base[i] = c1 << 16;
+        g.delta[i] = (c2 - c1) << 16;
+    }
+
+    switch (type) {
+        case VGA_GRADIENT_HORIZONTAL: P_VGA_GradientHorizontal(&g, x_lup, width); break;
+        case VGA_GRADIENT_VERTICAL:   P_VGA_GradientVertical(&g, y_lup, height); break;
+        case VGA_GRADIENT_RADIAL:     P_VGA_GradientRadial(&g, x_lup, y_lup, width, height); break;
+        default: break;
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Expands one pattern row into 8 pixel colors and a write mask.
+ */
+static void P_VGA_PatternRow(const VGA_Pattern *pattern, int32_t y, uint64_t *colors, uint64_t *mask)
+{
+    uint8_t bits = pattern_table[pattern->id][y & 7];
+    uint64_t set = nibble_mask[bits >> 4] | ((uint64_t)nibble_mask[bits & 15] << 32);
+    uint64_t fg = pattern->fg * 0x0101010101010101ULL;
+    uint64_t bg = pattern->bg * 0x0101010101010101ULL;
+
+    *colors = (fg & set) | (bg & ~set);
+    *mask = pattern->transparent ? set : ~0ULL;
+}
+
+/**
+ * @brief Stores an 8x8 one-bit pattern in a pattern slot.
+ */
+VGA_Status UB_VGA_DefinePattern(uint8_t id, const uint8_t *rows)
+{
+    if (id >= VGA_PATTERN_COUNT || rows == NULL) return VGA_ERROR_INVALID_PARAMETER;
+
+    for (uint8_t i = 0; i < 8; i++) {
+        pattern_table[id][i] = rows[i];
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws a horizontal span with a pattern.
+ */
+VGA_Status UB_VGA_PatternHLine(int32_t x0, int32_t y, int32_t x1, const VGA_Pattern *pattern)
+{
+    if (pattern == NULL || pattern->id >= VGA_PATTERN_COUNT) return VGA_ERROR_INVALID_PARAMETER;
+    if (y < VGA.clip_rect.y || y >= (VGA.clip_rect.y + VGA.clip_rect.height)) return VGA_SUCCESS;
+
+    int32_t start_x = max(min(x0, x1), VGA.clip_rect.x);
+    int32_t end_x = min(max(x0, x1), VGA.clip_rect.x + VGA.clip_rect.width - 1);
+    if (start_x > end_x) return VGA_SUCCESS;
+
+    uint64_t colors, mask;
+    P_VGA_PatternRow(pattern, y, &colors, &mask);
+    if (mask != 0) P_VGA_PatternSpan(start_x, end_x, y, colors, mask);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Fills a rectangle with a pattern.
+ */
+VGA_Status UB_VGA_PatternRectangle(int16_t x_lup, int16_t y_lup, uint16_t width, uint16_t height, const VGA_Pattern *pattern)
+{
+    if (width == 0 || height == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if (pattern == NULL || pattern->id >= VGA_PATTERN_COUNT) return VGA_ERROR_INVALID_PARAMETER;
+
+    int32_t left = max(x_lup, VGA.clip_rect.x);
+    int32_t right = min(x_lup + width, VGA.clip_rect.x + VGA.clip_rect.width) - 1;
+    int32_t top = max(y_lup, VGA.clip_rect.y);
+    int32_t bottom = min(y_lup + height, VGA.clip_rect.y + VGA.clip_rect.height) - 1;
+    if (left > right || top > bottom) return VGA_SUCCESS;
+
+    uint64_t colors[8], mask[8];
+    for (uint8_t i = 0; i < 8; i++) {
+        P_VGA_PatternRow(pattern, i, &colors[i], &mask[i]);
+    }
+
+    for (int32_t y = top; y <= bottom; y++) {
+        if (mask[y & 7] != 0) P_VGA_PatternSpan(left, right, y, colors[y & 7], mask[y & 7]);
+    }
+    return VGA_SUCCESS;
+}
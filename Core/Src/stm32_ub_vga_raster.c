@@ -0,0 +1,350 @@
+/**
+ * @file    stm32_ub_vga_raster.c
+ * @brief   Implementation of the raster effects.
+ *
+ * @details The effects are a line overlay in layer VGA_OVERLAY_EFFECTS, so
+ *          they work on the framebuffer row before the sprites are drawn
+ *          over it. The program writes P_VGA_RasterTable; the interrupt
+ *          copies the entries that are in use to P_VGA_RasterShown on the
+ *          first row of a frame, only after a change, and keeps the rows
+ *          they cover so a row without an effect returns at once.
+ *
+ *          A row starts from the framebuffer row. A shift writes the whole
+ *          line buffer from it; any other effect copies it first, once. An
+ *          effect with a table looks up one entry for the row, so a wobble
+ *          or a gradient costs the same as a plain shift or recolor.
+ *
+ *          The budget is kept by estimating every effect before it runs:
+ *          a fixed cost plus a cost per 16 pixels for its kind, which starts
+ *          at an estimate from the instruction count and grows to the most
+ *          the DWT cycle counter has measured. The copy of the row is
+ *          estimated at the cost of a shift.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_raster.h"
+#include "stm32_ub_vga_private.h"
+#include <string.h>
+
+/** @brief Cycles of an effect besides its pixels: the lookup and the call overhead. */
+#define P_VGA_RASTER_BASE_CYCLES   40
+
+#define min(a,b) ((a) < (b) ? (a) : (b))
+
+/**
+ * @brief Cycles per 16 pixels of each kind of effect, as first estimated.
+ * @details A copy moves a word per cycle or two; a color lookup or compare
+ *          takes a load, a load or compare and a store per pixel.
+ */
+static const uint16_t P_VGA_RasterCostStart[VGA_RASTER_BLANK + 1] = { 0, 12, 48, 40, 8 };
+
+/** @brief The table the program writes, and whether it changed since the interrupt took it. */
+static VGA_RasterEffect P_VGA_RasterTable[VGA_RASTER_MAX_EFFECTS];
+static volatile bool P_VGA_RasterChanged = false;
+
+// The entries in use as the interrupt applies them, and the rows they cover
+static VGA_RasterEffect P_VGA_RasterShown[VGA_RASTER_MAX_EFFECTS];
+static uint32_t P_VGA_RasterCount = 0;
+static uint32_t P_VGA_RasterTop = 0;
+static uint32_t P_VGA_RasterBottom = 0;
+
+// State of the interrupt within a frame
+static uint16_t P_VGA_RasterLastRow = 0xFFFF;
+static uint32_t P_VGA_RasterBudget = 0;
+static uint16_t P_VGA_RasterCost[VGA_RASTER_BLANK + 1];
+static bool P_VGA_RasterCostValid = false;
+
+/** @brief Copy of a row for a shift at 4 bpp, where the row is already in the line buffer. */
+static uint8_t P_VGA_RasterScratch[VGA_MAX_DISPLAY_X] __attribute__((aligned(4)));
+
+static uint8_t P_VGA_RasterBudgetPercent = VGA_RASTER_BUDGET_PERCENT;
+
+// Counters of UB_VGA_GetRasterStats
+static volatile uint32_t P_VGA_RasterRows = 0;
+static volatile uint32_t P_VGA_RasterLate = 0;
+static volatile uint32_t P_VGA_RasterSkipped = 0;
+static volatile uint32_t P_VGA_RasterMaxCycles = 0;
+static volatile uint64_t P_VGA_RasterTotalCycles = 0;
+
+
+//--------------------------------------------------------------
+// Internal functions
+//--------------------------------------------------------------
+
+/**
+ * @brief Takes a changed table and the budget of the mode at the start of a frame.
+ */
+static void P_VGA_RasterFrameStart(void)
+{
+    if (!P_VGA_RasterCostValid) {
+        memcpy(P_VGA_RasterCost, P_VGA_RasterCostStart, sizeof(P_VGA_RasterCost));
+        P_VGA_RasterCostValid = true;
+    }
+    P_VGA_RasterBudget = (uint32_t)VGA.mode->h_total * P_VGA_HCLK_PER_TICK * P_VGA_RasterBudgetPercent / 100;
+
+    if (!P_VGA_RasterChanged) return;
+    P_VGA_RasterChanged = false;
+
+    uint32_t count = 0;
+    uint32_t top = UINT32_MAX;
+    uint32_t bottom = 0;
+    for (uint32_t i = 0; i < VGA_RASTER_MAX_EFFECTS; i++) {
+        const VGA_RasterEffect *e = &P_VGA_RasterTable[i];
+        if (e->type == VGA_RASTER_NONE) continue;
+        P_VGA_RasterShown[count++] = *e;
+        if (e->first_row < top) top = e->first_row;
+        if ((uint32_t)e->first_row + e->rows - 1 > bottom) bottom = (uint32_t)e->first_row + e->rows - 1;
+    }
+    P_VGA_RasterCount = count;
+    P_VGA_RasterTop = top;
+    P_VGA_RasterBottom = bottom;
+}
+
+/**
+ * @brief Returns the table entry of row n of an effect.
+ */
+static inline uint32_t P_VGA_RasterEntry(const VGA_RasterEffect *e, uint32_t n)
+{
+    uint32_t spacing = (e->spacing != 0) ? e->spacing : 1;
+    return (n / spacing + e->phase) % e->period;
+}
+
+/**
+ * @brief   Applies the effects to one framebuffer row (the line overlay).
+ * @details Runs in the scanout interrupt, for the rows in order; a row that
+ *          is not below the one before starts a new frame.
+ */
+static bool P_VGA_RasterOverlay(uint8_t *line, const uint8_t *src, uint16_t row)
+{
+    uint32_t start = P_VGA_DWT_CYCCNT;
+
+    if (row <= P_VGA_RasterLastRow) P_VGA_RasterFrameStart();
+    P_VGA_RasterLastRow = row;
+    if (row < P_VGA_RasterTop || row > P_VGA_RasterBottom) return false;
+
+    const uint32_t width = VGA_DISPLAY_X;
+    const uint8_t *in = src;
+    uint32_t applied = 0;
+    uint32_t skipped = 0;
+
+    for (uint32_t i = 0; i < P_VGA_RasterCount; i++) {
+        const VGA_RasterEffect *e = &P_VGA_RasterShown[i];
+        uint32_t n = (uint32_t)row - e->first_row;
+        if (n >= e->rows) continue;
+
+        // Columns, and the pixels to estimate: a copy of the row comes first
+        uint32_t x0 = 0;
+        uint32_t x1 = width;
+        if (e->type != VGA_RASTER_SHIFT) {
+            x0 = e->x;
+            if (x0 >= width) continue;
+            if (e->width != 0) x1 = min(x0 + e->width, width);
+        }
+        uint32_t pixels = x1 - x0;
+        uint32_t copy = 0;
+        if (in != line && e->type != VGA_RASTER_SHIFT) {
+            copy = P_VGA_RASTER_BASE_CYCLES + ((width * P_VGA_RasterCost[VGA_RASTER_SHIFT]) >> 4);
+        }
+
+        // Leave out this effect and the rest of the row if it does not fit
+        uint32_t cost = P_VGA_RASTER_BASE_CYCLES + copy + ((pixels * P_VGA_RasterCost[e->type]) >> 4);
+        uint32_t now = P_VGA_DWT_CYCCNT;
+        if (skipped != 0 || now - start + cost > P_VGA_RasterBudget) {
+            skipped++;
+            continue;
+        }
+
+        if (e->type == VGA_RASTER_SHIFT) {
+            int32_t offset = ((const int8_t *)e->table)[P_VGA_RasterEntry(e, n)] % (int32_t)width;
+            uint32_t d = (uint32_t)(offset < 0 ? offset + (int32_t)width : offset);
+            if (in == line) {
+                memcpy(P_VGA_RasterScratch, line, width);
+                in = P_VGA_RasterScratch;
+            }
+            memcpy(line + d, in, width - d);
+            memcpy(line, in + width - d, d);
+        }
+        else {
+            if (in != line) memcpy(line, in, width);
+            uint8_t *p = line + x0;
+            uint8_t *end = line + x1;
+            if (e->type == VGA_RASTER_REMAP) {
+                const uint8_t *map = (const uint8_t *)e->table;
+                while (p != end) {
+                    *p = map[*p];
+                    p++;
+                }
+            }
+            else if (e->type == VGA_RASTER_RECOLOR) {
+                uint8_t key = e->key;
+                uint8_t color = ((const uint8_t *)e->table)[P_VGA_RasterEntry(e, n)];
+                while (p != end) {
+                    if (*p == key) *p = color;
+                    p++;
+                }
+            }
+            else {
+                memset(p, e->key, x1 - x0);
+            }
+        }
+        in = line;
+        applied++;
+
+        // Learn the cost per 16 pixels, rounded up
+        uint32_t used = P_VGA_DWT_CYCCNT - now;
+        if (pixels != 0 && used > P_VGA_RASTER_BASE_CYCLES + copy) {
+            uint32_t per16 = ((used - P_VGA_RASTER_BASE_CYCLES - copy) * 16 + pixels - 1) / pixels;
+            if (per16 > P_VGA_RasterCost[e->type]) P_VGA_RasterCost[e->type] = (uint16_t)min(per16, 0xFFFF);
+        }
+    }
+
+    if (applied == 0 && skipped == 0) return false;
+
+    uint32_t cycles = P_VGA_DWT_CYCCNT - start;
+    P_VGA_RasterRows++;
+    P_VGA_RasterTotalCycles += cycles;
+    if (cycles > P_VGA_RasterMaxCycles) P_VGA_RasterMaxCycles = cycles;
+    if (skipped != 0) {
+        P_VGA_RasterLate++;
+        P_VGA_RasterSkipped += skipped;
+    }
+    return applied != 0;
+}
+
+/**
+ * @brief Tells whether an entry of the table is in use.
+ */
+static bool P_VGA_RasterAnyEffect(void)
+{
+    for (uint32_t i = 0; i < VGA_RASTER_MAX_EFFECTS; i++) {
+        if (P_VGA_RasterTable[i].type != VGA_RASTER_NONE) return true;
+    }
+    return false;
+}
+
+
+//--------------------------------------------------------------
+// Global functions
+//--------------------------------------------------------------
+
+/**
+ * @brief Sets an entry of the effect table, from the next frame on.
+ */
+VGA_Status UB_VGA_RasterSet(uint8_t slot, const VGA_RasterEffect *effect)
+{
+    if (slot >= VGA_RASTER_MAX_EFFECTS) return VGA_ERROR_INVALID_PARAMETER;
+
+    VGA_RasterEffect entry;
+    memset(&entry, 0, sizeof(entry));
+    if (effect != NULL && effect->type != VGA_RASTER_NONE) {
+        if (effect->type > VGA_RASTER_BLANK || effect->rows == 0) return VGA_ERROR_INVALID_PARAMETER;
+        if (effect->type != VGA_RASTER_BLANK && effect->table == NULL) return VGA_ERROR_INVALID_PARAMETER;
+        if ((effect->type == VGA_RASTER_SHIFT || effect->type == VGA_RASTER_RECOLOR) &&
+            effect->period == 0) return VGA_ERROR_INVALID_PARAMETER;
+        entry = *effect;
+
+        // Start the cycle counter for the budget, and the overlay
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        P_VGA_DWT_CTRL |= P_VGA_DWT_CTRL_CYCCNTENA;
+        VGA_Status status = UB_VGA_SetLineOverlay(VGA_OVERLAY_EFFECTS, P_VGA_RasterOverlay);
+        if (status != VGA_SUCCESS) return status;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    P_VGA_RasterTable[slot] = entry;
+    P_VGA_RasterChanged = true;
+    __set_PRIMASK(primask);
+
+    if (!P_VGA_RasterAnyEffect()) UB_VGA_RasterClear();
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Sets the phase of an effect, from the next frame on.
+ */
+VGA_Status UB_VGA_RasterSetPhase(uint8_t slot, uint8_t phase)
+{
+    if (slot >= VGA_RASTER_MAX_EFFECTS) return VGA_ERROR_INVALID_PARAMETER;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    P_VGA_RasterTable[slot].phase = phase;
+    P_VGA_RasterChanged = true;
+    __set_PRIMASK(primask);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Returns an entry of the effect table.
+ */
+const VGA_RasterEffect *UB_VGA_RasterGet(uint8_t slot)
+{
+    if (slot >= VGA_RASTER_MAX_EFFECTS) return NULL;
+    return &P_VGA_RasterTable[slot];
+}
+
+/**
+ * @brief Clears the effect table and stops the effect overlay.
+ */
+void UB_VGA_RasterClear(void)
+{
+    UB_VGA_SetLineOverlay(VGA_OVERLAY_EFFECTS, NULL);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset(P_VGA_RasterTable, 0, sizeof(P_VGA_RasterTable));
+    P_VGA_RasterChanged = true;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Sets the cycle budget of the effects on a row.
+ */
+VGA_Status UB_VGA_SetRasterBudget(uint8_t percent)
+{
+    if (percent == 0 || percent > 100) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_RasterBudgetPercent = percent;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Returns the counters of the effects.
+ */
+void UB_VGA_GetRasterStats(VGA_RasterStats *stats)
+{
+    if (stats == NULL) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stats->rows = P_VGA_RasterRows;
+    stats->late_rows = P_VGA_RasterLate;
+    stats->skipped = P_VGA_RasterSkipped;
+    stats->max_cycles = P_VGA_RasterMaxCycles;
+    stats->avg_cycles = (P_VGA_RasterRows != 0) ? (uint32_t)(P_VGA_RasterTotalCycles / P_VGA_RasterRows) : 0;
+    __set_PRIMASK(primask);
+    stats->budget_cycles = (uint32_t)VGA.mode->h_total * P_VGA_HCLK_PER_TICK * P_VGA_RasterBudgetPercent / 100;
+}
+
+/**
+ * @brief Clears the counters of the effects.
+ * @details Also starts the learned cost per kind of effect again from the estimate.
+ */
+void UB_VGA_ResetRasterStats(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    P_VGA_RasterRows = 0;
+    P_VGA_RasterLate = 0;
+    P_VGA_RasterSkipped = 0;
+    P_VGA_RasterMaxCycles = 0;
+    P_VGA_RasterTotalCycles = 0;
+    P_VGA_RasterCostValid = false;
+    __set_PRIMASK(primask);
+}
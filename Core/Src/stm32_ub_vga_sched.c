@@ -0,0 +1,444 @@
+/**
+ * @file    stm32_ub_vga_sched.c
+ * @brief   Implementation of the render scheduler.
+ *
+ * @details The queue is a ring of operations, each with its own progress:
+ *          the pixels done of a rectangle or bitmap, the Bresenham state of
+ *          a line. A chunk continues the operation at the head for as many
+ *          pixels as fit in the time left, measured with
+ *          UB_VGA_BlankCycles.
+ *
+ *          The size of a chunk comes from a fixed cost plus a cost per 16
+ *          pixels for its kind of operation, which starts at an estimate
+ *          and grows to the most the DWT cycle counter has measured. A chunk
+ *          that a scanout interrupt cut in two is not measured, so the
+ *          interrupt time does not count as drawing. Other interrupts are
+ *          not seen, so a sample over twice the current cost is left out,
+ *          and the cost never grows past four times the estimate: the
+ *          blanking intervals always keep room for a chunk.
+ *
+ *          The queue is only used from the main loop, so it needs no lock.
+ *          Only the jitter counters are written by the scanout interrupt,
+ *          at the end of a line sent while P_VGA_SchedDrawing is set.
+ *
+ * @date    19.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_sched.h"
+#include "stm32_ub_vga_private.h"
+#include "bitmaps.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Cycles of a chunk besides its pixels: finding the position and the calls. */
+#define P_VGA_SCHED_BASE_CYCLES   60
+
+/** @brief Cycles kept free at the end of a blanking interval, for the interrupt latency. */
+#define P_VGA_SCHED_MARGIN_CYCLES   40
+
+/**
+ * @brief Highest sample the learned cost takes, in times the current cost.
+ * @details A SysTick or UART interrupt in the middle of a chunk makes it
+ *          look far slower than it is; such a sample is left out.
+ */
+#define P_VGA_SCHED_COST_STEP   2
+
+/** @brief Highest learned cost, in times the first estimate. */
+#define P_VGA_SCHED_COST_LIMIT   4
+
+#define min(a,b) ((a) < (b) ? (a) : (b))
+
+/** @brief Kinds of operation. */
+enum {
+    P_VGA_SCHED_FILL = 0,
+    P_VGA_SCHED_LINE,
+    P_VGA_SCHED_BITMAP,
+    P_VGA_SCHED_JOB,
+    P_VGA_SCHED_KINDS
+};
+
+/**
+ * @brief Cycles per 16 pixels of each kind of operation, as first estimated.
+ * @details A fill writes a span per row with memset; a line or a bitmap
+ *          calls UB_VGA_SetPixel per pixel. A job is taken to be as slow.
+ */
+static const uint16_t P_VGA_SchedCostStart[P_VGA_SCHED_KINDS] = { 10, 160, 200, 200 };
+
+/**
+ * @brief An operation in the queue.
+ */
+typedef struct {
+    uint8_t type;           // P_VGA_SCHED_FILL, _LINE, _BITMAP or _JOB
+    uint8_t color;          // Fill and line: color; bitmap: ID
+    int8_t sx, sy;          // Line: steps
+    int16_t x0, y0;         // Fill, bitmap: top-left corner; line: the next pixel
+    int16_t x1, y1;         // Fill: bottom-right corner; line: the last pixel
+    int16_t dx, dy;         // Line: distances, dy negative
+    int32_t err;            // Line: Bresenham error
+    uint32_t pos;           // Fill, bitmap: pixels done
+    VGA_SchedJob job;       // Job: function and its context
+    void *context;
+} P_VGA_SchedOp;
+
+static P_VGA_SchedOp P_VGA_SchedQueue[VGA_SCHED_QUEUE_SIZE];
+static uint32_t P_VGA_SchedHead = 0;
+static uint32_t P_VGA_SchedCount = 0;
+
+static VGA_SchedMode P_VGA_SchedMode = VGA_SCHED_DIRECT;
+static uint16_t P_VGA_SchedCost[P_VGA_SCHED_KINDS];
+static bool P_VGA_SchedCostValid = false;
+
+// Counters of UB_VGA_GetSchedStats
+static uint32_t P_VGA_SchedOps = 0;
+static uint32_t P_VGA_SchedPixels = 0;
+static uint32_t P_VGA_SchedChunks = 0;
+static uint32_t P_VGA_SchedLate = 0;
+static uint32_t P_VGA_SchedMaxCycles = 0;
+static uint32_t P_VGA_SchedDrawCycles = 0;
+static uint32_t P_VGA_SchedBusyCycles = 0;
+static uint32_t P_VGA_SchedBusyStart = 0;
+
+// Line ends during a chunk, written by the scanout interrupt
+volatile bool P_VGA_SchedDrawing = false;
+static volatile uint32_t P_VGA_SchedJitterLines = 0;
+static volatile uint32_t P_VGA_SchedJitterMin = UINT32_MAX;
+static volatile uint32_t P_VGA_SchedJitterMax = 0;
+
+
+//--------------------------------------------------------------
+// Internal functions
+//--------------------------------------------------------------
+
+/**
+ * @brief Takes a free entry at the tail of the queue.
+ * @return The entry, or NULL when the queue is full.
+ */
+static P_VGA_SchedOp *P_VGA_SchedPush(uint8_t type)
+{
+    if (P_VGA_SchedCount >= VGA_SCHED_QUEUE_SIZE) return NULL;
+
+    if (P_VGA_SchedCount == 0) {
+        // Start the cycle counter, and the time until the queue is empty
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        P_VGA_DWT_CTRL |= P_VGA_DWT_CTRL_CYCCNTENA;
+        P_VGA_SchedBusyStart = P_VGA_DWT_CYCCNT;
+    }
+    if (!P_VGA_SchedCostValid) {
+        memcpy(P_VGA_SchedCost, P_VGA_SchedCostStart, sizeof(P_VGA_SchedCost));
+        P_VGA_SchedCostValid = true;
+    }
+
+    P_VGA_SchedOp *op = &P_VGA_SchedQueue[(P_VGA_SchedHead + P_VGA_SchedCount) % VGA_SCHED_QUEUE_SIZE];
+    memset(op, 0, sizeof(*op));
+    op->type = type;
+    P_VGA_SchedCount++;
+    return op;
+}
+
+/**
+ * @brief Draws up to pixels pixels of an operation.
+ * @param done Set to the pixels drawn.
+ * @return true when the operation is finished.
+ */
+static bool P_VGA_SchedStep(P_VGA_SchedOp *op, uint32_t pixels, uint32_t *done)
+{
+    if (op->type == P_VGA_SCHED_FILL) {
+        // Spans of the rows, from where the last chunk stopped
+        uint32_t width = (uint32_t)(op->x1 - op->x0 + 1);
+        uint32_t total = width * (uint32_t)(op->y1 - op->y0 + 1);
+        uint32_t end = min(op->pos + pixels, total);
+        *done = end - op->pos;
+        while (op->pos < end) {
+            uint32_t row = op->pos / width;
+            uint32_t col = op->pos - row * width;
+            uint32_t n = min(width - col, end - op->pos);
+            UB_VGA_FastHLine(op->x0 + (int32_t)col, op->y0 + (int32_t)row, op->x0 + (int32_t)(col + n) - 1, op->color);
+            op->pos += n;
+        }
+        return op->pos == total;
+    }
+
+    if (op->type == P_VGA_SCHED_LINE) {
+        // Bresenham as in UB_VGA_DrawLine, continued from the stored state
+        uint32_t n = 0;
+        while (n < pixels) {
+            UB_VGA_SetPixel(op->x0, op->y0, op->color);
+            n++;
+            if (op->x0 == op->x1 && op->y0 == op->y1) {
+                *done = n;
+                return true;
+            }
+            int32_t e2 = 2 * op->err;
+            if (e2 >= op->dy) {
+                op->err += op->dy;
+                op->x0 += op->sx;
+            }
+            if (e2 <= op->dx) {
+                op->err += op->dx;
+                op->y0 += op->sy;
+            }
+        }
+        *done = n;
+        return false;
+    }
+
+    if (op->type == P_VGA_SCHED_BITMAP) {
+        const Bitmap_t *bitmap = &vga_bitmaps[op->color];
+        uint32_t total = (uint32_t)bitmap->width * bitmap->height;
+        uint32_t end = min(op->pos + pixels, total);
+        *done = end - op->pos;
+        for (; op->pos < end; op->pos++) {
+            uint32_t y = op->pos / bitmap->width;
+            uint32_t x = op->pos - y * bitmap->width;
+            uint8_t color = bitmap->data[y][x];
+            if (color != BITMAP_TRANSPARENT_COLOR) {
+                UB_VGA_SetPixel(op->x0 + x, op->y0 + y, color);
+            }
+        }
+        return op->pos == total;
+    }
+
+    *done = pixels;
+    return op->job(op->context, pixels);
+}
+
+
+//--------------------------------------------------------------
+// Global functions
+//--------------------------------------------------------------
+
+/**
+ * @brief Chooses where the chunks run.
+ */
+VGA_Status UB_VGA_SchedSetMode(VGA_SchedMode mode)
+{
+    if (mode != VGA_SCHED_DIRECT && mode != VGA_SCHED_VBLANK && mode != VGA_SCHED_BLANKING) {
+        return VGA_ERROR_INVALID_PARAMETER;
+    }
+
+    P_VGA_SchedMode = mode;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Returns where the chunks run.
+ */
+VGA_SchedMode UB_VGA_SchedGetMode(void)
+{
+    return P_VGA_SchedMode;
+}
+
+/**
+ * @brief Queues a filled rectangle.
+ */
+VGA_Status UB_VGA_SchedFillRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color)
+{
+    if (width == 0 || height == 0) return VGA_ERROR_INVALID_PARAMETER;
+
+    // Only the part on screen; the clipping rectangle is applied when it is drawn
+    int32_t x0 = (x < 0) ? 0 : x;
+    int32_t y0 = (y < 0) ? 0 : y;
+    int32_t x1 = min((int32_t)x + width - 1, VGA_DISPLAY_X - 1);
+    int32_t y1 = min((int32_t)y + height - 1, VGA_DISPLAY_Y - 1);
+    if (x0 > x1 || y0 > y1) return VGA_SUCCESS;
+
+    P_VGA_SchedOp *op = P_VGA_SchedPush(P_VGA_SCHED_FILL);
+    if (op == NULL) return VGA_ERROR_OUT_OF_MEMORY;
+    op->x0 = (int16_t)x0;
+    op->y0 = (int16_t)y0;
+    op->x1 = (int16_t)x1;
+    op->y1 = (int16_t)y1;
+    op->color = color;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Queues a line of one pixel wide.
+ */
+VGA_Status UB_VGA_SchedLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color)
+{
+    // Horizontal and vertical lines are spans
+    if (y1 == y2) return UB_VGA_SchedFillRect(min(x1, x2), y1, abs(x2 - x1) + 1, 1, color);
+    if (x1 == x2) return UB_VGA_SchedFillRect(x1, min(y1, y2), 1, abs(y2 - y1) + 1, color);
+
+    P_VGA_SchedOp *op = P_VGA_SchedPush(P_VGA_SCHED_LINE);
+    if (op == NULL) return VGA_ERROR_OUT_OF_MEMORY;
+    op->x0 = x1;
+    op->y0 = y1;
+    op->x1 = x2;
+    op->y1 = y2;
+    op->dx = (int16_t)abs(x2 - x1);
+    op->dy = (int16_t)-abs(y2 - y1);
+    op->sx = (x1 < x2) ? 1 : -1;
+    op->sy = (y1 < y2) ? 1 : -1;
+    op->err = op->dx + op->dy;
+    op->color = color;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Queues a bitmap.
+ */
+VGA_Status UB_VGA_SchedBitmap(uint8_t id, int16_t x, int16_t y)
+{
+    if (id >= NUM_BITMAPS) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_SchedOp *op = P_VGA_SchedPush(P_VGA_SCHED_BITMAP);
+    if (op == NULL) return VGA_ERROR_OUT_OF_MEMORY;
+    op->x0 = x;
+    op->y0 = y;
+    op->color = id;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Queues a job.
+ */
+VGA_Status UB_VGA_SchedJob(VGA_SchedJob job, void *context)
+{
+    if (job == NULL) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_SchedOp *op = P_VGA_SchedPush(P_VGA_SCHED_JOB);
+    if (op == NULL) return VGA_ERROR_OUT_OF_MEMORY;
+    op->job = job;
+    op->context = context;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Records the TIM2 count at the end of a line sent while a chunk ran.
+ * @details Called from the scanout interrupt.
+ */
+void P_VGA_SchedLineEnd(uint32_t tick)
+{
+    P_VGA_SchedJitterLines++;
+    if (tick < P_VGA_SchedJitterMin) P_VGA_SchedJitterMin = tick;
+    if (tick > P_VGA_SchedJitterMax) P_VGA_SchedJitterMax = tick;
+}
+
+/**
+ * @brief Tells whether the queue is full.
+ */
+bool UB_VGA_SchedFull(void)
+{
+    return P_VGA_SchedCount >= VGA_SCHED_QUEUE_SIZE;
+}
+
+/**
+ * @brief Runs chunks of the queue while the mode allows it.
+ */
+bool UB_VGA_SchedRun(void)
+{
+    while (P_VGA_SchedCount != 0) {
+        P_VGA_SchedOp *op = &P_VGA_SchedQueue[P_VGA_SchedHead];
+
+        // The time the chunk may take: until a pixel is read again, or any
+        // time at all
+        uint32_t window = UB_VGA_BlankCycles();
+        uint32_t allowed = window;
+        if (P_VGA_SchedMode == VGA_SCHED_DIRECT) allowed = UINT32_MAX;
+        else if (P_VGA_SchedMode == VGA_SCHED_VBLANK && !UB_VGA_InVBlank()) allowed = 0;
+
+        uint32_t pixels = VGA_SCHED_CHUNK_PIXELS;
+        if (allowed != UINT32_MAX) {
+            if (allowed <= P_VGA_SCHED_BASE_CYCLES + P_VGA_SCHED_MARGIN_CYCLES) return false;
+            uint32_t fit = (allowed - P_VGA_SCHED_BASE_CYCLES - P_VGA_SCHED_MARGIN_CYCLES) * 16 / P_VGA_SchedCost[op->type];
+            if (fit == 0) return false;
+            pixels = min(pixels, fit);
+        }
+
+        uint32_t line = VGA.hsync_cnt;
+        uint32_t start = P_VGA_DWT_CYCCNT;
+        uint32_t done = 0;
+        P_VGA_SchedDrawing = true;
+        bool finished = P_VGA_SchedStep(op, pixels, &done);
+        P_VGA_SchedDrawing = false;
+        uint32_t used = P_VGA_DWT_CYCCNT - start;
+
+        P_VGA_SchedChunks++;
+        P_VGA_SchedPixels += done;
+        P_VGA_SchedDrawCycles += used;
+        if (used > P_VGA_SchedMaxCycles) P_VGA_SchedMaxCycles = used;
+        if (used > window) P_VGA_SchedLate++;
+
+        // Learn the cost per 16 pixels, rounded up, of a chunk no scanout
+        // interrupt came in between
+        if (line == VGA.hsync_cnt && done != 0 && used > P_VGA_SCHED_BASE_CYCLES) {
+            uint32_t per16 = ((used - P_VGA_SCHED_BASE_CYCLES) * 16 + done - 1) / done;
+            uint32_t cost = P_VGA_SchedCost[op->type];
+            uint32_t limit = (uint32_t)P_VGA_SchedCostStart[op->type] * P_VGA_SCHED_COST_LIMIT;
+            if (per16 > cost && per16 <= cost * P_VGA_SCHED_COST_STEP)
+                P_VGA_SchedCost[op->type] = (uint16_t)min(per16, limit);
+        }
+
+        if (finished) {
+            P_VGA_SchedHead = (P_VGA_SchedHead + 1) % VGA_SCHED_QUEUE_SIZE;
+            P_VGA_SchedCount--;
+            P_VGA_SchedOps++;
+            if (P_VGA_SchedCount == 0) P_VGA_SchedBusyCycles += P_VGA_DWT_CYCCNT - P_VGA_SchedBusyStart;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the queue until it is empty.
+ */
+void UB_VGA_SchedFlush(void)
+{
+    while (!UB_VGA_SchedRun()) {
+    }
+}
+
+/**
+ * @brief Returns the counters of the scheduler.
+ */
+void UB_VGA_GetSchedStats(VGA_SchedStats *stats)
+{
+    if (stats == NULL) return;
+
+    stats->ops = P_VGA_SchedOps;
+    stats->pixels = P_VGA_SchedPixels;
+    stats->chunks = P_VGA_SchedChunks;
+    stats->late_chunks = P_VGA_SchedLate;
+    stats->max_chunk_cycles = P_VGA_SchedMaxCycles;
+    stats->draw_cycles = P_VGA_SchedDrawCycles;
+    stats->busy_cycles = P_VGA_SchedBusyCycles;
+    stats->pixels_per_ms = (P_VGA_SchedBusyCycles != 0) ?
+        (uint32_t)((uint64_t)P_VGA_SchedPixels * P_VGA_HCLK_KHZ / P_VGA_SchedBusyCycles) : 0;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stats->jitter_lines = P_VGA_SchedJitterLines;
+    stats->jitter_ticks = (P_VGA_SchedJitterLines != 0) ? P_VGA_SchedJitterMax - P_VGA_SchedJitterMin : 0;
+    __set_PRIMASK(primask);
+    stats->queued = (uint8_t)P_VGA_SchedCount;
+}
+
+/**
+ * @brief Clears the counters of the scheduler.
+ * @details Also starts the measured cost per kind of operation again from the estimate.
+ */
+void UB_VGA_ResetSchedStats(void)
+{
+    P_VGA_SchedOps = 0;
+    P_VGA_SchedPixels = 0;
+    P_VGA_SchedChunks = 0;
+    P_VGA_SchedLate = 0;
+    P_VGA_SchedMaxCycles = 0;
+    P_VGA_SchedDrawCycles = 0;
+    P_VGA_SchedBusyCycles = 0;
+    P_VGA_SchedBusyStart = P_VGA_DWT_CYCCNT;
+    P_VGA_SchedCostValid = false;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    P_VGA_SchedJitterLines = 0;
+    P_VGA_SchedJitterMin = UINT32_MAX;
+    P_VGA_SchedJitterMax = 0;
+    __set_PRIMASK(primask);
+}
@@ -16,6 +16,7 @@
 // Includes
 //--------------------------------------------------------------
 #include "stm32_ub_vga_screen.h"
+#include "stm32_ub_vga_private.h"
 #include "bitmaps.h"
 #include "fonts.h"
 #include <stdlib.h>
@@ -25,25 +26,277 @@
 #define max(a,b) ((a) > (b) ? (a) : (b))
 #define min(a,b) ((a) < (b) ? (a) : (b))
 
+/**
+ * @brief The video modes.
+ * @details Timings with HCLK = 126 MHz (TIM2 at 63 MHz):
+ *          - 640x480@60: 25.175 MHz pixel clock, 800 x 525 pixels in
+ *            total, so a line is 2002 ticks (31.47 kHz, 59.94 Hz). 320
+ *            pixels of 10 HCLK, or 160 pixels of 20 HCLK, fill the picture.
+ *          - 800x600@56: 36 MHz pixel clock, 1024 x 625 pixels in total, so
+ *            a line is 1792 ticks (35.16 kHz, 56.25 Hz), the HSync pulse 126
+ *            ticks (72 pixels) and the picture starts after 350 ticks (200
+ *            pixels). 400 pixels of 7 HCLK fill the 800 pixels exactly.
+ *          The stride of the 400 pixel mode has two guard pixels, because
+ *          the pixel clock gate needs pixel_clocks * stride to be even.
+ *          The 16 color modes keep no guard pixels in the framebuffer: the
+ *          guard pixel is part of the line buffer the line is expanded into.
+ */
+const VGA_Mode VGA_Modes[VGA_MODE_COUNT] = {
+  // width height stride pitch bpp shift clocks h_total h_sync h_start v_total v_sync v_start positive
+  { 320, 240, 321, 321, 8, 1, 10, 2002, 240, 280, 525, 2, 36, false },   // VGA_MODE_320X240
+  { 320, 480, 321, 321, 8, 0, 10, 2002, 240, 280, 525, 2, 36, false },   // VGA_MODE_320X480
+  { 160, 120, 161, 161, 8, 2, 20, 2002, 240, 280, 525, 2, 36, false },   // VGA_MODE_160X120
+  { 400, 300, 402, 402, 8, 1,  7, 1792, 126, 350, 625, 2, 24, true  },   // VGA_MODE_400X300
+  { 320, 240, 321, 160, 4, 1, 10, 2002, 240, 280, 525, 2, 36, false },   // VGA_MODE_320X240_16
+  { 320, 480, 321, 160, 4, 0, 10, 2002, 240, 280, 525, 2, 36, false },   // VGA_MODE_320X480_16
+  { 320, 120, 321, 321, 8, 2, 10, 2002, 240, 280, 525, 2, 36, false },   // VGA_MODE_320X120
+};
+
+/**
+ * @brief TIM2 ticks after the end of the pixels of a line that still count
+ *        as the line: the last DMA transfer and the entry of its interrupt.
+ */
+#define P_VGA_LINE_END_TICKS  16
+
 /**
  * @brief Global VGA control structure instance.
+ * @details Starts in the default mode, so drawing works before
+ *          UB_VGA_Screen_Init.
  */
-VGA_t VGA;
+VGA_t VGA = { .mode = &VGA_Modes[VGA_DEFAULT_MODE], .draw_ram = VGA_RAM1 };
 
 /**
  * @brief Framebuffer for the VGA screen.
- * @details The size is (VGA_DISPLAY_X + 1) * VGA_DISPLAY_Y to account for a
- *          guard pixel at the end of each scanline.
+ * @details Holds VGA_DISPLAY_Y lines of VGA_LINE_STRIDE bytes in the current
+ *          mode: the visible pixels and a black guard pixel at the end of
+ *          each scanline, or at 4 bpp two pixels per byte. Word aligned, so
+ *          that the 4 bpp lines can be read a word at a time.
+ */
+uint8_t VGA_RAM1[VGA_RAM_SIZE] __attribute__((aligned(4)));
+
+#if VGA_SCANOUT_DOUBLE_BUFFER
+/**
+ * @brief All-black line scanned out during the vertical blanking interval.
+ */
+static uint8_t P_VGA_BlackLine[VGA_MAX_LINE_STRIDE] __attribute__((aligned(4)));
+
+/**
+ * @brief Line buffers of the 4 bpp modes and the line renderer.
+ * @details Row r is expanded or drawn into buffer r & 1, while the DMA
+ *          sends the other one. Only the visible pixels are written, so the
+ *          guard pixels behind them stay black. Each buffer is rounded up to
+ *          whole words, so both start word aligned.
+ */
+static uint8_t P_VGA_LineBuffer[2][(VGA_MAX_LINE_STRIDE + 3) & ~3] __attribute__((aligned(4)));
+#endif
+
+//--------------------------------------------------------------
+// Palette of the 4 bpp modes
+//--------------------------------------------------------------
+/**
+ * @brief The 16 CGA colors, in CGA order.
+ * @details Made of the VGA_COL_ colors, so that these are drawn exactly
+ *          with the default palette; dark grey has no name of its own.
+ */
+#define P_VGA_CGA_COLORS \
+  VGA_COL_BLACK, VGA_COL_BLUE, VGA_COL_GREEN, VGA_COL_CYAN, \
+  VGA_COL_RED, VGA_COL_MAGENTA, VGA_COL_BROWN, VGA_COL_GREY, \
+  0x49, VGA_COL_LIGHT_BLUE, VGA_COL_LIGHT_GREEN, VGA_COL_LIGHT_CYAN, \
+  VGA_COL_LIGHT_RED, VGA_COL_LIGHT_MAGENTA, VGA_COL_YELLOW, VGA_COL_WHITE
+
+static const uint8_t P_VGA_DefaultPalette[VGA_PALETTE_SIZE] = { P_VGA_CGA_COLORS };
+static uint8_t P_VGA_Palette[VGA_PALETTE_SIZE] = { P_VGA_CGA_COLORS };
+
+/**
+ * @brief Index of the palette entry nearest to every R3G3B2 color.
+ */
+static uint8_t P_VGA_PaletteIndex[256];
+
+/**
+ * @brief The two pixel colors of every 4 bpp byte, in scanout order.
+ * @details Entry b holds the color of the high nibble in its low byte, so
+ *          that on the little-endian core a store of the halfword puts the
+ *          left pixel first.
+ */
+static uint16_t P_VGA_ExpandTable[256] __attribute__((aligned(4)));
+
+// The tables are built when first needed: the expansion table when a
+// 4 bpp mode is set, the index table when a color is first drawn
+static bool P_VGA_ExpandValid = false;
+static bool P_VGA_IndexValid = false;
+
+/**
+ * @brief Scratch line of UB_VGA_SpanBegin at 4 bpp.
+ */
+static uint8_t P_VGA_Span[VGA_MAX_DISPLAY_X] __attribute__((aligned(4)));
+static uint8_t *P_VGA_SpanRow;
+static int32_t P_VGA_SpanX, P_VGA_SpanCount;
+
+//--------------------------------------------------------------
+// Line map
+//--------------------------------------------------------------
+/**
+ * @brief Framebuffer line of every screen row, twice.
+ * @details The scanout reads P_VGA_LineMap. A new table is written into
+ *          the other one, and the ISR swaps it in at the start of the next
+ *          frame when P_VGA_LineMapPending is set. Volatile, so that the
+ *          entries are stored before the flag is.
+ */
+static volatile uint16_t P_VGA_LineMaps[2][VGA_MAX_DISPLAY_Y];
+static volatile uint16_t * volatile P_VGA_LineMap = P_VGA_LineMaps[0];
+static volatile bool P_VGA_LineMapPending = false;
+// Table last written, NULL until the first mode is set
+static volatile uint16_t *P_VGA_LineMapLast = NULL;
+
+/**
+ * @brief The bands the table was built from; none after UB_VGA_SetLineMap.
+ */
+static VGA_Band P_VGA_Bands[VGA_MAX_BANDS];
+static uint8_t P_VGA_BandCount = 0;
+
+//--------------------------------------------------------------
+// Pages
+//--------------------------------------------------------------
+/**
+ * @brief Page the scanout shows, and the page to show from the next frame on.
+ * @details UB_VGA_Present sets P_VGA_NextPage; the ISR moves it to
+ *          P_VGA_ShowPage at the start of a frame and clears it.
+ */
+static uint8_t * volatile P_VGA_ShowPage = VGA_RAM1;
+static uint8_t * volatile P_VGA_NextPage = NULL;
+static uint8_t P_VGA_PageCount = 1;
+// The scanout runs, so a flip waits for the ISR
+static bool P_VGA_Running = false;
+
+// Frames counted by the ISR, the frame of the last flip, and the counters of UB_VGA_GetPageStats
+static volatile uint32_t P_VGA_FrameCount = 0;
+static volatile uint32_t P_VGA_FlipFrame = 0;
+static uint32_t P_VGA_LastFlip = 0;
+static uint32_t P_VGA_StatsFrame = 0;
+static uint32_t P_VGA_Presented = 0;
+static uint32_t P_VGA_Dropped = 0;
+
+/**
+ * @brief Rectangles drawn to the back page since the last present.
+ */
+static VGA_Rect P_VGA_Dirty[VGA_MAX_DIRTY];
+static uint8_t P_VGA_DirtyCount = 0;
+
+//--------------------------------------------------------------
+// Line renderer
+//--------------------------------------------------------------
+/**
+ * @brief Renderer set by UB_VGA_SetLineRenderer(Rows) with its rows, and the ones the ISR uses.
+ * @details The ISR takes them over at the start of a frame, so a frame is
+ *          drawn by one source only.
+ */
+static volatile VGA_LineRenderer P_VGA_LineRenderer = NULL;
+static volatile uint16_t P_VGA_RendererFirst = 0;
+static volatile uint16_t P_VGA_RendererCount = VGA_RENDERER_ALL_ROWS;
+static VGA_LineRenderer P_VGA_LineRendererShown = NULL;
+static uint16_t P_VGA_RendererFirstShown = 0;
+static uint16_t P_VGA_RendererCountShown = VGA_RENDERER_ALL_ROWS;
+
+/**
+ * @brief Overlays set by UB_VGA_SetLineOverlay, and the ones the ISR uses.
+ * @details The ISR keeps the overlays that are set, in layer order.
+ *          P_VGA_RowOverlaid tells the repeats of a row that an overlay drew
+ *          its first one into the line buffer.
+ */
+static volatile VGA_LineOverlay P_VGA_LineOverlay[VGA_OVERLAY_LAYERS];
+static VGA_LineOverlay P_VGA_LineOverlayShown[VGA_OVERLAY_LAYERS];
+static uint8_t P_VGA_OverlayCountShown = 0;
+static bool P_VGA_RowOverlaid = false;
+
+/**
+ * @brief Takes over the overlays that are set, in layer order.
+ */
+static inline void P_VGA_TakeOverlays(void)
+{
+  uint32_t count = 0;
+  for(uint32_t i = 0; i < VGA_OVERLAY_LAYERS; i++) {
+    VGA_LineOverlay overlay = P_VGA_LineOverlay[i];
+    if(overlay != NULL) P_VGA_LineOverlayShown[count++] = overlay;
+  }
+  P_VGA_OverlayCountShown = (uint8_t)count;
+}
+
+/**
+ * @brief Reads pixel x of a 4 bpp framebuffer line.
+ */
+static inline uint8_t P_VGA_GetNibble(const uint8_t *row, int32_t x)
+{
+  return (row[x >> 1] >> ((~x & 1) << 2)) & 0x0F;
+}
+
+/**
+ * @brief Writes pixel x of a 4 bpp framebuffer line.
+ */
+static inline void P_VGA_SetNibble(uint8_t *row, int32_t x, uint8_t value)
+{
+  uint8_t *p = &row[x >> 1];
+  if(x & 1) {
+    *p = (*p & 0xF0) | value;
+  }
+  else {
+    *p = (*p & 0x0F) | (value << 4);
+  }
+}
+
+//--------------------------------------------------------------
+// Interrupt cycle measurement
+//--------------------------------------------------------------
+#if VGA_MEASURE_ISR
+static volatile VGA_IsrStats P_VGA_IsrStats;
+
+#define P_VGA_ISR_ENTER()   uint32_t p_vga_isr_start = P_VGA_DWT_CYCCNT
+#define P_VGA_ISR_LEAVE()   P_VGA_IsrRecord(P_VGA_DWT_CYCCNT - p_vga_isr_start)
+#define P_VGA_ISR_LINE_END()  P_VGA_IsrLineEnd(TIM2->CNT)
+
+/**
+ * @brief Adds the cycles of one interrupt call to the statistics.
  */
-uint8_t VGA_RAM1[(VGA_DISPLAY_X+1)*VGA_DISPLAY_Y];
+static inline void P_VGA_IsrRecord(uint32_t cycles)
+{
+  P_VGA_IsrStats.calls++;
+  P_VGA_IsrStats.total_cycles += cycles;
+  if(cycles < P_VGA_IsrStats.min_cycles) P_VGA_IsrStats.min_cycles = cycles;
+  if(cycles > P_VGA_IsrStats.max_cycles) P_VGA_IsrStats.max_cycles = cycles;
+}
+
+/**
+ * @brief Adds the TIM2 count at the end of a line to the statistics.
+ */
+static inline void P_VGA_IsrLineEnd(uint32_t tick)
+{
+  if(tick < P_VGA_IsrStats.min_end_tick) P_VGA_IsrStats.min_end_tick = tick;
+  if(tick > P_VGA_IsrStats.max_end_tick) P_VGA_IsrStats.max_end_tick = tick;
+}
+#else
+#define P_VGA_ISR_ENTER()
+#define P_VGA_ISR_LEAVE()
+#define P_VGA_ISR_LINE_END()
+#endif
 
 //--------------------------------------------------------------
 // Internal function prototypes
 //--------------------------------------------------------------
 static void P_VGA_InitIO(void);
+static void P_VGA_Stop(void);
 static void P_VGA_InitTIM(void);
 static void P_VGA_InitINT(void);
 static void P_VGA_InitDMA(void);
+static void P_VGA_BuildExpandTable(void);
+static void P_VGA_BuildIndexTable(void);
+static void P_VGA_InitLineMap(void);
+static volatile uint16_t *P_VGA_LineMapBegin(void);
+static void P_VGA_LineMapEnd(volatile uint16_t *map);
+static void P_VGA_CompileBands(volatile uint16_t *map);
+static uint32_t P_VGA_PageSize(void);
+static bool P_VGA_FramebufferFits(void);
+static bool P_VGA_FramebufferHidden(void);
+static void P_VGA_CopyForward(uint8_t *dst, const uint8_t *src);
+static uint32_t P_VGA_PixelCycles(const VGA_Mode *mode);
 static VGA_Status P_VGA_DrawSinglePixelLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint8_t color);
 
 
@@ -52,28 +305,640 @@ static VGA_Status P_VGA_DrawSinglePixelLine(int32_t x1, int32_t y1, int32_t x2,
  */
 void UB_VGA_Screen_Init(void)
 {
-  uint16_t xp,yp;
+#if VGA_MEASURE_ISR
+  // Start the cycle counter
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  P_VGA_DWT_CYCCNT = 0;
+  P_VGA_DWT_CTRL |= P_VGA_DWT_CTRL_CYCCNTENA;
+  UB_VGA_ResetIsrStats();
+#endif
+
+  P_VGA_InitIO();
+  if(UB_VGA_SetMode(VGA_DEFAULT_MODE) != VGA_SUCCESS) {
+    UB_VGA_SetMode(VGA_MODE_320X240);
+  }
+}
 
-  VGA.hsync_cnt=0;
-  VGA.start_adr=0;
-  VGA.dma2_cr_reg=0;
+/**
+ * @brief Checks the timing and memory use of a video mode.
+ */
+VGA_Status UB_VGA_CheckMode(const VGA_Mode *mode)
+{
+  if(mode == NULL) return VGA_ERROR_INVALID_PARAMETER;
+
+  // Framebuffer: at least one guard pixel per line, and it has to fit
+  if(mode->width == 0 || mode->height == 0) return VGA_ERROR_INVALID_PARAMETER;
+  if(mode->stride <= mode->width || mode->stride > VGA_MAX_LINE_STRIDE) return VGA_ERROR_INVALID_PARAMETER;
+  if(mode->width > VGA_MAX_DISPLAY_X || mode->line_shift > 3) return VGA_ERROR_INVALID_PARAMETER;
+  if(mode->bpp == 8) {
+    if(mode->pitch != mode->stride) return VGA_ERROR_INVALID_PARAMETER;
+  }
+  else if(mode->bpp == 4) {
+    // Lines are expanded eight pixels (one word) at a time into a line
+    // buffer, which only the double-buffer engine can send
+    if(!VGA_SCANOUT_DOUBLE_BUFFER || (mode->width & 7) != 0) return VGA_ERROR_INVALID_PARAMETER;
+    if(mode->pitch != mode->width / 2) return VGA_ERROR_INVALID_PARAMETER;
+  }
+  else {
+    return VGA_ERROR_INVALID_PARAMETER;
+  }
 
-  UB_VGA_ResetClipRect();
+  // Horizontal: the pixels, guard pixels included, lie between the end of
+  // the HSync pulse and the end of the line. TIM3 counts the gate in TIM2
+  // ticks of two HCLK cycles, so the line must be an even number of cycles.
+  uint32_t pixel_cycles = P_VGA_PixelCycles(mode);
+  if(mode->pixel_clocks < VGA_MIN_PIXEL_CLOCKS || (pixel_cycles & 1) != 0) return VGA_ERROR_INVALID_PARAMETER;
+  if(mode->h_sync == 0 || mode->h_start <= mode->h_sync) return VGA_ERROR_INVALID_PARAMETER;
+  if(mode->h_start + pixel_cycles / P_VGA_HCLK_PER_TICK >= mode->h_total) return VGA_ERROR_INVALID_PARAMETER;
 
-  // Clear framebuffer to black
-  for(yp=0;yp<VGA_DISPLAY_Y;yp++) {
-    for(xp=0;xp<(VGA_DISPLAY_X+1);xp++) {
-      VGA_RAM1[(yp*(VGA_DISPLAY_X+1))+xp]=0;
-    }
+  // Vertical: the picture lies between the end of the VSync pulse and the
+  // end of the frame
+  if(mode->v_sync == 0 || mode->v_start <= mode->v_sync) return VGA_ERROR_INVALID_PARAMETER;
+  if(mode->v_start + ((uint32_t)mode->height << mode->line_shift) > mode->v_total) return VGA_ERROR_INVALID_PARAMETER;
+
+  if((uint32_t)mode->pitch * mode->height > VGA_RAM_SIZE) return VGA_ERROR_OUT_OF_MEMORY;
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Switches to another video mode.
+ */
+VGA_Status UB_VGA_SetMode(VGA_ModeId id)
+{
+  if(id >= VGA_MODE_COUNT) return VGA_ERROR_INVALID_PARAMETER;
+
+  const VGA_Mode *mode = &VGA_Modes[id];
+  VGA_Status status = UB_VGA_CheckMode(mode);
+  // A line renderer of the whole screen only needs the line buffers
+  if(status == VGA_ERROR_OUT_OF_MEMORY && P_VGA_FramebufferHidden()) status = VGA_SUCCESS;
+  if(status != VGA_SUCCESS) return status;
+
+  P_VGA_Stop();
+
+  VGA.mode = mode;
+  VGA.hsync_cnt = 0;
+  VGA.start_adr = (uint32_t)(&VGA_RAM1[0]);
+  VGA.dma2_cr_reg = 0;
+  UB_VGA_ResetClipRect();
+  P_VGA_InitLineMap();
+
+  // One page, at the start of VGA_RAM1
+  P_VGA_PageCount = 1;
+  P_VGA_ShowPage = VGA_RAM1;
+  P_VGA_NextPage = NULL;
+  P_VGA_DirtyCount = 0;
+  VGA.draw_ram = VGA_RAM1;
+
+  // Clear framebuffer to black, guard pixels included; at 4 bpp index 0
+  // is black with the default palette
+  if(P_VGA_FramebufferFits()) memset(VGA_RAM1, 0, (uint32_t)mode->pitch * mode->height);
+  if(mode->bpp == 4 && !P_VGA_ExpandValid) P_VGA_BuildExpandTable();
+  P_VGA_LineRendererShown = P_VGA_LineRenderer;
+  P_VGA_RendererFirstShown = P_VGA_RendererFirst;
+  P_VGA_RendererCountShown = P_VGA_RendererCount;
+  P_VGA_TakeOverlays();
+#if VGA_SCANOUT_DOUBLE_BUFFER
+  // A wider mode may have left pixels where the guard pixels are now
+  memset(P_VGA_LineBuffer, 0, sizeof(P_VGA_LineBuffer));
+#endif
+
+  // VSync idles high for negative and low for positive pulses
+  if(mode->sync_positive) {
+    GPIOB->BSRRH = GPIO_Pin_12;
+  }
+  else {
+    GPIOB->BSRRL = GPIO_Pin_12;
   }
 
-  P_VGA_InitIO();
   P_VGA_InitTIM();
   P_VGA_InitDMA();
   P_VGA_InitINT();
 
-  // Read and store the initial configuration of the DMA Stream's Control Register
-  VGA.dma2_cr_reg=DMA2_Stream5->CR;
+  // Read and store the initial configuration of the DMA Stream's Control Register
+  VGA.dma2_cr_reg=DMA2_Stream5->CR;
+
+#if VGA_SCANOUT_DOUBLE_BUFFER
+  // Arm the stream before the first gate opens, so that it receives exactly
+  // one line of requests per gate from the very first line on
+  DMA_Cmd(DMA2_Stream5, ENABLE);
+  TIM_Cmd(TIM1, ENABLE);
+  TIM_Cmd(TIM3, ENABLE);
+#endif
+  // TIM2 is the master of the line timing, start it last
+  TIM_Cmd(TIM2, ENABLE);
+  P_VGA_Running = true;
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Returns the line and frame timing of the current mode.
+ */
+void UB_VGA_GetTiming(VGA_Timing *timing)
+{
+  if(timing == NULL) return;
+
+  const VGA_Mode *mode = VGA.mode;
+  timing->line_cycles = (uint32_t)mode->h_total * P_VGA_HCLK_PER_TICK;
+  timing->pixel_cycles = P_VGA_PixelCycles(mode);
+  timing->gate_ticks = timing->pixel_cycles / P_VGA_HCLK_PER_TICK;
+  timing->hblank_cycles = timing->line_cycles - timing->pixel_cycles;
+  timing->frame_cycles = timing->line_cycles * mode->v_total;
+  timing->visible_lines = (uint16_t)(mode->height << mode->line_shift);
+  // The original engine adds a DMA interrupt to every line with picture
+  timing->irqs_per_frame = mode->v_total + (VGA_SCANOUT_DOUBLE_BUFFER ? 0 : timing->visible_lines);
+  timing->frame_hz_x100 = (uint32_t)((uint64_t)P_VGA_TIM2_HZ * 100 / ((uint32_t)mode->h_total * mode->v_total));
+}
+
+/**
+ * @brief Reads the cycle statistics of the scanout interrupts.
+ */
+void UB_VGA_GetIsrStats(VGA_IsrStats *stats)
+{
+  if(stats == NULL) return;
+
+#if VGA_MEASURE_ISR
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  stats->calls = P_VGA_IsrStats.calls;
+  stats->total_cycles = P_VGA_IsrStats.total_cycles;
+  stats->min_cycles = (P_VGA_IsrStats.calls != 0) ? P_VGA_IsrStats.min_cycles : 0;
+  stats->max_cycles = P_VGA_IsrStats.max_cycles;
+  stats->min_end_tick = (P_VGA_IsrStats.calls != 0) ? P_VGA_IsrStats.min_end_tick : 0;
+  stats->max_end_tick = P_VGA_IsrStats.max_end_tick;
+  __set_PRIMASK(primask);
+#else
+  memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+/**
+ * @brief Clears the cycle statistics of the scanout interrupts.
+ */
+void UB_VGA_ResetIsrStats(void)
+{
+#if VGA_MEASURE_ISR
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  P_VGA_IsrStats.calls = 0;
+  P_VGA_IsrStats.total_cycles = 0;
+  P_VGA_IsrStats.min_cycles = UINT32_MAX;
+  P_VGA_IsrStats.max_cycles = 0;
+  P_VGA_IsrStats.min_end_tick = UINT32_MAX;
+  P_VGA_IsrStats.max_end_tick = 0;
+  __set_PRIMASK(primask);
+#endif
+}
+
+/**
+ * @brief Sets one entry of the palette.
+ */
+VGA_Status UB_VGA_SetPaletteEntry(uint8_t index, uint8_t color)
+{
+  if(index >= VGA_PALETTE_SIZE) return VGA_ERROR_INVALID_PARAMETER;
+
+  P_VGA_Palette[index] = color;
+  if(P_VGA_ExpandValid) {
+    // Only the 31 bytes that contain the index change
+    for(uint32_t n = 0; n < VGA_PALETTE_SIZE; n++) {
+      uint32_t high = (index << 4) | n;
+      uint32_t low = (n << 4) | index;
+      P_VGA_ExpandTable[high] = (uint16_t)(color | (P_VGA_Palette[n] << 8));
+      P_VGA_ExpandTable[low] = (uint16_t)(P_VGA_Palette[n] | (color << 8));
+    }
+  }
+  P_VGA_IndexValid = false;
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Sets the whole palette.
+ */
+VGA_Status UB_VGA_SetPalette(const uint8_t *colors)
+{
+  if(colors == NULL) return VGA_ERROR_INVALID_PARAMETER;
+
+  memcpy(P_VGA_Palette, colors, VGA_PALETTE_SIZE);
+  if(P_VGA_ExpandValid) P_VGA_BuildExpandTable();
+  P_VGA_IndexValid = false;
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Restores the default palette.
+ */
+void UB_VGA_ResetPalette(void)
+{
+  UB_VGA_SetPalette(P_VGA_DefaultPalette);
+}
+
+/**
+ * @brief Reads one entry of the palette.
+ */
+uint8_t UB_VGA_GetPaletteEntry(uint8_t index)
+{
+  if(index >= VGA_PALETTE_SIZE) return 0;
+  return P_VGA_Palette[index];
+}
+
+/**
+ * @brief Returns the value the framebuffer stores for a color.
+ */
+uint8_t UB_VGA_ColorValue(uint8_t color)
+{
+  if(!VGA_INDEXED) return color;
+  if(!P_VGA_IndexValid) P_VGA_BuildIndexTable();
+  return P_VGA_PaletteIndex[color];
+}
+
+/**
+ * @brief Returns the index of the palette entry nearest to a color.
+ */
+uint8_t UB_VGA_PaletteIndex(uint8_t color)
+{
+  if(!P_VGA_IndexValid) P_VGA_BuildIndexTable();
+  return P_VGA_PaletteIndex[color];
+}
+
+/**
+ * @brief Divides the screen into bands with their own window and scroll position.
+ */
+VGA_Status UB_VGA_SetBands(const VGA_Band *bands, uint8_t count)
+{
+  if(bands == NULL || count == 0 || count > VGA_MAX_BANDS) return VGA_ERROR_INVALID_PARAMETER;
+
+  int32_t rows = 0;
+  for(uint8_t i = 0; i < count; i++) {
+    const VGA_Band *band = &bands[i];
+    if(band->rows == 0 || band->height == 0 || band->zoom == 0 || band->scroll >= band->height) {
+      return VGA_ERROR_INVALID_PARAMETER;
+    }
+    if(band->top + band->height > VGA_DISPLAY_Y) return VGA_ERROR_INVALID_COORDINATE;
+    rows += band->rows;
+  }
+  if(rows != VGA_DISPLAY_Y) return VGA_ERROR_INVALID_PARAMETER;
+
+  memcpy(P_VGA_Bands, bands, count * sizeof(VGA_Band));
+  P_VGA_BandCount = count;
+
+  volatile uint16_t *map = P_VGA_LineMapBegin();
+  P_VGA_CompileBands(map);
+  P_VGA_LineMapEnd(map);
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Scrolls one band.
+ */
+VGA_Status UB_VGA_ScrollBand(uint8_t index, int32_t lines)
+{
+  if(index >= P_VGA_BandCount) return VGA_ERROR_INVALID_PARAMETER;
+
+  VGA_Band *band = &P_VGA_Bands[index];
+  int32_t scroll = band->scroll + lines % band->height;
+  if(scroll < 0) scroll += band->height;
+  if(scroll >= band->height) scroll -= band->height;
+  band->scroll = (uint16_t)scroll;
+
+  volatile uint16_t *map = P_VGA_LineMapBegin();
+  P_VGA_CompileBands(map);
+  P_VGA_LineMapEnd(map);
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Sets the framebuffer line of every screen row directly.
+ */
+VGA_Status UB_VGA_SetLineMap(const uint16_t *lines)
+{
+  if(lines == NULL) return VGA_ERROR_INVALID_PARAMETER;
+  for(int32_t row = 0; row < VGA_DISPLAY_Y; row++) {
+    if(lines[row] >= VGA_DISPLAY_Y) return VGA_ERROR_INVALID_COORDINATE;
+  }
+
+  P_VGA_BandCount = 0;
+
+  volatile uint16_t *map = P_VGA_LineMapBegin();
+  for(int32_t row = 0; row < VGA_DISPLAY_Y; row++) {
+    map[row] = lines[row];
+  }
+  P_VGA_LineMapEnd(map);
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Shows every framebuffer line on its own row again.
+ */
+void UB_VGA_ResetLineMap(void)
+{
+  VGA_Band band = { .rows = VGA_DISPLAY_Y, .top = 0, .height = VGA_DISPLAY_Y, .scroll = 0, .zoom = 1 };
+  UB_VGA_SetBands(&band, 1);
+}
+
+/**
+ * @brief Returns the framebuffer line shown on a screen row.
+ */
+uint16_t UB_VGA_GetRowLine(uint16_t row)
+{
+  if(row >= VGA_DISPLAY_Y || P_VGA_LineMapLast == NULL) return row;
+  return P_VGA_LineMapLast[row];
+}
+
+/**
+ * @brief Sets the number of framebuffer pages.
+ */
+VGA_Status UB_VGA_SetPages(uint8_t count)
+{
+  if(count < 1 || count > 2) return VGA_ERROR_INVALID_PARAMETER;
+  if(count == P_VGA_PageCount) return VGA_SUCCESS;
+  if(P_VGA_FramebufferHidden()) return VGA_ERROR_INVALID_PARAMETER;
+
+  uint32_t size = P_VGA_PageSize();
+  if(count == 2) {
+    if(2 * size > VGA_RAM_SIZE) return VGA_ERROR_OUT_OF_MEMORY;
+    // Draw on a copy of the screen in the other page
+    uint8_t *back = (P_VGA_ShowPage == VGA_RAM1) ? &VGA_RAM1[size] : VGA_RAM1;
+    memcpy(back, P_VGA_ShowPage, size);
+    VGA.draw_ram = back;
+  }
+  else {
+    VGA.draw_ram = P_VGA_ShowPage;
+  }
+  P_VGA_PageCount = count;
+  P_VGA_DirtyCount = 0;
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Returns the number of framebuffer pages.
+ */
+uint8_t UB_VGA_GetPages(void)
+{
+  return P_VGA_PageCount;
+}
+
+/**
+ * @brief Shows the back page from the next frame on.
+ */
+VGA_Status UB_VGA_Present(bool copy_forward)
+{
+  if(P_VGA_PageCount < 2) return VGA_ERROR_INVALID_PARAMETER;
+
+  uint8_t *front = VGA.draw_ram;
+  uint8_t *back = P_VGA_ShowPage;
+  if(P_VGA_Running) {
+    // The ISR flips at the start of the next frame; until then the old
+    // front page is still on screen and must not be drawn to. Without the
+    // ISR (interrupts masked, or the scanout stopped) the flip never comes,
+    // so the wait ends after two frames of the mode.
+    const VGA_Mode *mode = VGA.mode;
+    uint32_t limit = 2u * mode->h_total * mode->v_total * P_VGA_HCLK_PER_TICK;
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    P_VGA_DWT_CTRL |= P_VGA_DWT_CTRL_CYCCNTENA;
+    uint32_t start = P_VGA_DWT_CYCCNT;
+    P_VGA_NextPage = front;
+    while(P_VGA_NextPage != NULL && P_VGA_Running && P_VGA_DWT_CYCCNT - start < limit) {
+    }
+
+    // Withdraw a flip that did not happen; the ISR may still take it until then
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    bool pending = (P_VGA_NextPage != NULL);
+    P_VGA_NextPage = NULL;
+    __set_PRIMASK(primask);
+    if(pending) {
+      if(P_VGA_Running) return VGA_ERROR_TIMEOUT;
+      P_VGA_ShowPage = front;
+      P_VGA_FlipFrame = P_VGA_FrameCount;
+    }
+  }
+  else {
+    P_VGA_ShowPage = front;
+    P_VGA_FlipFrame = P_VGA_FrameCount;
+  }
+
+  // The frames between the previous flip and this one repeated a page
+  uint32_t frames = P_VGA_FlipFrame - P_VGA_LastFlip;
+  if(P_VGA_Presented != 0 && frames > 1) P_VGA_Dropped += frames - 1;
+  P_VGA_LastFlip = P_VGA_FlipFrame;
+  P_VGA_Presented++;
+
+  VGA.draw_ram = back;
+  if(copy_forward) P_VGA_CopyForward(back, front);
+  P_VGA_DirtyCount = 0;
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Marks a rectangle of the back page as drawn.
+ */
+void UB_VGA_MarkDirty(const VGA_Rect *rect)
+{
+  if(rect == NULL) return;
+
+  int32_t x0 = max(rect->x, 0);
+  int32_t y0 = max(rect->y, 0);
+  int32_t x1 = min(rect->x + rect->width, VGA_DISPLAY_X);
+  int32_t y1 = min(rect->y + rect->height, VGA_DISPLAY_Y);
+  if(x0 >= x1 || y0 >= y1) return;
+
+  if(P_VGA_DirtyCount == VGA_MAX_DIRTY) {
+    // Out of rectangles: merge them all into one
+    for(uint8_t i = 0; i < VGA_MAX_DIRTY; i++) {
+      const VGA_Rect *r = &P_VGA_Dirty[i];
+      x0 = min(x0, r->x);
+      y0 = min(y0, r->y);
+      x1 = max(x1, r->x + r->width);
+      y1 = max(y1, r->y + r->height);
+    }
+    P_VGA_DirtyCount = 0;
+  }
+  VGA_Rect *r = &P_VGA_Dirty[P_VGA_DirtyCount++];
+  r->x = x0;
+  r->y = y0;
+  r->width = x1 - x0;
+  r->height = y1 - y0;
+}
+
+/**
+ * @brief Returns the page flip counters.
+ */
+void UB_VGA_GetPageStats(VGA_PageStats *stats)
+{
+  if(stats == NULL) return;
+
+  const VGA_Mode *mode = VGA.mode;
+  stats->frames = P_VGA_FrameCount - P_VGA_StatsFrame;
+  stats->presented = P_VGA_Presented;
+  stats->dropped = P_VGA_Dropped;
+  // Frame rate of the mode in 1/100 Hz: TIM2 ticks per second over ticks per frame
+  uint32_t rate = (uint32_t)((uint64_t)P_VGA_TIM2_HZ * 100 / ((uint32_t)mode->h_total * mode->v_total));
+  stats->fps_x100 = (stats->frames != 0) ? (uint32_t)((uint64_t)stats->presented * rate / stats->frames) : 0;
+}
+
+/**
+ * @brief Clears the page flip counters.
+ */
+void UB_VGA_ResetPageStats(void)
+{
+  P_VGA_StatsFrame = P_VGA_FrameCount;
+  P_VGA_Presented = 0;
+  P_VGA_Dropped = 0;
+}
+
+/**
+ * @brief Lets a function draw every row just before it is scanned out.
+ */
+VGA_Status UB_VGA_SetLineRenderer(VGA_LineRenderer renderer)
+{
+  return UB_VGA_SetLineRendererRows(renderer, 0, VGA_RENDERER_ALL_ROWS);
+}
+
+/**
+ * @brief Lets a function draw some rows just before they are scanned out.
+ */
+VGA_Status UB_VGA_SetLineRendererRows(VGA_LineRenderer renderer, uint16_t first, uint16_t count)
+{
+  bool whole = (renderer != NULL && first == 0 && count == VGA_RENDERER_ALL_ROWS);
+  if(renderer != NULL) {
+    // Rows are drawn into the line buffers of the double-buffer engine
+    if(!VGA_SCANOUT_DOUBLE_BUFFER || count == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if(whole && P_VGA_PageCount != 1) return VGA_ERROR_INVALID_PARAMETER;
+  }
+  if(!whole && !P_VGA_FramebufferFits()) return VGA_ERROR_OUT_OF_MEMORY;
+
+  // The ISR must not take over a renderer with the rows of another
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  P_VGA_LineRenderer = renderer;
+  P_VGA_RendererFirst = first;
+  P_VGA_RendererCount = count;
+  if(!P_VGA_Running) {
+    P_VGA_LineRendererShown = renderer;
+    P_VGA_RendererFirstShown = first;
+    P_VGA_RendererCountShown = count;
+  }
+  __set_PRIMASK(primask);
+
+  // Turns drawing into the framebuffer off or on again
+  UB_VGA_ResetClipRect();
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Returns the line renderer set with UB_VGA_SetLineRenderer(Rows).
+ */
+VGA_LineRenderer UB_VGA_GetLineRenderer(void)
+{
+  return P_VGA_LineRenderer;
+}
+
+/**
+ * @brief Lets a function draw over the framebuffer rows just before they are scanned out.
+ */
+VGA_Status UB_VGA_SetLineOverlay(uint8_t layer, VGA_LineOverlay overlay)
+{
+  if(layer >= VGA_OVERLAY_LAYERS) return VGA_ERROR_INVALID_PARAMETER;
+  if(overlay != NULL && !VGA_SCANOUT_DOUBLE_BUFFER) return VGA_ERROR_INVALID_PARAMETER;
+
+  P_VGA_LineOverlay[layer] = overlay;
+  if(!P_VGA_Running) P_VGA_TakeOverlays();
+  return VGA_SUCCESS;
+}
+
+/**
+ * @brief Returns the line overlay of a layer set with UB_VGA_SetLineOverlay.
+ */
+VGA_LineOverlay UB_VGA_GetLineOverlay(uint8_t layer)
+{
+  if(layer >= VGA_OVERLAY_LAYERS) return NULL;
+  return P_VGA_LineOverlay[layer];
+}
+
+/**
+ * @brief Tells whether the scanout runs.
+ */
+bool UB_VGA_IsRunning(void)
+{
+  return P_VGA_Running;
+}
+
+/**
+ * @brief Tells whether the scanout is in the vertical blanking interval.
+ */
+bool UB_VGA_InVBlank(void)
+{
+  const VGA_Mode *mode = VGA.mode;
+  uint32_t lines = (uint32_t)mode->height << mode->line_shift;
+
+  // Neither the line being sent nor the next one; the subtraction wraps
+  // above the picture
+  uint32_t line = (uint32_t)VGA.hsync_cnt - mode->v_start;
+  return !P_VGA_Running || (line >= lines && line + 1 >= lines);
+}
+
+/**
+ * @brief Waits for the start of the next vertical blanking interval.
+ */
+void UB_VGA_WaitForVBlank(void)
+{
+  if(!P_VGA_Running) return;
+
+  while(UB_VGA_InVBlank()) {
+  }
+  while(!UB_VGA_InVBlank()) {
+  }
+}
+
+/**
+ * @brief Returns the time until the scanout reads pixels again.
+ */
+uint32_t UB_VGA_BlankCycles(void)
+{
+  if(!P_VGA_Running) return UINT32_MAX;
+
+  const VGA_Mode *mode = VGA.mode;
+  uint32_t lines = (uint32_t)mode->height << mode->line_shift;
+  uint32_t end = mode->h_start + (uint32_t)mode->pixel_clocks * mode->stride / 2 + P_VGA_LINE_END_TICKS;
+
+  // The line count and the position in the line, without an interrupt in between
+  uint32_t count;
+  uint32_t tick;
+  do {
+    count = VGA.hsync_cnt;
+    tick = TIM2->CNT;
+  } while(count != VGA.hsync_cnt);
+
+  // The next line to start and the ticks until its first pixel. The
+  // double-buffer engine counts a line when the one before it ends, the
+  // original engine when it starts.
+  uint32_t next;
+  uint32_t ticks;
+  if(tick >= mode->h_start && tick < end) {
+    // The pixels of line count are sent, if it is in the picture
+    if((uint32_t)count - mode->v_start < lines) return 0;
+#if !VGA_SCANOUT_DOUBLE_BUFFER
+    // Its line start interrupt may not have counted the line yet
+    if(tick < mode->h_start + P_VGA_LINE_END_TICKS && (uint32_t)count + 1 - mode->v_start < lines) return 0;
+#endif
+    next = count + 1;
+    ticks = mode->h_total - tick + mode->h_start;
+  }
+  else {
+#if VGA_SCANOUT_DOUBLE_BUFFER
+    next = count;
+#else
+    next = count + 1;
+#endif
+    ticks = (tick < mode->h_start) ? mode->h_start - tick : mode->h_total - tick + mode->h_start;
+  }
+  if(next >= mode->v_total) next -= mode->v_total;
+
+  // Lines of the vertical blanking interval before it; the subtraction
+  // wraps above the picture
+  if((uint32_t)next - mode->v_start >= lines) {
+    ticks += ((mode->v_start + mode->v_total - next) % mode->v_total) * (uint32_t)mode->h_total;
+  }
+  return ticks * P_VGA_HCLK_PER_TICK;
 }
 
 /**
@@ -81,7 +946,7 @@ void UB_VGA_Screen_Init(void)
  */
 void UB_VGA_SetClipRect(const VGA_Rect *rect)
 {
-    if (rect == NULL) {
+    if (rect == NULL || P_VGA_FramebufferHidden()) {
         UB_VGA_ResetClipRect();
         return;
     }
@@ -107,8 +972,10 @@ void UB_VGA_ResetClipRect(void)
 {
     VGA.clip_rect.x = 0;
     VGA.clip_rect.y = 0;
-    VGA.clip_rect.width = VGA_DISPLAY_X;
-    VGA.clip_rect.height = VGA_DISPLAY_Y;
+    // Nothing is drawn while a line renderer replaces the framebuffer,
+    // which may not even fit in VGA_RAM1
+    VGA.clip_rect.width = P_VGA_FramebufferHidden() ? 0 : VGA_DISPLAY_X;
+    VGA.clip_rect.height = P_VGA_FramebufferHidden() ? 0 : VGA_DISPLAY_Y;
 }
 
 /**
@@ -116,10 +983,16 @@ void UB_VGA_ResetClipRect(void)
  */
 VGA_Status UB_VGA_FillScreen(uint8_t color)
 {
-  memset(VGA_RAM1, color, (VGA_DISPLAY_X+1)*VGA_DISPLAY_Y);
-  // Ensure the guard pixel at the end of each line is black.
+  if(P_VGA_FramebufferHidden()) return VGA_SUCCESS;
+  if(VGA_INDEXED) {
+    // No guard pixels in a 4 bpp framebuffer
+    memset(VGA_FRAMEBUFFER, UB_VGA_ColorValue(color) * 0x11, VGA_LINE_STRIDE*VGA_DISPLAY_Y);
+    return VGA_SUCCESS;
+  }
+  memset(VGA_FRAMEBUFFER, color, VGA_LINE_STRIDE*VGA_DISPLAY_Y);
+  // Ensure the guard pixels at the end of each line are black.
   for(uint16_t yp=0; yp<VGA_DISPLAY_Y; yp++) {
-      VGA_RAM1[(yp*(VGA_DISPLAY_X+1))+VGA_DISPLAY_X] = 0;
+      memset(&VGA_FRAMEBUFFER[(yp*VGA_LINE_STRIDE)+VGA_DISPLAY_X], 0, VGA_LINE_STRIDE-VGA_DISPLAY_X);
   }
   return VGA_SUCCESS;
 }
@@ -138,11 +1011,28 @@ VGA_Status UB_VGA_SetPixel(uint16_t xp, uint16_t yp, uint8_t color)
       return VGA_SUCCESS; // Not an error, just clipped.
   }
 
-  VGA_RAM1[(yp*(VGA_DISPLAY_X+1))+xp]=color;
+  if(VGA_INDEXED) {
+    P_VGA_SetNibble(&VGA_FRAMEBUFFER[yp*VGA_LINE_STRIDE], xp, UB_VGA_ColorValue(color));
+  }
+  else {
+    VGA_FRAMEBUFFER[(yp*VGA_LINE_STRIDE)+xp]=color;
+  }
 
   return VGA_SUCCESS;
 }
 
+/**
+ * @brief Reads the color of a single pixel.
+ */
+uint8_t UB_VGA_GetPixel(uint16_t xp, uint16_t yp)
+{
+  if(xp >= VGA_DISPLAY_X || yp >= VGA_DISPLAY_Y || P_VGA_FramebufferHidden()) return 0;
+
+  const uint8_t *row = &VGA_FRAMEBUFFER[yp*VGA_LINE_STRIDE];
+  if(VGA_INDEXED) return P_VGA_Palette[P_VGA_GetNibble(row, xp)];
+  return row[xp];
+}
+
 /**
  * @brief Draws a fast horizontal line, respecting the clipping rectangle.
  */
@@ -155,8 +1045,7 @@ VGA_Status UB_VGA_FastHLine(int32_t x0, int32_t y, int32_t x1, uint8_t color)
 
     if (start_x > end_x) return VGA_SUCCESS;
 
-    uint32_t base_addr = y * (VGA_DISPLAY_X + 1);
-    memset(&VGA_RAM1[base_addr + start_x], color, end_x - start_x + 1);
+    UB_VGA_FillValues(start_x, y, end_x, UB_VGA_ColorValue(color));
 
     return VGA_SUCCESS;
 }
@@ -173,13 +1062,234 @@ VGA_Status UB_VGA_FastVLine(int32_t x, int32_t y0, int32_t y1, uint8_t color)
     
     if (start_y > end_y) return VGA_SUCCESS;
 
-    uint32_t line_addr_start = start_y * (VGA_DISPLAY_X + 1) + x;
+    if (VGA_INDEXED) {
+        uint8_t value = UB_VGA_ColorValue(color);
+        for (int32_t y = start_y; y <= end_y; y++) {
+            P_VGA_SetNibble(&VGA_FRAMEBUFFER[y * VGA_LINE_STRIDE], x, value);
+        }
+        return VGA_SUCCESS;
+    }
+
+    uint32_t line_addr_start = start_y * VGA_LINE_STRIDE + x;
     for (int32_t i = 0; i <= (end_y - start_y); i++) {
-        VGA_RAM1[line_addr_start + i * (VGA_DISPLAY_X + 1)] = color;
+        VGA_FRAMEBUFFER[line_addr_start + i * VGA_LINE_STRIDE] = color;
     }
     return VGA_SUCCESS;
 }
 
+/**
+ * @brief Writes a stored value to a run of pixels.
+ */
+void UB_VGA_FillValues(int32_t x0, int32_t y, int32_t x1, uint8_t value)
+{
+  uint8_t *row = &VGA_FRAMEBUFFER[y * VGA_LINE_STRIDE];
+
+  if(!VGA_INDEXED) {
+    memset(&row[x0], value, x1 - x0 + 1);
+    return;
+  }
+
+  // A lone right pixel, whole bytes, then a lone left pixel
+  if(x0 & 1) {
+    P_VGA_SetNibble(row, x0, value);
+    x0++;
+  }
+  if(x0 > x1) return;
+  memset(&row[x0 >> 1], value * 0x11, (x1 - x0 + 1) >> 1);
+  if(((x1 - x0) & 1) == 0) {
+    P_VGA_SetNibble(row, x1, value);
+  }
+}
+
+/**
+ * @brief Opens a run of pixels for direct access as R3G3B2 bytes.
+ */
+uint8_t *UB_VGA_SpanBegin(int32_t x, int32_t y, int32_t count)
+{
+  if(!VGA_INDEXED) return &VGA_FRAMEBUFFER[y * VGA_LINE_STRIDE + x];
+
+  P_VGA_SpanRow = &VGA_FRAMEBUFFER[y * VGA_LINE_STRIDE];
+  P_VGA_SpanX = x;
+  P_VGA_SpanCount = count;
+  for(int32_t i = 0; i < count; i++) {
+    P_VGA_Span[i] = P_VGA_Palette[P_VGA_GetNibble(P_VGA_SpanRow, x + i)];
+  }
+  return P_VGA_Span;
+}
+
+/**
+ * @brief Closes the span opened by UB_VGA_SpanBegin.
+ */
+void UB_VGA_SpanEnd(void)
+{
+  if(!VGA_INDEXED) return;
+
+  if(!P_VGA_IndexValid) P_VGA_BuildIndexTable();
+  for(int32_t i = 0; i < P_VGA_SpanCount; i++) {
+    P_VGA_SetNibble(P_VGA_SpanRow, P_VGA_SpanX + i, P_VGA_PaletteIndex[P_VGA_Span[i]]);
+  }
+}
+
+/**
+ * @brief Builds the table that expands a 4 bpp byte into two pixel colors.
+ */
+static void P_VGA_BuildExpandTable(void)
+{
+  for(uint32_t b = 0; b < 256; b++) {
+    P_VGA_ExpandTable[b] = (uint16_t)(P_VGA_Palette[b >> 4] | (P_VGA_Palette[b & 0x0F] << 8));
+  }
+  P_VGA_ExpandValid = true;
+}
+
+/**
+ * @brief Builds the table with the nearest palette entry of every color.
+ * @details Distance is the squared difference of the red, green and blue
+ *          levels, each scaled to 0..255 (3, 3 and 2 bits). An exact match
+ *          always wins, and of equal distances the lowest index.
+ */
+static void P_VGA_BuildIndexTable(void)
+{
+  for(uint32_t c = 0; c < 256; c++) {
+    int32_t r = (c >> 5) * 36, g = ((c >> 2) & 7) * 36, b = (c & 3) * 85;
+    uint32_t best = UINT32_MAX;
+    for(uint8_t i = 0; i < VGA_PALETTE_SIZE; i++) {
+      uint8_t p = P_VGA_Palette[i];
+      int32_t dr = r - (p >> 5) * 36;
+      int32_t dg = g - ((p >> 2) & 7) * 36;
+      int32_t db = b - (p & 3) * 85;
+      uint32_t d = (uint32_t)(dr * dr + dg * dg + db * db);
+      if(d < best) {
+        best = d;
+        P_VGA_PaletteIndex[c] = i;
+      }
+    }
+  }
+  P_VGA_IndexValid = true;
+}
+
+/**
+ * @brief Sets the identity table in both line maps.
+ * @details Only while the scanout is stopped: the table is also written
+ *          into the map the ISR reads.
+ */
+static void P_VGA_InitLineMap(void)
+{
+  P_VGA_Bands[0].rows = VGA_DISPLAY_Y;
+  P_VGA_Bands[0].top = 0;
+  P_VGA_Bands[0].height = VGA_DISPLAY_Y;
+  P_VGA_Bands[0].scroll = 0;
+  P_VGA_Bands[0].zoom = 1;
+  P_VGA_BandCount = 1;
+
+  P_VGA_CompileBands(P_VGA_LineMaps[0]);
+  P_VGA_CompileBands(P_VGA_LineMaps[1]);
+  P_VGA_LineMap = P_VGA_LineMaps[0];
+  P_VGA_LineMapLast = P_VGA_LineMaps[0];
+  P_VGA_LineMapPending = false;
+}
+
+/**
+ * @brief Returns the line map that the ISR does not read, to write a new table into.
+ * @details Clears the pending flag first: the ISR runs to completion before
+ *          this code continues, so once the flag is clear it cannot swap in
+ *          a table that is half written. A table that was still pending is
+ *          simply overwritten.
+ */
+static volatile uint16_t *P_VGA_LineMapBegin(void)
+{
+  P_VGA_LineMapPending = false;
+  return (P_VGA_LineMap == P_VGA_LineMaps[0]) ? P_VGA_LineMaps[1] : P_VGA_LineMaps[0];
+}
+
+/**
+ * @brief Hands a table written after P_VGA_LineMapBegin to the ISR.
+ */
+static void P_VGA_LineMapEnd(volatile uint16_t *map)
+{
+  P_VGA_LineMapLast = map;
+  P_VGA_LineMapPending = true;
+}
+
+/**
+ * @brief Builds the table of the bands.
+ */
+static void P_VGA_CompileBands(volatile uint16_t *map)
+{
+  for(uint8_t i = 0; i < P_VGA_BandCount; i++) {
+    const VGA_Band *band = &P_VGA_Bands[i];
+    uint16_t line = band->scroll;
+    uint8_t repeat = 0;
+    for(uint16_t row = 0; row < band->rows; row++) {
+      *map++ = band->top + line;
+      if(++repeat == band->zoom) {
+        repeat = 0;
+        if(++line == band->height) line = 0;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Checks whether the framebuffer of the current mode fits in VGA_RAM1.
+ */
+static bool P_VGA_FramebufferFits(void)
+{
+  return (uint32_t)VGA_LINE_STRIDE * VGA_DISPLAY_Y <= VGA_RAM_SIZE;
+}
+
+/**
+ * @brief Tells whether a line renderer draws the whole screen instead of the framebuffer.
+ */
+static bool P_VGA_FramebufferHidden(void)
+{
+  return P_VGA_LineRenderer != NULL && P_VGA_RendererFirst == 0 && P_VGA_RendererCount == VGA_RENDERER_ALL_ROWS;
+}
+
+/**
+ * @brief Bytes per page, rounded up to whole words so that every page
+ *        can be read a word at a time.
+ */
+static uint32_t P_VGA_PageSize(void)
+{
+  return ((uint32_t)VGA_LINE_STRIDE * VGA_DISPLAY_Y + 3) & ~3u;
+}
+
+/**
+ * @brief HCLK cycles of the pixels of a line, guard pixels included: the
+ *        TIM1 periods that the TIM3 gate lets through.
+ */
+static uint32_t P_VGA_PixelCycles(const VGA_Mode *mode)
+{
+  return (uint32_t)mode->pixel_clocks * mode->stride;
+}
+
+/**
+ * @brief Copies the dirty rectangles, or the whole page when none were
+ *        marked, from one page to the other.
+ * @details At 4 bpp whole bytes are copied, so a pixel next to a rectangle
+ *          may be copied as well; it is the same in both pages or newer in src.
+ */
+static void P_VGA_CopyForward(uint8_t *dst, const uint8_t *src)
+{
+  if(P_VGA_DirtyCount == 0) {
+    memcpy(dst, src, P_VGA_PageSize());
+    return;
+  }
+
+  for(uint8_t i = 0; i < P_VGA_DirtyCount; i++) {
+    const VGA_Rect *r = &P_VGA_Dirty[i];
+    int32_t x0 = r->x;
+    int32_t x1 = r->x + r->width;
+    if(VGA_INDEXED) {
+      x0 >>= 1;
+      x1 = (x1 + 1) >> 1;
+    }
+    for(int32_t y = r->y; y < r->y + r->height; y++) {
+      memcpy(&dst[y * VGA_LINE_STRIDE + x0], &src[y * VGA_LINE_STRIDE + x0], x1 - x0);
+    }
+  }
+}
+
 /**
  * @brief Initializes all GPIO pins required for VGA output.
  * @details Configures:
@@ -224,31 +1334,66 @@ static void P_VGA_InitIO(void)
 
 
 /**
- * @brief Initializes TIM1 and TIM2 for VGA signal generation.
+ * @brief Stops the scanout.
+ * @details Returns the timers to their reset state, stops the DMA stream
+ *          and switches the scanout interrupts off, so the next mode can be
+ *          programmed from scratch. Also safe before the first mode is set.
+ */
+static void P_VGA_Stop(void)
+{
+  P_VGA_Running = false;
+  NVIC_DisableIRQ(TIM2_IRQn);
+  NVIC_DisableIRQ(DMA2_Stream5_IRQn);
+
+  TIM_DeInit(TIM2);
+  TIM_DeInit(TIM3);
+  TIM_DeInit(TIM1);
+
+  DMA_Cmd(DMA2_Stream5, DISABLE);
+  while((DMA2_Stream5->CR & DMA_SxCR_EN) != 0) {
+  }
+  DMA_DeInit(DMA2_Stream5);
+  NVIC_ClearPendingIRQ(TIM2_IRQn);
+  NVIC_ClearPendingIRQ(DMA2_Stream5_IRQn);
+
+  GPIOE->BSRRH = VGA_GPIO_HINIBBLE;
+}
+
+/**
+ * @brief Initializes TIM1 and TIM2 (and TIM3) for VGA signal generation.
  * @details Configures:
  *          - TIM1 as the pixel clock, triggering DMA transfers.
  *          - TIM2 to generate HSync pulses on CH4 and to trigger the start
  *            of a scanline data transfer on CH3.
+ *          With VGA_SCANOUT_DOUBLE_BUFFER the line start comes from TIM2
+ *          CH1 instead: its rising edge resets TIM3, whose CH1 is then high
+ *          for exactly one line of pixels and gates TIM1. The timers are
+ *          started by UB_VGA_SetMode. All timings come from the current mode.
  */
 static void P_VGA_InitTIM(void)
 {
   TIM_TimeBaseInitTypeDef  TIM_TimeBaseStructure;
   TIM_OCInitTypeDef  TIM_OCInitStructure;
+  const VGA_Mode *mode = VGA.mode;
+  uint16_t sync_polarity = mode->sync_positive ? TIM_OCPolarity_High : TIM_OCPolarity_Low;
 
   // Enable clocks for TIM1 and TIM2
   RCC_APB2PeriphClockCmd(RCC_APB2Periph_TIM1, ENABLE);
   RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+#if VGA_SCANOUT_DOUBLE_BUFFER
+  RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+#endif
 
   // Configure TIM1 (Pixel Clock)
-  TIM_TimeBaseStructure.TIM_Period =  VGA_TIM1_PERIODE;
-  TIM_TimeBaseStructure.TIM_Prescaler = VGA_TIM1_PRESCALE;
+  TIM_TimeBaseStructure.TIM_Period = mode->pixel_clocks - 1;
+  TIM_TimeBaseStructure.TIM_Prescaler = 0;
   TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
   TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
   TIM_TimeBaseInit(TIM1, &TIM_TimeBaseStructure);
 
   // Configure TIM2 (HSync and DMA Trigger)
-  TIM_TimeBaseStructure.TIM_Period = VGA_TIM2_HSYNC_PERIODE;
-  TIM_TimeBaseStructure.TIM_Prescaler = VGA_TIM2_HSYNC_PRESCALE;
+  TIM_TimeBaseStructure.TIM_Period = mode->h_total - 1;
+  TIM_TimeBaseStructure.TIM_Prescaler = 0;
   TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
   TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
   TIM_TimeBaseInit(TIM2, &TIM_TimeBaseStructure);
@@ -256,7 +1401,7 @@ static void P_VGA_InitTIM(void)
   // Configure TIM2 Channel 3 (DMA Trigger)
   TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
   TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;
-  TIM_OCInitStructure.TIM_Pulse = VGA_TIM2_HTRIGGER_START-VGA_TIM2_DMA_DELAY;
+  TIM_OCInitStructure.TIM_Pulse = mode->h_start;
   TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_Low;
   TIM_OC3Init(TIM2, &TIM_OCInitStructure);
   TIM_OC3PreloadConfig(TIM2, TIM_OCPreload_Enable);
@@ -264,22 +1409,58 @@ static void P_VGA_InitTIM(void)
   // Configure TIM2 Channel 4 (HSync)
   TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
   TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;
-  TIM_OCInitStructure.TIM_Pulse = VGA_TIM2_HSYNC_IMP;
-  TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_Low;
+  TIM_OCInitStructure.TIM_Pulse = mode->h_sync;
+  TIM_OCInitStructure.TIM_OCPolarity = sync_polarity;
   TIM_OC4Init(TIM2, &TIM_OCInitStructure);
   TIM_OC4PreloadConfig(TIM2, TIM_OCPreload_Enable);
 
-  // Enable auto-reload preload for both timers and start TIM2
+#if VGA_SCANOUT_DOUBLE_BUFFER
+  // Configure TIM2 Channel 1 (line start): OC1Ref rises where the
+  // picture starts and is passed on as TRGO
+  TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM2;
+  TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Disable;
+  TIM_OCInitStructure.TIM_Pulse = mode->h_start;
+  TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;
+  TIM_OC1Init(TIM2, &TIM_OCInitStructure);
+  TIM_OC1PreloadConfig(TIM2, TIM_OCPreload_Enable);
+  TIM_SelectOutputTrigger(TIM2, TIM_TRGOSource_OC1Ref);
+
+  // Configure TIM3 (pixel clock gate): reset by TIM2 at the line start,
+  // OC1Ref stays high for one framebuffer line of pixel clock periods
+  TIM_TimeBaseStructure.TIM_Period = 0xFFFF;
+  TIM_TimeBaseStructure.TIM_Prescaler = 0;
+  TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+  TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+  TIM_TimeBaseInit(TIM3, &TIM_TimeBaseStructure);
+  TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
+  TIM_OCInitStructure.TIM_Pulse = P_VGA_PixelCycles(mode) / P_VGA_HCLK_PER_TICK;
+  TIM_OC1Init(TIM3, &TIM_OCInitStructure);
+  TIM_SelectOutputTrigger(TIM3, TIM_TRGOSource_OC1Ref);
+  TIM_SelectInputTrigger(TIM3, TIM_TS_ITR1);      // ITR1 of TIM3 is TIM2
+  TIM_SelectSlaveMode(TIM3, TIM_SlaveMode_Reset);
+  // Keep the gate closed until TIM2 starts the first line
+  TIM_SetCounter(TIM3, TIM_OCInitStructure.TIM_Pulse);
+
+  // TIM1 only counts while the gate is open. The gate is a whole number of
+  // pixel periods long, so TIM1 stops at the same phase every line; start
+  // it half a period in, so the DMA requests fall in the middle of the gate
+  // and the sync delay between the timers cannot add or drop one.
+  TIM_SelectInputTrigger(TIM1, TIM_TS_ITR2);      // ITR2 of TIM1 is TIM3
+  TIM_SelectSlaveMode(TIM1, TIM_SlaveMode_Gated);
+  TIM_SetCounter(TIM1, mode->pixel_clocks / 2);
+#endif
+
+  // Enable auto-reload preload for both timers
   TIM_ARRPreloadConfig(TIM1, ENABLE);
   TIM_ARRPreloadConfig(TIM2, ENABLE);
-  TIM_Cmd(TIM2, ENABLE);
 }
 
 /**
  * @brief Initializes interrupts for DMA and Timers.
  * @details Configures NVIC for:
  *          - DMA2 Stream 5 Transfer Complete interrupt.
- *          - TIM2 Channel 3 Compare interrupt (to start scanline processing).
+ *          - TIM2 Channel 3 Compare interrupt (to start scanline processing),
+ *            only used by the original scanout engine.
  */
 static void P_VGA_InitINT(void)
 {
@@ -293,12 +1474,14 @@ static void P_VGA_InitINT(void)
   NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
   NVIC_Init(&NVIC_InitStructure);
 
+#if !VGA_SCANOUT_DOUBLE_BUFFER
   // Configure TIM2 Compare Channel 3 Interrupt
   TIM_ITConfig(TIM2,TIM_IT_CC3,ENABLE);
   NVIC_InitStructure.NVIC_IRQChannel = TIM2_IRQn;
   NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
   NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
   NVIC_Init(&NVIC_InitStructure);
+#endif
 }
 
 
@@ -307,6 +1490,9 @@ static void P_VGA_InitINT(void)
  * @details Configures DMA2 Stream 5, Channel 6 to transfer one scanline
  *          of pixel data from the framebuffer (VGA_RAM1) to the GPIOE
  *          Output Data Register upon a TIM1 update event.
+ *          With VGA_SCANOUT_DOUBLE_BUFFER the stream runs in double-buffer
+ *          mode: after each line it switches to the other memory address by
+ *          itself, and both addresses start on the black line.
  */
 static void P_VGA_InitDMA(void)
 {
@@ -320,26 +1506,168 @@ static void P_VGA_InitDMA(void)
   DMA_DeInit(DMA2_Stream5);
   DMA_InitStructure.DMA_Channel = DMA_Channel_6;
   DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)VGA_GPIOE_ODR_ADDRESS;
+#if VGA_SCANOUT_DOUBLE_BUFFER
+  DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)P_VGA_BlackLine;
+#else
   DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)&VGA_RAM1;
+#endif
   DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
-  DMA_InitStructure.DMA_BufferSize = VGA_DISPLAY_X+1;
+  DMA_InitStructure.DMA_BufferSize = VGA.mode->stride;
   DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
   DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
   DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
   DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+#if VGA_SCANOUT_DOUBLE_BUFFER
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+#else
   DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+#endif
   DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
   DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
   DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_HalfFull;
   DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
   DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
   DMA_Init(DMA2_Stream5, &DMA_InitStructure);
+#if VGA_SCANOUT_DOUBLE_BUFFER
+  DMA_DoubleBufferModeConfig(DMA2_Stream5, (uint32_t)P_VGA_BlackLine, DMA_Memory_0);
+  DMA_DoubleBufferModeCmd(DMA2_Stream5, ENABLE);
+#endif
 
   // Link DMA to TIM1 Update event
   TIM_DMACmd(TIM1,TIM_DMA_Update,ENABLE);
 }
 
 
+#if VGA_SCANOUT_DOUBLE_BUFFER
+/**
+ * @brief   Expands a 4 bpp framebuffer line through the palette.
+ * @details Reads four bytes (eight pixels) per word and writes two words,
+ *          with one table lookup per two pixels. width must be a multiple
+ *          of 8, and both lines word aligned.
+ */
+static inline void P_VGA_ExpandLine(uint8_t *dst, const uint8_t *src, uint32_t width)
+{
+  const uint32_t *in = (const uint32_t *)src;
+  uint32_t *out = (uint32_t *)dst;
+
+  for(uint32_t n = width / 8; n != 0; n--) {
+    uint32_t w = *in++;
+    *out++ = P_VGA_ExpandTable[w & 0xFF] | ((uint32_t)P_VGA_ExpandTable[(w >> 8) & 0xFF] << 16);
+    *out++ = P_VGA_ExpandTable[(w >> 16) & 0xFF] | ((uint32_t)P_VGA_ExpandTable[w >> 24] << 16);
+  }
+}
+
+/**
+ * @brief   DMA2 Stream 5 Interrupt Service Routine (double-buffer engine).
+ * @details Triggered once per line (visible or not) when the last pixel of
+ *          the line has been sent. The stream has then already switched to
+ *          the other buffer, which holds the next line, so this ISR has the
+ *          whole next line to fill the idle buffer with the line after it.
+ *          Nothing here is timing critical for the picture: starting and
+ *          stopping the line is done by TIM3 and TIM1. The ISR also counts
+ *          the lines and drives the VSync signal.
+ */
+void DMA2_Stream5_IRQHandler(void)
+{
+  P_VGA_ISR_ENTER();
+  P_VGA_ISR_LINE_END();
+  if(P_VGA_SchedDrawing) P_VGA_SchedLineEnd(TIM2->CNT);
+
+  DMA2->HIFCR = DMA_HIFCR_CTCIF5;
+
+  const VGA_Mode *mode = VGA.mode;
+
+  // hsync_cnt becomes the line that starts next
+  VGA.hsync_cnt++;
+  if(VGA.hsync_cnt >= mode->v_total) {
+    VGA.hsync_cnt = 0;
+    P_VGA_FrameCount++;
+    // Flip the page and swap in a new line map before the first row of
+    // the frame is queued
+    if(P_VGA_NextPage != NULL) {
+      P_VGA_ShowPage = P_VGA_NextPage;
+      P_VGA_NextPage = NULL;
+      P_VGA_FlipFrame = P_VGA_FrameCount;
+    }
+    if(P_VGA_LineMapPending) {
+      P_VGA_LineMap = P_VGA_LineMapLast;
+      P_VGA_LineMapPending = false;
+    }
+    P_VGA_LineRendererShown = P_VGA_LineRenderer;
+    P_VGA_RendererFirstShown = P_VGA_RendererFirst;
+    P_VGA_RendererCountShown = P_VGA_RendererCount;
+    P_VGA_TakeOverlays();
+  }
+
+  // Generate VSync pulse during the vertical blanking interval
+  if((VGA.hsync_cnt < mode->v_sync) != mode->sync_positive) {
+    GPIOB->BSRRH = GPIO_Pin_12; // VSync low
+  }
+  else {
+    GPIOB->BSRRL = GPIO_Pin_12; // VSync high
+  }
+
+  // Queue the line after the next one; every screen row is shown
+  // 1 << line_shift times and the line map names its framebuffer line.
+  // The subtraction wraps for lines above the picture.
+  uint32_t line = (uint32_t)VGA.hsync_cnt + 1 - mode->v_start;
+  if(line < ((uint32_t)mode->height << mode->line_shift)) {
+    uint32_t row = line >> mode->line_shift;
+    const uint8_t *src = &P_VGA_ShowPage[P_VGA_LineMap[row] * mode->pitch];
+    // The renderer draws its own rows; the subtraction wraps above them
+    VGA_LineRenderer renderer = P_VGA_LineRendererShown;
+    if(row - P_VGA_RendererFirstShown >= P_VGA_RendererCountShown) renderer = NULL;
+    uint32_t overlays = P_VGA_OverlayCountShown;
+    if(renderer != NULL || mode->bpp == 4 || overlays != 0) {
+      // Expand or draw the row on its first repeat, into the buffer the DMA
+      // is not sending: the line now starting belongs to the row before (or
+      // is black)
+      uint8_t *buffer = P_VGA_LineBuffer[row & 1];
+      if((line & ((1u << mode->line_shift) - 1)) == 0) {
+        if(renderer != NULL) {
+          renderer(buffer, (uint16_t)row);
+        }
+        else {
+          if(mode->bpp == 4) P_VGA_ExpandLine(buffer, src, mode->width);
+          // An overlay after one that drew draws over the line buffer
+          const uint8_t *in = (mode->bpp == 4) ? buffer : src;
+          bool drawn = false;
+          for(uint32_t i = 0; i < overlays; i++) {
+            if(P_VGA_LineOverlayShown[i](buffer, in, (uint16_t)row)) {
+              drawn = true;
+              in = buffer;
+            }
+          }
+          P_VGA_RowOverlaid = drawn;
+        }
+      }
+      // At 8 bpp a row the overlay left alone is sent from the framebuffer
+      if(renderer != NULL || mode->bpp == 4 || P_VGA_RowOverlaid) {
+        VGA.start_adr = (uint32_t)buffer;
+      }
+      else {
+        VGA.start_adr = (uint32_t)src;
+      }
+    }
+    else {
+      VGA.start_adr = (uint32_t)src;
+    }
+  }
+  else {
+    VGA.start_adr = (uint32_t)P_VGA_BlackLine;
+  }
+  if((DMA2_Stream5->CR & DMA_SxCR_CT) != 0) {
+    DMA2_Stream5->M0AR = VGA.start_adr;
+  }
+  else {
+    DMA2_Stream5->M1AR = VGA.start_adr;
+  }
+
+  P_VGA_ISR_LEAVE();
+}
+
+#else
+
 /**
  * @brief   TIM2 Interrupt Service Routine.
  * @details This ISR is triggered by the TIM2 CC3 event at the start of each
@@ -350,17 +1678,31 @@ static void P_VGA_InitDMA(void)
  */
 void TIM2_IRQHandler(void)
 {
+  P_VGA_ISR_ENTER();
+
   TIM_ClearITPendingBit(TIM2, TIM_IT_CC3);
 
+  const VGA_Mode *mode = VGA.mode;
+
   VGA.hsync_cnt++;
-  if(VGA.hsync_cnt >= VGA_VSYNC_PERIODE) {
+  if(VGA.hsync_cnt >= mode->v_total) {
     VGA.hsync_cnt = 0;
-    // Reset framebuffer address to the start of the first line
-    VGA.start_adr = (uint32_t)(&VGA_RAM1[0]);
+    P_VGA_FrameCount++;
+    // Flip the page, swap in a new line map and point at the line of the first row
+    if(P_VGA_NextPage != NULL) {
+      P_VGA_ShowPage = P_VGA_NextPage;
+      P_VGA_NextPage = NULL;
+      P_VGA_FlipFrame = P_VGA_FrameCount;
+    }
+    if(P_VGA_LineMapPending) {
+      P_VGA_LineMap = P_VGA_LineMapLast;
+      P_VGA_LineMapPending = false;
+    }
+    VGA.start_adr = (uint32_t)&P_VGA_ShowPage[P_VGA_LineMap[0] * mode->pitch];
   }
 
   // Generate VSync pulse during the vertical blanking interval
-  if(VGA.hsync_cnt < VGA_VSYNC_IMP) {
+  if((VGA.hsync_cnt < mode->v_sync) != mode->sync_positive) {
     GPIOB->BSRRH = GPIO_Pin_12; // VSync low
   }
   else {
@@ -368,7 +1710,8 @@ void TIM2_IRQHandler(void)
   }
 
   // Check if we are in the visible screen area
-  if((VGA.hsync_cnt >= VGA_VSYNC_BILD_START) && (VGA.hsync_cnt <= VGA_VSYNC_BILD_STOP)) {
+  uint32_t line = (uint32_t)VGA.hsync_cnt - mode->v_start;
+  if(line < ((uint32_t)mode->height << mode->line_shift)) {
     // Restore pre-calculated DMA configuration
     DMA2_Stream5->CR = VGA.dma2_cr_reg;
     // Set the source memory address for the current scanline
@@ -378,11 +1721,15 @@ void TIM2_IRQHandler(void)
     // Start the DMA transfer
     DMA2_Stream5->CR |= DMA_SxCR_EN;
 
-    // Increment framebuffer address for the next line
-    if((VGA.hsync_cnt & 0x01) != 0) {
-      VGA.start_adr += (VGA_DISPLAY_X + 1);
+    // Look up the framebuffer line of the next row after the last repeat
+    // of this one, while the line is being sent
+    uint32_t repeat = (1u << mode->line_shift) - 1;
+    if((line & repeat) == repeat && line + 1 < ((uint32_t)mode->height << mode->line_shift)) {
+      VGA.start_adr = (uint32_t)&P_VGA_ShowPage[P_VGA_LineMap[(line + 1) >> mode->line_shift] * mode->pitch];
     }
   }
+
+  P_VGA_ISR_LEAVE();
 }
 
 
@@ -396,8 +1743,12 @@ void TIM2_IRQHandler(void)
  */
 void DMA2_Stream5_IRQHandler(void)
 {
+  P_VGA_ISR_ENTER();
+
   if(DMA_GetITStatus(DMA2_Stream5, DMA_IT_TCIF5))
   {
+    P_VGA_ISR_LINE_END();
+    if(P_VGA_SchedDrawing) P_VGA_SchedLineEnd(TIM2->CNT);
     DMA_ClearITPendingBit(DMA2_Stream5, DMA_IT_TCIF5);
 
     // Stop pixel clock and DMA transfer
@@ -406,7 +1757,10 @@ void DMA2_Stream5_IRQHandler(void)
     // Set GPIO output to black during blanking interval
     GPIOE->BSRRH = VGA_GPIO_HINIBBLE;
   }
+
+  P_VGA_ISR_LEAVE();
 }
+#endif
 
 /**
  * @brief Draws a pre-defined bitmap from bitmaps.h.
@@ -432,7 +1786,11 @@ VGA_Status UB_VGA_DrawBitmap(uint8_t id, uint16_t x_lup, uint16_t y_lup) {
 
 /**
  * @brief   Internal helper function to draw a 1-pixel thick line.
- * @details Uses Bresenham's line algorithm. Clipping is handled by UB_VGA_SetPixel.
+ * @details Horizontal and vertical lines are drawn as spans. Other lines use
+ *          Bresenham's line algorithm; when the whole line lies inside the
+ *          clipping rectangle it writes through a pointer (a fixed stride for
+ *          lines at +-45 degrees), otherwise clipping is handled per pixel by
+ *          UB_VGA_SetPixel. All paths set exactly the same pixels.
  * @param   x1 Starting X-coordinate.
  * @param   y1 Starting Y-coordinate.
  * @param   x2 Ending X-coordinate.
@@ -442,6 +1800,10 @@ VGA_Status UB_VGA_DrawBitmap(uint8_t id, uint16_t x_lup, uint16_t y_lup) {
  */
 static VGA_Status P_VGA_DrawSinglePixelLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint8_t color)
 {
+    // Horizontal and vertical lines are spans; most outlines, grids and UI lines take this path.
+    if (y1 == y2) return UB_VGA_FastHLine(x1, y1, x2, color);
+    if (x1 == x2) return UB_VGA_FastVLine(x1, y1, y2, color);
+
     int32_t dx = abs(x2 - x1);
     int32_t sx = x1 < x2 ? 1 : -1;
     int32_t dy = -abs(y2 - y1);
@@ -449,6 +1811,43 @@ static VGA_Status P_VGA_DrawSinglePixelLine(int32_t x1, int32_t y1, int32_t x2,
     int32_t err = dx + dy;
     int32_t e2;
 
+    bool inside = min(x1, x2) >= VGA.clip_rect.x && max(x1, x2) < VGA.clip_rect.x + VGA.clip_rect.width &&
+                  min(y1, y2) >= VGA.clip_rect.y && max(y1, y2) < VGA.clip_rect.y + VGA.clip_rect.height;
+
+    // The pointer paths write whole bytes, so 4 bpp modes take the SetPixel path
+    if (inside && !VGA_INDEXED) {
+        // No pixel can be clipped, so step a pointer through the framebuffer instead of calling SetPixel.
+        uint8_t *p = &VGA_FRAMEBUFFER[y1 * VGA_LINE_STRIDE + x1];
+        int32_t step_y = sy * VGA_LINE_STRIDE;
+
+        if (dx == -dy) {
+            // +-45 degrees: Bresenham steps both axes every pixel, so the pointer moves by a fixed stride.
+            int32_t step = sx + step_y;
+            for (int32_t i = 0; i <= dx; i++) {
+                *p = color;
+                p += step;
+            }
+            return VGA_SUCCESS;
+        }
+
+        for (;;) {
+            *p = color;
+            if (x1 == x2 && y1 == y2) break;
+            e2 = 2 * err;
+            if (e2 >= dy) {
+                err += dy;
+                x1 += sx;
+                p += sx;
+            }
+            if (e2 <= dx) {
+                err += dx;
+                y1 += sy;
+                p += step_y;
+            }
+        }
+        return VGA_SUCCESS;
+    }
+
     for (;;) {
     	UB_VGA_SetPixel(x1, y1, color);
 		if (x1 == x2 && y1 == y2) break;
@@ -475,6 +1874,25 @@ VGA_Status UB_VGA_DrawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, u
         return P_VGA_DrawSinglePixelLine(x1, y1, x2, y2, color);
     }
 
+    uint16_t r = thickness / 2;
+
+    if (x1 == x2 || y1 == y2) {
+        // The circles along an axis-aligned line merge into a rectangle of spans;
+        // only the round caps at both ends are left to draw as circles.
+        if (y1 == y2) {
+            for (int32_t y = (int32_t)y1 - r; y <= (int32_t)y1 + r; y++) {
+                UB_VGA_FastHLine(x1, y, x2, color);
+            }
+        } else {
+            for (int32_t y = min(y1, y2); y <= max(y1, y2); y++) {
+                UB_VGA_FastHLine((int32_t)x1 - r, y, (int32_t)x1 + r, color);
+            }
+        }
+        UB_VGA_FillCircle(x1, y1, r, color);
+        if (x1 != x2 || y1 != y2) UB_VGA_FillCircle(x2, y2, r, color);
+        return VGA_SUCCESS;
+    }
+
     // For thick lines, trace the Bresenham path and draw a filled circle at each step.
     int32_t dx = abs(x2 - x1);
     int32_t sx = x1 < x2 ? 1 : -1;
@@ -482,7 +1900,6 @@ VGA_Status UB_VGA_DrawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, u
     int32_t sy = y1 < y2 ? 1 : -1;
     int32_t err = dx + dy;
     int32_t e2;
-    uint16_t r = thickness / 2;
 
     int32_t current_x = x1;
     int32_t current_y = y1;
@@ -550,28 +1967,116 @@ VGA_Status UB_VGA_DrawRectangle(uint16_t x_lup, uint16_t y_lup, uint16_t width,
     return VGA_SUCCESS;
 }
 
+/**
+ * @brief Half-widths of the rows of filled circles with a radius up to
+ *        VGA_CIRCLE_TABLE_MAX, indexed by radius and row distance from the center.
+ * @details Generated offline with the same midpoint steps as
+ *          P_VGA_FillCircleRows (the widest span per row), so a table circle
+ *          and a computed circle are identical. The entries for radius r start
+ *          at P_VGA_CIRCLE_ROW(r) and run from the center row (dy = 0) to
+ *          the top row (dy = r).
+ */
+#define VGA_CIRCLE_TABLE_MAX   32
+#define P_VGA_CIRCLE_ROW(r)    (((r) - 1) * ((r) + 2) / 2)
+
+static const uint8_t P_VGA_CircleSpans[P_VGA_CIRCLE_ROW(VGA_CIRCLE_TABLE_MAX + 1)] = {
+    /*  1 */ 1, 0,
+    /*  2 */ 2, 1, 0,
+    /*  3 */ 3, 2, 1, 0,
+    /*  4 */ 4, 3, 2, 1, 0,
+    /*  5 */ 5, 4, 4, 3, 2, 0,
+    /*  6 */ 6, 5, 5, 4, 3, 2, 0,
+    /*  7 */ 7, 6, 6, 5, 5, 4, 2, 0,
+    /*  8 */ 8, 7, 7, 7, 6, 5, 4, 3, 0,
+    /*  9 */ 9, 8, 8, 8, 7, 6, 5, 4, 3, 0,
+    /* 10 */ 10, 9, 9, 9, 8, 8, 7, 6, 5, 3, 0,
+    /* 11 */ 11, 10, 10, 10, 9, 9, 8, 7, 6, 5, 3, 0,
+    /* 12 */ 12, 11, 11, 11, 10, 10, 9, 9, 8, 7, 5, 3, 0,
+    /* 13 */ 13, 12, 12, 12, 12, 11, 11, 10, 9, 8, 7, 6, 4, 0,
+    /* 14 */ 14, 13, 13, 13, 13, 12, 12, 11, 10, 9, 8, 7, 6, 4, 0,
+    /* 15 */ 15, 14, 14, 14, 14, 13, 13, 12, 12, 11, 10, 9, 8, 6, 4, 0,
+    /* 16 */ 16, 15, 15, 15, 15, 14, 14, 13, 13, 12, 11, 10, 9, 8, 6, 4, 0,
+    /* 17 */ 17, 16, 16, 16, 16, 15, 15, 15, 14, 13, 13, 12, 11, 10, 8, 7, 4, 0,
+    /* 18 */ 18, 17, 17, 17, 17, 17, 16, 16, 15, 15, 14, 13, 12, 11, 10, 9, 7, 5, 0,
+    /* 19 */ 19, 18, 18, 18, 18, 18, 17, 17, 16, 16, 15, 14, 13, 12, 11, 10, 9, 7, 5, 0,
+    /* 20 */ 20, 19, 19, 19, 19, 19, 18, 18, 17, 17, 16, 16, 15, 14, 13, 12, 11, 9, 7, 5, 0,
+    /* 21 */ 21, 20, 20, 20, 20, 20, 19, 19, 19, 18, 17, 17, 16, 15, 14, 13, 12, 11, 9, 8, 5, 0,
+    /* 22 */ 22, 21, 21, 21, 21, 21, 20, 20, 20, 19, 19, 18, 17, 17, 16, 15, 14, 13, 11, 10, 8, 5, 0,
+    /* 23 */ 23, 22, 22, 22, 22, 22, 21, 21, 21, 20, 20, 19, 19, 18, 17, 16, 15, 14, 13, 12, 10, 8, 5, 0,
+    /* 24 */ 24, 23, 23, 23, 23, 23, 22, 22, 22, 21, 21, 20, 20, 19, 18, 17, 16, 15, 14, 13, 12, 10, 8, 5, 0,
+    /* 25 */ 25, 24, 24, 24, 24, 24, 24, 23, 23, 22, 22, 21, 21, 20, 20, 19, 18, 17, 16, 15, 14, 12, 10, 8, 6, 0,
+    /* 26 */ 26, 25, 25, 25, 25, 25, 25, 24, 24, 24, 23, 23, 22, 21, 21, 20, 19, 18, 17, 16, 15, 14, 12, 11, 9, 6, 0,
+    /* 27 */ 27, 26, 26, 26, 26, 26, 26, 25, 25, 25, 24, 24, 23, 23, 22, 21, 21, 20, 19, 18, 17, 16, 14, 13, 11, 9, 6, 0,
+    /* 28 */ 28, 27, 27, 27, 27, 27, 27, 26, 26, 26, 25, 25, 24, 24, 23, 23, 22, 21, 20, 19, 18, 17, 16, 15, 13, 11, 9, 6, 0,
+    /* 29 */ 29, 28, 28, 28, 28, 28, 28, 27, 27, 27, 26, 26, 25, 25, 24, 24, 23, 22, 21, 21, 20, 19, 17, 16, 15, 13, 11, 9, 6, 0,
+    /* 30 */ 30, 29, 29, 29, 29, 29, 29, 28, 28, 28, 27, 27, 27, 26, 26, 25, 24, 24, 23, 22, 21, 20, 19, 18, 17, 15, 14, 12, 9, 6, 0,
+    /* 31 */ 31, 30, 30, 30, 30, 30, 30, 29, 29, 29, 29, 28, 28, 27, 27, 26, 25, 25, 24, 23, 22, 21, 20, 19, 18, 17, 15, 14, 12, 10, 6, 0,
+    /* 32 */ 32, 31, 31, 31, 31, 31, 31, 31, 30, 30, 30, 29, 29, 28, 28, 27, 27, 26, 25, 25, 24, 23, 22, 21, 20, 19, 17, 16, 14, 12, 10, 7, 0
+};
+
+/**
+ * @brief Draws one stretch of the outline in all eight octants.
+ * @details In the first octant the stretch is the pixels (x, y0) to (x, y1):
+ *          a vertical run. Mirrored it gives four vertical runs at the left
+ *          and right and four horizontal runs at the top and bottom.
+ */
+static void P_VGA_CircleRuns(int32_t cx, int32_t cy, int32_t x, int32_t y0, int32_t y1, uint8_t color, bool inside)
+{
+    if (!inside) {
+        UB_VGA_FastVLine(cx + x, cy + y0, cy + y1, color);
+        UB_VGA_FastVLine(cx - x, cy + y0, cy + y1, color);
+        UB_VGA_FastVLine(cx + x, cy - y1, cy - y0, color);
+        UB_VGA_FastVLine(cx - x, cy - y1, cy - y0, color);
+        UB_VGA_FastHLine(cx + y0, cy + x, cx + y1, color);
+        UB_VGA_FastHLine(cx - y1, cy + x, cx - y0, color);
+        UB_VGA_FastHLine(cx + y0, cy - x, cx + y1, color);
+        UB_VGA_FastHLine(cx - y1, cy - x, cx - y0, color);
+        return;
+    }
+
+    // The whole circle is inside the clipping rectangle: write the runs directly.
+    const int32_t stride = VGA_LINE_STRIDE;
+    uint8_t *center = &VGA_FRAMEBUFFER[cy * stride + cx];
+    for (int32_t y = y0; y <= y1; y++) {
+        int32_t down = y * stride;
+        center[down + x] = color;
+        center[down - x] = color;
+        center[-down + x] = color;
+        center[-down - x] = color;
+    }
+    int32_t n = y1 - y0 + 1;
+    memset(center + x * stride + y0, color, n);
+    memset(center + x * stride - y1, color, n);
+    memset(center - x * stride + y0, color, n);
+    memset(center - x * stride - y1, color, n);
+}
+
 /**
  * @brief Draws a circle outline.
+ * @details Midpoint circle algorithm over one octant. Instead of eight
+ *          single pixels per step, the steps that share the same x are
+ *          collected into one stretch and drawn as eight mirrored runs.
  */
 VGA_Status UB_VGA_DrawCircle(uint16_t center_x, uint16_t center_y, uint16_t radius, uint8_t color)
 {
     if (radius == 0) return VGA_ERROR_INVALID_PARAMETER;
 
+    int32_t cx = center_x;
+    int32_t cy = center_y;
+    bool inside = !VGA_INDEXED &&
+                  cx - radius >= VGA.clip_rect.x && cx + radius < VGA.clip_rect.x + VGA.clip_rect.width &&
+                  cy - radius >= VGA.clip_rect.y && cy + radius < VGA.clip_rect.y + VGA.clip_rect.height;
+
     int32_t x = radius;
     int32_t y = 0;
     int32_t err = 0;
+    int32_t y0 = 0;
 
     // Midpoint circle algorithm.
     while (x >= y)
     {
-        UB_VGA_SetPixel(center_x + x, center_y + y, color);
-        UB_VGA_SetPixel(center_x + y, center_y + x, color);
-        UB_VGA_SetPixel(center_x - y, center_y + x, color);
-        UB_VGA_SetPixel(center_x - x, center_y + y, color);
-        UB_VGA_SetPixel(center_x - x, center_y - y, color);
-        UB_VGA_SetPixel(center_x - y, center_y - x, color);
-        UB_VGA_SetPixel(center_x + y, center_y - x, color);
-        UB_VGA_SetPixel(center_x + x, center_y - y, color);
+        int32_t x_step = x;
+        int32_t y_step = y;
 
         if (err <= 0)
         {
@@ -583,28 +2088,93 @@ VGA_Status UB_VGA_DrawCircle(uint16_t center_x, uint16_t center_y, uint16_t radi
             x -= 1;
             err -= 2*x + 1;
         }
+
+        // The stretch with this x ends when x changes or the octant is done.
+        if (x != x_step || x < y) {
+            P_VGA_CircleRuns(cx, cy, x_step, y0, y_step, color, inside);
+            y0 = y;
+        }
     }
     return VGA_SUCCESS;
 }
 
 /**
- * @brief Draws a filled circle.
+ * @brief Draws the rows cy - dy and cy + dy of a filled circle.
+ * @param center Framebuffer address of the center when the whole circle is
+ *        inside the clipping rectangle, so the rows need no clipping; NULL otherwise.
  */
-VGA_Status UB_VGA_FillCircle(uint16_t center_x, uint16_t center_y, uint16_t radius, uint8_t color)
+static inline void P_VGA_FillCircleRow(uint8_t *center, int32_t cx, int32_t cy, int32_t dy, int32_t half_width, uint8_t color)
 {
-    if (radius == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if (center != NULL) {
+        uint8_t *row = center + dy * VGA_LINE_STRIDE - half_width;
+        memset(row, color, 2 * half_width + 1);
+        if (dy != 0) memset(row - 2 * dy * VGA_LINE_STRIDE, color, 2 * half_width + 1);
+        return;
+    }
+    UB_VGA_FastHLine(cx - half_width, cy + dy, cx + half_width, color);
+    if (dy != 0) UB_VGA_FastHLine(cx - half_width, cy - dy, cx + half_width, color);
+}
+
+/**
+ * @brief Fills a circle with the midpoint algorithm, one span per row.
+ * @details Each midpoint step touches a row near the middle (cy +- y, half
+ *          width x) and a row near the top and bottom (cy +- x, half width
+ *          y). A middle row is widest the first time its y comes up, an
+ *          outer row the last time its x comes up, so those are the only
+ *          times they are drawn. When the octant ends on x == y that row is
+ *          both, and only the (wider) middle row is drawn.
+ */
+static void P_VGA_FillCircleRows(uint8_t *center, int32_t cx, int32_t cy, int32_t radius, uint8_t color)
+{
+    int32_t x = radius;
+    int32_t y = 0;
+    int32_t err = 0;
+
+    P_VGA_FillCircleRow(center, cx, cy, 0, radius, color);
+    while (x >= y)
+    {
+        int32_t x_step = x;
+        int32_t y_step = y;
+
+        if (err <= 0)
+        {
+            y += 1;
+            err += 2*y + 1;
+        }
+        if (err > 0)
+        {
+            x -= 1;
+            err -= 2*x + 1;
+        }
+
+        if (y != y_step && x >= y) P_VGA_FillCircleRow(center, cx, cy, y, x, color);
+        if ((x != x_step || x < y) && x_step != y_step) P_VGA_FillCircleRow(center, cx, cy, x_step, y_step, color);
+    }
+}
+
+/**
+ * @brief Half-widths of the rows of a filled circle, as UB_VGA_FillCircle draws them.
+ * @param radius Radius, up to 255.
+ * @param half_width Filled with radius + 1 entries, from the center row (dy = 0)
+ *        to the top row (dy = radius).
+ */
+void P_VGA_CircleHalfWidths(uint16_t radius, uint8_t *half_width)
+{
+    if (radius <= VGA_CIRCLE_TABLE_MAX) {
+        memcpy(half_width, &P_VGA_CircleSpans[P_VGA_CIRCLE_ROW(radius)], radius + 1);
+        return;
+    }
 
+    // The midpoint steps of P_VGA_FillCircleRows, recording the rows it draws
     int32_t x = radius;
     int32_t y = 0;
     int32_t err = 0;
 
-    // Midpoint circle algorithm, drawing horizontal lines for fill.
+    half_width[0] = (uint8_t)radius;
     while (x >= y)
     {
-        UB_VGA_FastHLine(center_x - x, center_y + y, center_x + x, color);
-        UB_VGA_FastHLine(center_x - x, center_y - y, center_x + x, color);
-        UB_VGA_FastHLine(center_x - y, center_y + x, center_x + y, color);
-        UB_VGA_FastHLine(center_x - y, center_y - x, center_x + y, color);
+        int32_t x_step = x;
+        int32_t y_step = y;
 
         if (err <= 0)
         {
@@ -616,6 +2186,37 @@ VGA_Status UB_VGA_FillCircle(uint16_t center_x, uint16_t center_y, uint16_t radi
             x -= 1;
             err -= 2*x + 1;
         }
+
+        if (y != y_step && x >= y) half_width[y] = (uint8_t)x;
+        if ((x != x_step || x < y) && x_step != y_step) half_width[x_step] = (uint8_t)y_step;
+    }
+}
+
+/**
+ * @brief Draws a filled circle.
+ * @details Every row is drawn exactly once. Radii up to VGA_CIRCLE_TABLE_MAX,
+ *          which thick lines stamp at every pixel, come from a table.
+ */
+VGA_Status UB_VGA_FillCircle(uint16_t center_x, uint16_t center_y, uint16_t radius, uint8_t color)
+{
+    if (radius == 0) return VGA_ERROR_INVALID_PARAMETER;
+
+    int32_t cx = center_x;
+    int32_t cy = center_y;
+    uint8_t *center = NULL;
+    if (!VGA_INDEXED && cx - radius >= VGA.clip_rect.x && cx + radius < VGA.clip_rect.x + VGA.clip_rect.width &&
+        cy - radius >= VGA.clip_rect.y && cy + radius < VGA.clip_rect.y + VGA.clip_rect.height) {
+        center = &VGA_FRAMEBUFFER[cy * VGA_LINE_STRIDE + cx];
+    }
+
+    if (radius > VGA_CIRCLE_TABLE_MAX) {
+        P_VGA_FillCircleRows(center, cx, cy, radius, color);
+        return VGA_SUCCESS;
+    }
+
+    const uint8_t *half_width = &P_VGA_CircleSpans[P_VGA_CIRCLE_ROW(radius)];
+    for (int32_t dy = 0; dy <= radius; dy++) {
+        P_VGA_FillCircleRow(center, cx, cy, dy, half_width[dy], color);
     }
     return VGA_SUCCESS;
 }
@@ -0,0 +1,1205 @@
+/**
+ * @file    stm32_ub_vga_shapes.c
+ * @brief   Implementation of the extended shape primitives.
+ *
+ * @details Polygon filling uses a classic edge table / active edge table
+ *          scanline algorithm. Pixels are sampled at their centers. Each edge
+ *          keeps the first pixel column at or right of its crossing with the
+ *          current scanline plus an exact remainder, and steps both with
+ *          integer adds once per scanline (a Bresenham-style DDA), so the
+ *          result matches an exact rasteriser without per-line divisions.
+ *          Each scanline costs one sort of the (few) active edges and one
+ *          span write per inside interval.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_shapes.h"
+#include <stdlib.h>
+
+#define max(a,b) ((a) > (b) ? (a) : (b))
+#define min(a,b) ((a) < (b) ? (a) : (b))
+
+/**
+ * @brief Largest vertex coordinate accepted by the fill, keeps the edge
+ *        arithmetic within 32 bits.
+ */
+#define VGA_POLY_COORD_MAX   8191
+
+//--------------------------------------------------------------
+/**
+ * @brief One non-horizontal polygon edge.
+ * @details With the edge crossing the current scanline center at x_c, the
+ *          edge stores px = ceil(x_c - 0.5) (the first pixel whose center is
+ *          not left of the edge) and err = (px - (x_c - 0.5)) * den.
+ */
+//--------------------------------------------------------------
+typedef struct {
+    int32_t px;       /*!< First pixel at or right of the edge on this scanline */
+    int32_t err;      /*!< Exact remainder, 0 <= err < den */
+    int32_t step_q;   /*!< Whole pixels stepped per scanline */
+    int32_t step_r;   /*!< Remainder stepped per scanline, 0 <= step_r < den */
+    int32_t den;      /*!< Denominator, twice the edge height */
+    int16_t y_top;    /*!< First scanline covered by the edge */
+    int16_t y_bottom; /*!< First scanline no longer covered by the edge */
+    int16_t x_top;    /*!< X of the upper vertex */
+    int16_t dx;       /*!< Horizontal extent of the edge (signed) */
+    int8_t  dir;      /*!< +1 for a downward edge, -1 for an upward edge */
+} P_VGA_Edge;
+
+/**
+ * @brief Callback that writes one span [x0, x1] on scanline y.
+ * @details Scanlines are already clipped, x0 and x1 are not.
+ */
+typedef void (*P_VGA_SpanFunc)(int32_t x0, int32_t x1, int32_t y, const void *ctx);
+
+// Edge table and active edge table. Static to keep the stack small.
+static P_VGA_Edge edge_table[VGA_POLY_MAX_POINTS];
+static uint8_t active_edges[VGA_POLY_MAX_POINTS];
+
+
+/**
+ * @brief Integer division rounding towards minus infinity.
+ */
+static inline int32_t P_VGA_FloorDiv(int32_t num, int32_t den)
+{
+    int32_t q = num / den;
+    if ((num % den) != 0 && ((num < 0) != (den < 0))) q--;
+    return q;
+}
+
+/**
+ * @brief Positions an edge on scanline y.
+ * @details The edge crosses the center of scanline y at
+ *          x_c = x_top + dx * (2 * (y - y_top) + 1) / den, with den = 2 * dy.
+ */
+static void P_VGA_EdgeStart(P_VGA_Edge *e, int32_t y)
+{
+    int32_t dy2 = e->den / 2;
+    // (x_c - 0.5) * den
+    int32_t num = e->x_top * e->den + e->dx * (2 * (y - e->y_top) + 1) - dy2;
+    e->px = -P_VGA_FloorDiv(-num, e->den);
+    e->err = e->px * e->den - num;
+}
+
+/**
+ * @brief Advances an edge to the next scanline.
+ */
+static inline void P_VGA_EdgeStep(P_VGA_Edge *e)
+{
+    e->px += e->step_q;
+    e->err -= e->step_r;
+    if (e->err < 0) {
+        e->px++;
+        e->err += e->den;
+    }
+}
+
+
+/**
+ * @brief Sets up the edge from vertex a to vertex b (a->y != b->y).
+ */
+static void P_VGA_EdgeInit(P_VGA_Edge *e, const VGA_Point *a, const VGA_Point *b)
+{
+    if (a->y < b->y) {
+        e->dir = 1;
+    } else {
+        const VGA_Point *t = a; a = b; b = t;
+        e->dir = -1;
+    }
+    e->y_top = a->y;
+    e->y_bottom = b->y;
+    e->x_top = a->x;
+    e->dx = b->x - a->x;
+    e->den = 2 * (b->y - a->y);
+    // x_c moves by 2 * dx / den per scanline
+    e->step_q = P_VGA_FloorDiv(2 * e->dx, e->den);
+    e->step_r = 2 * e->dx - e->step_q * e->den;
+    e->px = 0;
+    e->err = 0;
+}
+
+/**
+ * @brief Builds the edge table, sorted on the first scanline of each edge.
+ * @return Number of edges in the table.
+ */
+static uint8_t P_VGA_BuildEdgeTable(const VGA_Point *pts, uint8_t count)
+{
+    uint8_t n = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const VGA_Point *a = &pts[i];
+        const VGA_Point *b = &pts[(i + 1) % count];
+
+        if (a->y == b->y) continue; // Horizontal edges never cross a scanline center
+
+        P_VGA_Edge e;
+        P_VGA_EdgeInit(&e, a, b);
+
+        // Insertion sort on y_top
+        uint8_t j = n;
+        while (j > 0 && edge_table[j - 1].y_top > e.y_top) {
+            edge_table[j] = edge_table[j - 1];
+            j--;
+        }
+        edge_table[j] = e;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Checks that all vertices are within the range of the edge arithmetic.
+ */
+static bool P_VGA_PointsInRange(const VGA_Point *pts, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (abs(pts[i].x) > VGA_POLY_COORD_MAX || abs(pts[i].y) > VGA_POLY_COORD_MAX)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Rotates a line style left by n pixels.
+ */
+static inline uint32_t P_VGA_RotateStyle(uint32_t style, uint32_t n)
+{
+    n &= 31;
+    return n ? (style << n) | (style >> (32 - n)) : style;
+}
+
+/**
+ * @brief Draws a styled horizontal (dy = 0) or vertical (dx = 0) line.
+ * @details The length of the run of equal bits at the top of the style is
+ *          one count-leading-zeros, so every dash is one span and every gap
+ *          one skip, instead of a test per pixel. Thick dashes are drawn
+ *          with UB_VGA_DrawLine, which stamps the same pixels the per-pixel
+ *          path would.
+ * @param dx, dy Unit step from the first pixel towards the last.
+ * @param length Number of pixels.
+ * @return The style rotated past the line.
+ */
+static uint32_t P_VGA_StyledAxisLine(int32_t x, int32_t y, int32_t dx, int32_t dy, int32_t length,
+                                     uint8_t color, uint8_t thickness, uint32_t style)
+{
+    int32_t done = 0;
+
+    while (done < length) {
+        bool on = (style & 0x80000000u) != 0;
+        int32_t run = length - done;
+        if (style != 0xFFFFFFFFu && style != 0) {
+            run = min(run, (int32_t)__builtin_clz(on ? ~style : style));
+        }
+        if (on) {
+            int32_t xa = x + dx * done, xb = x + dx * (done + run - 1);
+            int32_t ya = y + dy * done, yb = y + dy * (done + run - 1);
+            if (thickness > 1) {
+                UB_VGA_DrawLine(xa, ya, xb, yb, color, thickness);
+            } else if (dy == 0) {
+                UB_VGA_FastHLine(min(xa, xb), y, max(xa, xb), color);
+            } else {
+                UB_VGA_FastVLine(x, min(ya, yb), max(ya, yb), color);
+            }
+        }
+        style = P_VGA_RotateStyle(style, run);
+        done += run;
+    }
+    return style;
+}
+
+/**
+ * @brief Draws a styled line.
+ * @return The style rotated past the line.
+ */
+static uint32_t P_VGA_StyledLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                                 uint8_t color, uint8_t thickness, uint32_t style)
+{
+    if (y1 == y2) return P_VGA_StyledAxisLine(x1, y1, x1 < x2 ? 1 : -1, 0, abs(x2 - x1) + 1, color, thickness, style);
+    if (x1 == x2) return P_VGA_StyledAxisLine(x1, y1, 0, y1 < y2 ? 1 : -1, abs(y2 - y1) + 1, color, thickness, style);
+
+    int32_t dx = abs(x2 - x1);
+    int32_t sx = x1 < x2 ? 1 : -1;
+    int32_t dy = -abs(y2 - y1);
+    int32_t sy = y1 < y2 ? 1 : -1;
+    int32_t err = dx + dy;
+    int32_t e2;
+
+    if (style == VGA_LINE_SOLID) {
+        UB_VGA_DrawLine(x1, y1, x2, y2, color, thickness);
+        return style;
+    }
+
+    uint16_t r = thickness / 2;
+    for (;;) {
+        if (style & 0x80000000u) {
+            if (thickness == 1) UB_VGA_SetPixel(x1, y1, color);
+            else UB_VGA_FillCircle(x1, y1, r, color);
+        }
+        style = P_VGA_RotateStyle(style, 1);
+        if (x1 == x2 && y1 == y2) break;
+        e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x1 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+    return style;
+}
+
+/**
+ * @brief Draws a line with a dash pattern.
+ */
+VGA_Status UB_VGA_DrawLineStyled(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t color, uint8_t thickness, uint32_t style)
+{
+    if (thickness == 0 || style == 0) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_StyledLine(x1, y1, x2, y2, color, thickness, style);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws the outline of a closed polygon.
+ */
+VGA_Status UB_VGA_DrawPolygon(const VGA_Point *pts, uint8_t count, uint8_t color, uint8_t thickness)
+{
+    return UB_VGA_DrawPolygonStyled(pts, count, color, thickness, VGA_LINE_SOLID);
+}
+
+/**
+ * @brief Draws the outline of a closed polygon with a dash pattern.
+ */
+VGA_Status UB_VGA_DrawPolygonStyled(const VGA_Point *pts, uint8_t count, uint8_t color, uint8_t thickness, uint32_t style)
+{
+    if (pts == NULL || count < 2 || count > VGA_POLY_MAX_POINTS || thickness == 0 || style == 0) return VGA_ERROR_INVALID_PARAMETER;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (pts[i].x < 0 || pts[i].x >= VGA_DISPLAY_X || pts[i].y < 0 || pts[i].y >= VGA_DISPLAY_Y)
+            return VGA_ERROR_INVALID_COORDINATE;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        const VGA_Point *a = &pts[i];
+        const VGA_Point *b = &pts[(i + 1) % count];
+        if (count == 2 && i == 1) break; // A 2-point polygon is a single line
+        // The next edge starts on the last pixel of this one: step back one
+        style = P_VGA_RotateStyle(P_VGA_StyledLine(a->x, a->y, b->x, b->y, color, thickness, style), 31);
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws one segment of a polyline or plot.
+ * @details 1-pixel segments that are horizontal, vertical or one column wide
+ *          are written as spans. For a step of one column Bresenham puts the
+ *          first (n + 1) / 2 of the n + 1 pixels in the first column.
+ */
+static void P_VGA_TraceSegment(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint8_t color, uint8_t thickness)
+{
+    if (thickness > 1) {
+        UB_VGA_DrawLine(x1, y1, x2, y2, color, thickness);
+    } else if (y1 == y2) {
+        UB_VGA_FastHLine(min(x1, x2), y1, max(x1, x2), color);
+    } else if (x1 == x2) {
+        UB_VGA_FastVLine(x1, min(y1, y2), max(y1, y2), color);
+    } else if (abs(x2 - x1) == 1) {
+        int32_t sy = y1 < y2 ? 1 : -1;
+        int32_t half = (abs(y2 - y1) + 1) / 2;
+        int32_t ya = y1 + sy * (half - 1);   // Last pixel in the first column
+        int32_t yb = y1 + sy * half;         // First pixel in the second column
+        UB_VGA_FastVLine(x1, min(y1, ya), max(y1, ya), color);
+        UB_VGA_FastVLine(x2, min(yb, y2), max(yb, y2), color);
+    } else {
+        UB_VGA_DrawLine(x1, y1, x2, y2, color, 1);
+    }
+}
+
+/**
+ * @brief Draws an open polyline through a list of points in one pass.
+ */
+VGA_Status UB_VGA_DrawPolyline(const VGA_Point *pts, uint16_t count, uint8_t color, uint8_t thickness)
+{
+    if (pts == NULL || count == 0 || thickness == 0) return VGA_ERROR_INVALID_PARAMETER;
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (pts[i].x < 0 || pts[i].x > VGA_POLY_COORD_MAX || pts[i].y < 0 || pts[i].y > VGA_POLY_COORD_MAX)
+            return VGA_ERROR_INVALID_COORDINATE;
+    }
+
+    if (count == 1) {
+        P_VGA_TraceSegment(pts[0].x, pts[0].y, pts[0].x, pts[0].y, color, thickness);
+        return VGA_SUCCESS;
+    }
+    for (uint16_t i = 1; i < count; i++) {
+        P_VGA_TraceSegment(pts[i - 1].x, pts[i - 1].y, pts[i].x, pts[i].y, color, thickness);
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws a point cloud: one pixel per point.
+ */
+VGA_Status UB_VGA_DrawPoints(const VGA_Point *pts, uint16_t count, uint8_t color)
+{
+    if (pts == NULL) return VGA_ERROR_INVALID_PARAMETER;
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (pts[i].x >= 0 && pts[i].y >= 0) UB_VGA_SetPixel(pts[i].x, pts[i].y, color);
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Plots a data series: a polyline through (x0 + i * step, y[i]).
+ */
+VGA_Status UB_VGA_PlotSeries(int16_t x0, uint16_t step, const int16_t *y, uint16_t count, uint8_t color, uint8_t thickness)
+{
+    if (y == NULL || count == 0 || step == 0 || thickness == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if (x0 < 0 || x0 + (int32_t)step * (count - 1) > VGA_POLY_COORD_MAX) return VGA_ERROR_INVALID_COORDINATE;
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (y[i] < 0 || y[i] > VGA_POLY_COORD_MAX) return VGA_ERROR_INVALID_COORDINATE;
+    }
+
+    int32_t x = x0;
+    if (count == 1) P_VGA_TraceSegment(x, y[0], x, y[0], color, thickness);
+    for (uint16_t i = 1; i < count; i++, x += step) {
+        P_VGA_TraceSegment(x, y[i - 1], x + step, y[i], color, thickness);
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Fills a polygon using an active edge table, emitting its spans.
+ */
+static VGA_Status P_VGA_FillPolygon(const VGA_Point *pts, uint8_t count, VGA_FillRule rule, P_VGA_SpanFunc span, const void *ctx)
+{
+    if (pts == NULL || count < 3 || count > VGA_POLY_MAX_POINTS) return VGA_ERROR_INVALID_PARAMETER;
+    if (rule != VGA_FILL_EVENODD && rule != VGA_FILL_NONZERO) return VGA_ERROR_INVALID_PARAMETER;
+
+    if (!P_VGA_PointsInRange(pts, count)) return VGA_ERROR_INVALID_COORDINATE;
+
+    uint8_t num_edges = P_VGA_BuildEdgeTable(pts, count);
+    if (num_edges == 0) return VGA_SUCCESS;
+
+    // Scanline range of the polygon, limited to the clipping rectangle.
+    int32_t y_first = edge_table[0].y_top;
+    int32_t y_last = edge_table[0].y_bottom;
+    for (uint8_t i = 1; i < num_edges; i++) {
+        y_last = max(y_last, edge_table[i].y_bottom);
+    }
+    y_first = max(y_first, VGA.clip_rect.y);
+    y_last = min(y_last, VGA.clip_rect.y + VGA.clip_rect.height);
+
+    uint8_t next_edge = 0;
+    uint8_t num_active = 0;
+
+    for (int32_t y = y_first; y < y_last; y++) {
+        // Activate edges that start at or above this scanline. Their position
+        // is evaluated directly on this scanline, which also covers edges
+        // that started above the clipping rectangle.
+        while (next_edge < num_edges && edge_table[next_edge].y_top <= y) {
+            P_VGA_Edge *e = &edge_table[next_edge];
+            if (e->y_bottom > y) {
+                P_VGA_EdgeStart(e, y);
+                active_edges[num_active++] = next_edge;
+            }
+            next_edge++;
+        }
+
+        // Drop finished edges, then insertion sort the rest on px. The order
+        // rarely changes between scanlines, so this is close to linear.
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < num_active; i++) {
+            if (edge_table[active_edges[i]].y_bottom > y) active_edges[n++] = active_edges[i];
+        }
+        num_active = n;
+        for (uint8_t i = 1; i < num_active; i++) {
+            uint8_t idx = active_edges[i];
+            int32_t px = edge_table[idx].px;
+            uint8_t j = i;
+            while (j > 0 && edge_table[active_edges[j - 1]].px > px) {
+                active_edges[j] = active_edges[j - 1];
+                j--;
+            }
+            active_edges[j] = idx;
+        }
+
+        // Emit one span per inside interval.
+        if (rule == VGA_FILL_EVENODD) {
+            for (uint8_t i = 0; i + 1 < num_active; i += 2) {
+                int32_t x0 = edge_table[active_edges[i]].px;
+                int32_t x1 = edge_table[active_edges[i + 1]].px - 1;
+                if (x0 <= x1) span(x0, x1, y, ctx);
+            }
+        } else {
+            int32_t winding = 0;
+            int32_t span_start = 0;
+            for (uint8_t i = 0; i < num_active; i++) {
+                const P_VGA_Edge *e = &edge_table[active_edges[i]];
+                if (winding == 0) span_start = e->px;
+                winding += e->dir;
+                if (winding == 0) {
+                    int32_t x1 = e->px - 1;
+                    if (span_start <= x1) span(span_start, x1, y, ctx);
+                }
+            }
+        }
+
+        for (uint8_t i = 0; i < num_active; i++) {
+            P_VGA_EdgeStep(&edge_table[active_edges[i]]);
+        }
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Span callback for a single color.
+ */
+static void P_VGA_FlatSpan(int32_t x0, int32_t x1, int32_t y, const void *ctx)
+{
+    UB_VGA_FastHLine(x0, y, x1, *(const uint8_t *)ctx);
+}
+
+/**
+ * @brief Span callback for a pattern fill.
+ */
+static void P_VGA_PatternFillSpan(int32_t x0, int32_t x1, int32_t y, const void *ctx)
+{
+    UB_VGA_PatternHLine(x0, y, x1, (const VGA_Pattern *)ctx);
+}
+
+/**
+ * @brief Fills a polygon with a single color.
+ */
+VGA_Status UB_VGA_FillPolygon(const VGA_Point *pts, uint8_t count, uint8_t color, VGA_FillRule rule)
+{
+    return P_VGA_FillPolygon(pts, count, rule, P_VGA_FlatSpan, &color);
+}
+
+/**
+ * @brief Fills a polygon with a pattern.
+ */
+VGA_Status UB_VGA_PatternPolygon(const VGA_Point *pts, uint8_t count, const VGA_Pattern *pattern, VGA_FillRule rule)
+{
+    if (pattern == NULL || pattern->id >= VGA_PATTERN_COUNT) return VGA_ERROR_INVALID_PARAMETER;
+    return P_VGA_FillPolygon(pts, count, rule, P_VGA_PatternFillSpan, pattern);
+}
+
+
+//--------------------------------------------------------------
+// Triangles
+//--------------------------------------------------------------
+
+/**
+ * @brief Color gradients of a shaded triangle.
+ * @details Per R, G and B field the value is kept in 16.16 fixed point, in
+ *          units of one output level (R and G 0..7, B 0..3).
+ */
+typedef struct {
+    int32_t ref_x, ref_y;   /*!< Reference vertex */
+    int32_t base[3];        /*!< Field values at the reference vertex */
+    int32_t ddx[3];         /*!< Change per pixel */
+    int32_t ddy[3];         /*!< Change per scanline */
+} P_VGA_Shade;
+
+static const uint8_t shade_shift[3] = {5, 2, 0};
+static const uint8_t shade_mask[3]  = {7, 7, 3};
+
+
+/**
+ * @brief Walks a triangle scanline by scanline and emits its spans.
+ * @details The long edge (top to bottom vertex) is stepped over the whole
+ *          height, the two short edges each over their half. Pixel centers
+ *          are sampled, which gives the top-left fill convention: pixels on
+ *          a left or top edge are drawn, pixels on a right or bottom edge
+ *          belong to the neighbouring triangle.
+ */
+static void P_VGA_RasterTriangle(const VGA_Point *v, P_VGA_SpanFunc span, const void *ctx)
+{
+    const VGA_Point *a = &v[0], *b = &v[1], *c = &v[2], *t;
+
+    // Sort the vertices top to bottom
+    if (b->y < a->y) { t = a; a = b; b = t; }
+    if (c->y < a->y) { t = a; a = c; c = t; }
+    if (c->y < b->y) { t = b; b = c; c = t; }
+
+    int32_t cross = (c->x - a->x) * (b->y - a->y) - (c->y - a->y) * (b->x - a->x);
+    if (cross == 0) return; // Degenerate, covers no pixel centers
+
+    int32_t y_first = max(a->y, VGA.clip_rect.y);
+    int32_t y_last = min(c->y, VGA.clip_rect.y + VGA.clip_rect.height);
+    if (y_first >= y_last) return;
+
+    P_VGA_Edge long_edge, short_edge;
+    P_VGA_EdgeInit(&long_edge, a, c);
+    P_VGA_EdgeStart(&long_edge, y_first);
+
+    // With y pointing down a negative cross product puts b right of a-c
+    P_VGA_Edge *left = (cross < 0) ? &long_edge : &short_edge;
+    P_VGA_Edge *right = (cross < 0) ? &short_edge : &long_edge;
+
+    for (uint8_t half = 0; half < 2; half++) {
+        const VGA_Point *p0 = half ? b : a;
+        const VGA_Point *p1 = half ? c : b;
+        int32_t y0 = max(p0->y, y_first);
+        int32_t y1 = min(p1->y, y_last);
+        if (y0 >= y1) continue;
+
+        P_VGA_EdgeInit(&short_edge, p0, p1);
+        P_VGA_EdgeStart(&short_edge, y0);
+
+        for (int32_t y = y0; y < y1; y++) {
+            if (left->px < right->px) span(left->px, right->px - 1, y, ctx);
+            P_VGA_EdgeStep(left);
+            P_VGA_EdgeStep(right);
+        }
+    }
+}
+
+/**
+ * @brief Span callback for a shaded triangle.
+ * @details Each field is interpolated at the pixel center and quantised
+ *          with the Bayer threshold of the pixel, so in-between levels show
+ *          up as a fine, stable pattern instead of bands.
+ */
+static void P_VGA_ShadedSpan(int32_t x0, int32_t x1, int32_t y, const void *ctx)
+{
+    const P_VGA_Shade *sh = (const P_VGA_Shade *)ctx;
+
+    x0 = max(x0, VGA.clip_rect.x);
+    x1 = min(x1, VGA.clip_rect.x + VGA.clip_rect.width - 1);
+    if (x0 > x1) return;
+
+    // Field values at the center of the first pixel
+    int32_t val[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        int64_t d = (int64_t)sh->ddx[i] * (2 * (x0 - sh->ref_x) + 1)
+                  + (int64_t)sh->ddy[i] * (2 * (y - sh->ref_y) + 1);
+        val[i] = sh->base[i] + (int32_t)(d >> 1);
+    }
+
+    // Rounding offsets 1 - (threshold + 0.5) / 16 for this scanline
+    int32_t bias[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        bias[i] = 0x10000 - (2 * VGA_BAYER_4X4[y & 3][i] + 1) * 0x800;
+    }
+
+    int32_t r = val[0], g = val[1], b = val[2];
+    int32_t dr = sh->ddx[0], dg = sh->ddx[1], db = sh->ddx[2];
+    uint8_t *dst = UB_VGA_SpanBegin(x0, y, x1 - x0 + 1);
+
+    for (int32_t x = x0; x <= x1; x++) {
+        int32_t o = bias[x & 3];
+        int32_t lr = (r + o) >> 16;
+        int32_t lg = (g + o) >> 16;
+        int32_t lb = (b + o) >> 16;
+        lr = min(max(lr, 0), 7);
+        lg = min(max(lg, 0), 7);
+        lb = min(max(lb, 0), 3);
+        *dst++ = (uint8_t)((lr << 5) | (lg << 2) | lb);
+        r += dr; g += dg; b += db;
+    }
+    UB_VGA_SpanEnd();
+}
+
+/**
+ * @brief Computes the color gradients of a triangle from its vertex colors.
+ */
+static void P_VGA_ShadeSetup(P_VGA_Shade *sh, const VGA_Point *v, const uint8_t *colors)
+{
+    int32_t e1x = v[1].x - v[0].x, e1y = v[1].y - v[0].y;
+    int32_t e2x = v[2].x - v[0].x, e2y = v[2].y - v[0].y;
+    int32_t area2 = e1x * e2y - e2x * e1y;
+
+    sh->ref_x = v[0].x;
+    sh->ref_y = v[0].y;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t c0 = (colors[0] >> shade_shift[i]) & shade_mask[i];
+        int32_t d1 = ((colors[1] >> shade_shift[i]) & shade_mask[i]) - c0;
+        int32_t d2 = ((colors[2] >> shade_shift[i]) & shade_mask[i]) - c0;
+
+        sh->base[i] = c0 << 16;
+        sh->ddx[i] = (int32_t)(((int64_t)(d1 * e2y - d2 * e1y) << 16) / area2);
+        sh->ddy[i] = (int32_t)(((int64_t)(d2 * e1x - d1 * e2x) << 16) / area2);
+    }
+}
+
+/**
+ * @brief Fills one triangle, flat or shaded.
+ */
+static void P_VGA_Triangle(const VGA_Point *v, uint8_t color, const uint8_t *colors)
+{
+    if (colors == NULL) {
+        P_VGA_RasterTriangle(v, P_VGA_FlatSpan, &color);
+        return;
+    }
+
+    // Equal vertex colors need no interpolation
+    if (colors[0] == colors[1] && colors[0] == colors[2]) {
+        P_VGA_RasterTriangle(v, P_VGA_FlatSpan, &colors[0]);
+        return;
+    }
+
+    if ((v[1].x - v[0].x) * (v[2].y - v[0].y) == (v[2].x - v[0].x) * (v[1].y - v[0].y)) return;
+
+    P_VGA_Shade sh;
+    P_VGA_ShadeSetup(&sh, v, colors);
+    P_VGA_RasterTriangle(v, P_VGA_ShadedSpan, &sh);
+}
+
+/**
+ * @brief Fills a triangle with a single color.
+ */
+VGA_Status UB_VGA_FillTriangle(const VGA_Point *v, uint8_t color)
+{
+    if (v == NULL) return VGA_ERROR_INVALID_PARAMETER;
+    if (!P_VGA_PointsInRange(v, 3)) return VGA_ERROR_INVALID_COORDINATE;
+
+    P_VGA_Triangle(v, color, NULL);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Fills a triangle with colors interpolated between its vertices.
+ */
+VGA_Status UB_VGA_FillTriangleShaded(const VGA_Point *v, const uint8_t *colors)
+{
+    if (v == NULL || colors == NULL) return VGA_ERROR_INVALID_PARAMETER;
+    if (!P_VGA_PointsInRange(v, 3)) return VGA_ERROR_INVALID_COORDINATE;
+
+    P_VGA_Triangle(v, 0, colors);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Fills a triangle strip.
+ */
+VGA_Status UB_VGA_FillTriangleStrip(const VGA_Point *pts, uint16_t count, uint8_t color, const uint8_t *colors)
+{
+    if (pts == NULL || count < 3) return VGA_ERROR_INVALID_PARAMETER;
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (abs(pts[i].x) > VGA_POLY_COORD_MAX || abs(pts[i].y) > VGA_POLY_COORD_MAX)
+            return VGA_ERROR_INVALID_COORDINATE;
+    }
+
+    // Triangle i uses vertices i, i+1 and i+2
+    for (uint16_t i = 0; i + 2 < count; i++) {
+        P_VGA_Triangle(&pts[i], color, colors ? &colors[i] : NULL);
+    }
+    return VGA_SUCCESS;
+}
+
+
+//--------------------------------------------------------------
+// Ellipses, arcs and rounded rectangles
+//--------------------------------------------------------------
+
+/**
+ * @brief sin(0..90 degrees) in Q14.
+ */
+static const int16_t sin_q14[91] = {
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384
+};
+
+/**
+ * @brief Angular range of an arc.
+ * @details Directions are unit vectors in Q14 with y pointing up, so angles
+ *          run counter-clockwise on the screen.
+ */
+typedef struct {
+    int32_t sx, sy;     /*!< Direction of the start angle */
+    int32_t ex, ey;     /*!< Direction of the end angle */
+    bool wide;          /*!< Sweep of more than 180 degrees */
+} P_VGA_Sector;
+
+/**
+ * @brief Four mirrored quarter curves around two corner centers.
+ * @details For an ellipse both centers are equal; for a rounded rectangle
+ *          they are the centers of the corner arcs.
+ */
+typedef struct {
+    int32_t x_left, x_right;    /*!< Centers of the left and right quarters */
+    int32_t y_top, y_bottom;    /*!< Centers of the upper and lower quarters */
+    uint8_t color;
+    const P_VGA_Sector *sector; /*!< Arc range, or NULL for the whole curve */
+    const VGA_Pattern *pattern; /*!< Pattern of a fill, or NULL to fill with color */
+} P_VGA_Quad;
+
+
+/**
+ * @brief Integer sine, Q14.
+ */
+static int32_t P_VGA_SinDeg(int32_t angle)
+{
+    angle %= 360;
+    if (angle < 0) angle += 360;
+    if (angle <= 90) return sin_q14[angle];
+    if (angle <= 180) return sin_q14[180 - angle];
+    if (angle <= 270) return -sin_q14[angle - 180];
+    return -sin_q14[360 - angle];
+}
+
+/**
+ * @brief Checks whether the direction (dx, dy) (screen coordinates) lies inside the sector.
+ */
+static bool P_VGA_InSector(const P_VGA_Sector *s, int32_t dx, int32_t dy)
+{
+    dy = -dy;
+    int32_t after_start = s->sx * dy - s->sy * dx;  // P is counter-clockwise of start
+    int32_t before_end = dx * s->ey - dy * s->ex;   // P is clockwise of end
+
+    if (!s->wide) return after_start >= 0 && before_end >= 0;
+    // A wide sector is everything outside the narrow gap from end to start
+    return !(after_start < 0 && before_end < 0);
+}
+
+/**
+ * @brief Sets a pixel given in signed coordinates, respecting the clipping rectangle.
+ */
+static inline void P_VGA_Plot(int32_t x, int32_t y, uint8_t color)
+{
+    if (x < VGA.clip_rect.x || x >= VGA.clip_rect.x + VGA.clip_rect.width) return;
+    if (y < VGA.clip_rect.y || y >= VGA.clip_rect.y + VGA.clip_rect.height) return;
+    UB_VGA_SetPixel(x, y, color);
+}
+
+/**
+ * @brief Plots one curve point in all four quarters.
+ */
+static void P_VGA_QuadPoints(const P_VGA_Quad *q, int32_t x, int32_t y)
+{
+    const P_VGA_Sector *s = q->sector;
+
+    if (s == NULL || P_VGA_InSector(s, x, y))   P_VGA_Plot(q->x_right + x, q->y_bottom + y, q->color);
+    if (s == NULL || P_VGA_InSector(s, -x, y))  P_VGA_Plot(q->x_left - x, q->y_bottom + y, q->color);
+    if (s == NULL || P_VGA_InSector(s, x, -y))  P_VGA_Plot(q->x_right + x, q->y_top - y, q->color);
+    if (s == NULL || P_VGA_InSector(s, -x, -y)) P_VGA_Plot(q->x_left - x, q->y_top - y, q->color);
+}
+
+/**
+ * @brief Fills the two scanlines at vertical offset y with half-width x.
+ */
+static void P_VGA_QuadRows(const P_VGA_Quad *q, int32_t x, int32_t y)
+{
+    if (q->pattern != NULL) {
+        UB_VGA_PatternHLine(q->x_left - x, q->y_bottom + y, q->x_right + x, q->pattern);
+        if (y != 0 || q->y_top != q->y_bottom)
+            UB_VGA_PatternHLine(q->x_left - x, q->y_top - y, q->x_right + x, q->pattern);
+        return;
+    }
+    UB_VGA_FastHLine(q->x_left - x, q->y_bottom + y, q->x_right + x, q->color);
+    if (y != 0 || q->y_top != q->y_bottom)
+        UB_VGA_FastHLine(q->x_left - x, q->y_top - y, q->x_right + x, q->color);
+}
+
+/**
+ * @brief State of the quarter-ellipse walker.
+ * @details Runs from (rx, 0) to (0, ry) with an integer midpoint (Bresenham)
+ *          algorithm. The error term of the next pixel is kept incrementally,
+ *          and x and y step independently, so the curve stays connected even
+ *          for very flat ellipses. Only adds and small multiplies are used.
+ *          Here x counts up from -rx to 0.
+ */
+typedef struct {
+    int32_t x, y;
+    int32_t err;
+    int32_t a2, b2;
+} P_VGA_EllipseWalk;
+
+static void P_VGA_WalkInit(P_VGA_EllipseWalk *w, int32_t rx, int32_t ry)
+{
+    w->a2 = rx * rx;
+    w->b2 = ry * ry;
+    w->x = -rx;
+    w->y = 0;
+    w->err = w->x * (2 * w->b2 + w->x) + w->b2; // Error of the first step
+}
+
+/**
+ * @brief Moves the walker to the next pixel of the curve.
+ * @return false once the quarter is complete.
+ */
+static inline bool P_VGA_WalkStep(P_VGA_EllipseWalk *w)
+{
+    int32_t e2 = 2 * w->err;
+    if (e2 >= (2 * w->x + 1) * w->b2) {
+        w->x++;
+        w->err += (2 * w->x + 1) * w->b2;
+    }
+    if (e2 <= (2 * w->y + 1) * w->a2) {
+        w->y++;
+        w->err += (2 * w->y + 1) * w->a2;
+    }
+    return w->x <= 0;
+}
+
+/**
+ * @brief Returns the half-width of the next scanline (0, 1, ..., ry).
+ * @details The first point of a scanline is the widest. Very flat ellipses
+ *          reach x = 0 before ry, the remaining rows are the tips.
+ */
+static int32_t P_VGA_WalkNextRow(P_VGA_EllipseWalk *w)
+{
+    if (w->x > 0) return 0;
+
+    int32_t row = w->y;
+    int32_t width = -w->x;
+    while (P_VGA_WalkStep(w) && w->y == row) { }
+    return width;
+}
+
+/**
+ * @brief Walks a quarter ellipse and draws or fills the mirrored curve.
+ * @details When filling, every scanline is written exactly once with the
+ *          widest x of the outline on that line, so the fill covers the
+ *          outline exactly.
+ */
+static void P_VGA_QuadWalk(const P_VGA_Quad *q, int32_t rx, int32_t ry, bool fill)
+{
+    P_VGA_EllipseWalk w;
+    P_VGA_WalkInit(&w, rx, ry);
+
+    if (fill) {
+        for (int32_t y = 0; y <= ry; y++) {
+            P_VGA_QuadRows(q, P_VGA_WalkNextRow(&w), y);
+        }
+        return;
+    }
+
+    int32_t row;
+    do {
+        P_VGA_QuadPoints(q, -w.x, w.y);
+        row = w.y;
+    } while (P_VGA_WalkStep(&w));
+
+    // Very flat ellipses reach x = 0 early, finish the tips
+    while (++row <= ry) {
+        P_VGA_QuadPoints(q, 0, row);
+    }
+}
+
+/**
+ * @brief Draws an ellipse outline.
+ */
+VGA_Status UB_VGA_DrawEllipse(int16_t center_x, int16_t center_y, uint16_t radius_x, uint16_t radius_y, uint8_t color)
+{
+    if (radius_x == 0 || radius_y == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if (radius_x > VGA_ELLIPSE_MAX_RADIUS || radius_y > VGA_ELLIPSE_MAX_RADIUS) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_Quad q = {center_x, center_x, center_y, center_y, color, NULL, NULL};
+    P_VGA_QuadWalk(&q, radius_x, radius_y, false);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws a filled ellipse.
+ */
+VGA_Status UB_VGA_FillEllipse(int16_t center_x, int16_t center_y, uint16_t radius_x, uint16_t radius_y, uint8_t color)
+{
+    if (radius_x == 0 || radius_y == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if (radius_x > VGA_ELLIPSE_MAX_RADIUS || radius_y > VGA_ELLIPSE_MAX_RADIUS) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_Quad q = {center_x, center_x, center_y, center_y, color, NULL, NULL};
+    P_VGA_QuadWalk(&q, radius_x, radius_y, true);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Fills an ellipse with a pattern.
+ */
+VGA_Status UB_VGA_PatternEllipse(int16_t center_x, int16_t center_y, uint16_t radius_x, uint16_t radius_y, const VGA_Pattern *pattern)
+{
+    if (radius_x == 0 || radius_y == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if (radius_x > VGA_ELLIPSE_MAX_RADIUS || radius_y > VGA_ELLIPSE_MAX_RADIUS) return VGA_ERROR_INVALID_PARAMETER;
+    if (pattern == NULL || pattern->id >= VGA_PATTERN_COUNT) return VGA_ERROR_INVALID_PARAMETER;
+
+    P_VGA_Quad q = {center_x, center_x, center_y, center_y, pattern->fg, NULL, pattern};
+    P_VGA_QuadWalk(&q, radius_x, radius_y, true);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws an elliptical arc.
+ */
+VGA_Status UB_VGA_DrawArc(int16_t center_x, int16_t center_y, uint16_t radius_x, uint16_t radius_y,
+                          int16_t start_angle, int16_t end_angle, uint8_t color)
+{
+    if (radius_x == 0 || radius_y == 0) return VGA_ERROR_INVALID_PARAMETER;
+    if (radius_x > VGA_ELLIPSE_MAX_RADIUS || radius_y > VGA_ELLIPSE_MAX_RADIUS) return VGA_ERROR_INVALID_PARAMETER;
+
+    int32_t sweep = (end_angle - start_angle) % 360;
+    if (sweep < 0) sweep += 360;
+
+    P_VGA_Sector s;
+    s.sx = P_VGA_SinDeg(start_angle + 90);
+    s.sy = P_VGA_SinDeg(start_angle);
+    s.ex = P_VGA_SinDeg(end_angle + 90);
+    s.ey = P_VGA_SinDeg(end_angle);
+    s.wide = (sweep > 180);
+
+    // Equal angles (after wrapping) mean a full ellipse
+    P_VGA_Quad q = {center_x, center_x, center_y, center_y, color, (sweep == 0) ? NULL : &s, NULL};
+    P_VGA_QuadWalk(&q, radius_x, radius_y, false);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws a rounded rectangle, outline or filled.
+ */
+static VGA_Status P_VGA_RoundRect(int16_t x_lup, int16_t y_lup, uint16_t width, uint16_t height,
+                                  uint16_t radius, uint8_t color, bool fill)
+{
+    if (width == 0 || height == 0 || radius > VGA_ELLIPSE_MAX_RADIUS) return VGA_ERROR_INVALID_PARAMETER;
+
+    // The corner arcs may at most meet in the middle
+    int32_t r = min(radius, (min(width, height) - 1) / 2);
+    int32_t x2 = x_lup + width - 1;
+    int32_t y2 = y_lup + height - 1;
+
+    P_VGA_Quad q = {x_lup + r, x2 - r, y_lup + r, y2 - r, color, NULL, NULL};
+
+    if (fill) {
+        // The corners also write the rows through the corner centers
+        if (r > 0) P_VGA_QuadWalk(&q, r, r, true);
+        for (int32_t y = q.y_top + (r > 0); y <= q.y_bottom - (r > 0); y++) {
+            UB_VGA_FastHLine(x_lup, y, x2, color);
+        }
+    } else {
+        if (r > 0) P_VGA_QuadWalk(&q, r, r, false);
+        UB_VGA_FastHLine(q.x_left, y_lup, q.x_right, color);
+        UB_VGA_FastHLine(q.x_left, y2, q.x_right, color);
+        UB_VGA_FastVLine(x_lup, q.y_top, q.y_bottom, color);
+        UB_VGA_FastVLine(x2, q.y_top, q.y_bottom, color);
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws the outline of a rounded rectangle.
+ */
+VGA_Status UB_VGA_DrawRoundRect(int16_t x_lup, int16_t y_lup, uint16_t width, uint16_t height, uint16_t radius, uint8_t color)
+{
+    return P_VGA_RoundRect(x_lup, y_lup, width, height, radius, color, false);
+}
+
+/**
+ * @brief Draws a filled rounded rectangle.
+ */
+VGA_Status UB_VGA_FillRoundRect(int16_t x_lup, int16_t y_lup, uint16_t width, uint16_t height, uint16_t radius, uint8_t color)
+{
+    return P_VGA_RoundRect(x_lup, y_lup, width, height, radius, color, true);
+}
+
+/**
+ * @brief Writes one scanline of a ring: the outer span minus the hole.
+ * @param xo Half-width of the outer disk.
+ * @param xi Half-width of the hole, or -1 if the row does not cross the hole.
+ */
+static void P_VGA_RingRow(int32_t cx, int32_t y, int32_t xo, int32_t xi, uint8_t color)
+{
+    if (xi < 0) {
+        UB_VGA_FastHLine(cx - xo, y, cx + xo, color);
+    } else if (xi < xo) {
+        UB_VGA_FastHLine(cx - xo, y, cx - xi - 1, color);
+        UB_VGA_FastHLine(cx + xi + 1, y, cx + xo, color);
+    }
+}
+
+/**
+ * @brief Draws a ring (a circle outline with thickness).
+ * @details The ring is the filled disk of the given radius minus the filled
+ *          disk of radius - thickness. Both disks are walked together, one
+ *          scanline at a time, so each row is at most two spans and the ring
+ *          has no gaps.
+ */
+VGA_Status UB_VGA_DrawRing(int16_t center_x, int16_t center_y, uint16_t radius, uint16_t thickness, uint8_t color)
+{
+    if (radius == 0 || thickness == 0 || radius > VGA_ELLIPSE_MAX_RADIUS) return VGA_ERROR_INVALID_PARAMETER;
+
+    int32_t hole = (int32_t)radius - thickness;
+
+    P_VGA_EllipseWalk outer, inner;
+    P_VGA_WalkInit(&outer, radius, radius);
+    if (hole > 0) P_VGA_WalkInit(&inner, hole, hole);
+
+    for (int32_t dy = 0; dy <= radius; dy++) {
+        int32_t xo = P_VGA_WalkNextRow(&outer);
+        int32_t xi = (hole > 0 && dy <= hole) ? P_VGA_WalkNextRow(&inner) : -1;
+
+        P_VGA_RingRow(center_x, center_y + dy, xo, xi, color);
+        if (dy != 0) P_VGA_RingRow(center_x, center_y - dy, xo, xi, color);
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Forward differences of a Bezier curve, per axis in 32.32 fixed point.
+ * @details With step h along the curve, d1 is the change of the position
+ *          over one step, d2 the change of d1 and d3 the change of d2 (0 for
+ *          a quadratic curve). The step is a power of two of 1/2^depth of
+ *          the curve; t counts in those smallest steps.
+ */
+typedef struct {
+    int64_t f[2];
+    int64_t d1[2], d2[2], d3[2];
+} P_VGA_Bezier;
+
+/**
+ * @brief Checks that one step of the curve is flat enough.
+ * @details Over the next step the second difference of the curve runs from
+ *          d2 - d3 to d2, and a curve bends away from its chord by at most
+ *          1/8 of that. Both ends are checked per axis.
+ */
+static bool P_VGA_BezierFlat(const int64_t *d2, const int64_t *d3, int64_t limit)
+{
+    for (uint8_t a = 0; a < 2; a++) {
+        int64_t e = d2[a] - d3[a];
+        if (d2[a] > limit || d2[a] < -limit || e > limit || e < -limit) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Traces a Bezier curve with adaptive forward differencing.
+ */
+static void P_VGA_DrawBezier(const VGA_Point *p, uint8_t degree, uint8_t color, uint8_t thickness, uint16_t flatness)
+{
+    P_VGA_Bezier b;
+    const VGA_Point *last = &p[degree];
+
+    // Power basis a*t^3 + b*t^2 + c*t + p0, differences for a step of the whole curve
+    for (uint8_t a = 0; a < 2; a++) {
+        int32_t p0 = a ? p[0].y : p[0].x;
+        int32_t p1 = a ? p[1].y : p[1].x;
+        int32_t p2 = a ? p[2].y : p[2].x;
+        int32_t ca, cb, cc;
+        if (degree == 3) {
+            int32_t p3 = a ? p[3].y : p[3].x;
+            ca = -p0 + 3 * p1 - 3 * p2 + p3;
+            cb = 3 * p0 - 6 * p1 + 3 * p2;
+            cc = 3 * (p1 - p0);
+        } else {
+            ca = 0;
+            cb = p0 - 2 * p1 + p2;
+            cc = 2 * (p1 - p0);
+        }
+        b.f[a] = (int64_t)p0 << 32;
+        b.d1[a] = (int64_t)(ca + cb + cc) << 32;
+        b.d2[a] = (int64_t)(6 * ca + 2 * cb) << 32;
+        b.d3[a] = (int64_t)(6 * ca) << 32;
+    }
+
+    // Chord distance d2 / 8 at most flatness / 16 pixel
+    const int64_t limit = (int64_t)flatness << 31;
+    const uint32_t end = 1UL << VGA_BEZIER_MAX_DEPTH;
+    uint32_t t = 0;
+    uint32_t step = end;
+    int32_t x0 = p[0].x, y0 = p[0].y;
+    bool drawn = false;
+
+    while (t < end) {
+        // Double the step while it stays flat and t stays on the coarser grid
+        while (step < end && (t & (2 * step - 1)) == 0) {
+            int64_t d2u[2], d3u[2];
+            for (uint8_t a = 0; a < 2; a++) {
+                d2u[a] = 4 * (b.d2[a] + b.d3[a]);
+                d3u[a] = 8 * b.d3[a];
+            }
+            if (!P_VGA_BezierFlat(d2u, d3u, limit)) break;
+            for (uint8_t a = 0; a < 2; a++) {
+                b.d1[a] = 2 * b.d1[a] + b.d2[a];
+                b.d2[a] = d2u[a];
+                b.d3[a] = d3u[a];
+            }
+            step <<= 1;
+        }
+
+        // Halve the step until it is flat enough
+        while (step > 1 && !P_VGA_BezierFlat(b.d2, b.d3, limit)) {
+            for (uint8_t a = 0; a < 2; a++) {
+                b.d3[a] >>= 3;
+                b.d2[a] = (b.d2[a] >> 2) - b.d3[a];
+                b.d1[a] = (b.d1[a] - b.d2[a]) >> 1;
+            }
+            step >>= 1;
+        }
+
+        for (uint8_t a = 0; a < 2; a++) {
+            b.f[a] += b.d1[a];
+            b.d1[a] += b.d2[a];
+            b.d2[a] += b.d3[a];
+        }
+        t += step;
+
+        // The last point is taken exactly, so rounding never moves the end
+        int32_t x1 = (t == end) ? last->x : (int32_t)((b.f[0] + 0x80000000LL) >> 32);
+        int32_t y1 = (t == end) ? last->y : (int32_t)((b.f[1] + 0x80000000LL) >> 32);
+        if (x1 != x0 || y1 != y0) {
+            UB_VGA_DrawLine(x0, y0, x1, y1, color, thickness);
+            x0 = x1;
+            y0 = y1;
+            drawn = true;
+        }
+    }
+
+    // A curve that stays on one pixel is still drawn as a dot
+    if (!drawn) UB_VGA_DrawLine(x0, y0, x0, y0, color, thickness);
+}
+
+/**
+ * @brief Checks the arguments shared by both Bezier functions.
+ */
+static VGA_Status P_VGA_BezierCheck(const VGA_Point *p, uint8_t count, uint8_t thickness)
+{
+    if (p == NULL || thickness == 0) return VGA_ERROR_INVALID_PARAMETER;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (p[i].x < 0 || p[i].x >= VGA_DISPLAY_X || p[i].y < 0 || p[i].y >= VGA_DISPLAY_Y)
+            return VGA_ERROR_INVALID_COORDINATE;
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws a quadratic Bezier curve.
+ */
+VGA_Status UB_VGA_DrawBezierQuad(const VGA_Point *p, uint8_t color, uint8_t thickness, uint16_t flatness)
+{
+    VGA_Status status = P_VGA_BezierCheck(p, 3, thickness);
+    if (status != VGA_SUCCESS) return status;
+
+    P_VGA_DrawBezier(p, 2, color, thickness, flatness ? flatness : VGA_BEZIER_FLATNESS_DEFAULT);
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Draws a cubic Bezier curve.
+ */
+VGA_Status UB_VGA_DrawBezierCubic(const VGA_Point *p, uint8_t color, uint8_t thickness, uint16_t flatness)
+{
+    VGA_Status status = P_VGA_BezierCheck(p, 4, thickness);
+    if (status != VGA_SUCCESS) return status;
+
+    P_VGA_DrawBezier(p, 3, color, thickness, flatness ? flatness : VGA_BEZIER_FLATNESS_DEFAULT);
+    return VGA_SUCCESS;
+}
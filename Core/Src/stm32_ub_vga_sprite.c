@@ -0,0 +1,572 @@
+/**
+ * @file    stm32_ub_vga_sprite.c
+ * @brief   Implementation of the sprite layer.
+ *
+ * @details Framebuffer mode. A sprite that is drawn keeps the rectangle it
+ *          covers, clipped to the clipping rectangle, and the pixels that
+ *          were there. An update puts those pixels back and draws the sprite
+ *          at its new place. Sprites that overlap a changed sprite, at its
+ *          old or its new place, are taken along, and so on, because putting
+ *          back the background is only right in the reverse order of drawing:
+ *          all of them are put back, the one drawn last first, then drawn in
+ *          z-order. Sprites that overlap none of them are left alone. The
+ *          update waits for the vertical blanking interval, so the beam never
+ *          shows a sprite half drawn.
+ *
+ *          Scanout mode. The sprites are a line overlay (see
+ *          UB_VGA_SetLineOverlay): for every framebuffer row, the interrupt
+ *          copies the row into the line buffer when a sprite is on it and
+ *          draws the sprite rows over it. An update turns the sprites into a
+ *          table of views, clipped to the screen and sorted by z, which the
+ *          interrupt takes over at the start of a frame, as the display list.
+ *
+ *          Both modes measure their cost with the DWT cycle counter.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_sprite.h"
+#include "stm32_ub_vga_private.h"
+#include <string.h>
+
+#if VGA_SPRITE_COUNT > 255
+#error "VGA_SPRITE_COUNT must fit in the uint8_t sprite ids"
+#endif
+
+#define min(a,b) ((a) < (b) ? (a) : (b))
+#define max(a,b) ((a) > (b) ? (a) : (b))
+
+/**
+ * @brief One sprite, as the program sets it, with its save-under buffer.
+ */
+typedef struct {
+    const Bitmap_t *image;  /*!< NULL until the first UB_VGA_SpriteShow */
+    int16_t x, y;           /*!< Top-left corner */
+    uint8_t z;              /*!< Z-order */
+    uint8_t key;            /*!< Color key */
+    bool visible;
+    bool changed;           /*!< Changed since the last update */
+    bool drawn;             /*!< Framebuffer: drawn, so under holds the background */
+    VGA_Rect rect;          /*!< Framebuffer: the clipped rectangle drawn */
+    uint8_t under[VGA_SPRITE_SIZE * VGA_SPRITE_SIZE];   /*!< Pixels under rect, rows of VGA_SPRITE_SIZE */
+} P_VGA_Sprite;
+
+/**
+ * @brief One sprite as the interrupt draws it, clipped to the screen.
+ */
+typedef struct {
+    const uint8_t *pixels;  /*!< Pixel of column x on the top row; rows are VGA_SPRITE_SIZE apart */
+    int16_t top;            /*!< Top row, may be above the screen */
+    uint16_t x;             /*!< First column on screen */
+    uint8_t width;          /*!< Columns on screen */
+    uint8_t height;         /*!< Rows */
+    uint8_t key;            /*!< Color key */
+} P_VGA_SpriteView;
+
+/**
+ * @brief The sprites of one frame, in z-order.
+ */
+typedef struct {
+    P_VGA_SpriteView views[VGA_SPRITE_COUNT];
+    uint8_t count;
+} P_VGA_SpriteTable;
+
+static P_VGA_Sprite P_VGA_Sprites[VGA_SPRITE_COUNT];
+
+/** @brief Sprite ids in the order they were drawn by the last update. */
+static uint8_t P_VGA_SpriteOrder[VGA_SPRITE_COUNT];
+static bool P_VGA_SpriteOrderValid = false;
+
+/** @brief Mode the sprites were drawn in; a new mode has cleared them. */
+static const VGA_Mode *P_VGA_SpriteDrawnMode = NULL;
+
+static VGA_SpriteMode P_VGA_SpriteMode = VGA_SPRITE_FRAMEBUFFER;
+
+/**
+ * @brief The table the interrupt draws, and the table handed to it.
+ * @details UB_VGA_SpriteUpdate sets P_VGA_SpriteQueued; the interrupt moves
+ *          it to P_VGA_SpriteShown on the first row of a frame and clears it.
+ */
+static P_VGA_SpriteTable P_VGA_SpriteTables[2];
+static P_VGA_SpriteTable * volatile P_VGA_SpriteShown = &P_VGA_SpriteTables[0];
+static P_VGA_SpriteTable * volatile P_VGA_SpriteQueued = NULL;
+
+// State of the interrupt within a frame
+static uint16_t P_VGA_SpriteLastRow = 0xFFFF;
+static uint32_t P_VGA_SpriteFrameCycles = 0;
+static uint32_t P_VGA_SpriteFrameRows = 0;
+
+// Counters of UB_VGA_GetSpriteStats
+static uint32_t P_VGA_SpriteUpdates = 0;
+static uint32_t P_VGA_SpriteUpdateCycles = 0;
+static uint32_t P_VGA_SpriteLate = 0;
+static uint32_t P_VGA_SpriteRedrawn = 0;
+static volatile uint32_t P_VGA_SpriteMaxFrameCycles = 0;
+static volatile uint32_t P_VGA_SpriteMaxRowCycles = 0;
+static volatile uint32_t P_VGA_SpriteRows = 0;
+
+
+//--------------------------------------------------------------
+// Internal functions
+//--------------------------------------------------------------
+
+/**
+ * @brief Returns a sprite, or NULL for an invalid id.
+ */
+static P_VGA_Sprite *P_VGA_SpriteGet(uint8_t id)
+{
+    if (id >= VGA_SPRITE_COUNT) return NULL;
+    return &P_VGA_Sprites[id];
+}
+
+/**
+ * @brief Tells whether two rectangles share a pixel; empty ones share none.
+ */
+static bool P_VGA_SpriteOverlap(const VGA_Rect *a, const VGA_Rect *b)
+{
+    return a->width > 0 && b->width > 0 && a->height > 0 && b->height > 0 &&
+           a->x < b->x + b->width && b->x < a->x + a->width &&
+           a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+/**
+ * @brief Sorts the sprite ids by z-order, and by id at the same z.
+ */
+static void P_VGA_SpriteSort(uint8_t *order)
+{
+    for (uint32_t i = 0; i < VGA_SPRITE_COUNT; i++) {
+        uint8_t id = (uint8_t)i;
+        uint8_t z = P_VGA_Sprites[id].z;
+        uint32_t n = i;
+        while (n > 0 && P_VGA_Sprites[order[n - 1]].z > z) {
+            order[n] = order[n - 1];
+            n--;
+        }
+        order[n] = id;
+    }
+}
+
+/**
+ * @brief Puts back the pixels under a sprite in the framebuffer.
+ */
+static void P_VGA_SpriteRestore(P_VGA_Sprite *sprite)
+{
+    const VGA_Rect *r = &sprite->rect;
+    for (int32_t row = 0; row < r->height; row++) {
+        uint8_t *span = UB_VGA_SpanBegin(r->x, r->y + row, r->width);
+        memcpy(span, &sprite->under[row * VGA_SPRITE_SIZE], (size_t)r->width);
+        UB_VGA_SpanEnd();
+    }
+    sprite->drawn = false;
+}
+
+/**
+ * @brief Saves the pixels of a rectangle and draws the sprite over them.
+ * @param rect Part of the sprite to draw, inside the clipping rectangle.
+ */
+static void P_VGA_SpriteDraw(P_VGA_Sprite *sprite, const VGA_Rect *rect)
+{
+    const Bitmap_t *image = sprite->image;
+    int32_t sx = rect->x - sprite->x;
+    int32_t sy = rect->y - sprite->y;
+
+    for (int32_t row = 0; row < rect->height; row++) {
+        uint8_t *span = UB_VGA_SpanBegin(rect->x, rect->y + row, rect->width);
+        memcpy(&sprite->under[row * VGA_SPRITE_SIZE], span, (size_t)rect->width);
+        const uint8_t *pixels = &image->data[sy + row][sx];
+        for (int32_t i = 0; i < rect->width; i++) {
+            if (pixels[i] != sprite->key) span[i] = pixels[i];
+        }
+        UB_VGA_SpanEnd();
+    }
+    sprite->rect = *rect;
+    sprite->drawn = true;
+}
+
+/**
+ * @brief Forgets the sprites in a framebuffer that was cleared by a new mode.
+ */
+static void P_VGA_SpriteCheckMode(void)
+{
+    if (P_VGA_SpriteDrawnMode == VGA.mode) return;
+
+    for (uint32_t i = 0; i < VGA_SPRITE_COUNT; i++) {
+        if (P_VGA_Sprites[i].drawn) {
+            P_VGA_Sprites[i].drawn = false;
+            P_VGA_Sprites[i].changed = true;
+        }
+    }
+    P_VGA_SpriteDrawnMode = VGA.mode;
+}
+
+/**
+ * @brief Update in framebuffer mode.
+ */
+static VGA_Status P_VGA_SpriteUpdateFramebuffer(void)
+{
+    if (UB_VGA_GetPages() != 1) return VGA_ERROR_INVALID_PARAMETER;
+    P_VGA_SpriteCheckMode();
+
+    // Where every sprite goes: its bitmap, clipped
+    VGA_Rect clip;
+    VGA_Rect target[VGA_SPRITE_COUNT];
+    bool redraw[VGA_SPRITE_COUNT];
+    UB_VGA_GetClipRect(&clip);
+    for (uint32_t i = 0; i < VGA_SPRITE_COUNT; i++) {
+        const P_VGA_Sprite *s = &P_VGA_Sprites[i];
+        VGA_Rect *t = &target[i];
+        t->width = 0;
+        t->height = 0;
+        if (s->visible) {
+            int32_t x0 = max(s->x, clip.x);
+            int32_t y0 = max(s->y, clip.y);
+            int32_t x1 = min(s->x + s->image->width, clip.x + clip.width);
+            int32_t y1 = min(s->y + s->image->height, clip.y + clip.height);
+            if (x0 < x1 && y0 < y1) {
+                t->x = x0;
+                t->y = y0;
+                t->width = x1 - x0;
+                t->height = y1 - y0;
+            }
+        }
+        redraw[i] = s->changed;
+    }
+
+    // Take along every sprite that overlaps one to redraw, old or new place
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        for (uint32_t i = 0; i < VGA_SPRITE_COUNT; i++) {
+            if (!redraw[i]) continue;
+            const P_VGA_Sprite *a = &P_VGA_Sprites[i];
+            for (uint32_t j = 0; j < VGA_SPRITE_COUNT; j++) {
+                if (redraw[j]) continue;
+                const P_VGA_Sprite *b = &P_VGA_Sprites[j];
+                if (!b->drawn) continue;
+                if ((a->drawn && P_VGA_SpriteOverlap(&a->rect, &b->rect)) ||
+                    P_VGA_SpriteOverlap(&target[i], &b->rect)) {
+                    redraw[j] = true;
+                    grown = true;
+                }
+            }
+        }
+    }
+
+    // Nothing changed: no need to wait for the blank
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < VGA_SPRITE_COUNT; i++) {
+        if (redraw[i]) count++;
+    }
+    if (count == 0) {
+        P_VGA_SpriteRedrawn = 0;
+        return VGA_SUCCESS;
+    }
+
+    uint8_t order[VGA_SPRITE_COUNT];
+    P_VGA_SpriteSort(order);
+    if (!P_VGA_SpriteOrderValid) {
+        memcpy(P_VGA_SpriteOrder, order, sizeof(order));
+        P_VGA_SpriteOrderValid = true;
+    }
+
+    UB_VGA_WaitForVBlank();
+    uint32_t start = P_VGA_DWT_CYCCNT;
+
+    // Put the backgrounds back, the sprite drawn last first
+    uint32_t redrawn = 0;
+    for (uint32_t k = VGA_SPRITE_COUNT; k > 0; k--) {
+        P_VGA_Sprite *s = &P_VGA_Sprites[P_VGA_SpriteOrder[k - 1]];
+        if (redraw[P_VGA_SpriteOrder[k - 1]] && s->drawn) P_VGA_SpriteRestore(s);
+    }
+    for (uint32_t k = 0; k < VGA_SPRITE_COUNT; k++) {
+        uint8_t id = order[k];
+        P_VGA_Sprite *s = &P_VGA_Sprites[id];
+        if (!redraw[id]) continue;
+        if (target[id].width > 0) {
+            P_VGA_SpriteDraw(s, &target[id]);
+            redrawn++;
+        }
+        s->changed = false;
+    }
+    memcpy(P_VGA_SpriteOrder, order, sizeof(order));
+
+    uint32_t cycles = P_VGA_DWT_CYCCNT - start;
+    if (cycles > P_VGA_SpriteUpdateCycles) P_VGA_SpriteUpdateCycles = cycles;
+    if (!UB_VGA_InVBlank()) P_VGA_SpriteLate++;
+    P_VGA_SpriteRedrawn = redrawn;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Update in scanout mode: hands a new table of views to the interrupt.
+ */
+static VGA_Status P_VGA_SpriteUpdateScanout(void)
+{
+    uint32_t start = P_VGA_DWT_CYCCNT;
+
+    // Take the queued table back, so the interrupt cannot take it while it
+    // is rebuilt; the table it shows stays alone
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    P_VGA_SpriteQueued = NULL;
+    P_VGA_SpriteTable *table = (P_VGA_SpriteShown == &P_VGA_SpriteTables[0]) ?
+                               &P_VGA_SpriteTables[1] : &P_VGA_SpriteTables[0];
+    __set_PRIMASK(primask);
+
+    uint8_t order[VGA_SPRITE_COUNT];
+    P_VGA_SpriteSort(order);
+    table->count = 0;
+    for (uint32_t k = 0; k < VGA_SPRITE_COUNT; k++) {
+        P_VGA_Sprite *s = &P_VGA_Sprites[order[k]];
+        s->changed = false;
+        if (!s->visible) continue;
+
+        int32_t x0 = max(s->x, 0);
+        int32_t x1 = min(s->x + s->image->width, VGA_DISPLAY_X);
+        if (x0 >= x1 || s->y >= VGA_DISPLAY_Y || s->y + s->image->height <= 0) continue;
+
+        P_VGA_SpriteView *v = &table->views[table->count++];
+        v->pixels = &s->image->data[0][x0 - s->x];
+        v->top = s->y;
+        v->x = (uint16_t)x0;
+        v->width = (uint8_t)(x1 - x0);
+        v->height = (uint8_t)s->image->height;
+        v->key = s->key;
+    }
+
+    if (UB_VGA_IsRunning()) {
+        P_VGA_SpriteQueued = table;
+    }
+    else {
+        P_VGA_SpriteShown = table;
+    }
+
+    uint32_t cycles = P_VGA_DWT_CYCCNT - start;
+    if (cycles > P_VGA_SpriteUpdateCycles) P_VGA_SpriteUpdateCycles = cycles;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Closes the counters of a frame and takes over a new table.
+ */
+static void P_VGA_SpriteFrameStart(void)
+{
+    if (P_VGA_SpriteFrameCycles > P_VGA_SpriteMaxFrameCycles) P_VGA_SpriteMaxFrameCycles = P_VGA_SpriteFrameCycles;
+    P_VGA_SpriteRows = P_VGA_SpriteFrameRows;
+    P_VGA_SpriteFrameCycles = 0;
+    P_VGA_SpriteFrameRows = 0;
+
+    if (P_VGA_SpriteQueued != NULL) {
+        P_VGA_SpriteShown = P_VGA_SpriteQueued;
+        P_VGA_SpriteQueued = NULL;
+    }
+}
+
+/**
+ * @brief   Draws the sprites over one framebuffer row (the line overlay).
+ * @details Runs in the scanout interrupt, for the rows in order; a row that
+ *          is not below the one before starts a new frame.
+ */
+static bool P_VGA_SpriteOverlay(uint8_t *line, const uint8_t *src, uint16_t row)
+{
+    uint32_t start = P_VGA_DWT_CYCCNT;
+
+    if (row <= P_VGA_SpriteLastRow) P_VGA_SpriteFrameStart();
+    P_VGA_SpriteLastRow = row;
+
+    const P_VGA_SpriteTable *table = P_VGA_SpriteShown;
+    bool drawn = false;
+    for (uint32_t i = 0; i < table->count; i++) {
+        const P_VGA_SpriteView *v = &table->views[i];
+        uint32_t sy = (uint32_t)((int32_t)row - v->top);
+        if (sy >= v->height) continue;
+
+        if (!drawn) {
+            if (line != src) memcpy(line, src, VGA_DISPLAY_X);
+            drawn = true;
+        }
+        const uint8_t *pixels = v->pixels + sy * VGA_SPRITE_SIZE;
+        uint8_t *out = line + v->x;
+        uint8_t key = v->key;
+        for (uint32_t n = 0; n < v->width; n++) {
+            if (pixels[n] != key) out[n] = pixels[n];
+        }
+    }
+
+    uint32_t cycles = P_VGA_DWT_CYCCNT - start;
+    P_VGA_SpriteFrameCycles += cycles;
+    if (drawn) P_VGA_SpriteFrameRows++;
+    if (cycles > P_VGA_SpriteMaxRowCycles) P_VGA_SpriteMaxRowCycles = cycles;
+    return drawn;
+}
+
+
+//--------------------------------------------------------------
+// Global functions
+//--------------------------------------------------------------
+
+/**
+ * @brief Chooses where the sprites are drawn.
+ */
+VGA_Status UB_VGA_SpriteSetMode(VGA_SpriteMode mode)
+{
+    if (mode != VGA_SPRITE_FRAMEBUFFER && mode != VGA_SPRITE_SCANOUT) return VGA_ERROR_INVALID_PARAMETER;
+
+    // Start the cycle counter for the counters
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    P_VGA_DWT_CTRL |= P_VGA_DWT_CTRL_CYCCNTENA;
+
+    VGA_Status status = UB_VGA_SetLineOverlay(VGA_OVERLAY_SPRITES, mode == VGA_SPRITE_SCANOUT ? P_VGA_SpriteOverlay : NULL);
+    if (status != VGA_SUCCESS) return status;
+
+    UB_VGA_SpriteErase();
+    if (mode == VGA_SPRITE_FRAMEBUFFER) {
+        // The interrupt shows no sprites until scanout mode is chosen again
+        P_VGA_SpriteQueued = NULL;
+        P_VGA_SpriteTables[0].count = 0;
+        P_VGA_SpriteTables[1].count = 0;
+    }
+    P_VGA_SpriteMode = mode;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Shows a sprite from the next update on.
+ */
+VGA_Status UB_VGA_SpriteShow(uint8_t id, const Bitmap_t *image, int16_t x, int16_t y, uint8_t z)
+{
+    P_VGA_Sprite *s = P_VGA_SpriteGet(id);
+    if (s == NULL || image == NULL) return VGA_ERROR_INVALID_PARAMETER;
+    if (image->width == 0 || image->width > VGA_SPRITE_SIZE ||
+        image->height == 0 || image->height > VGA_SPRITE_SIZE) return VGA_ERROR_INVALID_PARAMETER;
+
+    if (s->image == NULL) s->key = BITMAP_TRANSPARENT_COLOR;
+    s->image = image;
+    s->x = x;
+    s->y = y;
+    s->z = z;
+    s->visible = true;
+    s->changed = true;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Moves a sprite, from the next update on.
+ */
+VGA_Status UB_VGA_SpriteMove(uint8_t id, int16_t x, int16_t y)
+{
+    P_VGA_Sprite *s = P_VGA_SpriteGet(id);
+    if (s == NULL || s->image == NULL) return VGA_ERROR_INVALID_PARAMETER;
+
+    if (s->x != x || s->y != y) {
+        s->x = x;
+        s->y = y;
+        s->changed = true;
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Sets the color of the pixels of a sprite that are not drawn.
+ */
+VGA_Status UB_VGA_SpriteSetKey(uint8_t id, uint8_t key)
+{
+    P_VGA_Sprite *s = P_VGA_SpriteGet(id);
+    if (s == NULL || s->image == NULL) return VGA_ERROR_INVALID_PARAMETER;
+
+    s->key = key;
+    s->changed = true;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Hides a sprite from the next update on.
+ */
+VGA_Status UB_VGA_SpriteHide(uint8_t id)
+{
+    P_VGA_Sprite *s = P_VGA_SpriteGet(id);
+    if (s == NULL) return VGA_ERROR_INVALID_PARAMETER;
+
+    if (s->visible) {
+        s->visible = false;
+        s->changed = true;
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Puts the changes of the sprites on screen.
+ */
+VGA_Status UB_VGA_SpriteUpdate(void)
+{
+    VGA_Status status;
+    if (P_VGA_SpriteMode == VGA_SPRITE_SCANOUT) {
+        status = P_VGA_SpriteUpdateScanout();
+    }
+    else {
+        status = P_VGA_SpriteUpdateFramebuffer();
+    }
+    if (status == VGA_SUCCESS) P_VGA_SpriteUpdates++;
+    return status;
+}
+
+/**
+ * @brief Takes the sprites out of the framebuffer.
+ */
+void UB_VGA_SpriteErase(void)
+{
+    P_VGA_SpriteCheckMode();
+    if (!P_VGA_SpriteOrderValid) return;
+
+    // With two pages the drawing page is not the one the sprites are in
+    bool restore = (UB_VGA_GetPages() == 1);
+    for (uint32_t k = VGA_SPRITE_COUNT; k > 0; k--) {
+        P_VGA_Sprite *s = &P_VGA_Sprites[P_VGA_SpriteOrder[k - 1]];
+        if (!s->drawn) continue;
+        if (restore) P_VGA_SpriteRestore(s);
+        s->drawn = false;
+        s->changed = true;
+    }
+}
+
+/**
+ * @brief Returns the counters of the sprite layer.
+ */
+void UB_VGA_GetSpriteStats(VGA_SpriteStats *stats)
+{
+    if (stats == NULL) return;
+
+    stats->updates = P_VGA_SpriteUpdates;
+    stats->update_cycles = P_VGA_SpriteUpdateCycles;
+    stats->late = P_VGA_SpriteLate;
+    stats->redrawn = P_VGA_SpriteRedrawn;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stats->frame_cycles = P_VGA_SpriteMaxFrameCycles;
+    stats->row_cycles = P_VGA_SpriteMaxRowCycles;
+    stats->rows = P_VGA_SpriteRows;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Clears the counters of the sprite layer.
+ */
+void UB_VGA_ResetSpriteStats(void)
+{
+    P_VGA_SpriteUpdates = 0;
+    P_VGA_SpriteUpdateCycles = 0;
+    P_VGA_SpriteLate = 0;
+    P_VGA_SpriteRedrawn = 0;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    P_VGA_SpriteMaxFrameCycles = 0;
+    P_VGA_SpriteMaxRowCycles = 0;
+    P_VGA_SpriteRows = 0;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,290 @@
+/**
+ * @file    stm32_ub_vga_textmode.c
+ * @brief   Implementation of the character-cell text mode.
+ *
+ * @details The text area is a line renderer (see UB_VGA_SetLineRendererRows)
+ *          for its band of screen rows. For every row the interrupt looks up
+ *          the row of the glyph each cell shows and writes the cell as three
+ *          halfwords of two pixels: bg ^ ((fg ^ bg) & mask), with the mask of
+ *          each pair of glyph bits from a table of four. A cell costs about
+ *          20 cycles, a row of 53 cells about 1100, a quarter of a line.
+ *
+ *          The font of fonts.h stores columns; the glyphs are turned into
+ *          rows of 6 bits once, in RAM, so a row needs one load per cell.
+ *
+ *          The map is a ring of rows: P_VGA_TextTop names the map row shown
+ *          at the top, so scrolling moves it instead of the characters. The
+ *          interrupt reads it, and the palette, on the first row of a frame,
+ *          so a frame is not shown half scrolled.
+ *
+ * @date    18.10.2026
+ * @author  J. Mullink
+ */
+
+//--------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------
+#include "stm32_ub_vga_textmode.h"
+#include "fonts.h"
+#include <string.h>
+
+#if VGA_TEXT_MAX_CELLS > 255 * 255
+#error "VGA_TEXT_MAX_CELLS is more than 255 rows of 255 columns"
+#endif
+
+#define min(a,b) ((a) < (b) ? (a) : (b))
+
+/** @brief Glyph rows: bit 5 is the left pixel, bit 0 the blank column. */
+static uint8_t P_VGA_TextGlyphs[128][VGA_TEXT_CELL_HEIGHT];
+static bool P_VGA_TextGlyphsValid = false;
+
+/** @brief Pixel masks of two glyph bits, left pixel in the low byte. */
+static const uint16_t P_VGA_TextPairMask[4] = { 0x0000, 0xFF00, 0x00FF, 0xFFFF };
+
+static VGA_TextCell P_VGA_TextCells[VGA_TEXT_MAX_CELLS];
+
+// Size and place of the text area
+static uint8_t P_VGA_TextColumns = 0;
+static uint8_t P_VGA_TextRowCount = 0;
+static uint16_t P_VGA_TextFirst = 0;
+
+/**
+ * @brief Map row at the top of the area, and the one the interrupt shows this frame.
+ */
+static volatile uint8_t P_VGA_TextTop = 0;
+static uint8_t P_VGA_TextTopShown = 0;
+
+/** @brief Palette index of the pixels outside the cells. */
+static volatile uint8_t P_VGA_TextFill = 0;
+
+/** @brief The palette in both bytes, taken over by the interrupt once per frame. */
+static uint16_t P_VGA_TextColors[VGA_PALETTE_SIZE];
+
+
+//--------------------------------------------------------------
+// Internal functions
+//--------------------------------------------------------------
+
+/**
+ * @brief Turns the columns of the Consolas font into rows.
+ */
+static void P_VGA_TextBuildGlyphs(void)
+{
+    for (uint32_t ch = 0; ch < 128; ch++) {
+        for (uint32_t y = 0; y < VGA_TEXT_CELL_HEIGHT; y++) {
+            uint8_t bits = 0;
+            for (uint32_t x = 0; x < 5; x++) {
+                if (y < 7 && (font_consolas_data[ch][x] >> y) & 1) bits |= 0x20 >> x;
+            }
+            P_VGA_TextGlyphs[ch][y] = bits;
+        }
+    }
+    P_VGA_TextGlyphsValid = true;
+}
+
+/**
+ * @brief Returns the cells of a text row, which must exist.
+ */
+static VGA_TextCell *P_VGA_TextMapRow(uint32_t row, uint32_t top)
+{
+    uint32_t map_row = top + row;
+    if (map_row >= P_VGA_TextRowCount) map_row -= P_VGA_TextRowCount;
+    return &P_VGA_TextCells[map_row * P_VGA_TextColumns];
+}
+
+/**
+ * @brief   Draws one screen row of the text area (the line renderer).
+ * @details Runs in the scanout interrupt, for the rows of the area in order.
+ */
+static void P_VGA_TextRender(uint8_t *line, uint16_t row)
+{
+    uint32_t local = (uint32_t)row - P_VGA_TextFirst;
+
+    if (local == 0) {
+        P_VGA_TextTopShown = P_VGA_TextTop;
+        for (uint32_t i = 0; i < VGA_PALETTE_SIZE; i++) {
+            P_VGA_TextColors[i] = (uint16_t)(UB_VGA_GetPaletteEntry((uint8_t)i) * 0x0101);
+        }
+    }
+
+    const uint32_t width = VGA_DISPLAY_X;
+    uint32_t text_row = local / VGA_TEXT_CELL_HEIGHT;
+    uint32_t x = 0;
+
+    if (text_row < P_VGA_TextRowCount) {
+        const VGA_TextCell *cell = P_VGA_TextMapRow(text_row, P_VGA_TextTopShown);
+        const uint8_t *glyph_row = &P_VGA_TextGlyphs[0][local % VGA_TEXT_CELL_HEIGHT];
+        uint32_t columns = min(P_VGA_TextColumns, width / VGA_TEXT_CELL_WIDTH);
+        uint16_t *out = (uint16_t *)line;
+
+        for (uint32_t n = columns; n != 0; n--, cell++) {
+            uint32_t bits = glyph_row[(cell->ch & 0x7F) * VGA_TEXT_CELL_HEIGHT];
+            uint32_t bg = P_VGA_TextColors[cell->attr >> 4];
+            uint32_t diff = P_VGA_TextColors[cell->attr & 0x0F] ^ bg;
+            out[0] = (uint16_t)(bg ^ (diff & P_VGA_TextPairMask[bits >> 4]));
+            out[1] = (uint16_t)(bg ^ (diff & P_VGA_TextPairMask[(bits >> 2) & 3]));
+            out[2] = (uint16_t)(bg ^ (diff & P_VGA_TextPairMask[bits & 3]));
+            out += 3;
+        }
+        x = columns * VGA_TEXT_CELL_WIDTH;
+    }
+    memset(&line[x], (uint8_t)P_VGA_TextColors[P_VGA_TextFill], width - x);
+}
+
+
+//--------------------------------------------------------------
+// Global functions
+//--------------------------------------------------------------
+
+/**
+ * @brief Shows a text area from the next frame on.
+ */
+VGA_Status UB_VGA_TextStart(uint16_t first_row, uint8_t rows)
+{
+    if (first_row >= VGA_DISPLAY_Y) return VGA_ERROR_INVALID_COORDINATE;
+
+    uint32_t columns = VGA_DISPLAY_X / VGA_TEXT_CELL_WIDTH;
+    uint32_t space = (VGA_DISPLAY_Y - first_row) / VGA_TEXT_CELL_HEIGHT;
+    uint16_t count;
+    if (rows == 0) {
+        // To the bottom of the screen, whatever the mode is later on
+        rows = (uint8_t)min(min(space, VGA_TEXT_MAX_CELLS / columns), 255);
+        if (rows == 0) return VGA_ERROR_INVALID_COORDINATE;
+        count = VGA_RENDERER_ALL_ROWS;
+    }
+    else {
+        if (rows > space) return VGA_ERROR_INVALID_COORDINATE;
+        if (columns * rows > VGA_TEXT_MAX_CELLS) return VGA_ERROR_OUT_OF_MEMORY;
+        count = (uint16_t)(rows * VGA_TEXT_CELL_HEIGHT);
+    }
+    if (!P_VGA_TextGlyphsValid) P_VGA_TextBuildGlyphs();
+
+    // The interrupt may be drawing the old area
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    P_VGA_TextColumns = (uint8_t)columns;
+    P_VGA_TextRowCount = rows;
+    P_VGA_TextFirst = first_row;
+    P_VGA_TextTop = 0;
+    P_VGA_TextTopShown = 0;
+    __set_PRIMASK(primask);
+
+    UB_VGA_TextClear(VGA_TEXT_ATTR_DEFAULT);
+    for (uint32_t i = 0; i < VGA_PALETTE_SIZE; i++) {
+        P_VGA_TextColors[i] = (uint16_t)(UB_VGA_GetPaletteEntry((uint8_t)i) * 0x0101);
+    }
+    return UB_VGA_SetLineRendererRows(P_VGA_TextRender, first_row, count);
+}
+
+/**
+ * @brief Shows the framebuffer in the rows of the text area again.
+ */
+VGA_Status UB_VGA_TextStop(void)
+{
+    if (!UB_VGA_TextActive()) return VGA_SUCCESS;
+    return UB_VGA_SetLineRenderer(NULL);
+}
+
+/**
+ * @brief Tells whether the text area is shown.
+ */
+bool UB_VGA_TextActive(void)
+{
+    return UB_VGA_GetLineRenderer() == P_VGA_TextRender;
+}
+
+/**
+ * @brief Returns the number of columns of the text area.
+ */
+uint8_t UB_VGA_TextColumns(void)
+{
+    return P_VGA_TextColumns;
+}
+
+/**
+ * @brief Returns the number of rows of the text area.
+ */
+uint8_t UB_VGA_TextRows(void)
+{
+    return P_VGA_TextRowCount;
+}
+
+/**
+ * @brief Returns the attribute for two colors.
+ */
+uint8_t UB_VGA_TextAttr(uint8_t fg, uint8_t bg)
+{
+    return VGA_TEXT_ATTR(UB_VGA_PaletteIndex(fg), UB_VGA_PaletteIndex(bg));
+}
+
+/**
+ * @brief Returns the cells of one row.
+ */
+VGA_TextCell *UB_VGA_TextRow(uint8_t row)
+{
+    if (row >= P_VGA_TextRowCount) return NULL;
+    return P_VGA_TextMapRow(row, P_VGA_TextTop);
+}
+
+/**
+ * @brief Writes one character.
+ */
+VGA_Status UB_VGA_TextPutChar(uint8_t col, uint8_t row, char ch, uint8_t attr)
+{
+    VGA_TextCell *cells = UB_VGA_TextRow(row);
+    if (cells == NULL || col >= P_VGA_TextColumns) return VGA_ERROR_INVALID_COORDINATE;
+
+    cells[col].ch = (uint8_t)ch;
+    cells[col].attr = attr;
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Writes a string from a cell on, up to the end of the row.
+ */
+VGA_Status UB_VGA_TextPrint(uint8_t col, uint8_t row, const char *text, uint8_t attr)
+{
+    if (text == NULL) return VGA_ERROR_INVALID_PARAMETER;
+    VGA_TextCell *cells = UB_VGA_TextRow(row);
+    if (cells == NULL || col >= P_VGA_TextColumns) return VGA_ERROR_INVALID_COORDINATE;
+
+    for (uint32_t x = col; x < P_VGA_TextColumns && *text != '\0'; x++, text++) {
+        cells[x].ch = (uint8_t)*text;
+        cells[x].attr = attr;
+    }
+    return VGA_SUCCESS;
+}
+
+/**
+ * @brief Clears the text area to spaces.
+ */
+void UB_VGA_TextClear(uint8_t attr)
+{
+    uint32_t count = (uint32_t)P_VGA_TextColumns * P_VGA_TextRowCount;
+    for (uint32_t i = 0; i < count; i++) {
+        P_VGA_TextCells[i].ch = ' ';
+        P_VGA_TextCells[i].attr = attr;
+    }
+    P_VGA_TextFill = attr >> 4;
+}
+
+/**
+ * @brief Scrolls the text area up.
+ */
+void UB_VGA_TextScroll(uint8_t rows, uint8_t attr)
+{
+    if (P_VGA_TextRowCount == 0) return;
+    if (rows > P_VGA_TextRowCount) rows = P_VGA_TextRowCount;
+
+    // The rows at the top become the new rows at the bottom
+    for (uint32_t r = 0; r < rows; r++) {
+        VGA_TextCell *cells = UB_VGA_TextRow((uint8_t)r);
+        for (uint32_t x = 0; x < P_VGA_TextColumns; x++) {
+            cells[x].ch = ' ';
+            cells[x].attr = attr;
+        }
+    }
+    uint32_t top = P_VGA_TextTop + rows;
+    if (top >= P_VGA_TextRowCount) top -= P_VGA_TextRowCount;
+    P_VGA_TextTop = (uint8_t)top;
+}